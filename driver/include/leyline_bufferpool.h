@@ -0,0 +1,71 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE BUFFER POOL
+// Device-wide cache of stream buffer pages, so opening a stream doesn't allocate and
+// map pages every time. Blocks come in power-of-two page counts; a stream takes the
+// smallest class that holds its buffer and sees exactly its own size through a view
+// MDL. A returned block is zeroed by a work item before it is handed out again, or on
+// the open path if it is reused first, and keeps its view (and mirror mapping) so a
+// stream of the same size maps nothing at all. Blocks beyond the high-water mark are
+// freed. Uses only the platform shim, so it runs in the host simulation.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_common.h"
+
+// Classes of 1, 2, 4 ... 1024 pages (4 KB to 4 MB); larger buffers are not pooled.
+#define LEYLINE_POOL_CLASSES        11
+
+// Default high-water mark for the bytes held for reuse.
+#define LEYLINE_POOL_DEFAULT_LIMIT  (16 * 1024 * 1024)
+
+struct LeylinePoolBlock
+{
+    LIST_ENTRY  ListEntry;          // Clean or Dirty list while pooled
+    ULONG       Class;
+    PMDL        Mdl;                // The class's pages
+    PUCHAR      Mapping;            // All of them, mapped once
+
+    // What the last stream saw, kept while pooled so a stream of the same size reuses it.
+    ULONG       ViewSize;
+    PMDL        ViewMdl;            // The first ViewSize bytes of Mdl, for PortCls
+    PMDL        MirrorMdl;          // Set while MirrorMapping holds the view twice
+    PVOID       MirrorMapping;
+};
+
+struct LeylineBufferPool
+{
+    KSPIN_LOCK      Lock;
+    LIST_ENTRY      Clean[LEYLINE_POOL_CLASSES];    // Zeroed, ready to hand out
+    LIST_ENTRY      Dirty;                          // Returned, zeroed before reuse
+    PIO_WORKITEM    ZeroWork;                       // Null: zeroed on the open path only
+    BOOLEAN         ZeroQueued;
+    BOOLEAN         Closing;                        // Cleanup started; returns are freed
+    KEVENT          ZeroIdle;                       // Signaled while ZeroWork isn't queued
+    LeylinePoolStats Stats;                         // Limit and PooledBytes included
+};
+
+// Map the first Size bytes of Mdl's pages twice, back to back, through a second MDL
+// that lists each page frame twice. Size is whole pages. Null if it can't be mapped.
+PVOID LeylineMapMirrored(PMDL Mdl, ULONG Size, PMDL* MirrorMdl);
+
+// Lifetime, at PASSIVE_LEVEL. DeviceObject owns the zeroing work item; without one,
+// returned blocks are zeroed when reused. Cleanup waits for the work item and frees
+// every pooled block; blocks returned later are freed, not pooled.
+void LeylineBufferPoolInit(LeylineBufferPool* Pool, PDEVICE_OBJECT DeviceObject, ULONGLONG Limit);
+void LeylineBufferPoolCleanup(LeylineBufferPool* Pool);
+
+// Take a zeroed block whose view is Size bytes, mirrored if asked and the mapping
+// succeeds (MirrorMdl says). STATUS_NOT_SUPPORTED if Size is beyond the largest class.
+// Release hands the block back once nothing maps its view. Both at PASSIVE_LEVEL.
+NTSTATUS LeylineBufferPoolAcquire(LeylineBufferPool* Pool, ULONG Size, BOOLEAN Mirrored,
+                                  LeylinePoolBlock** Block);
+void     LeylineBufferPoolRelease(LeylineBufferPool* Pool, LeylinePoolBlock* Block);
+
+// High-water mark for the bytes held for reuse; lowering it frees blocks now, and 0
+// turns pooling off. Statistics are a snapshot. At PASSIVE_LEVEL.
+void LeylineBufferPoolSetLimit(LeylineBufferPool* Pool, ULONGLONG Limit);
+void LeylineBufferPoolQueryStats(LeylineBufferPool* Pool, LeylinePoolStats* Stats);
@@ -0,0 +1,116 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE STREAM CLOCK
+// Turns QPC ticks since a stream started into whole frames without dividing. Init
+// splits Rate / Frequency into an integer part and a 64-bit binary fraction; a reading
+// is then a multiply-high estimate that is exact or one frame short, settled by one
+// 128-bit comparison. The result is floor(elapsed * Rate / Frequency) exactly, for any
+// elapsed time the counter can reach, so positions never drift from the start time and
+// are always whole frames. The same split of Frequency / Rate answers the reverse
+// question, when a given frame begins. LeylineDivisor does the same for a fixed
+// divisor, so frame counts wrap into a ring without a division either. Pure arithmetic;
+// host-tested.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_common.h"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FIXED DIVISOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LeylineDivisor
+{
+    ULONGLONG Divisor;
+    ULONGLONG Reciprocal;   // floor((2^64 - 1) / Divisor)
+};
+
+// Divisor must not be zero.
+void LeylineDivisorInit(LeylineDivisor* Divisor, ULONGLONG Value);
+
+// Exact quotient and remainder. The reciprocal estimate is at most two short, so the
+// correction loop runs at most twice.
+inline ULONGLONG LeylineDivide(const LeylineDivisor* Divisor, ULONGLONG Value, ULONGLONG* Remainder)
+{
+    ULONGLONG quotient  = UnsignedMultiplyHigh(Value, Divisor->Reciprocal);
+    ULONGLONG remainder = Value - quotient * Divisor->Divisor;
+    while (remainder >= Divisor->Divisor)
+    {
+        quotient++;
+        remainder -= Divisor->Divisor;
+    }
+    *Remainder = remainder;
+    return quotient;
+}
+
+inline ULONGLONG LeylineModulo(const LeylineDivisor* Divisor, ULONGLONG Value)
+{
+    ULONGLONG remainder;
+    LeylineDivide(Divisor, Value, &remainder);
+    return remainder;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM CLOCK
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LeylineStreamClock
+{
+    LONGLONG  Start;        // QPC at which frame 0 began
+    ULONGLONG Whole;        // Frames per tick, integer part (zero unless Rate > Frequency)
+    ULONGLONG Fraction;     // Frames per tick, fractional part in units of 2^-64, rounded down
+    ULONGLONG Rate;         // Frames per second
+    ULONGLONG Frequency;    // Ticks per second
+    ULONGLONG InverseWhole;     // Ticks per frame, integer part
+    ULONGLONG InverseFraction;  // Ticks per frame, fractional part, as Fraction
+};
+
+// A zero Rate or a non-positive Frequency gives a clock that stays at frame 0.
+void LeylineClockInit(LeylineStreamClock* Clock, ULONG Rate, LONGLONG Frequency, LONGLONG Start);
+
+// Whole frames elapsed between Start and Now; zero before Start.
+inline ULONGLONG LeylineClockFrames(const LeylineStreamClock* Clock, LONGLONG Now)
+{
+    if (Now <= Clock->Start) return 0;
+
+    ULONGLONG elapsed = (ULONGLONG)(Now - Clock->Start);
+    ULONGLONG frames  = elapsed * Clock->Whole + UnsignedMultiplyHigh(elapsed, Clock->Fraction);
+
+    // One frame short if (frames + 1) * Frequency still fits under elapsed * Rate.
+    ULONGLONG targetHigh, nextHigh;
+    ULONGLONG target = UnsignedMultiply128(elapsed, Clock->Rate, &targetHigh);
+    ULONGLONG next   = UnsignedMultiply128(frames + 1, Clock->Frequency, &nextHigh);
+    if (nextHigh < targetHigh || (nextHigh == targetHigh && next <= target)) frames++;
+    return frames;
+}
+
+// The first QPC at which LeylineClockFrames reaches Frame, or MAXLONGLONG if it never
+// does. Same estimate-and-correct as above, run the other way.
+inline LONGLONG LeylineClockTimeOf(const LeylineStreamClock* Clock, ULONGLONG Frame)
+{
+    if (Clock->Rate == 0) return MAXLONGLONG;
+
+    // Frames that begin around 2^63 ticks out are past any reachable counter value; the
+    // estimate below would wrap for them.
+    ULONGLONG targetHigh, reachedHigh;
+    ULONGLONG target = UnsignedMultiply128(Frame, Clock->Frequency, &targetHigh);
+    if (targetHigh >= (Clock->Rate >> 1)) return MAXLONGLONG;
+
+    // floor(Frame * Frequency / Rate) or one less, then up to the first tick whose
+    // elapsed * Rate reaches Frame * Frequency.
+    ULONGLONG elapsed = Frame * Clock->InverseWhole + UnsignedMultiplyHigh(Frame, Clock->InverseFraction);
+    ULONGLONG reached = UnsignedMultiply128(elapsed, Clock->Rate, &reachedHigh);
+    while (reachedHigh < targetHigh || (reachedHigh == targetHigh && reached < target))
+    {
+        elapsed++;
+        ULONGLONG before = reached;
+        reached += Clock->Rate;
+        reachedHigh += (reached < before);
+    }
+
+    if (elapsed > (ULONGLONG)(MAXLONGLONG - Clock->Start)) return MAXLONGLONG;
+    return Clock->Start + (LONGLONG)elapsed;
+}
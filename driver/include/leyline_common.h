@@ -8,10 +8,8 @@
 
 #pragma once
 
-#include <portcls.h>
-#include <stdunk.h>
-#include <stdarg.h>
-#include <intrin.h>
+#include "leyline_platform.h"
+#include "leyline_telemetry.h"
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // IOCTL DEFINITIONS
@@ -32,124 +30,305 @@
 #define IOCTL_LEYLINE_CREATE_CABLE \
     CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 4, METHOD_BUFFERED, FILE_ANY_ACCESS)
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// SHARED PARAMETER BLOCK
-// Layout must be identical between kernel, APO, and HSA.
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#define IOCTL_LEYLINE_GET_PLACEMENT \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 5, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_SET_PLACEMENT \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 6, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_MAP_POSITIONS \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 7, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_MAP_TELEMETRY \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 8, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_GET_POOL_STATS \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 9, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_SET_POOL_LIMIT \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 10, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_GET_SAFETY \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 11, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_SET_SAFETY \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 12, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+#define IOCTL_LEYLINE_GET_STATS \
+    CTL_CODE(FILE_DEVICE_LEYLINE, LEYLINE_IOCTL_BASE + 13, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+// Per-tick probes behind IOCTL_LEYLINE_GET_STATS. Build with LEYLINE_PROBES=0 to compile
+// them out of the tick; the IOCTL then fails with STATUS_NOT_SUPPORTED.
+#ifndef LEYLINE_PROBES
+#define LEYLINE_PROBES          1
+#endif
+
+// No processor override: the balancer chooses.
+#define LEYLINE_PROCESSOR_AUTO  0xFFFFFFFF
+
+// Capture read-behind a cable starts with (two loopback periods, adaptive) and the
+// most IOCTL_LEYLINE_SET_SAFETY accepts.
+#define LEYLINE_SAFETY_DEFAULT_US   2000
+#define LEYLINE_SAFETY_MAX_US       50000
+
+// IOCTL_LEYLINE_GET_STATS histograms, one per probe. Lateness and wake are nanoseconds
+// read off the QPC; the stages are cycles of the processor's time stamp counter.
+#define LEYLINE_PROBE_LATENESS  0   // Tick start past one period after the previous tick
+#define LEYLINE_PROBE_TICK      1   // The whole timer callback
+#define LEYLINE_PROBE_WAKE      2   // Timer to the worker taking the tick; none inline
+#define LEYLINE_PROBE_POSITIONS 3   // Clocks, position registers, contributors, overrun
+#define LEYLINE_PROBE_MIX       4   // Copies, bus, resampling, gain and meter
+#define LEYLINE_PROBE_PUBLISH   5   // Position records
+#define LEYLINE_PROBE_LOCK_WAIT 6   // Notification timer waiting for StreamLock
+#define LEYLINE_PROBE_SIGNAL    7   // Notification timer signaling and re-arming
+#define LEYLINE_PROBE_COUNT     8
+
+// Log2 buckets: bucket 0 counts values below 2, bucket B values in [2^B, 2^(B+1)), and
+// the last one everything above.
+#define LEYLINE_STATS_BUCKETS   32
 
 #pragma pack(push, 1)
-struct LeylineSharedParameters
+// IOCTL_LEYLINE_SET_PLACEMENT input. Processor is an active processor index or
+// LEYLINE_PROCESSOR_AUTO.
+struct LeylinePlacementRequest
+{
+    ULONG   CableId;
+    ULONG   Processor;
+};
+
+// IOCTL_LEYLINE_GET_PLACEMENT output: a header, then as many cables as fit.
+struct LeylineCablePlacement
 {
-    ULONG   MasterGainBits;     // IEEE 754 float bits for master gain
-    ULONG   PeakLBits;          // IEEE 754 float bits for left peak
-    ULONG   PeakRBits;          // IEEE 754 float bits for right peak
-    LONGLONG QpcFrequency;
-    LONGLONG RenderStartQpc;
-    LONGLONG CaptureStartQpc;
-    ULONG   BufferSize;
-    ULONG   ByteRate;
-    ULONG   WritePos;           // Current render position (byte offset)
-    ULONG   ReadPos;            // Current capture position (byte offset)
+    ULONG   CableId;
+    ULONG   Processor;          // Processor index the cable's DPC targets
+    ULONG   Override;           // Configured index, or LEYLINE_PROCESSOR_AUTO
+    ULONG   CostNs;             // Measured loopback time per ms of audio, smoothed
+};
+
+struct LeylinePlacementInfo
+{
+    ULONG   Processors;         // Active processors considered
+    ULONG   CableCount;         // Cables in total; Cables[] may hold fewer
+    LeylineCablePlacement Cables[1];
+};
+
+// IOCTL_LEYLINE_GET_POOL_STATS output. Counts run from start-up; the hit rate is
+// Hits / (Hits + Misses). IOCTL_LEYLINE_SET_POOL_LIMIT takes a ULONGLONG Limit.
+struct LeylinePoolStats
+{
+    ULONGLONG Limit;            // High-water mark for PooledBytes
+    ULONGLONG PooledBytes;      // Held for reuse now, zeroed or waiting to be
+    ULONG     Hits;             // Stream buffers served from the pool
+    ULONG     Misses;           // Allocated because no block of the size class was free
+    ULONG     Oversized;        // Larger than the largest class, so never pooled
+    ULONG     Returned;         // Blocks taken back for reuse
+    ULONG     Trimmed;          // Blocks freed to keep PooledBytes under Limit
+    ULONG     ZeroedAhead;      // Blocks zeroed by the work item, off the open path
+    ULONG     ZeroedOnOpen;     // Blocks reused before the work item reached them
+};
+
+// IOCTL_LEYLINE_SET_SAFETY input. OffsetUs is the read-behind, or with Adaptive its
+// floor.
+struct LeylineSafetyRequest
+{
+    ULONG   CableId;
+    ULONG   OffsetUs;
+    ULONG   Adaptive;
+};
+
+// IOCTL_LEYLINE_GET_SAFETY output, for the cable Id given as an optional ULONG input
+// (cable 1 without one). Lateness is how much later than one period after the previous
+// tick each tick ran, over the last window of about a second; 0 until one completes.
+struct LeylineCableSafety
+{
+    ULONG   CableId;
+    ULONG   OffsetUs;           // Read-behind a capture starting now gets
+    ULONG   FloorUs;            // Configured offset
+    ULONG   Adaptive;
+    ULONG   EstimateUs;         // What the last window's lateness needs
+    ULONG   LatenessP50Us;
+    ULONG   LatenessP99Us;
+    ULONG   LatenessMaxUs;
+};
+
+// IOCTL_LEYLINE_GET_STATS output, for the cable Id given as an optional ULONG input
+// (cable 1 without one). Counts run from when the cable was created and wrap, so take
+// differences between two reads. Cycles over time is ElapsedCycles per ElapsedQpc at
+// QpcFrequency.
+struct LeylineCableStats
+{
+    ULONG     CableId;
+    ULONG     GlitchCount;        // Ticks that found frames the renderer had overwritten
+    ULONGLONG LostFrames;         // Master frames those ticks skipped
+    ULONGLONG ElapsedCycles;
+    ULONGLONG ElapsedQpc;
+    ULONGLONG QpcFrequency;
+    ULONG     Histograms[LEYLINE_PROBE_COUNT][LEYLINE_STATS_BUCKETS];
 };
 #pragma pack(pop)
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // RING BUFFER
-// A simple, lock-free ring buffer for audio samples.
+// A single-producer, single-consumer byte ring. The indices run freely: they wrap at
+// 2^32 when the size is a power of two, so an offset is a mask, and at twice the size
+// otherwise. Either way full and empty differ by distance alone and every byte is
+// usable. Each side owns a cache line holding the index it publishes (release) and
+// its cached copy of the other side's, which it reloads (acquire) only when the copy
+// says there is not enough room or data. AcquireWrite and AcquireRead hand out the
+// bytes in place, in at most two pieces; Commit publishes what was used. Over a
+// mirrored mapping, where the buffer's pages appear again right after its end, they
+// are always one piece.
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+// Bytes one side may touch, in ring order. Length[1] is zero unless they wrap.
+struct RingBufferSpan
+{
+    PUCHAR  Data[2];
+    ULONG   Length[2];
+};
+
 class RingBuffer
 {
 public:
-    RingBuffer() : m_Buffer(nullptr), m_Size(0), m_WritePos(0), m_ReadPos(0) {}
+    RingBuffer() { Init(nullptr, 0); }
 
-    void Init(PUCHAR buffer, ULONG size)
+    // Not safe against a running producer or consumer. Sizes that are not a power of
+    // two must stay below 2 GB. Mirrored: size bytes past the buffer alias its start.
+    void Init(PUCHAR buffer, ULONG size, BOOLEAN mirrored = FALSE)
     {
         m_Buffer   = buffer;
-        m_Size     = size;
-        m_WritePos = 0;
-        m_ReadPos  = 0;
+        m_Size     = buffer ? size : 0;
+        m_Mask     = m_Size ? m_Size - 1 : 0;
+        m_Wrap     = (m_Size & m_Mask) ? m_Size * 2 : 0;
+        m_Mirrored = buffer ? mirrored : FALSE;
+        Reset();
     }
 
-    PUCHAR GetBaseAddress() const { return m_Buffer; }
-    ULONG  GetSize()        const { return m_Size; }
+    PUCHAR  GetBaseAddress() const { return m_Buffer; }
+    ULONG   GetSize()        const { return m_Size; }
+    BOOLEAN IsMirrored()     const { return m_Mirrored; }
 
-    ULONG AvailableWrite() const
+    // From either side, or a third party. The consumer index is read first, so the
+    // producer never sees more room, nor the consumer less data, than there is.
+    ULONG AvailableRead() const
     {
-        if (m_Size == 0) return 0;
-        if (m_WritePos >= m_ReadPos)
-            return m_Size - (m_WritePos - m_ReadPos) - 1;
-        return m_ReadPos - m_WritePos - 1;
+        ULONG read = ReadULongAcquire(&m_Consumer.Index);
+        return Distance(ReadULongAcquire(&m_Producer.Index), read);
     }
 
-    ULONG AvailableRead() const
+    ULONG AvailableWrite() const { return m_Size - AvailableRead(); }
+
+    // Producer: up to Max free bytes at the write index. Commit no more than returned.
+    ULONG AcquireWrite(RingBufferSpan* span, ULONG max = MAXULONG)
     {
-        if (m_Size == 0) return 0;
-        if (m_WritePos >= m_ReadPos)
-            return m_WritePos - m_ReadPos;
-        return m_Size - (m_ReadPos - m_WritePos);
+        ULONG write = m_Producer.Index;
+        ULONG room  = m_Size - Distance(write, m_Producer.Cached);
+        if (room < max)
+        {
+            m_Producer.Cached = ReadULongAcquire(&m_Consumer.Index);
+            room = m_Size - Distance(write, m_Producer.Cached);
+        }
+        return MakeSpan(span, write, min(room, max));
     }
 
-    ULONG Write(const PUCHAR data, ULONG len)
+    void CommitWrite(ULONG len)
     {
-        ULONG available = AvailableWrite();
-        ULONG toWrite   = min(len, available);
-        if (toWrite == 0) return 0;
+        WriteULongRelease(&m_Producer.Index, Advance(m_Producer.Index, len));
+    }
 
-        ULONG firstPart = min(toWrite, m_Size - m_WritePos);
-        RtlCopyMemory(m_Buffer + m_WritePos, data, firstPart);
+    // Consumer: up to Max written bytes at the read index. Commit no more than returned.
+    ULONG AcquireRead(RingBufferSpan* span, ULONG max = MAXULONG)
+    {
+        ULONG read  = m_Consumer.Index;
+        ULONG ready = Distance(m_Consumer.Cached, read);
+        if (ready < max)
+        {
+            m_Consumer.Cached = ReadULongAcquire(&m_Producer.Index);
+            ready = Distance(m_Consumer.Cached, read);
+        }
+        return MakeSpan(span, read, min(ready, max));
+    }
 
-        if (firstPart < toWrite)
-            RtlCopyMemory(m_Buffer, data + firstPart, toWrite - firstPart);
+    void CommitRead(ULONG len)
+    {
+        WriteULongRelease(&m_Consumer.Index, Advance(m_Consumer.Index, len));
+    }
+
+    // Copying forms of the above.
+    ULONG Write(const UCHAR* data, ULONG len)
+    {
+        RingBufferSpan span;
+        ULONG toWrite = AcquireWrite(&span, len);
+        if (toWrite == 0) return 0;
+
+        RtlCopyMemory(span.Data[0], data, span.Length[0]);
+        if (span.Length[1])
+            RtlCopyMemory(span.Data[1], data + span.Length[0], span.Length[1]);
 
-        m_WritePos = (m_WritePos + toWrite) % m_Size;
+        CommitWrite(toWrite);
         return toWrite;
     }
 
     ULONG Read(PUCHAR data, ULONG len)
     {
-        ULONG available = AvailableRead();
-        ULONG toRead    = min(len, available);
+        RingBufferSpan span;
+        ULONG toRead = AcquireRead(&span, len);
         if (toRead == 0) return 0;
 
-        ULONG firstPart = min(toRead, m_Size - m_ReadPos);
-        RtlCopyMemory(data, m_Buffer + m_ReadPos, firstPart);
+        RtlCopyMemory(data, span.Data[0], span.Length[0]);
+        if (span.Length[1])
+            RtlCopyMemory(data + span.Length[0], span.Data[1], span.Length[1]);
 
-        if (firstPart < toRead)
-            RtlCopyMemory(data + firstPart, m_Buffer, toRead - firstPart);
-
-        m_ReadPos = (m_ReadPos + toRead) % m_Size;
+        CommitRead(toRead);
         return toRead;
     }
 
-    void Reset() { m_WritePos = m_ReadPos = 0; }
+    // Not safe against a running producer or consumer.
+    void Reset()
+    {
+        m_Producer.Index = m_Producer.Cached = 0;
+        m_Consumer.Index = m_Consumer.Cached = 0;
+    }
 
 private:
-    PUCHAR  m_Buffer;
-    ULONG   m_Size;
-    ULONG   m_WritePos;
-    ULONG   m_ReadPos;
-};
-
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// AUDIO MATH UTILITIES
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    ULONG Advance(ULONG index, ULONG len) const
+    {
+        index += len;
+        if (m_Wrap && index >= m_Wrap) index -= m_Wrap;
+        return index;
+    }
 
-namespace WaveRTMath
-{
-    // Convert elapsed QPC ticks to an absolute byte offset.
-    inline ULONGLONG TicksToBytes(LONGLONG elapsedTicks, ULONG byteRate, LONGLONG frequency)
+    // Bytes from one index forward to another.
+    ULONG Distance(ULONG to, ULONG from) const
     {
-        if (frequency <= 0) return 0;
-        // Standard 64-bit math is safe for >100 days of continuous playback at 192kHz/24bit.
-        return (ULONGLONG)((elapsedTicks * (unsigned __int64)byteRate) / (unsigned __int64)frequency);
+        ULONG distance = to - from;
+        if (m_Wrap && to < from) distance += m_Wrap;
+        return distance;
     }
 
-    // Clamp a byte offset into a ring buffer.
-    inline ULONGLONG CalculatePosition(LONGLONG elapsedTicks, ULONG byteRate, LONGLONG frequency, SIZE_T bufferSize)
+    ULONG MakeSpan(RingBufferSpan* span, ULONG index, ULONG len) const
     {
-        ULONGLONG bytes = TicksToBytes(elapsedTicks, byteRate, frequency);
-        if (bufferSize > 0) bytes %= (ULONGLONG)bufferSize;
-        return bytes;
+        ULONG offset = m_Wrap ? (index >= m_Size ? index - m_Size : index) : (index & m_Mask);
+        ULONG first  = m_Mirrored ? len : min(len, m_Size - offset);
+        span->Data[0]   = m_Buffer + offset;
+        span->Length[0] = first;
+        span->Data[1]   = m_Buffer;
+        span->Length[1] = len - first;
+        return len;
     }
-}
+
+    // Written once by Init, read by both sides.
+    PUCHAR  m_Buffer;
+    ULONG   m_Size;
+    ULONG   m_Mask;             // Size - 1; the offset mask when Wrap is zero
+    ULONG   m_Wrap;             // Twice the size, or zero to wrap at 2^32
+    BOOLEAN m_Mirrored;
+
+    struct DECLSPEC_CACHEALIGN Side
+    {
+        volatile ULONG Index;   // Published by this side
+        ULONG          Cached;  // This side's last look at the other side's Index
+    };
+    Side    m_Producer;
+    Side    m_Consumer;
+};
@@ -19,6 +19,7 @@ NTSTATUS ComponentIdHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS JackDescriptionHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS VolumeHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS MuteHandler(PPCPROPERTY_REQUEST PropertyRequest);
+NTSTATUS PeakMeterHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS PinCategoryHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS PinNameHandler(PPCPROPERTY_REQUEST PropertyRequest);
 NTSTATUS ProposedFormatHandler(PPCPROPERTY_REQUEST PropertyRequest);
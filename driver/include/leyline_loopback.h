@@ -0,0 +1,527 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE LOOPBACK CORE
+// Portable stream state and the render -> capture copy engine. Depends only on the
+// platform shim (spinlock, QPC, KEVENT, KTIMER, MDL), never on PortCls, so the same
+// code runs in the driver and in the Linux host simulation.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_bufferpool.h"
+#include "leyline_clock.h"
+#include "leyline_common.h"
+#include "leyline_meter.h"
+#include "leyline_mixer.h"
+#include "leyline_resampler.h"
+
+#define LEYLINE_MAX_NOTIFICATION_EVENTS 8
+
+// A non-master render stream further than this from the master's read window is
+// re-aligned to its own clock rather than mixed from a stale offset.
+#define LOOPBACK_RESYNC_FRAMES          16
+
+// LoopbackStreamAllocateBuffer flag: map the buffer twice back to back, so a span of
+// up to the buffer size starting anywhere in it is linear and the mix never splits a
+// copy at the wrap. Costs twice the address space and whole-page buffer sizes.
+#define LOOPBACK_BUFFER_MIRRORED        0x00000001
+
+// LoopbackStream::PositionSlot of a stream without a position record.
+#define LOOPBACK_NO_POSITION_SLOT       0xFFFFFFFF
+
+// Distinct rate pairs the engine keeps converter tables for.
+#define LOOPBACK_MAX_RESAMPLE_TABLES    16
+
+// A master volume or mute change reaches its new gain over this long, without clicks.
+#define LOOPBACK_GAIN_RAMP_MS           5
+
+// A capture stream aliased onto a render stream's pages reads this far behind the
+// render stream's position, so a tick that rewrites the frames just played with the
+// mix is done with them before the capture gets there. At most half the buffer.
+#define LOOPBACK_ALIAS_LAG_MS           2
+
+// Each running stream asks for a tick period of an eighth of its buffer or half its
+// notification interval, whichever is shorter, and the cable ticks at the shortest any
+// asks for. A cable allows LOOPBACK_MIN_PERIOD_US to LOOPBACK_MAX_PERIOD_US; a bare
+// engine ticks at LOOPBACK_PERIOD_US only. Below a millisecond the period is a
+// multiple of LOOPBACK_FAST_STEP_US on a high-resolution timer; above, whole ms.
+#define LOOPBACK_BUFFER_TICKS           8
+#define LOOPBACK_MIN_PERIOD_US          500
+#define LOOPBACK_MAX_PERIOD_US          10000
+#define LOOPBACK_FAST_STEP_US           100
+
+// Tick lateness is binned in LOOPBACK_LATENESS_BUCKET_US steps, the last bucket taking
+// everything beyond, over windows of LOOPBACK_LATENESS_WINDOW ticks (about a second).
+#define LOOPBACK_LATENESS_BUCKETS       64
+#define LOOPBACK_LATENESS_BUCKET_US     250
+#define LOOPBACK_LATENESS_WINDOW        1024
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BUFFER PAGES
+// The pages behind an allocated stream buffer and their kernel mapping. Counted, so a
+// capture stream aliased onto a render stream's buffer keeps them once the render
+// stream frees its buffer; whoever drops the last reference unmaps and frees them, or
+// hands them back to the buffer pool they came from.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LoopbackPages
+{
+    volatile LONG RefCount;
+    PMDL        Mdl;
+    PVOID       Mapping;
+    PMDL        MirrorMdl;          // Describes Mapping when the buffer is mirrored
+    ULONG       Size;
+    LeylineBufferPool* Pool;        // Owner of Block, which holds all of the above
+    LeylinePoolBlock*  Block;       // Null for pages the stream allocated itself
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK STREAM
+// Everything the loopback engine needs to know about one render or capture stream.
+// Owned by CMiniportWaveRTStream in the driver, or directly by the host simulation.
+// The first cache line is all the tick touches in the stream itself: what it writes
+// every tick, next to what a position query reads. Everything else the tick needs is
+// copied into the snapshot's stream table (below) when the stream registers. Lines 1
+// and 2 are what the copies are made from; the rest is touched when the stream opens,
+// changes format or state, or closes. The layout report checks lines 0 and 2.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct DECLSPEC_CACHEALIGN LoopbackStream
+{
+    // Line 0. Cursor is the engine cursor in frames. Render: next frame to mix.
+    // Capture: frame reached this tick, or the next frame to write when resampled.
+    PUCHAR      BufferBase;         // Buffer.GetBaseAddress()
+    ULONG       BufferFrames;       // Whole frames in Buffer
+    KSSTATE     State;
+    ULONG       ByteRate;
+    ULONG       FrameBytes;         // Derived from the format; never zero
+    LONGLONG    StartTime;
+    ULONGLONG   HwPositionRegister;
+    ULONGLONG   HwClockRegister;
+    ULONGLONG   Cursor;
+
+    // Record in the engine's position page while registered (its StreamId is PositionId).
+    // Assigned and released under StreamLock, like NotifyFrames and NotifyNext; the tick
+    // reads it here rather than from its copy, so it never writes a released record.
+    ULONG       PositionSlot;
+    BOOLEAN     Mixing;             // Render stream contributes to the current tick
+    BOOLEAN     Resampling;         // Converted to or from the bus rate this tick
+
+    // Line 1: the clock, rebuilt at RUN from StartTime and FrameRate.
+    LeylineStreamClock Clock;
+    ULONG       FrameRate;          // ByteRate / FrameBytes
+    ULONG       Channels;
+
+    // Line 2: the rest of what the tick's copy holds.
+    ULONGLONG   FrameShift;         // Added to the clock's frames when aliased; under StreamLock
+    LeylineDivisor BufferDivisor;   // Wraps frame counts into the buffer
+    const LeylineMixKernels* Kernels; // Picked once per format for this CPU
+    LoopbackPages* Pages;           // Referenced while held; null for a borrowed MDL
+    LeylineSampleFormat SampleFormat;
+    ULONG       SafetyFrames;       // Capture read-behind, fixed at RUN; 0 for render
+    ULONG       PositionId;
+    BOOLEAN     BufferMirrored;     // Buffer.IsMirrored()
+    BOOLEAN     IsCapture;
+
+    // Then the notification state and the period, read only under StreamLock.
+    ULONGLONG   NotifyNext;         // Frame at which the next notification is due
+    ULONG       NotifyFrames;       // NotificationBytes in whole frames, fixed at RUN
+    ULONG       PeriodUs;           // Tick period asked for, fixed at RUN
+
+    // Cold: lists, the format as given, the ring itself, the converter and events.
+    LIST_ENTRY  ListEntry;
+    PMDL        Mdl;
+    PVOID       Mapping;
+    LONGLONG    Frequency;
+    ULONG       BitsPerSample;
+    BOOLEAN     IsFloat;
+    RingBuffer  Buffer;
+    LeylineResampler Resampler;     // History allocated at RUN, freed on unregister
+    PKEVENT     NotificationEvents[LEYLINE_MAX_NOTIFICATION_EVENTS];
+    ULONG       NotificationBytes;
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM SNAPSHOT
+// What the tick reads instead of the lists: the registered streams and converter
+// tables as of the last change. A writer builds a new one under StreamLock, swaps the
+// pointer, and frees the old one after the tick that may still be reading it has
+// finished. Writers never modify one once published.
+// The streams are a table of two-line entries, one per stream, in list order, each
+// holding what the mix reads and only writers change: the state, the clock and its
+// shift, the wrap divisor, the format and kernels, the pages. Those change only under
+// StreamLock and are followed by a new snapshot, so a tick walks one contiguous array
+// and touches each stream's own first line only for what it updates.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct DECLSPEC_CACHEALIGN LoopbackTickStream
+{
+    LoopbackStream*     Stream;
+    LeylineStreamClock  Clock;
+    ULONGLONG           FrameShift;
+    LeylineDivisor      BufferDivisor;
+    const LeylineMixKernels* Kernels;
+    LoopbackPages*      Pages;
+    ULONG               FrameRate;
+    ULONG               Channels;
+    LeylineSampleFormat SampleFormat;
+    BOOLEAN             BufferMirrored;
+    BOOLEAN             Running;           // State was KSSTATE_RUN when published
+    BOOLEAN             OwnerRunning;      // A capture whose pages a running render writes
+    ULONG               SafetyFrames;
+};
+
+struct LoopbackSnapshot
+{
+    ULONG                  RenderCount;
+    ULONG                  CaptureCount;
+    LeylineResampleQuality ResampleQuality;
+    ULONG                  ResampleTableCount;
+    ULONG                  TableGeneration;    // Changes when tables are retired
+    const LeylineResampleTable* ResampleTables[LOOPBACK_MAX_RESAMPLE_TABLES];
+    LoopbackTickStream     Streams[1];         // RenderCount renders, then the captures
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK ENGINE
+// Stream lists, lock, mix bus and the periodic timer that drives the copy. StreamLock
+// serializes writers (registration, power, controls) and guards the lists; the tick
+// never takes it. The tick owns the mix state below; writers only touch that state
+// while the timer is stopped, and stopping it waits out a tick in flight, with
+// StreamLock dropped and TimerGate held so no other timer change overtakes it.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LoopbackEngine
+{
+    KSPIN_LOCK  StreamLock;
+    LIST_ENTRY  RenderStreams;
+    LIST_ENTRY  CaptureStreams;
+    KTIMER      LoopbackTimer;
+    KDPC        LoopbackDpc;
+    BOOLEAN     TimerRunning;
+    BOOLEAN     TimerChanging;      // Stopping or retuning: a tick mixes nothing meanwhile
+    FAST_MUTEX  TimerGate;          // Orders timer changes across their wait for a tick
+    ULONG       GlitchCount;        // Ticks that dropped frames the renderer had overwritten
+    ULONGLONG   LostFrames;
+    ULONG       CableId;            // Names the engine in trace events; set by its cable
+
+    // Notification scheduler: a high-resolution one-shot timer armed for the earliest
+    // notification boundary of any running stream, whether or not the loopback timer
+    // runs. NotifyDue is the QPC it is armed for, or 0. Both under StreamLock. Without
+    // the timer (allocation failed) the tick signals events at its own granularity.
+    PEX_TIMER   NotifyTimer;
+    LONGLONG    NotifyDue;
+    BOOLEAN     NotifyEnabled;      // Cleared while the device is stopped
+
+    // The tick's view of the lists, and its sequence: odd while a tick runs, so a
+    // writer that replaced something can wait for the one tick that might still see it.
+    LoopbackSnapshot* volatile Snapshot;
+    volatile LONG TickSequence;
+
+    // Converter tables per rate pair, built at PASSIVE_LEVEL when a stream starts.
+    // Writers' copies; the tick uses the snapshot's. TableGenerationSeen is the tick's.
+    LeylineResampleQuality ResampleQuality;
+    LeylineResampleTable*  ResampleTables[LOOPBACK_MAX_RESAMPLE_TABLES];
+    ULONG                  ResampleTableCount;
+    ULONG                  TableGeneration;
+    ULONG                  TableGenerationSeen;
+
+    // Master volume and mute as a linear gain applied on the way into every capture.
+    // Setters move GainTarget; the tick starts a ramp from GainCurrent when it sees it
+    // differ from GainRampTarget and moves GainCurrent toward it.
+    volatile float GainTarget;
+    float       GainFrom;
+    float       GainCurrent;
+    float       GainRampTarget;
+
+    // Levels of the mix after master gain. Metering keeps the bus running even when
+    // every capture takes the raw copy. Settled levels go to Telemetry and to the
+    // legacy SharedParams, whichever are set; PublishPending asks the tick to publish
+    // them to a page attached while it runs. The gain section of Telemetry is written
+    // by the setters under StreamLock, from VolumeLevel and Mute.
+    volatile BOOLEAN MeterLevels;
+    volatile BOOLEAN MeterLoudness;
+    LeylineMeter Meter;
+    LeylineTelemetryPage* volatile Telemetry;
+    LeylineSharedParameters* volatile SharedParams;
+    volatile LONG PublishPending;
+    LONG        VolumeLevel;
+    BOOLEAN     Mute;
+
+    // Per-stream position records for user mode, or null. Writers fill a stream's
+    // record under StreamLock when it starts, pauses or leaves; the tick refreshes the
+    // position of running ones. PositionLock is held by either while it writes records,
+    // always at DISPATCH_LEVEL, and the tick skips its refresh when a writer has it.
+    // PositionSlots has a bit per record in use.
+    LeylinePositionPage* volatile PositionPage;
+    volatile LONG PositionLock;
+    ULONG       PositionSlots;
+    ULONG       PositionNextId;
+
+    // Processor the DPC targets (LEYLINE_PROCESSOR_AUTO until placed), and a moving
+    // average of the time the tick spends mixing, in QPC ticks scaled by
+    // 1 << LOOPBACK_COST_SHIFT. The cost is zero while the timer is stopped.
+    ULONG       Processor;
+    LONGLONG    TickCost;
+
+    // The timer runs only while some render and some capture stream are both in RUN,
+    // so a cable whose streams are paused, acquired or stopped takes no wakeups. It
+    // ticks every TickPeriodUs, the shortest period a running stream asked for and at
+    // most MaxPeriodUs: on FastTimer (high resolution, TickFast) below a millisecond,
+    // and otherwise on LoopbackTimer, coalescable by TimerToleranceMs where the capture
+    // read-behind floor covers the delay. The period, the range, TimerArms and the
+    // tolerance are the writers', changed only while the timer is stopped; the wakeup
+    // counts are the tick's. All but the range go to the telemetry page's timer section.
+    PEX_TIMER   FastTimer;          // Null if it could not be allocated: whole ms only
+    BOOLEAN     TickFast;
+    ULONG       TickPeriodUs;
+    ULONG       MinPeriodUs;
+    ULONG       MaxPeriodUs;
+    LONGLONG    QpcFrequency;
+    ULONG       TimerToleranceMs;
+    ULONGLONG   TimerArms;
+    ULONGLONG   TimerWakeups;
+    ULONGLONG   IdleWakeups;        // Wakeups that found nothing to mix
+
+    // With a worker thread the timer only stamps each tick and wakes it, and the mix
+    // runs on the worker at PASSIVE_LEVEL; without one it runs in the timer callback.
+    // The timer's half posts the tick's QPC into whichever of Requests the worker is
+    // not reading, by RequestSequence parity, under DpcSequence (odd while it runs, so
+    // WaitForTick covers both halves). The worker takes the newest request, counting
+    // the ones it skipped in CoalescedTicks, and mixes up to it under TickSequence.
+    // WorkerLatency is its smoothed post-to-done time, scaled like TickCost, and goes
+    // into the read-behind estimate in place of the tick cost. Set up before the timer
+    // first runs and torn down after it last does. The worker follows the DPC to
+    // Processor as its ideal processor; WorkerProcessor is the one it last took.
+    HANDLE      WorkerThread;       // Null: the tick mixes in the timer callback
+    KEVENT      WorkerWake;
+    volatile LONG WorkerStop;
+    volatile LONG DpcSequence;
+    volatile LONG RequestSequence;
+    LONG        RequestTaken;       // The worker's
+    ULONG       WorkerProcessor;    // The worker's
+    LONGLONG    Requests[2];
+    LONGLONG    WorkerLatency;
+    ULONGLONG   WorkerBatches;
+    ULONGLONG   CoalescedTicks;
+
+    // Capture read-behind. A capture reports its position SafetyFrames behind the
+    // frames the tick has written, so a reader never reaches frames the next tick has
+    // yet to write; the offset is taken when the stream starts and held while it runs,
+    // so its position never steps back. SafetyFloorUs and SafetyAdaptive are under
+    // StreamLock. The tick bins how late each tick came against the period and, at
+    // the end of each window, publishes its percentiles and SafetyEstimateUs: what
+    // that lateness needs. An adaptive cable starts captures at the larger of the two.
+    ULONG       SafetyFloorUs;
+    BOOLEAN     SafetyAdaptive;
+    volatile ULONG SafetyEstimateUs;
+    volatile ULONG LatenessP50Us;
+    volatile ULONG LatenessP99Us;
+    volatile ULONG LatenessMaxUs;
+    LONGLONG    TickPeriodQpc;
+    LONGLONG    LastTickQpc;        // Tick's; 0 until the first tick after the timer is armed
+    LONGLONG    LatenessMaxQpc;
+    ULONG       LatenessTicks;
+    ULONG       LatenessCounts[LOOPBACK_LATENESS_BUCKETS];
+
+    // Scratch for one block of the render mix; only touched by the tick.
+    float       MixBus[LEYLINE_MIX_BLOCK_FRAMES * LEYLINE_MAX_CHANNELS];
+    float       ResampleScratch[LEYLINE_MIX_BLOCK_FRAMES * LEYLINE_MAX_CHANNELS];
+
+    // Per-tick probes for IOCTL_LEYLINE_GET_STATS. Each histogram has one writer: the
+    // timer callback, the worker or the notification timer, in that order, so only a
+    // rarely used bucket at either end shares a line with another writer's. Read without
+    // a lock. The bases are taken at Init to turn cycles into time.
+#if LEYLINE_PROBES
+    ULONG       ProbeCounts[LEYLINE_PROBE_COUNT][LEYLINE_STATS_BUCKETS];
+    ULONGLONG   ProbeCycleBase;
+    LONGLONG    ProbeQpcBase;
+#endif
+};
+
+// The loopback timer's base period, which the read-behind floor and the tick cost are
+// measured against: 1ms.
+static const ULONG    LOOPBACK_PERIOD_US    = 1000;
+
+// Tick cost smoothing: each tick moves the average 1/16 of the way to its own cost.
+static const ULONG    LOOPBACK_COST_SHIFT   = 4;
+
+// The worker thread's priority: above the real-time band MMCSS gives audio clients, so
+// none of them holds up a tick in progress, or the writers waiting for it.
+static const LONG     LOOPBACK_WORKER_PRIORITY = LOW_REALTIME_PRIORITY + 12;
+
+// Requests a worker batch takes before it goes back to wait; later ones wake it again.
+static const ULONG    LOOPBACK_WORKER_BATCH = 4;
+
+// The tick republishes the timer's counters every this many wakeups (100 ms).
+static const ULONG    LOOPBACK_TIMER_PUBLISH_TICKS = 100;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ENGINE API
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LoopbackEngineInit(LoopbackEngine* Engine);
+
+// Cancel the timers and drain any queued DPC (surprise removal, D3, unload).
+// PASSIVE_LEVEL.
+void LoopbackEngineStop(LoopbackEngine* Engine);
+
+// Re-arm the timer after a return to D0 if a render and a capture stream are still
+// running, and the notification timer if any stream wants notifications.
+// PASSIVE_LEVEL.
+void LoopbackEngineResume(LoopbackEngine* Engine);
+
+// Free the notification timer, converter tables and snapshot, and end the worker
+// thread. Only after Stop, once no stream can start. PASSIVE_LEVEL.
+void LoopbackEngineCleanup(LoopbackEngine* Engine);
+
+// Move the mix off the timer callback onto a real-time worker thread of the engine's
+// own. Before any stream starts; on failure the tick stays in the callback. Cables
+// start one; a bare engine mixes in the callback. PASSIVE_LEVEL.
+NTSTATUS LoopbackEngineStartWorker(LoopbackEngine* Engine);
+
+// Back a capture stream's buffer with the pages of the engine's only registered
+// render stream, when its format matches, its buffer holds at least RequestedSize and
+// no other capture shares it. The capture's frame count is shifted so that its
+// position runs LOOPBACK_ALIAS_LAG_MS behind the render stream's offset; the shift is
+// set again whenever either starts. While that render stream is the only source at
+// unity gain the tick copies nothing; otherwise it writes the mix over the frames the
+// render stream has just played. STATUS_NOT_SUPPORTED if the streams don't qualify, and
+// the caller allocates a buffer of its own. ActualSize is the render stream's size.
+// The render client must keep its writes within the buffer less that lag ahead of its
+// play position, or it overwrites frames the capture has yet to read.
+NTSTATUS LoopbackEngineAliasBuffer(LoopbackEngine* Engine, LoopbackStream* Capture, ULONG RequestedSize,
+                                   ULONG* ActualSize);
+
+// Pick the converter tier and build its tables for the running streams. PASSIVE_LEVEL.
+void LoopbackEngineSetResampleQuality(LoopbackEngine* Engine, LeylineResampleQuality Quality);
+
+// Master volume in 1/65536 dB and mute, from the topology nodes. The tick ramps to
+// the new gain. IRQL <= DISPATCH_LEVEL.
+void LoopbackEngineSetMasterGain(LoopbackEngine* Engine, LONG VolumeLevel, BOOLEAN Mute);
+
+// Metering of the mix (peak and RMS, on by default) and of its short-term loudness
+// (off by default: its K-weighting filters are serial per channel and cost several
+// times the levels).
+void LoopbackEngineSetMetering(LoopbackEngine* Engine, BOOLEAN Levels, BOOLEAN Loudness);
+
+// Where the gain and settled levels are published; null to stop. The caller fills the
+// header first. Before the page is unmapped.
+void LoopbackEngineSetTelemetry(LoopbackEngine* Engine, LeylineTelemetryPage* Page);
+
+// Where the tick publishes settled levels for legacy clients; null to stop. Before the
+// page is unmapped.
+void LoopbackEngineSetSharedParameters(LoopbackEngine* Engine, LeylineSharedParameters* Params);
+
+// Where stream positions are published; null to stop. Fills the header and the records
+// of streams already registered. Before the page is unmapped.
+void LoopbackEngineSetPositionPage(LoopbackEngine* Engine, LeylinePositionPage* Page);
+
+// Largest peak of one bus channel since the previous call, full scale 1.0.
+float LoopbackEngineTakePeak(LoopbackEngine* Engine, ULONG Channel);
+
+// Target the DPC at one processor (index), moving a running timer there. The next
+// tick may come up to a period late; positions are clock-based so nothing is lost.
+// The worker thread takes the processor as its ideal one when it next wakes.
+// IRQL <= DISPATCH_LEVEL.
+void LoopbackEngineSetProcessor(LoopbackEngine* Engine, ULONG Processor);
+
+// Smoothed time the tick spends mixing per millisecond of audio, in nanoseconds: one
+// tick's cost at the base period, and scaled to it at any other.
+ULONG LoopbackEngineTickCostNs(const LoopbackEngine* Engine);
+
+// Whether the timer runs, that is some render and some capture stream are in RUN: the
+// only time the engine costs anything to place. IRQL <= DISPATCH_LEVEL.
+BOOLEAN LoopbackEngineRunning(LoopbackEngine* Engine);
+
+// The tick periods streams starting from now on may ask for, in microseconds; a
+// maximum above a millisecond is rounded down to whole ms. The running timer moves to
+// a shorter period at once, and to a longer one only as far as the streams already
+// running asked for. The engine starts at LOOPBACK_PERIOD_US for both; cables allow
+// LOOPBACK_MIN_PERIOD_US to LOOPBACK_MAX_PERIOD_US. PASSIVE_LEVEL.
+void LoopbackEngineSetTickRange(LoopbackEngine* Engine, ULONG MinPeriodUs, ULONG MaxPeriodUs);
+
+// Capture read-behind for captures that start from now on: OffsetUs (at most
+// LEYLINE_SAFETY_MAX_US), or with Adaptive the larger of that and what the observed
+// tick lateness needs. Running captures keep theirs until they restart. The engine
+// starts with none; cables start at LEYLINE_SAFETY_DEFAULT_US, adaptive.
+void LoopbackEngineSetSafetyOffset(LoopbackEngine* Engine, ULONG OffsetUs, BOOLEAN Adaptive);
+
+// The read-behind a capture starting now would get, the settings and the lateness
+// percentiles of the last full window. CableId is left for the caller.
+void LoopbackEngineQuerySafety(LoopbackEngine* Engine, LeylineCableSafety* Info);
+
+// The probe histograms and overrun counts; STATUS_NOT_SUPPORTED when the probes are
+// compiled out. CableId is left for the caller.
+NTSTATUS LoopbackEngineQueryStats(const LoopbackEngine* Engine, LeylineCableStats* Info);
+
+// One loopback period: advance positions, mix every running render stream into every
+// running capture stream, converting rates through the bus, and refresh the position
+// records. Signals events only when there is no notification timer. With a worker
+// thread, only stamps the tick and wakes the worker, which does the rest.
+void LoopbackEngineTick(LoopbackEngine* Engine);
+
+// What the worker thread runs each time it wakes: the rest of the ticks posted since,
+// as one batch up to the newest, with vector state saved once. The host simulation
+// calls it where the thread would have run. PASSIVE_LEVEL.
+void LoopbackEngineWork(LoopbackEngine* Engine);
+
+// The worker thread: waits for ticks until the engine is cleaned up.
+extern "C" void LoopbackWorkerRoutine(PVOID StartContext);
+
+extern "C" void LoopbackDpcRoutine(PKDPC Dpc, PVOID DeferredContext,
+                                   PVOID SystemArgument1, PVOID SystemArgument2);
+
+// The notification timer's callback: signal every stream whose boundary has passed and
+// re-arm for the next one. DISPATCH_LEVEL.
+extern "C" void LoopbackNotifyRoutine(PEX_TIMER Timer, PVOID Context);
+
+// The high-resolution timer's callback for periods under a millisecond: one tick.
+// DISPATCH_LEVEL.
+extern "C" void LoopbackFastTimerRoutine(PEX_TIMER Timer, PVOID Context);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM API
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LoopbackStreamInit(LoopbackStream* Stream, BOOLEAN Capture);
+// ValidBitsPerSample is 0 unless WAVEFORMATEXTENSIBLE narrows the container.
+void LoopbackStreamSetFormat(LoopbackStream* Stream, ULONG ByteRate, ULONG BitsPerSample,
+                             ULONG ValidBitsPerSample, ULONG Channels, BOOLEAN IsFloat);
+
+// Transition the stream; RUN stamps the start time and joins the engine, STOP leaves it.
+// PASSIVE_LEVEL: a change to the engine's timer waits out a tick in progress.
+void LoopbackStreamSetState(LoopbackEngine* Engine, LoopbackStream* Stream, KSSTATE State);
+
+// Leave the engine unconditionally (stream teardown). PASSIVE_LEVEL.
+void LoopbackStreamUnregister(LoopbackEngine* Engine, LoopbackStream* Stream);
+
+// Byte offset into the ring buffer at QPC time Now (0 while not running). A capture's
+// runs its read-behind behind the frames written.
+ULONGLONG LoopbackStreamPosition(const LoopbackStream* Stream, LONGLONG Now);
+
+// A capture's read-behind in bytes: its own while registered, otherwise what it would
+// get starting now. Always 0 for a render stream.
+ULONG LoopbackStreamSafetyBytes(LoopbackEngine* Engine, const LoopbackStream* Stream);
+
+// Buffer ownership. Allocate sizes and maps private pages, mirrored if Flags asks and
+// the mapping succeeds; AllocatePooled takes them from Pool instead when the size has
+// a class there, and allocates them itself otherwise. Attach borrows an MDL. Free
+// drops the stream's reference to its pages, which are freed (or returned to their
+// pool) once no aliased capture holds them either.
+NTSTATUS LoopbackStreamAllocateBuffer(LoopbackStream* Stream, ULONG RequestedSize, ULONG Flags,
+                                      ULONG* ActualSize);
+NTSTATUS LoopbackStreamAllocatePooledBuffer(LoopbackStream* Stream, LeylineBufferPool* Pool,
+                                            ULONG RequestedSize, ULONG Flags, ULONG* ActualSize);
+void     LoopbackStreamAttachBuffer(LoopbackStream* Stream, PMDL Mdl, PUCHAR Base, ULONG Size);
+void     LoopbackStreamFreeBuffer(LoopbackStream* Stream);
+
+// Notification events (referenced while registered). Engine is the one the stream
+// joins, or null. Remove and Release wait out a tick that may still be signalling the
+// event before dropping it. PASSIVE_LEVEL.
+NTSTATUS LoopbackStreamAddEvent(LoopbackEngine* Engine, LoopbackStream* Stream, PKEVENT Event);
+NTSTATUS LoopbackStreamRemoveEvent(LoopbackEngine* Engine, LoopbackStream* Stream, PKEVENT Event);
+void     LoopbackStreamReleaseEvents(LoopbackEngine* Engine, LoopbackStream* Stream);
+void     LoopbackStreamSignalEvents(LoopbackStream* Stream, ULONGLONG LastPosBytes, ULONGLONG CurrentPosBytes);
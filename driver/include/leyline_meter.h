@@ -0,0 +1,79 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE METER
+// Peak, RMS and short-term loudness of the float bus, measured on each block the tick
+// has already mixed while it is still in cache. Peak and sum of squares come from one
+// vectorized pass; loudness adds the BS.1770 K-weighting filters per channel. Levels
+// are settled every LEYLINE_METER_BLOCK_MS and published from there.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_mixer.h"
+
+// RMS window and publish period. Also the BS.1770 block step, so short-term loudness
+// is the mean of the last LEYLINE_METER_LOUDNESS_BLOCKS blocks (3 s).
+#define LEYLINE_METER_BLOCK_MS          100
+#define LEYLINE_METER_LOUDNESS_BLOCKS   30
+
+// Reported loudness for silence, in LUFS.
+#define LEYLINE_METER_SILENCE_LUFS      (-120.0f)
+
+// One second-order section in direct form I, double precision so the 38 Hz high-pass
+// stays stable at 192 kHz.
+struct LeylineBiquad
+{
+    double  B0, B1, B2;
+    double  A1, A2;
+};
+
+// Settled levels, linear full scale except Loudness.
+struct LeylineMeterLevels
+{
+    float   Peak[LEYLINE_MAX_CHANNELS];
+    float   Rms[LEYLINE_MAX_CHANNELS];
+    float   Loudness;                   // LUFS, short-term
+};
+
+struct LeylineMeter
+{
+    ULONG   SampleRate;                 // 0 while idle
+    ULONG   Channels;
+    BOOLEAN Loudness;                   // Run the K-weighting filters
+    ULONG   BlockFrames;
+    ULONG   BlockFill;
+
+    // Current block.
+    float   BlockPeak[LEYLINE_MAX_CHANNELS];
+    double  BlockEnergy[LEYLINE_MAX_CHANNELS];
+    double  BlockWeighted[LEYLINE_MAX_CHANNELS];
+
+    // Largest peak since the last LeylineMeterTakePeak, for the topology node.
+    float   PeakHold[LEYLINE_MAX_CHANNELS];
+
+    // K-weighting: high shelf then high-pass, with x1 x2 y1 y2 per section and channel.
+    LeylineBiquad Shelf;
+    LeylineBiquad HighPass;
+    double  State[LEYLINE_MAX_CHANNELS][8];
+
+    double  LoudnessHistory[LEYLINE_METER_LOUDNESS_BLOCKS];
+    ULONG   LoudnessIndex;
+    ULONG   LoudnessCount;
+
+    LeylineMeterLevels Levels;
+    ULONG   Blocks;                     // Blocks settled since the last reset
+};
+
+// Start over at a bus rate and width (0 = idle). Only arithmetic, so the tick calls it
+// whenever the master stream's rate or the bus width changes.
+void    LeylineMeterReset(LeylineMeter* Meter, ULONG SampleRate, ULONG Channels, BOOLEAN Loudness);
+
+// Measure Frames interleaved bus frames as if scaled by Gain. Returns TRUE when at least
+// one block settled, i.e. Levels changed.
+BOOLEAN LeylineMeterProcess(LeylineMeter* Meter, const float* Bus, ULONG Frames, float Gain,
+                            LeylineSimdLevel Level);
+
+// Return and clear the held peak of one channel. Safe while the meter is processing.
+float   LeylineMeterTakePeak(LeylineMeter* Meter, ULONG Channel);
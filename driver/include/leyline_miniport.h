@@ -9,9 +9,60 @@
 #pragma once
 
 #include "leyline_common.h"
+#include "leyline_loopback.h"
+#include "leyline_placement.h"
+#include "leyline_slab.h"
+#include "leyline_trace.h"
 #include "leyline_guids.h"
 #include "leyline_descriptors.h"
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CABLE
+// One render/capture endpoint pair and everything its loopback needs: the engine
+// (stream lists, lock, timer and DPC), volume and mute, and the shared parameter and
+// position pages.
+// Its four miniports hold a pointer to it, so a cable never sees another cable's
+// streams or waits on its lock. Cable 1 is embedded in the DeviceExtension; the rest
+// are allocated by IOCTL_LEYLINE_CREATE_CABLE and live until unload.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct DeviceExtension;
+
+struct LeylineCable
+{
+    LIST_ENTRY          ListEntry;        // DeviceExtension::Cables, spawned cables only
+    ULONG               Id;               // 1-based, matches the subdevice name suffix
+    DeviceExtension*    Device;
+
+    // Processor index from IOCTL_LEYLINE_SET_PLACEMENT, or LEYLINE_PROCESSOR_AUTO.
+    ULONG               ProcessorOverride;
+
+    // Loopback engine
+    LoopbackEngine      Loopback;
+
+    // Volume / Mute (shared between property handlers and DPC)
+    LONG                VolumeLevel;      // 1/65536 dB, range [-96*0x10000, 0]
+    LONG                MuteState;        // 0 = unmuted, nonzero = muted
+    ULONG               GainLinear16;     // Precomputed 16.16 fixed-point linear gain
+
+    // Gain and meter telemetry, mapped by IOCTL_LEYLINE_MAP_TELEMETRY, and the legacy
+    // page mapped by IOCTL_LEYLINE_MAP_PARAMS.
+    LeylineTelemetryPage* Telemetry;
+    PMDL                TelemetryMdl;
+    LeylineSharedParameters* SharedParams;
+    PMDL                SharedParamsMdl;
+
+    // Per-stream position records, mapped by IOCTL_LEYLINE_MAP_POSITIONS.
+    LeylinePositionPage* PositionPage;
+    PMDL                PositionMdl;
+
+    // Fallback audio buffer for streams whose own allocation fails. Only cable 1 has
+    // one; it is also what IOCTL_LEYLINE_MAP_BUFFER maps.
+    PMDL                LoopbackMdl;
+    PUCHAR              LoopbackBuffer;
+    SIZE_T              LoopbackSize;
+};
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // DEVICE EXTENSION
 // Appended past the PortCls-reserved region of DeviceExtension.
@@ -24,38 +75,90 @@ class CMiniportTopology;
 struct DeviceExtension
 {
     PDEVICE_OBJECT  ControlDeviceObject;
-    LeylineSharedParameters* SharedParams;
-    PMDL            SharedParamsMdl;
     PVOID           SharedParamsUserMapping;
-    PMDL            LoopbackMdl;
-    PUCHAR          LoopbackBuffer;
-    SIZE_T          LoopbackSize;
     PVOID           UserMapping;
     CMiniportWaveRT* RenderMiniport;
     CMiniportWaveRT* CaptureMiniport;
     CMiniportTopology* RenderTopoMiniport;
     CMiniportTopology* CaptureTopoMiniport;
 
-    // Loopback engine
-    KSPIN_LOCK          StreamLock;
-    LIST_ENTRY          RenderStreams;
-    LIST_ENTRY          CaptureStreams;
-    KTIMER              LoopbackTimer;
-    KDPC                LoopbackDpc;
-    BOOLEAN             TimerRunning;
-    ULONGLONG           LastCopiedByte;
-    ULONG               GlitchCount;
+    // Cable 1, registered by StartDevice.
+    LeylineCable        Cable;
 
-    // Volume / Mute (shared between property handlers and DPC)
-    LONG                VolumeLevel;      // 1/65536 dB, range [-96*0x10000, 0]
-    LONG                MuteState;        // 0 = unmuted, nonzero = muted
-    ULONG               GainLinear16;     // Precomputed 16.16 fixed-point linear gain
+    // Cables 2..n. Only changed and walked at PASSIVE_LEVEL; the lock keeps the IOCTL
+    // path and unload/power from racing.
+    LIST_ENTRY          Cables;
+    KSPIN_LOCK          CableLock;
+    ULONG               CableCount;       // Including cable 1
+
+    // Stream buffer pages for every cable, initialized with the cable list.
+    LeylineBufferPool   BufferPool;
 };
 
 // The PortCls reference driver reserves this many pointer-sized slots
 // in the DeviceExtension before our own fields begin.
 static const SIZE_T LEYLINE_PORT_CLASS_DEVICE_EXTENSION_SIZE = 64 * sizeof(PVOID);
 
+// Cable lifetime (cable.cpp). Init allocates the shared and position pages and, if
+// LoopbackSize is nonzero, the fallback buffer; Cleanup stops the engine and frees them.
+void          LeylineCableInit(LeylineCable* Cable, DeviceExtension* DevExt, ULONG Id, SIZE_T LoopbackSize);
+void          LeylineCableCleanup(LeylineCable* Cable);
+
+// Spawned cables: allocate and link one, look one up by Id (cable 1 included), and
+// stop, resume or tear down every cable of the device, none before the first start.
+LeylineCable* LeylineCableCreate(DeviceExtension* DevExt, ULONG Id);
+LeylineCable* LeylineCableFind(DeviceExtension* DevExt, ULONG Id);
+void          LeylineCablesStop(DeviceExtension* DevExt);
+void          LeylineCablesResume(DeviceExtension* DevExt);
+void          LeylineCablesDestroy(DeviceExtension* DevExt);
+
+// DPC placement (leyline_placement.h). Balance re-targets each cable's DPC from the
+// measured tick costs; it runs at PASSIVE_LEVEL whenever a cable's timer starts or
+// stops, a cable is created, or an override changes.
+void          LeylineCablesBalance(DeviceExtension* DevExt);
+NTSTATUS      LeylineCablesGetPlacement(DeviceExtension* DevExt, LeylinePlacementInfo* Info,
+                                        ULONG Size, ULONG_PTR* Written);
+NTSTATUS      LeylineCableSetPlacement(DeviceExtension* DevExt, const LeylinePlacementRequest* Request);
+
+// Capture read-behind of one cable (IOCTL_LEYLINE_GET_SAFETY / SET_SAFETY). A new
+// setting applies to captures as they next start.
+NTSTATUS      LeylineCableGetSafety(DeviceExtension* DevExt, ULONG CableId, LeylineCableSafety* Info);
+NTSTATUS      LeylineCableSetSafety(DeviceExtension* DevExt, const LeylineSafetyRequest* Request);
+
+// Probe histograms of one cable (IOCTL_LEYLINE_GET_STATS).
+NTSTATUS      LeylineCableGetStats(DeviceExtension* DevExt, ULONG CableId, LeylineCableStats* Info);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// OBJECT SLABS
+// Driver-wide caches (driver.cpp) for what every stream open and cable spawn creates,
+// set up in DriverEntry and emptied at unload. A class declared with
+// DECLARE_SLAB_NEW is created with plain new, drawn from its slab, and returned to it
+// by the Release that deletes it; the pool form of new no longer compiles for it.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LeylineObjectSlabs
+{
+    LeylineSlab         Streams;          // CMiniportWaveRTStream
+    LeylineSlab         WaveMiniports;    // CMiniportWaveRT
+    LeylineSlab         TopoMiniports;    // CMiniportTopology
+    LeylineSlab         Cables;           // Spawned cables; cable 1 is in the extension
+};
+
+extern LeylineObjectSlabs g_ObjectSlabs;
+
+void LeylineObjectSlabsInit();
+void LeylineObjectSlabsCleanup();
+
+#define DECLARE_SLAB_NEW(Slab)                                                          \
+    static PVOID operator new(size_t Size) noexcept                                     \
+    {                                                                                   \
+        return LeylineSlabAllocate(&g_ObjectSlabs.Slab, Size);                          \
+    }                                                                                   \
+    static void operator delete(PVOID Object)                                           \
+    {                                                                                   \
+        LeylineSlabFree(&g_ObjectSlabs.Slab, Object);                                   \
+    }
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // WAVE RT STREAM
 // Manages a single audio stream (render or capture).
@@ -67,8 +170,9 @@ class CMiniportWaveRTStream : public IMiniportWaveRTStream,
 {
 public:
     DECLARE_STD_UNKNOWN();
+    DECLARE_SLAB_NEW(Streams);
 
-    CMiniportWaveRTStream(PUNKNOWN OuterUnknown, DeviceExtension* DevExt);
+    CMiniportWaveRTStream(PUNKNOWN OuterUnknown, LeylineCable* Cable);
     virtual ~CMiniportWaveRTStream();
 
     // IMiniportWaveRTStream
@@ -95,52 +199,21 @@ public:
     // Initialization helper.
     NTSTATUS Init(ULONG PinId, BOOLEAN Capture, PKSDATAFORMAT Format);
 
-    // Event signaling helper
-    void CheckAndSignalEvents(ULONGLONG lastPosBytes, ULONGLONG currentPosBytes);
-
-    // Hardware register update helper
-    void UpdateHwRegisters(ULONGLONG PositionBytes, ULONGLONG ClockValue)
-    {
-        m_HwPositionRegister = PositionBytes;
-        m_HwClockRegister = ClockValue;
-    }
-
-    // Public accessors for the loopback engine.
-    PUCHAR   GetBufferBase()     const { return m_Buffer.GetBaseAddress(); }
-    SIZE_T   GetBufferSize()     const { return m_Buffer.GetSize(); }
-    BOOLEAN  IsStreamCapture()   const { return m_IsCapture; }
-    KSSTATE  GetStreamState()    const { return m_State; }
-    ULONG    GetStreamByteRate() const { return m_ByteRate; }
-    LONGLONG GetStartTime()      const { return m_StartTime; }
-    LONGLONG GetFrequency()      const { return m_Frequency; }
-    ULONG    GetBitsPerSample()  const { return m_BitsPerSample; }
-    ULONG    GetChannels()       const { return m_Channels; }
-    BOOLEAN  IsFloat()           const { return m_IsFloat; }
-
-    LIST_ENTRY         m_ListEntry;
+    // Public accessors (state lives in the portable LoopbackStream).
+    PUCHAR   GetBufferBase()     const { return m_Stream.Buffer.GetBaseAddress(); }
+    SIZE_T   GetBufferSize()     const { return m_Stream.Buffer.GetSize(); }
+    BOOLEAN  IsStreamCapture()   const { return m_Stream.IsCapture; }
+    KSSTATE  GetStreamState()    const { return m_Stream.State; }
+    ULONG    GetStreamByteRate() const { return m_Stream.ByteRate; }
+    LONGLONG GetStartTime()      const { return m_Stream.StartTime; }
+    LONGLONG GetFrequency()      const { return m_Stream.Frequency; }
+    ULONG    GetBitsPerSample()  const { return m_Stream.BitsPerSample; }
+    ULONG    GetChannels()       const { return m_Stream.Channels; }
+    BOOLEAN  IsFloat()           const { return m_Stream.IsFloat; }
 
 private:
-    RingBuffer         m_Buffer;
-    KSSTATE            m_State;
-    PMDL               m_Mdl;
-    PVOID              m_Mapping;
-    BOOLEAN            m_IsCapture;
-    BOOLEAN            m_OwnsMdl;
-    LONGLONG           m_StartTime;
-    ULONG              m_ByteRate;
-    LONGLONG           m_Frequency;
-    DeviceExtension*   m_DevExt;
-    ULONG              m_BitsPerSample;
-    ULONG              m_Channels;
-    BOOLEAN            m_IsFloat;
-
-    // Notification events
-    PKEVENT            m_NotificationEvents[8];
-    ULONG              m_NotificationBytes;
-
-    // Hardware Registers
-    ULONGLONG          m_HwPositionRegister;
-    ULONGLONG          m_HwClockRegister;
+    LoopbackStream     m_Stream;
+    LeylineCable*      m_Cable;
 };
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -152,8 +225,9 @@ class CMiniportWaveRT : public IMiniportWaveRT,
 {
 public:
     DECLARE_STD_UNKNOWN();
+    DECLARE_SLAB_NEW(WaveMiniports);
 
-    CMiniportWaveRT(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, DeviceExtension* DevExt);
+    CMiniportWaveRT(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, LeylineCable* Cable);
     virtual ~CMiniportWaveRT();
 
     // IMiniport
@@ -175,7 +249,7 @@ public:
 private:
     BOOLEAN          m_IsCapture;
     BOOLEAN          m_IsInitialized;
-    DeviceExtension* m_DevExt;
+    LeylineCable*    m_Cable;
 };
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -187,10 +261,11 @@ class CMiniportTopology : public IMiniportTopology,
 {
 public:
     DECLARE_STD_UNKNOWN();
+    DECLARE_SLAB_NEW(TopoMiniports);
 
-    CMiniportTopology(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, DeviceExtension* DevExt);
+    CMiniportTopology(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, LeylineCable* Cable);
     virtual ~CMiniportTopology();
-    DeviceExtension* GetDevExt() const { return m_DevExt; }
+    LeylineCable* GetCable() const { return m_Cable; }
 
     // IMiniport
     STDMETHODIMP GetDescription(PPCFILTER_DESCRIPTOR* Description) override;
@@ -207,7 +282,7 @@ private:
     BOOLEAN          m_IsCapture;
     BOOLEAN          m_IsInitialized;
     PVOID            m_Port;
-    DeviceExtension* m_DevExt;
+    LeylineCable*    m_Cable;
 };
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -219,10 +294,3 @@ inline DeviceExtension* GetDeviceExtension(PDEVICE_OBJECT DeviceObject)
     PUCHAR base = reinterpret_cast<PUCHAR>(DeviceObject->DeviceExtension);
     return reinterpret_cast<DeviceExtension*>(base + LEYLINE_PORT_CLASS_DEVICE_EXTENSION_SIZE);
 }
-
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// LOOPBACK DPC
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-extern "C" void LoopbackDpcRoutine(PKDPC Dpc, PVOID DeferredContext,
-                                   PVOID SystemArgument1, PVOID SystemArgument2);
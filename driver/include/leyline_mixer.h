@@ -0,0 +1,105 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE MIXER
+// Float mix bus used by the loopback engine to sum every running render stream.
+// Each render stream is accumulated in one linear pass over its samples; the bus is
+// then written to each capture stream with saturation. The float bus is the pivot of
+// the format conversion matrix: every format has one decoder and one encoder per SIMD
+// level, picked once when the stream's format is set.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_platform.h"
+
+// Frames mixed per block; bounds the bus scratch regardless of DPC lateness.
+#define LEYLINE_MIX_BLOCK_FRAMES 256
+#define LEYLINE_MAX_CHANNELS     8
+
+enum LeylineSampleFormat
+{
+    LeylineSampleUnsupported = 0,
+    LeylineSampleInt16,
+    LeylineSampleInt24,         // Packed, 3 bytes per sample
+    LeylineSampleInt24In32,     // 24 valid bits, left-justified in a 32-bit container
+    LeylineSampleInt32,
+    LeylineSampleFloat32,
+    LeylineSampleFormatCount
+};
+
+// ValidBitsPerSample is wValidBitsPerSample from WAVEFORMATEXTENSIBLE (0 = container size).
+LeylineSampleFormat LeylineSampleFormatOf(ULONG BitsPerSample, ULONG ValidBitsPerSample, BOOLEAN IsFloat);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CONVERSION KERNELS
+// Matched-layout kernels take Samples = Frames * Channels interleaved samples. Every
+// level produces bit-identical output to the scalar kernels.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+enum LeylineSimdLevel
+{
+    LeylineSimdScalar = 0,
+    LeylineSimdSse2,
+    LeylineSimdAvx2,            // Needs the AVX register state saved at DISPATCH_LEVEL
+};
+
+typedef void (*LeylineAccumulateFn)(float* Bus, const UCHAR* Src, ULONG Samples);
+typedef void (*LeylineWriteOutFn)(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+typedef void (*LeylineScaleCopyFn)(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+
+// Gain is folded into the encode scale, so applying it costs nothing on the integer
+// formats and one multiply on float32. ScaleCopy gives the same samples as a pass
+// through an empty bus.
+struct LeylineMixKernels
+{
+    LeylineAccumulateFn Accumulate;     // Bus += decode(Src)
+    LeylineWriteOutFn   WriteOut;       // Dst = saturate(encode(Bus * Gain))
+    LeylineScaleCopyFn  ScaleCopy;      // Dst = saturate(encode(decode(Src) * Gain))
+    LeylineSimdLevel    Level;
+};
+
+// Highest level this CPU and OS support; detected once.
+LeylineSimdLevel LeylineDetectSimdLevel();
+
+// Kernels for Format at no more than Level. Never returns null.
+const LeylineMixKernels* LeylineSelectMixKernels(LeylineSampleFormat Format, LeylineSimdLevel Level);
+
+// Bracket a batch of kernel calls at DISPATCH_LEVEL. Begin saves the AVX state when
+// Wanted needs it and returns the level that is safe to use until End.
+LeylineSimdLevel LeylineSimdBegin(LeylineSimdLevel Wanted, PXSTATE_SAVE Save);
+void             LeylineSimdEnd(LeylineSimdLevel Level, PXSTATE_SAVE Save);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STRIDED PATHS
+// Scalar fallbacks for layouts whose channel counts differ.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Add Frames frames of interleaved Src into the bus. Channels beyond the narrower of
+// the two layouts are ignored.
+void MixAccumulate(float* Bus, ULONG BusChannels,
+                   const UCHAR* Src, LeylineSampleFormat Format, ULONG SrcChannels,
+                   ULONG Frames);
+
+// Write Frames frames of the bus times Gain to Dst, saturating to the destination
+// range. Destination channels without a bus channel are written as silence.
+void MixWriteOut(UCHAR* Dst, LeylineSampleFormat Format, ULONG DstChannels,
+                 const float* Bus, ULONG BusChannels, ULONG Frames, float Gain);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MASTER GAIN
+// Volume arrives in KS units of 1/65536 dB. The linear gain is looked up in two small
+// tables (whole dB and 1/16 dB steps), so nothing evaluates pow() in the driver.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_VOLUME_MIN      (-96 * 0x10000)
+#define LEYLINE_VOLUME_MAX      0
+#define LEYLINE_VOLUME_STEP     0x10000
+
+// Linear gain for Level, clamped to the volume range; exactly 1.0 at 0 dB.
+float LeylineGainFromVolume(LONG Level);
+
+// Multiply Frames interleaved frames of the bus by a gain that moves Step per frame
+// towards Target and holds there. Returns the gain after the last frame.
+float MixApplyGainRamp(float* Bus, ULONG Channels, ULONG Frames, float Gain, float Target, float Step);
@@ -0,0 +1,39 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE DPC PLACEMENT
+// Chooses a processor for each cable's loopback DPC from its measured tick cost.
+// Overrides are placed first; the rest go, most expensive first, to the least loaded
+// processor (LPT scheduling). Nothing moves while the current placement is within a
+// fraction of what LPT would achieve, and when something must, a cable stays where it
+// is unless moving saves more than a fraction of its own cost, so noise in the
+// measurements doesn't bounce DPCs between processors. Pure arithmetic, so it runs
+// anywhere and is host-tested.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_common.h"
+
+// Processors considered; indexes past this are never chosen or accepted as overrides.
+#define LEYLINE_PLACEMENT_MAX_PROCESSORS    64
+
+// Rebalance only if the busiest processor is more than 1/8 over the LPT result; then
+// a cable moves only if its processor is more than Cost >> SHIFT busier than the best.
+#define LEYLINE_PLACEMENT_HYSTERESIS_SHIFT  3
+
+struct LeylinePlacementEntry
+{
+    ULONG     CableId;
+    ULONG     Override;     // Processor index, or LEYLINE_PROCESSOR_AUTO
+    ULONG     Processor;    // In: current (or LEYLINE_PROCESSOR_AUTO); out: assigned
+    ULONGLONG Cost;         // Any unit, as long as every entry uses the same one
+    PVOID     Context;      // Caller's, carried through the reordering
+};
+
+// Assign every entry a processor below Processors. Reorders Entries (most expensive
+// first, overrides ahead). Load, if given, receives the summed cost per processor and
+// must hold Processors values. Returns how many entries changed processor.
+ULONG LeylinePlacementBalance(LeylinePlacementEntry* Entries, ULONG Count, ULONG Processors,
+                              ULONGLONG* Load);
@@ -0,0 +1,19 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE PLATFORM SELECTION
+// Pulls in the WDK headers for the driver build, or the user-mode kernel shim when
+// the portable loopback core is compiled for the Linux host simulation.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#if defined(LEYLINE_HOST)
+#include "leyline_host.h"
+#else
+#include <portcls.h>
+#include <stdunk.h>
+#include <stdarg.h>
+#include <intrin.h>
+#endif
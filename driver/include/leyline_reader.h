@@ -0,0 +1,291 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE TELEMETRY READER
+// Header-only user-mode reader for the pages in leyline_telemetry.h. Standard C++ and
+// nothing else, so it builds anywhere; only mapping a page needs Windows. The driver
+// publishes multi-field sections under a sequence that is odd while a write is in
+// progress, and these functions take a consistent copy or report that they could not.
+// A page may be mapped by several readers at once; none of them ever write to it.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_telemetry.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// IOCTL_LEYLINE_MAP_TELEMETRY, IOCTL_LEYLINE_MAP_POSITIONS and IOCTL_LEYLINE_MAP_PARAMS
+// from leyline_common.h, which needs the WDK.
+#define LEYLINE_READER_IOCTL_MAP_PARAMS     0x0022200Cu
+#define LEYLINE_READER_IOCTL_MAP_POSITIONS  0x0022201Cu
+#define LEYLINE_READER_IOCTL_MAP_TELEMETRY  0x00222020u
+
+// A write takes well under a microsecond, so a reader that keeps losing the race is
+// reading a page nobody is publishing consistently; give up rather than spin forever.
+#define LEYLINE_READER_RETRIES  1024
+
+struct LeylineGainReading
+{
+    float   Gain;               // Linear, 0 when muted
+    int32_t VolumeLevel;        // 1/65536 dB
+    bool    Mute;
+};
+
+struct LeylineMeterReading
+{
+    uint32_t Channels;          // 0 when nothing is playing
+    float    Peak[2];           // Full scale 1.0
+    float    Rms[2];
+    float    Loudness;          // LUFS
+};
+
+struct LeylineTimerReading
+{
+    bool     Running;
+    uint32_t ToleranceMs;
+    uint32_t PeriodUs;
+    uint64_t Wakeups;
+    uint64_t IdleWakeups;
+    uint64_t Arms;
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOADS
+// Volatile so each read goes to the page; the acquire fences keep the copy between
+// the two sequence reads.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline uint32_t LeylineLoad32(const void* Field)
+{
+    return *static_cast<const volatile uint32_t*>(Field);
+}
+
+static inline int64_t LeylineLoad64(const void* Field)
+{
+    return *static_cast<const volatile int64_t*>(Field);
+}
+
+static inline float LeylineFloatFromBits(uint32_t Bits)
+{
+    float value;
+    std::memcpy(&value, &Bits, sizeof(value));
+    return value;
+}
+
+// Copy Bytes from a section published under Sequence into Copy.
+static inline bool LeylineReadSection(const uint32_t* Sequence, const void* Section,
+                                      void* Copy, size_t Bytes)
+{
+    for (int attempt = 0; attempt < LEYLINE_READER_RETRIES; attempt++)
+    {
+        uint32_t begin = LeylineLoad32(Sequence);
+        if (begin & 1) continue;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Word loads from the page, byte stores into the copy, so Copy may be any type.
+        const volatile uint32_t* from = static_cast<const volatile uint32_t*>(Section);
+        unsigned char* to = static_cast<unsigned char*>(Copy);
+        for (size_t i = 0; i < Bytes / sizeof(uint32_t); i++)
+        {
+            uint32_t word = from[i];
+            std::memcpy(to + i * sizeof(word), &word, sizeof(word));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (LeylineLoad32(Sequence) == begin) return true;
+    }
+    return false;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TELEMETRY PAGE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// A page this reader understands, of which MappedBytes are mapped: right magic and
+// major version, and at least the first version 1 sections. A larger Size is a newer
+// driver that has appended to the page, which is fine; an appended section is only
+// read when Size covers it.
+static inline bool LeylineTelemetryValid(const LeylineTelemetryPage* Page, size_t MappedBytes)
+{
+    if (!Page || MappedBytes < sizeof(LeylineTelemetryHeader)) return false;
+    if (LeylineLoad32(&Page->Header.Magic) != LEYLINE_TELEMETRY_MAGIC) return false;
+    if (LeylineLoad32(&Page->Header.Version) != LEYLINE_TELEMETRY_VERSION) return false;
+
+    uint32_t size = LeylineLoad32(&Page->Header.Size);
+    size_t   read = (size < sizeof(LeylineTelemetryPage)) ? size : sizeof(LeylineTelemetryPage);
+    return size >= LEYLINE_TELEMETRY_SIZE_V1 && MappedBytes >= read;
+}
+
+static inline bool LeylineTelemetryHas(const LeylineTelemetryPage* Page, size_t SectionEnd)
+{
+    return LeylineLoad32(&Page->Header.Size) >= SectionEnd;
+}
+
+static inline bool LeylineReadGain(const LeylineTelemetryPage* Page, LeylineGainReading* Reading)
+{
+    uint32_t copy[3];
+    if (!LeylineReadSection(&Page->Gain.Sequence, &Page->Gain.GainBits, copy, sizeof(copy))) return false;
+
+    Reading->Gain        = LeylineFloatFromBits(copy[0]);
+    Reading->VolumeLevel = static_cast<int32_t>(copy[1]);
+    Reading->Mute        = copy[2] != 0;
+    return true;
+}
+
+static inline bool LeylineReadMeter(const LeylineTelemetryPage* Page, LeylineMeterReading* Reading)
+{
+    uint32_t copy[6];
+    if (!LeylineReadSection(&Page->Meter.Sequence, &Page->Meter.Channels, copy, sizeof(copy))) return false;
+
+    Reading->Channels = copy[0];
+    Reading->Peak[0]  = LeylineFloatFromBits(copy[1]);
+    Reading->Peak[1]  = LeylineFloatFromBits(copy[2]);
+    Reading->Rms[0]   = LeylineFloatFromBits(copy[3]);
+    Reading->Rms[1]   = LeylineFloatFromBits(copy[4]);
+    Reading->Loudness = LeylineFloatFromBits(copy[5]);
+    return true;
+}
+
+// False if the driver predates the timer section, as well as if it never settled.
+static inline bool LeylineReadTimer(const LeylineTelemetryPage* Page, LeylineTimerReading* Reading)
+{
+    if (!LeylineTelemetryHas(Page, offsetof(LeylineTelemetryPage, Timer) + sizeof(LeylineTelemetryTimer))) return false;
+
+    LeylineTelemetryTimer copy;
+    if (!LeylineReadSection(&Page->Timer.Sequence, &Page->Timer.Running, &copy.Running,
+                            offsetof(LeylineTelemetryTimer, Reserved) - offsetof(LeylineTelemetryTimer, Running))) return false;
+
+    Reading->Running     = copy.Running != 0;
+    Reading->ToleranceMs = copy.ToleranceMs;
+    Reading->PeriodUs    = copy.PeriodUs;
+    Reading->Wakeups     = copy.Wakeups;
+    Reading->IdleWakeups = copy.IdleWakeups;
+    Reading->Arms        = copy.Arms;
+    return true;
+}
+
+static inline int64_t LeylineTelemetryQpcFrequency(const LeylineTelemetryPage* Page)
+{
+    return LeylineLoad64(&Page->Header.QpcFrequency);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POSITION PAGE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline bool LeylinePositionsValid(const LeylinePositionPage* Page, size_t MappedBytes)
+{
+    if (!Page || MappedBytes < sizeof(LeylinePositionPage)) return false;
+    return LeylineLoad32(&Page->Version) == LEYLINE_POSITION_VERSION &&
+           LeylineLoad32(&Page->HeaderSize) == offsetof(LeylinePositionPage, Records) &&
+           LeylineLoad32(&Page->RecordSize) == sizeof(LeylinePositionRecord);
+}
+
+// A consistent copy of one record. False if Slot is out of range or the record never
+// settled; a record with StreamId 0 is free.
+static inline bool LeylineReadPosition(const LeylinePositionPage* Page, uint32_t Slot, LeylinePositionRecord* Record)
+{
+    if (Slot >= LeylineLoad32(&Page->RecordCount) || Slot >= LEYLINE_MAX_POSITION_RECORDS) return false;
+
+    const LeylinePositionRecord* record = &Page->Records[Slot];
+    if (!LeylineReadSection(&record->Sequence, &record->StreamId, &Record->StreamId,
+                            sizeof(LeylinePositionRecord) - offsetof(LeylinePositionRecord, StreamId))) return false;
+    Record->Sequence = 0;
+    return true;
+}
+
+// Bytes the stream of Record has played at Qpc: its last published position, moved on
+// at ByteRate while it runs.
+static inline uint64_t LeylinePositionAt(const LeylinePositionRecord* Record, int64_t QpcFrequency, int64_t Qpc)
+{
+    const uint32_t runState = 3;    // KSSTATE_RUN
+    if (Record->State != runState || Qpc <= Record->Qpc || QpcFrequency <= 0) return Record->Position;
+
+    double elapsed = static_cast<double>(Qpc - Record->Qpc) / static_cast<double>(QpcFrequency);
+    uint64_t frames = static_cast<uint64_t>(elapsed * Record->ByteRate) / (Record->FrameBytes ? Record->FrameBytes : 1);
+    return Record->Position + frames * Record->FrameBytes;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEGACY SHARED PARAMETERS
+// The packed page leaves its 32-bit fields 4-byte aligned, so they load directly; the
+// 64-bit ones do not and are not read here.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline bool LeylineReadLegacyMeter(const LeylineSharedParameters* Params, LeylineMeterReading* Reading)
+{
+    const char* base = reinterpret_cast<const char*>(Params);
+    const uint32_t* sequence = reinterpret_cast<const uint32_t*>(base + offsetof(LeylineSharedParameters, MeterSequence));
+
+    uint32_t peaks[2], levels[3];
+    for (int attempt = 0; attempt < LEYLINE_READER_RETRIES; attempt++)
+    {
+        uint32_t begin = LeylineLoad32(sequence);
+        if (begin & 1) continue;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        peaks[0]  = LeylineLoad32(base + offsetof(LeylineSharedParameters, PeakLBits));
+        peaks[1]  = LeylineLoad32(base + offsetof(LeylineSharedParameters, PeakRBits));
+        levels[0] = LeylineLoad32(base + offsetof(LeylineSharedParameters, RmsLBits));
+        levels[1] = LeylineLoad32(base + offsetof(LeylineSharedParameters, RmsRBits));
+        levels[2] = LeylineLoad32(base + offsetof(LeylineSharedParameters, LoudnessBits));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (LeylineLoad32(sequence) != begin) continue;
+
+        Reading->Channels = 2;      // The legacy page does not say
+        Reading->Peak[0]  = LeylineFloatFromBits(peaks[0]);
+        Reading->Peak[1]  = LeylineFloatFromBits(peaks[1]);
+        Reading->Rms[0]   = LeylineFloatFromBits(levels[0]);
+        Reading->Rms[1]   = LeylineFloatFromBits(levels[1]);
+        Reading->Loudness = LeylineFloatFromBits(levels[2]);
+        return true;
+    }
+    return false;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MAPPING (WINDOWS)
+// Each call maps the cable's page into the process again. Cable 1 is the default
+// cable; IOCTL_LEYLINE_CREATE_CABLE returns the Id of a new one.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#ifdef _WIN32
+static inline HANDLE LeylineOpenDevice()
+{
+    HANDLE device = CreateFileW(L"\\\\.\\Global\\LeylineAudio", GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (device == INVALID_HANDLE_VALUE)
+        device = CreateFileW(L"\\\\.\\LeylineAudio", GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    return device;
+}
+
+static inline void* LeylineMapPage(HANDLE Device, DWORD Ioctl, ULONG CableId)
+{
+    void* page = nullptr;
+    DWORD returned = 0;
+    if (!DeviceIoControl(Device, Ioctl, &CableId, sizeof(CableId), &page, sizeof(page), &returned, nullptr)) return nullptr;
+    return (returned == sizeof(page)) ? page : nullptr;
+}
+
+// The cable's telemetry page, or null if there is none or it is not one this reader
+// understands.
+static inline const LeylineTelemetryPage* LeylineMapTelemetry(HANDLE Device, ULONG CableId)
+{
+    const LeylineTelemetryPage* page = static_cast<const LeylineTelemetryPage*>(LeylineMapPage(Device, LEYLINE_READER_IOCTL_MAP_TELEMETRY, CableId));
+    return LeylineTelemetryValid(page, sizeof(LeylineTelemetryPage)) ? page : nullptr;
+}
+
+static inline const LeylinePositionPage* LeylineMapPositions(HANDLE Device, ULONG CableId)
+{
+    const LeylinePositionPage* page = static_cast<const LeylinePositionPage*>(LeylineMapPage(Device, LEYLINE_READER_IOCTL_MAP_POSITIONS, CableId));
+    return LeylinePositionsValid(page, sizeof(LeylinePositionPage)) ? page : nullptr;
+}
+#endif
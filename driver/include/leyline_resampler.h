@@ -0,0 +1,87 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE RESAMPLER
+// Fixed-ratio polyphase resampler between two stream rates, run on the float bus.
+// The rate pair is reduced to L/M; each of the L phases holds a windowed-sinc filter
+// of Taps coefficients, built once per rate pair and quality tier at PASSIVE_LEVEL.
+// The DPC only evaluates dot products over planar per-channel history.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_mixer.h"
+
+// Bounds on the per-pair table. Every pair between 8 kHz and 192 kHz in the standard
+// rate families fits in both.
+#define LEYLINE_RESAMPLE_MAX_TAPS   256
+#define LEYLINE_RESAMPLE_MAX_PHASES 4096
+
+// History frames per channel: the longest filter plus one block of new input.
+#define LEYLINE_RESAMPLE_HISTORY    (LEYLINE_RESAMPLE_MAX_TAPS + LEYLINE_MIX_BLOCK_FRAMES)
+
+enum LeylineResampleQuality
+{
+    LeylineResampleLow = 0,         // 16 taps, cutoff at 70% of the lower Nyquist
+    LeylineResampleMedium,          // 32 taps, 85%
+    LeylineResampleHigh,            // 64 taps, 92%
+    LeylineResampleQualityCount
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// COEFFICIENT TABLE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LeylineResampleTable
+{
+    ULONG   InRate;
+    ULONG   OutRate;
+    LeylineResampleQuality Quality;
+    ULONG   Phases;     // L = OutRate / gcd
+    ULONG   Step;       // M = InRate / gcd
+    ULONG   Taps;       // Per phase; a multiple of 8, widened when decimating
+    float*  Coefs;      // Phases x Taps, each phase normalized to unity DC gain
+};
+
+// Build the table for one rate pair. PASSIVE_LEVEL: allocates and evaluates the sinc.
+NTSTATUS LeylineResampleTableCreate(ULONG InRate, ULONG OutRate, LeylineResampleQuality Quality,
+                                    LeylineResampleTable** Table);
+void     LeylineResampleTableFree(LeylineResampleTable* Table);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAMING STATE
+// One per stream. The history is allocated up front so that switching to another
+// table in the DPC never allocates.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct LeylineResampler
+{
+    const LeylineResampleTable* Table;  // Null while idle
+    ULONG   Channels;
+    ULONG   MaxChannels;
+    ULONG   Phase;      // Sub-sample position of the next output, 0..Phases-1
+    ULONG   Offset;     // First history frame under the next output's filter
+    ULONG   Fill;       // History frames held
+    float*  History;    // MaxChannels planes of LEYLINE_RESAMPLE_HISTORY frames
+};
+
+NTSTATUS LeylineResamplerAllocate(LeylineResampler* Resampler, ULONG MaxChannels);
+void     LeylineResamplerFree(LeylineResampler* Resampler);
+
+// Switch to Table (or idle with null) and clear the history. Channels is capped at
+// MaxChannels.
+void     LeylineResamplerReset(LeylineResampler* Resampler, const LeylineResampleTable* Table, ULONG Channels);
+
+// Input frames that must still be pushed before OutFrames outputs can be pulled.
+ULONG    LeylineResamplerInputNeeded(const LeylineResampler* Resampler, ULONG OutFrames);
+
+// Append up to Frames interleaved frames with InChannels per frame, or silence if In is
+// null. Returns the number accepted; at least LEYLINE_MIX_BLOCK_FRAMES fit once the
+// pending outputs are pulled.
+ULONG    LeylineResamplerPush(LeylineResampler* Resampler, const float* In, ULONG InChannels, ULONG Frames);
+
+// Produce up to MaxFrames outputs into interleaved Out (OutChannels per frame), adding
+// to it when Accumulate is set. Returns the number of frames produced.
+ULONG    LeylineResamplerPull(LeylineResampler* Resampler, float* Out, ULONG OutChannels,
+                              ULONG MaxFrames, BOOLEAN Accumulate, LeylineSimdLevel Level);
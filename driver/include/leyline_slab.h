@@ -0,0 +1,44 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE OBJECT SLABS
+// A cache of equal-sized objects for one type, so opening a stream or spawning a cable
+// takes a slot from a free list instead of going to the pool. Slots are cache-line
+// aligned and cache-line sized, carved from chunks of several at a time, and handed
+// out zeroed, as the pool would. Chunks are kept until the slab is cleaned up, so the
+// slab holds as many objects as were ever live at once. Uses only the platform shim,
+// so it runs in the host simulation.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_common.h"
+
+// Chunks are carved into as many slots as fit this size, and at least one.
+#define LEYLINE_SLAB_CHUNK_BYTES    (16 * 1024)
+
+struct LeylineSlab
+{
+    KSPIN_LOCK  Lock;
+    PVOID       Free;               // Free slots, linked through their first pointer
+    LIST_ENTRY  Chunks;
+    ULONG       ObjectSize;         // Rounded up to whole cache lines
+    ULONG       ChunkObjects;
+    ULONG       Tag;
+
+    // Under Lock.
+    ULONG       InUse;
+    ULONG       Peak;               // Most objects live at once
+    ULONG       ChunkCount;
+};
+
+// Lifetime, at PASSIVE_LEVEL. Every object must be back before Cleanup, which frees
+// the chunks.
+void  LeylineSlabInit(LeylineSlab* Slab, SIZE_T ObjectSize, ULONG Tag);
+void  LeylineSlabCleanup(LeylineSlab* Slab);
+
+// A zeroed, cache-line aligned object of up to the slab's size, or null if Size is
+// larger or a new chunk can't be allocated. Both at or below DISPATCH_LEVEL.
+PVOID LeylineSlabAllocate(LeylineSlab* Slab, SIZE_T Size);
+void  LeylineSlabFree(LeylineSlab* Slab, PVOID Object);
@@ -0,0 +1,171 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE SHARED MEMORY ABI
+// Every page the driver maps into user mode, laid out with fixed-width types only so
+// the kernel, the APO and HSA, and user-mode readers on any platform include the same
+// file (leyline_reader.h reads them). Nothing here depends on the WDK.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TELEMETRY PAGE
+// One per cable, mapped by IOCTL_LEYLINE_MAP_TELEMETRY. A header the kernel writes once
+// before the page can be mapped, then one cache line per producer, so the volume
+// handlers and the loopback tick never write to the same line. A section with more
+// than one field is published under its own Sequence, odd while a write is in
+// progress: copy it between two reads of the sequence and retry if it was odd or
+// changed. The page is only ever extended: fields and sections are added at the end,
+// and Size grows; a change existing readers would misread bumps Version instead.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_TELEMETRY_MAGIC     0x4D544C4Cu    // "LLTM" in memory order
+#define LEYLINE_TELEMETRY_VERSION   1u
+
+struct alignas(64) LeylineTelemetryHeader
+{
+    uint32_t Magic;             // LEYLINE_TELEMETRY_MAGIC
+    uint32_t Version;           // LEYLINE_TELEMETRY_VERSION
+    uint32_t Size;              // Bytes of the page that are defined
+    uint32_t CableId;
+    int64_t  QpcFrequency;
+    uint32_t Reserved[10];
+};
+
+// Master volume and mute, as the loopback applies them. Written by the volume and mute
+// handlers.
+struct alignas(64) LeylineTelemetryGain
+{
+    uint32_t Sequence;
+    uint32_t GainBits;          // IEEE 754 float bits for the linear gain, 0 when muted
+    int32_t  VolumeLevel;       // 1/65536 dB
+    uint32_t Mute;              // Nonzero when muted
+    uint32_t Reserved[12];
+};
+
+// Levels of the mix after master gain, for the first two bus channels. Written by the
+// loopback tick every 100 ms, and once with silence when the loopback stops.
+struct alignas(64) LeylineTelemetryMeter
+{
+    uint32_t Sequence;
+    uint32_t Channels;          // Bus channels metered, 0 when silent
+    uint32_t PeakBits[2];       // IEEE 754 float bits, full scale 1.0
+    uint32_t RmsBits[2];
+    uint32_t LoudnessBits;      // Short-term loudness, LUFS
+    uint32_t Reserved[9];
+};
+
+// The loopback timer, for checking what an idle cable costs: it is armed only while a
+// render and a capture stream both run, so Wakeups stops moving when nothing plays, and
+// ticks at the period the streams asked for.
+// Written by the tick every 100 wakeups, and by whoever arms or stops the timer.
+// Appended to version 1; present when Header.Size covers it.
+struct alignas(64) LeylineTelemetryTimer
+{
+    uint32_t Sequence;
+    uint32_t Running;           // Nonzero while the timer is armed
+    uint32_t ToleranceMs;       // Coalescing tolerance it was last armed with
+    uint32_t PeriodUs;          // Tick period, retuned as streams start and stop
+    uint64_t Wakeups;           // Loopback DPCs run since the cable was created
+    uint64_t IdleWakeups;       // Of those, ones that found nothing to mix
+    uint64_t Arms;              // Times the timer was armed
+    uint32_t Reserved[6];
+};
+
+// Bytes of the page before any section was appended.
+#define LEYLINE_TELEMETRY_SIZE_V1   192u
+
+struct LeylineTelemetryPage
+{
+    LeylineTelemetryHeader Header;
+    LeylineTelemetryGain   Gain;
+    LeylineTelemetryMeter  Meter;
+    LeylineTelemetryTimer  Timer;
+};
+
+static_assert(sizeof(LeylineTelemetryHeader) == 64, "header fills one cache line");
+static_assert(sizeof(LeylineTelemetryGain) == 64 && sizeof(LeylineTelemetryMeter) == 64 &&
+              sizeof(LeylineTelemetryTimer) == 64, "one cache line per producer");
+static_assert(offsetof(LeylineTelemetryPage, Timer) == LEYLINE_TELEMETRY_SIZE_V1, "version 1 layout");
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POSITION PAGE
+// One record per running stream of a cable, each on its own cache line, mapped to user
+// mode by IOCTL_LEYLINE_MAP_POSITIONS. A record is rewritten under its Sequence, the
+// same way as a telemetry section, so Position and Qpc always belong together. The
+// loopback tick refreshes running streams; with no tick (no render and capture stream
+// both running) a running record holds its last position, and the position at any
+// later QPC follows from ByteRate and the page's QpcFrequency.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_POSITION_VERSION        1
+#define LEYLINE_MAX_POSITION_RECORDS    31
+
+// LeylinePositionRecord::Flags
+#define LEYLINE_POSITION_CAPTURE        0x00000001
+
+struct alignas(64) LeylinePositionRecord
+{
+    uint32_t Sequence;          // Odd while the record is being written
+    uint32_t StreamId;          // Nonzero while a stream owns the record; new per stream
+    uint32_t Flags;             // LEYLINE_POSITION_*
+    uint32_t State;             // KSSTATE; Position is frozen unless KSSTATE_RUN (3)
+    uint64_t Position;          // Bytes since the stream started running
+    int64_t  Qpc;               // When the stream reached Position
+    int64_t  StartQpc;          // When the stream started running (Position 0 unless aliased)
+    uint32_t ByteRate;
+    uint32_t FrameBytes;
+    uint32_t BufferSize;        // Position modulo BufferSize is the offset in the buffer
+    uint32_t SafetyBytes;       // Capture: how far Position trails the frames written
+    uint32_t Reserved[2];
+};
+
+struct LeylinePositionPage
+{
+    uint32_t Version;           // LEYLINE_POSITION_VERSION
+    uint32_t HeaderSize;        // Offset of Records
+    uint32_t RecordSize;
+    uint32_t RecordCount;
+    int64_t  QpcFrequency;
+    uint32_t Reserved[10];
+    LeylinePositionRecord Records[LEYLINE_MAX_POSITION_RECORDS];
+};
+
+static_assert(sizeof(LeylinePositionRecord) == 64, "one record per cache line");
+static_assert(sizeof(LeylinePositionPage) == 64 * (LEYLINE_MAX_POSITION_RECORDS + 1), "header fills one cache line");
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SHARED PARAMETER BLOCK (LEGACY)
+// The original unversioned page, still mapped by IOCTL_LEYLINE_MAP_PARAMS and kept up
+// to date for clients built against it. Packed, so the 64-bit fields are unaligned;
+// new clients use the telemetry and position pages. The meter fields (peaks, RMS,
+// loudness) are republished every 100 ms under MeterSequence, which is odd while a
+// publish is in progress. WritePos and ReadPos hold whichever stream was queried last.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma pack(push, 1)
+struct LeylineSharedParameters
+{
+    uint32_t MasterGainBits;    // IEEE 754 float bits for master gain
+    uint32_t PeakLBits;         // IEEE 754 float bits for left peak, after master gain
+    uint32_t PeakRBits;         // IEEE 754 float bits for right peak, after master gain
+    int64_t  QpcFrequency;
+    int64_t  RenderStartQpc;
+    int64_t  CaptureStartQpc;
+    uint32_t BufferSize;
+    uint32_t ByteRate;
+    uint32_t WritePos;          // Last render position queried (byte offset)
+    uint32_t ReadPos;           // Last capture position queried (byte offset)
+    uint32_t MeterSequence;     // Odd while the meter fields are being written
+    uint32_t RmsLBits;          // IEEE 754 float bits for left RMS
+    uint32_t RmsRBits;          // IEEE 754 float bits for right RMS
+    uint32_t LoudnessBits;      // IEEE 754 float bits for short-term loudness, LUFS
+};
+#pragma pack(pop)
+
+static_assert(sizeof(LeylineSharedParameters) == 68, "legacy layout");
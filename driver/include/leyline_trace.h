@@ -0,0 +1,64 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE EVENT TRACING
+// The driver's ETW provider, described by driver/leyline_events.man: stream state,
+// format and buffer events, cable creation, and overruns and underruns with byte
+// counts, each with a QPC timestamp. The enable callback folds the sessions' level and
+// keywords into one mask, so a call site costs a single test of it while no session
+// wants the event:
+//
+//     if (LeylineTraceOn(LEYLINE_KEYWORD_GLITCH)) LeylineTraceOverrun(...);
+//
+// Arguments are only evaluated inside the branch. Writers may be called at any IRQL up
+// to DISPATCH_LEVEL. Uses only the platform shim, so it runs in the host simulation.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_common.h"
+
+// Keywords, levels and event ids; each must match the manifest.
+#define LEYLINE_KEYWORD_STREAM      0x0000000000000001ULL  // State, format, buffer
+#define LEYLINE_KEYWORD_CABLE       0x0000000000000002ULL  // Cable creation
+#define LEYLINE_KEYWORD_GLITCH      0x0000000000000004ULL  // Overruns and underruns
+
+#define LEYLINE_LEVEL_WARNING       3
+#define LEYLINE_LEVEL_INFORMATION   4
+
+#define LEYLINE_EVENT_STREAM_STATE  1
+#define LEYLINE_EVENT_STREAM_FORMAT 2
+#define LEYLINE_EVENT_STREAM_BUFFER 3
+#define LEYLINE_EVENT_CABLE_CREATED 4
+#define LEYLINE_EVENT_OVERRUN       5
+#define LEYLINE_EVENT_UNDERRUN      6
+
+// Keywords some session has enabled at a level that admits them; 0 while unregistered.
+extern volatile ULONGLONG g_LeylineTraceKeywords;
+
+static inline BOOLEAN LeylineTraceOn(ULONGLONG Keyword)
+{
+    return (g_LeylineTraceKeywords & Keyword) != 0;
+}
+
+// At PASSIVE_LEVEL, from DriverEntry and DriverUnload. A failed registration leaves
+// tracing off and the driver running.
+NTSTATUS LeylineTraceRegister(LPCGUID ProviderId);
+void     LeylineTraceUnregister();
+
+// Streams are identified by address, cables by id (0 for a stream with no cable).
+// Positions and byte counts are in the stream's own bytes, times in QPC ticks.
+void LeylineTraceStreamState(ULONG CableId, const void* Stream, BOOLEAN Capture, KSSTATE OldState,
+                             KSSTATE NewState, ULONGLONG PositionBytes, LONGLONG Qpc);
+void LeylineTraceStreamFormat(const void* Stream, BOOLEAN Capture, ULONG FrameRate, ULONG BitsPerSample,
+                              ULONG ValidBitsPerSample, ULONG Channels, BOOLEAN IsFloat, LONGLONG Qpc);
+void LeylineTraceStreamBuffer(const void* Stream, ULONG RequestedBytes, ULONG Bytes, BOOLEAN Pooled,
+                              BOOLEAN Mirrored, NTSTATUS Status, LONGLONG Qpc);
+void LeylineTraceCableCreated(ULONG CableId, LONGLONG Qpc);
+
+// Render frames the renderer overwrote before the tick read them.
+void LeylineTraceOverrun(ULONG CableId, ULONGLONG LostFrames, ULONGLONG LostBytes, LONGLONG Qpc);
+// Capture bytes a reader may have reached before the tick wrote them.
+void LeylineTraceUnderrun(ULONG CableId, const void* Stream, ULONGLONG PositionBytes, ULONGLONG MissingBytes,
+                          LONGLONG Qpc);
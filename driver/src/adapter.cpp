@@ -17,7 +17,6 @@
 
 PDEVICE_OBJECT g_ControlDeviceObject    = nullptr;
 extern PDEVICE_OBJECT g_FunctionalDeviceObject;
-ULONGLONG      g_EtwRegHandle           = 0;
 
 static PDRIVER_DISPATCH s_OriginalDispatchCreate  = nullptr;
 static PDRIVER_DISPATCH s_OriginalDispatchClose   = nullptr;
@@ -58,7 +57,7 @@ static NTSTATUS DispatchClose(PDEVICE_OBJECT DeviceObject, PIRP Irp)
 
 static ULONG g_CableCount = 1;
 
-static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
+static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp, ULONG* CableId)
 {
     NTSTATUS status;
     DeviceExtension *devExt = GetDeviceExtension(Fdo);
@@ -73,6 +72,11 @@ static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
     WCHAR renderTopoName[64];
     WCHAR captureTopoName[64];
     ULONG id = InterlockedIncrement((LONG*)&g_CableCount);
+
+    // The new endpoints get their own engine, so nothing they play reaches cable 1.
+    LeylineCable *cable = LeylineCableCreate(devExt, id);
+    if (!cable) return STATUS_INSUFFICIENT_RESOURCES;
+    *CableId = id;
     
     RtlStringCbPrintfW(renderName, sizeof(renderName), L"WaveRender%lu", id);
     RtlStringCbPrintfW(captureName, sizeof(captureName), L"WaveCapture%lu", id);
@@ -83,7 +87,7 @@ static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
     status = PcNewPort(&renderPort, CLSID_PortWaveRT);
     if (NT_SUCCESS(status))
     {
-        CMiniportWaveRT *renderMiniport = new (NonPagedPool, 'LLWR') CMiniportWaveRT(nullptr, FALSE, devExt);
+        CMiniportWaveRT *renderMiniport = new CMiniportWaveRT(nullptr, FALSE, cable);
         if (renderMiniport)
         {
             renderMiniport->AddRef();
@@ -100,7 +104,7 @@ static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
     status = PcNewPort(&capturePort, CLSID_PortWaveRT);
     if (NT_SUCCESS(status))
     {
-        CMiniportWaveRT *captureMiniport = new (NonPagedPool, 'LLWC') CMiniportWaveRT(nullptr, TRUE, devExt);
+        CMiniportWaveRT *captureMiniport = new CMiniportWaveRT(nullptr, TRUE, cable);
         if (captureMiniport)
         {
             captureMiniport->AddRef();
@@ -117,7 +121,7 @@ static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
     status = PcNewPort(&renderTopoPort, CLSID_PortTopology);
     if (NT_SUCCESS(status))
     {
-        CMiniportTopology *renderTopoMiniport = new (NonPagedPool, 'LLTR') CMiniportTopology(nullptr, FALSE, devExt);
+        CMiniportTopology *renderTopoMiniport = new CMiniportTopology(nullptr, FALSE, cable);
         if (renderTopoMiniport)
         {
             renderTopoMiniport->AddRef();
@@ -134,7 +138,7 @@ static NTSTATUS SpawnNewCable(PDEVICE_OBJECT Fdo, PIRP Irp)
     status = PcNewPort(&captureTopoPort, CLSID_PortTopology);
     if (NT_SUCCESS(status))
     {
-        CMiniportTopology *captureTopoMiniport = new (NonPagedPool, 'LLTC') CMiniportTopology(nullptr, TRUE, devExt);
+        CMiniportTopology *captureTopoMiniport = new CMiniportTopology(nullptr, TRUE, cable);
         if (captureTopoMiniport)
         {
             captureTopoMiniport->AddRef();
@@ -224,9 +228,9 @@ static NTSTATUS DispatchDeviceControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
         if (g_FunctionalDeviceObject)
         {
             DeviceExtension *ext = GetDeviceExtension(g_FunctionalDeviceObject);
-            if (ext->LoopbackMdl)
+            if (ext->Cable.LoopbackMdl)
             {
-                PVOID userAddr = MmMapLockedPagesSpecifyCache(ext->LoopbackMdl, UserMode, MmCached, nullptr, FALSE, NormalPagePriority);
+                PVOID userAddr = MmMapLockedPagesSpecifyCache(ext->Cable.LoopbackMdl, UserMode, MmCached, nullptr, FALSE, NormalPagePriority);
                 if (userAddr)
                 {
                     *reinterpret_cast<PVOID*>(Irp->AssociatedIrp.SystemBuffer) = userAddr;
@@ -240,6 +244,8 @@ static NTSTATUS DispatchDeviceControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
         break;
 
     case IOCTL_LEYLINE_MAP_PARAMS:
+    case IOCTL_LEYLINE_MAP_POSITIONS:
+    case IOCTL_LEYLINE_MAP_TELEMETRY:
         if (stack->Parameters.DeviceIoControl.OutputBufferLength < sizeof(PVOID))
         {
             status = STATUS_BUFFER_TOO_SMALL;
@@ -247,10 +253,26 @@ static NTSTATUS DispatchDeviceControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
         }
         if (g_FunctionalDeviceObject)
         {
+            // An optional ULONG cable Id selects the page; without one it is cable 1's.
             DeviceExtension *ext = GetDeviceExtension(g_FunctionalDeviceObject);
-            if (ext->SharedParamsMdl)
+            ULONG cableId = 1;
+            if (stack->Parameters.DeviceIoControl.InputBufferLength >= sizeof(ULONG))
+                cableId = *reinterpret_cast<ULONG*>(Irp->AssociatedIrp.SystemBuffer);
+            LeylineCable *cable = LeylineCableFind(ext, cableId);
+            PMDL mdl = nullptr;
+            if (cable)
+            {
+                if (ioctl == IOCTL_LEYLINE_MAP_PARAMS)         mdl = cable->SharedParamsMdl;
+                else if (ioctl == IOCTL_LEYLINE_MAP_POSITIONS) mdl = cable->PositionMdl;
+                else                                           mdl = cable->TelemetryMdl;
+            }
+            if (!cable)
             {
-                PVOID userAddr = MmMapLockedPagesSpecifyCache(ext->SharedParamsMdl, UserMode, MmCached, nullptr, FALSE, NormalPagePriority);
+                status = STATUS_INVALID_PARAMETER;
+            }
+            else if (mdl)
+            {
+                PVOID userAddr = MmMapLockedPagesSpecifyCache(mdl, UserMode, MmCached, nullptr, FALSE, NormalPagePriority);
                 if (userAddr)
                 {
                     *reinterpret_cast<PVOID*>(Irp->AssociatedIrp.SystemBuffer) = userAddr;
@@ -266,7 +288,116 @@ static NTSTATUS DispatchDeviceControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
     case IOCTL_LEYLINE_CREATE_CABLE:
         if (g_FunctionalDeviceObject)
         {
-            status = SpawnNewCable(g_FunctionalDeviceObject, Irp);
+            ULONG id = 0;
+            status = SpawnNewCable(g_FunctionalDeviceObject, Irp, &id);
+            if (NT_SUCCESS(status) && stack->Parameters.DeviceIoControl.OutputBufferLength >= sizeof(ULONG))
+            {
+                *reinterpret_cast<ULONG*>(Irp->AssociatedIrp.SystemBuffer) = id;
+                info = sizeof(ULONG);
+            }
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_GET_PLACEMENT:
+        if (g_FunctionalDeviceObject)
+        {
+            status = LeylineCablesGetPlacement(GetDeviceExtension(g_FunctionalDeviceObject),
+                                               reinterpret_cast<LeylinePlacementInfo*>(Irp->AssociatedIrp.SystemBuffer),
+                                               stack->Parameters.DeviceIoControl.OutputBufferLength, &info);
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_GET_POOL_STATS:
+        if (stack->Parameters.DeviceIoControl.OutputBufferLength < sizeof(LeylinePoolStats))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            LeylineBufferPoolQueryStats(&GetDeviceExtension(g_FunctionalDeviceObject)->BufferPool,
+                                        reinterpret_cast<LeylinePoolStats*>(Irp->AssociatedIrp.SystemBuffer));
+            info = sizeof(LeylinePoolStats);
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_SET_POOL_LIMIT:
+        if (stack->Parameters.DeviceIoControl.InputBufferLength < sizeof(ULONGLONG))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            LeylineBufferPoolSetLimit(&GetDeviceExtension(g_FunctionalDeviceObject)->BufferPool,
+                                      *reinterpret_cast<const ULONGLONG*>(Irp->AssociatedIrp.SystemBuffer));
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_SET_PLACEMENT:
+        if (stack->Parameters.DeviceIoControl.InputBufferLength < sizeof(LeylinePlacementRequest))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            status = LeylineCableSetPlacement(GetDeviceExtension(g_FunctionalDeviceObject),
+                                              reinterpret_cast<const LeylinePlacementRequest*>(Irp->AssociatedIrp.SystemBuffer));
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_GET_SAFETY:
+        if (stack->Parameters.DeviceIoControl.OutputBufferLength < sizeof(LeylineCableSafety))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            ULONG cableId = 1;
+            if (stack->Parameters.DeviceIoControl.InputBufferLength >= sizeof(ULONG))
+                cableId = *reinterpret_cast<ULONG*>(Irp->AssociatedIrp.SystemBuffer);
+            status = LeylineCableGetSafety(GetDeviceExtension(g_FunctionalDeviceObject), cableId,
+                                           reinterpret_cast<LeylineCableSafety*>(Irp->AssociatedIrp.SystemBuffer));
+            if (NT_SUCCESS(status)) info = sizeof(LeylineCableSafety);
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_SET_SAFETY:
+        if (stack->Parameters.DeviceIoControl.InputBufferLength < sizeof(LeylineSafetyRequest))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            status = LeylineCableSetSafety(GetDeviceExtension(g_FunctionalDeviceObject),
+                                           reinterpret_cast<const LeylineSafetyRequest*>(Irp->AssociatedIrp.SystemBuffer));
+        }
+        else status = STATUS_DEVICE_NOT_READY;
+        break;
+
+    case IOCTL_LEYLINE_GET_STATS:
+        if (stack->Parameters.DeviceIoControl.OutputBufferLength < sizeof(LeylineCableStats))
+        {
+            status = STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+        if (g_FunctionalDeviceObject)
+        {
+            ULONG cableId = 1;
+            if (stack->Parameters.DeviceIoControl.InputBufferLength >= sizeof(ULONG))
+                cableId = *reinterpret_cast<ULONG*>(Irp->AssociatedIrp.SystemBuffer);
+            status = LeylineCableGetStats(GetDeviceExtension(g_FunctionalDeviceObject), cableId,
+                                          reinterpret_cast<LeylineCableStats*>(Irp->AssociatedIrp.SystemBuffer));
+            if (NT_SUCCESS(status)) info = sizeof(LeylineCableStats);
         }
         else status = STATUS_DEVICE_NOT_READY;
         break;
@@ -293,15 +424,7 @@ static NTSTATUS DispatchPnp(PDEVICE_OBJECT DeviceObject, PIRP Irp)
             DeviceExtension* ext = GetDeviceExtension(DeviceObject);
             if (ext)
             {
-                KIRQL oldIrql;
-                KeAcquireSpinLock(&ext->StreamLock, &oldIrql);
-                if (ext->TimerRunning)
-                {
-                    KeCancelTimer(&ext->LoopbackTimer);
-                    ext->TimerRunning = FALSE;
-                }
-                KeReleaseSpinLock(&ext->StreamLock, oldIrql);
-                KeRemoveQueueDpc(&ext->LoopbackDpc);
+                LeylineCablesStop(ext);
             }
             if (g_ControlDeviceObject)
             {
@@ -345,30 +468,9 @@ public:
         if (!m_DevExt) return;
 
         if (NewState.DeviceState != PowerDeviceD0)
-        {
-            KIRQL oldIrql;
-            KeAcquireSpinLock(&m_DevExt->StreamLock, &oldIrql);
-            if (m_DevExt->TimerRunning)
-            {
-                KeCancelTimer(&m_DevExt->LoopbackTimer);
-                m_DevExt->TimerRunning = FALSE;
-            }
-            KeReleaseSpinLock(&m_DevExt->StreamLock, oldIrql);
-            KeRemoveQueueDpc(&m_DevExt->LoopbackDpc);
-        }
+            LeylineCablesStop(m_DevExt);
         else
-        {
-            KIRQL oldIrql;
-            KeAcquireSpinLock(&m_DevExt->StreamLock, &oldIrql);
-            if (!IsListEmpty(&m_DevExt->RenderStreams) && !IsListEmpty(&m_DevExt->CaptureStreams) && !m_DevExt->TimerRunning)
-            {
-                LARGE_INTEGER dueTime;
-                dueTime.QuadPart = -10000LL;
-                KeSetTimerEx(&m_DevExt->LoopbackTimer, dueTime, 1, &m_DevExt->LoopbackDpc);
-                m_DevExt->TimerRunning = TRUE;
-            }
-            KeReleaseSpinLock(&m_DevExt->StreamLock, oldIrql);
-        }
+            LeylineCablesResume(m_DevExt);
     }
 
     STDMETHODIMP QueryPowerChangeState(POWER_STATE /*NewStateQuery*/) override
@@ -405,51 +507,20 @@ extern "C" NTSTATUS NTAPI StartDevice(PDEVICE_OBJECT DeviceObject, PIRP Irp, PRE
     NTSTATUS status;
     DeviceExtension *devExt = GetDeviceExtension(DeviceObject);
 
-    // Initialize loopback engine state.
-    KeInitializeSpinLock(&devExt->StreamLock);
-    InitializeListHead(&devExt->RenderStreams);
-    InitializeListHead(&devExt->CaptureStreams);
-    devExt->TimerRunning        = FALSE;
-    devExt->LastCopiedByte      = 0;
-    devExt->GlitchCount         = 0;
-    devExt->VolumeLevel         = 0;       // 0 dB
-    devExt->MuteState           = 0;       // Unmuted
-    devExt->GainLinear16        = 0x10000;  // Unity gain (1.0 in 16.16)
-    KeInitializeTimer(&devExt->LoopbackTimer);
-    KeInitializeDpc(&devExt->LoopbackDpc, LoopbackDpcRoutine, devExt);
-
-    if (!devExt->LoopbackMdl)
+    // Cable 1 owns the device-wide fallback buffer; spawned cables join the list. Every
+    // cable's streams take their buffers from the one pool. All of it lives as long as
+    // the device: a restart after a stop must not initialize cable 1's engine again
+    // over its running worker thread and timers.
+    if (!devExt->Cables.Flink)
     {
-        devExt->LoopbackSize = 128 * 1024;
-        PHYSICAL_ADDRESS low = {0}, high = {0}, skip = {0};
-        high.LowPart = 0xFFFFFFFF;
-        devExt->LoopbackMdl = MmAllocatePagesForMdlEx(low, high, skip, devExt->LoopbackSize, MmCached, MM_ALLOCATE_FULLY_REQUIRED);
-        if (devExt->LoopbackMdl)
-        {
-            devExt->LoopbackBuffer = (PUCHAR)MmMapLockedPagesSpecifyCache(devExt->LoopbackMdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
-            if (devExt->LoopbackBuffer) RtlZeroMemory(devExt->LoopbackBuffer, devExt->LoopbackSize);
-        }
-    }
-
-    if (!devExt->SharedParamsMdl)
-    {
-        PHYSICAL_ADDRESS low = {0}, high = {0}, skip = {0};
-        high.LowPart = 0xFFFFFFFF;
-        devExt->SharedParamsMdl = MmAllocatePagesForMdlEx(low, high, skip, sizeof(LeylineSharedParameters), MmCached, MM_ALLOCATE_FULLY_REQUIRED);
-        if (devExt->SharedParamsMdl)
-        {
-            devExt->SharedParams = (LeylineSharedParameters*)MmMapLockedPagesSpecifyCache(devExt->SharedParamsMdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
-            if (devExt->SharedParams)
-            {
-                RtlZeroMemory(devExt->SharedParams, sizeof(LeylineSharedParameters));
-                devExt->SharedParams->BufferSize = (ULONG)devExt->LoopbackSize;
-                devExt->SharedParams->ByteRate   = 48000 * 4;
-                LARGE_INTEGER freq;
-                KeQueryPerformanceCounter(&freq);
-                devExt->SharedParams->QpcFrequency = freq.QuadPart;
-            }
-        }
+        InitializeListHead(&devExt->Cables);
+        KeInitializeSpinLock(&devExt->CableLock);
+        devExt->CableCount = 1;
+        LeylineBufferPoolInit(&devExt->BufferPool, DeviceObject, LEYLINE_POOL_DEFAULT_LIMIT);
+        LeylineCableInit(&devExt->Cable, devExt, 1, 128 * 1024);
     }
+    LeylineCablesBalance(devExt);
+    LeylineCable *cable = &devExt->Cable;
 
     PPORT renderPort = nullptr;
     PPORT capturePort = nullptr;
@@ -460,7 +531,7 @@ extern "C" NTSTATUS NTAPI StartDevice(PDEVICE_OBJECT DeviceObject, PIRP Irp, PRE
     status = PcNewPort(&renderPort, CLSID_PortWaveRT);
     if (NT_SUCCESS(status))
     {
-        CMiniportWaveRT *renderMiniport = new (NonPagedPool, 'LLWR') CMiniportWaveRT(nullptr, FALSE, devExt);
+        CMiniportWaveRT *renderMiniport = new CMiniportWaveRT(nullptr, FALSE, cable);
         if (renderMiniport)
         {
             renderMiniport->AddRef();
@@ -480,7 +551,7 @@ extern "C" NTSTATUS NTAPI StartDevice(PDEVICE_OBJECT DeviceObject, PIRP Irp, PRE
     status = PcNewPort(&capturePort, CLSID_PortWaveRT);
     if (NT_SUCCESS(status))
     {
-        CMiniportWaveRT *captureMiniport = new (NonPagedPool, 'LLWC') CMiniportWaveRT(nullptr, TRUE, devExt);
+        CMiniportWaveRT *captureMiniport = new CMiniportWaveRT(nullptr, TRUE, cable);
         if (captureMiniport)
         {
             captureMiniport->AddRef();
@@ -500,7 +571,7 @@ extern "C" NTSTATUS NTAPI StartDevice(PDEVICE_OBJECT DeviceObject, PIRP Irp, PRE
     status = PcNewPort(&renderTopoPort, CLSID_PortTopology);
     if (NT_SUCCESS(status))
     {
-        CMiniportTopology *renderTopoMiniport = new (NonPagedPool, 'LLTR') CMiniportTopology(nullptr, FALSE, devExt);
+        CMiniportTopology *renderTopoMiniport = new CMiniportTopology(nullptr, FALSE, cable);
         if (renderTopoMiniport)
         {
             renderTopoMiniport->AddRef();
@@ -520,7 +591,7 @@ extern "C" NTSTATUS NTAPI StartDevice(PDEVICE_OBJECT DeviceObject, PIRP Irp, PRE
     status = PcNewPort(&captureTopoPort, CLSID_PortTopology);
     if (NT_SUCCESS(status))
     {
-        CMiniportTopology *captureTopoMiniport = new (NonPagedPool, 'LLTC') CMiniportTopology(nullptr, TRUE, devExt);
+        CMiniportTopology *captureTopoMiniport = new CMiniportTopology(nullptr, TRUE, cable);
         if (captureTopoMiniport)
         {
             captureTopoMiniport->AddRef();
@@ -0,0 +1,337 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BUFFER POOL
+// Size-classed blocks of stream buffer pages. Lists and counters are under the pool's
+// lock; allocating, mapping, zeroing and freeing happen outside it, on blocks that are
+// on no list. The zeroing work item is queued at most once at a time and drains Dirty.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_bufferpool.h"
+
+#define LEYLINE_POOL_TAG 'LLBP'
+
+static inline ULONG ClassBytes(ULONG Class)
+{
+    return (ULONG)PAGE_SIZE << Class;
+}
+
+// Smallest class that holds Size bytes; LEYLINE_POOL_CLASSES if none does.
+static ULONG SizeClass(ULONG Size)
+{
+    SIZE_T pages = BYTES_TO_PAGES(Size);
+    ULONG  cls   = 0;
+    while (cls < LEYLINE_POOL_CLASSES && ((SIZE_T)1 << cls) < pages) cls++;
+    return cls;
+}
+
+PVOID LeylineMapMirrored(PMDL Mdl, ULONG Size, PMDL* MirrorMdl)
+{
+    PMDL mirror = IoAllocateMdl(nullptr, Size * 2, FALSE, FALSE, nullptr);
+    if (!mirror) return nullptr;
+
+    ULONG       pages = Size / PAGE_SIZE;
+    PPFN_NUMBER src   = MmGetMdlPfnArray(Mdl);
+    PPFN_NUMBER dst   = MmGetMdlPfnArray(mirror);
+    for (ULONG i = 0; i < pages; i++) dst[i] = dst[pages + i] = src[i];
+    mirror->MdlFlags |= MDL_PAGES_LOCKED;
+
+    PVOID mapping = MmMapLockedPagesSpecifyCache(mirror, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
+    if (!mapping)
+    {
+        IoFreeMdl(mirror);
+        return nullptr;
+    }
+
+    *MirrorMdl = mirror;
+    return mapping;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BLOCKS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LeylinePoolBlock* NewBlock(ULONG Class)
+{
+    auto* block = static_cast<LeylinePoolBlock*>(
+        ExAllocatePool2(POOL_FLAG_NON_PAGED, sizeof(LeylinePoolBlock), LEYLINE_POOL_TAG));
+    if (!block) return nullptr;
+
+    // Nothing DMAs from these pages, so they may come from anywhere in physical memory.
+    PHYSICAL_ADDRESS low = { 0 }, high = { 0 }, skip = { 0 };
+    high.QuadPart = -1;
+
+    block->Class = Class;
+    block->Mdl   = MmAllocatePagesForMdlEx(low, high, skip, ClassBytes(Class), MmCached, MM_ALLOCATE_FULLY_REQUIRED);
+    if (block->Mdl)
+        block->Mapping = static_cast<PUCHAR>(
+            MmMapLockedPagesSpecifyCache(block->Mdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority));
+    if (!block->Mapping)
+    {
+        if (block->Mdl)
+        {
+            MmFreePagesFromMdl(block->Mdl);
+            IoFreeMdl(block->Mdl);
+        }
+        ExFreePoolWithTag(block, LEYLINE_POOL_TAG);
+        return nullptr;
+    }
+    return block;
+}
+
+static void DropView(LeylinePoolBlock* Block)
+{
+    if (Block->MirrorMdl)
+    {
+        MmUnmapLockedPages(Block->MirrorMapping, Block->MirrorMdl);
+        IoFreeMdl(Block->MirrorMdl);
+    }
+    if (Block->ViewMdl) IoFreeMdl(Block->ViewMdl);
+    Block->ViewSize      = 0;
+    Block->ViewMdl       = nullptr;
+    Block->MirrorMdl     = nullptr;
+    Block->MirrorMapping = nullptr;
+}
+
+static void FreeBlock(LeylinePoolBlock* Block)
+{
+    DropView(Block);
+    MmUnmapLockedPages(Block->Mapping, Block->Mdl);
+    MmFreePagesFromMdl(Block->Mdl);
+    IoFreeMdl(Block->Mdl);
+    ExFreePoolWithTag(Block, LEYLINE_POOL_TAG);
+}
+
+static void FreeBlocks(PLIST_ENTRY Head)
+{
+    while (!IsListEmpty(Head))
+        FreeBlock(CONTAINING_RECORD(RemoveHeadList(Head), LeylinePoolBlock, ListEntry));
+}
+
+// Only the pages a view exposed can have been written.
+static void ZeroBlock(LeylinePoolBlock* Block)
+{
+    RtlZeroMemory(Block->Mapping, BYTES_TO_PAGES(Block->ViewSize) * PAGE_SIZE);
+}
+
+// Point the block's view at its first Size bytes, keeping the last one if it fits.
+static NTSTATUS PrepareView(LeylinePoolBlock* Block, ULONG Size, BOOLEAN Mirrored)
+{
+    if (Block->ViewMdl && Block->ViewSize == Size && (Block->MirrorMdl != nullptr) == Mirrored)
+        return STATUS_SUCCESS;
+    DropView(Block);
+
+    PMDL view = IoAllocateMdl(nullptr, Size, FALSE, FALSE, nullptr);
+    if (!view) return STATUS_INSUFFICIENT_RESOURCES;
+    RtlCopyMemory(MmGetMdlPfnArray(view), MmGetMdlPfnArray(Block->Mdl), BYTES_TO_PAGES(Size) * sizeof(PFN_NUMBER));
+    view->MdlFlags |= MDL_PAGES_LOCKED;
+
+    Block->ViewMdl  = view;
+    Block->ViewSize = Size;
+    if (Mirrored) Block->MirrorMapping = LeylineMapMirrored(Block->Mdl, Size, &Block->MirrorMdl);
+    return STATUS_SUCCESS;
+}
+
+// A block of Class from Head, preferring one whose view is already Size. Under Lock.
+static LeylinePoolBlock* FindBlock(PLIST_ENTRY Head, ULONG Class, ULONG Size)
+{
+    LeylinePoolBlock* found = nullptr;
+    for (PLIST_ENTRY entry = Head->Flink; entry != Head; entry = entry->Flink)
+    {
+        LeylinePoolBlock* block = CONTAINING_RECORD(entry, LeylinePoolBlock, ListEntry);
+        if (block->Class != Class) continue;
+        if (block->ViewSize == Size) return block;
+        if (!found) found = block;
+    }
+    return found;
+}
+
+// Move blocks to Trimmed until PooledBytes is within Limit: dirty ones first, which
+// would cost a zeroing to use, then clean ones, largest first. Under Lock.
+static void TrimLocked(LeylineBufferPool* Pool, PLIST_ENTRY Trimmed)
+{
+    LeylinePoolStats* stats = &Pool->Stats;
+    for (ULONG list = 0; list <= LEYLINE_POOL_CLASSES && stats->PooledBytes > stats->Limit; list++)
+    {
+        PLIST_ENTRY head = (list == 0) ? &Pool->Dirty : &Pool->Clean[LEYLINE_POOL_CLASSES - list];
+        while (stats->PooledBytes > stats->Limit && !IsListEmpty(head))
+        {
+            LeylinePoolBlock* block = CONTAINING_RECORD(RemoveHeadList(head), LeylinePoolBlock, ListEntry);
+            stats->PooledBytes -= ClassBytes(block->Class);
+            stats->Trimmed++;
+            InsertTailList(Trimmed, &block->ListEntry);
+        }
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BACKGROUND ZEROING
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Drains Dirty at PASSIVE_LEVEL. A block being zeroed is on no list, so an open in the
+// meantime misses rather than waits, and a limit lowered meanwhile is applied to it
+// when it comes back.
+static void ZeroRoutine(PDEVICE_OBJECT /*DeviceObject*/, PVOID Context)
+{
+    auto* pool = static_cast<LeylineBufferPool*>(Context);
+    for (;;)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&pool->Lock, &irql);
+        if (IsListEmpty(&pool->Dirty))
+        {
+            pool->ZeroQueued = FALSE;
+            KeSetEvent(&pool->ZeroIdle, IO_NO_INCREMENT, FALSE);
+            KeReleaseSpinLock(&pool->Lock, irql);
+            return;
+        }
+        LeylinePoolBlock* block = CONTAINING_RECORD(RemoveHeadList(&pool->Dirty), LeylinePoolBlock, ListEntry);
+        KeReleaseSpinLock(&pool->Lock, irql);
+
+        ZeroBlock(block);
+
+        KeAcquireSpinLock(&pool->Lock, &irql);
+        BOOLEAN keep = !pool->Closing && pool->Stats.PooledBytes <= pool->Stats.Limit;
+        if (keep)
+        {
+            InsertTailList(&pool->Clean[block->Class], &block->ListEntry);
+            pool->Stats.ZeroedAhead++;
+        }
+        else
+        {
+            pool->Stats.PooledBytes -= ClassBytes(block->Class);
+            pool->Stats.Trimmed++;
+        }
+        KeReleaseSpinLock(&pool->Lock, irql);
+        if (!keep) FreeBlock(block);
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POOL
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LeylineBufferPoolInit(LeylineBufferPool* Pool, PDEVICE_OBJECT DeviceObject, ULONGLONG Limit)
+{
+    RtlZeroMemory(Pool, sizeof(*Pool));
+    KeInitializeSpinLock(&Pool->Lock);
+    for (ULONG cls = 0; cls < LEYLINE_POOL_CLASSES; cls++) InitializeListHead(&Pool->Clean[cls]);
+    InitializeListHead(&Pool->Dirty);
+    KeInitializeEvent(&Pool->ZeroIdle, NotificationEvent, TRUE);
+    Pool->ZeroWork    = DeviceObject ? IoAllocateWorkItem(DeviceObject) : nullptr;
+    Pool->Stats.Limit = Limit;
+}
+
+void LeylineBufferPoolCleanup(LeylineBufferPool* Pool)
+{
+    KIRQL irql;
+    KeAcquireSpinLock(&Pool->Lock, &irql);
+    Pool->Closing = TRUE;
+    KeReleaseSpinLock(&Pool->Lock, irql);
+
+    if (Pool->ZeroWork)
+    {
+        KeWaitForSingleObject(&Pool->ZeroIdle, Executive, KernelMode, FALSE, nullptr);
+        IoFreeWorkItem(Pool->ZeroWork);
+        Pool->ZeroWork = nullptr;
+    }
+    LeylineBufferPoolSetLimit(Pool, 0);
+}
+
+NTSTATUS LeylineBufferPoolAcquire(LeylineBufferPool* Pool, ULONG Size, BOOLEAN Mirrored,
+                                  LeylinePoolBlock** Block)
+{
+    ULONG             cls   = SizeClass(Size);
+    LeylinePoolBlock* block = nullptr;
+    BOOLEAN           dirty = FALSE;
+
+    KIRQL irql;
+    KeAcquireSpinLock(&Pool->Lock, &irql);
+    if (Size == 0 || Pool->Closing || Pool->Stats.Limit == 0 || cls >= LEYLINE_POOL_CLASSES)
+    {
+        if (cls >= LEYLINE_POOL_CLASSES) Pool->Stats.Oversized++;
+        KeReleaseSpinLock(&Pool->Lock, irql);
+        return STATUS_NOT_SUPPORTED;
+    }
+    block = FindBlock(&Pool->Clean[cls], cls, Size);
+    if (!block)
+    {
+        block = FindBlock(&Pool->Dirty, cls, Size);
+        dirty = (block != nullptr);
+    }
+    if (block)
+    {
+        RemoveEntryList(&block->ListEntry);
+        Pool->Stats.PooledBytes -= ClassBytes(cls);
+        Pool->Stats.Hits++;
+        if (dirty) Pool->Stats.ZeroedOnOpen++;
+    }
+    else Pool->Stats.Misses++;
+    KeReleaseSpinLock(&Pool->Lock, irql);
+
+    // Fresh pages come zeroed.
+    if (!block) block = NewBlock(cls);
+    else if (dirty) ZeroBlock(block);
+    if (!block) return STATUS_INSUFFICIENT_RESOURCES;
+
+    NTSTATUS status = PrepareView(block, Size, Mirrored);
+    if (!NT_SUCCESS(status))
+    {
+        FreeBlock(block);
+        return status;
+    }
+
+    *Block = block;
+    return STATUS_SUCCESS;
+}
+
+void LeylineBufferPoolRelease(LeylineBufferPool* Pool, LeylinePoolBlock* Block)
+{
+    ULONG   bytes = ClassBytes(Block->Class);
+    BOOLEAN keep  = FALSE;
+    BOOLEAN queue = FALSE;
+
+    KIRQL irql;
+    KeAcquireSpinLock(&Pool->Lock, &irql);
+    if (!Pool->Closing && Pool->Stats.PooledBytes + bytes <= Pool->Stats.Limit)
+    {
+        InsertTailList(&Pool->Dirty, &Block->ListEntry);
+        Pool->Stats.PooledBytes += bytes;
+        Pool->Stats.Returned++;
+        keep = TRUE;
+        if (Pool->ZeroWork && !Pool->ZeroQueued)
+        {
+            Pool->ZeroQueued = TRUE;
+            KeResetEvent(&Pool->ZeroIdle);
+            queue = TRUE;
+        }
+    }
+    else Pool->Stats.Trimmed++;
+    KeReleaseSpinLock(&Pool->Lock, irql);
+
+    if (!keep) FreeBlock(Block);
+    else if (queue) IoQueueWorkItem(Pool->ZeroWork, ZeroRoutine, DelayedWorkQueue, Pool);
+}
+
+void LeylineBufferPoolSetLimit(LeylineBufferPool* Pool, ULONGLONG Limit)
+{
+    LIST_ENTRY trimmed;
+    InitializeListHead(&trimmed);
+
+    KIRQL irql;
+    KeAcquireSpinLock(&Pool->Lock, &irql);
+    Pool->Stats.Limit = Limit;
+    TrimLocked(Pool, &trimmed);
+    KeReleaseSpinLock(&Pool->Lock, irql);
+
+    FreeBlocks(&trimmed);
+}
+
+void LeylineBufferPoolQueryStats(LeylineBufferPool* Pool, LeylinePoolStats* Stats)
+{
+    KIRQL irql;
+    KeAcquireSpinLock(&Pool->Lock, &irql);
+    *Stats = Pool->Stats;
+    KeReleaseSpinLock(&Pool->Lock, irql);
+}
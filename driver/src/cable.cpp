@@ -0,0 +1,344 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CABLE LIFETIME
+// Per-cable loopback engine, gain and shared pages. Each cable ticks on its own timer
+// under its own lock, so cables never mix into each other and add load independently;
+// placement spreads their DPCs over the processors by measured cost.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_miniport.h"
+
+#define LEYLINE_CABLE_TAG 'LLCB'
+
+// Nonpaged, kernel-mapped pages below 4 GB, zeroed.
+static PMDL AllocateMappedPages(SIZE_T Size, PVOID* Mapping)
+{
+    PHYSICAL_ADDRESS low = {0}, high = {0}, skip = {0};
+    high.LowPart = 0xFFFFFFFF;
+
+    *Mapping = nullptr;
+    PMDL mdl = MmAllocatePagesForMdlEx(low, high, skip, Size, MmCached, MM_ALLOCATE_FULLY_REQUIRED);
+    if (!mdl) return nullptr;
+
+    *Mapping = MmMapLockedPagesSpecifyCache(mdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
+    if (!*Mapping)
+    {
+        MmFreePagesFromMdl(mdl);
+        IoFreeMdl(mdl);
+        return nullptr;
+    }
+    RtlZeroMemory(*Mapping, Size);
+    return mdl;
+}
+
+static void FreeMappedPages(PMDL* Mdl, PVOID Mapping)
+{
+    if (!*Mdl) return;
+    if (Mapping) MmUnmapLockedPages(Mapping, *Mdl);
+    MmFreePagesFromMdl(*Mdl);
+    IoFreeMdl(*Mdl);
+    *Mdl = nullptr;
+}
+
+void LeylineCableInit(LeylineCable* Cable, DeviceExtension* DevExt, ULONG Id, SIZE_T LoopbackSize)
+{
+    Cable->Id                = Id;
+    Cable->Device            = DevExt;
+    Cable->ProcessorOverride = LEYLINE_PROCESSOR_AUTO;
+
+    // Initialize loopback engine state.
+    LoopbackEngineInit(&Cable->Loopback);
+    Cable->Loopback.CableId = Id;
+    LoopbackEngineSetSafetyOffset(&Cable->Loopback, LEYLINE_SAFETY_DEFAULT_US, TRUE);
+    LoopbackEngineSetTickRange(&Cable->Loopback, LOOPBACK_MIN_PERIOD_US, LOOPBACK_MAX_PERIOD_US);
+    LoopbackEngineStartWorker(&Cable->Loopback);
+    Cable->VolumeLevel  = 0;        // 0 dB
+    Cable->MuteState    = 0;        // Unmuted
+    Cable->GainLinear16 = 0x10000;  // Unity gain (1.0 in 16.16)
+
+    if (LoopbackSize && !Cable->LoopbackMdl)
+    {
+        PVOID mapping;
+        Cable->LoopbackMdl = AllocateMappedPages(LoopbackSize, &mapping);
+        Cable->LoopbackBuffer = static_cast<PUCHAR>(mapping);
+        Cable->LoopbackSize   = Cable->LoopbackMdl ? LoopbackSize : 0;
+    }
+
+    if (!Cable->TelemetryMdl)
+    {
+        PVOID mapping;
+        Cable->TelemetryMdl = AllocateMappedPages(sizeof(LeylineTelemetryPage), &mapping);
+        Cable->Telemetry    = static_cast<LeylineTelemetryPage*>(mapping);
+        if (Cable->Telemetry)
+        {
+            LARGE_INTEGER freq;
+            KeQueryPerformanceCounter(&freq);
+            Cable->Telemetry->Header.Magic        = LEYLINE_TELEMETRY_MAGIC;
+            Cable->Telemetry->Header.Version      = LEYLINE_TELEMETRY_VERSION;
+            Cable->Telemetry->Header.Size         = sizeof(LeylineTelemetryPage);
+            Cable->Telemetry->Header.CableId      = Id;
+            Cable->Telemetry->Header.QpcFrequency = freq.QuadPart;
+        }
+    }
+
+    LoopbackEngineSetTelemetry(&Cable->Loopback, Cable->Telemetry);
+
+    if (!Cable->SharedParamsMdl)
+    {
+        PVOID mapping;
+        Cable->SharedParamsMdl = AllocateMappedPages(sizeof(LeylineSharedParameters), &mapping);
+        Cable->SharedParams = static_cast<LeylineSharedParameters*>(mapping);
+        if (Cable->SharedParams)
+        {
+            Cable->SharedParams->BufferSize     = (ULONG)Cable->LoopbackSize;
+            Cable->SharedParams->ByteRate       = 48000 * 4;
+            Cable->SharedParams->MasterGainBits = 0x3F800000; // 1.0f
+            LARGE_INTEGER freq;
+            KeQueryPerformanceCounter(&freq);
+            Cable->SharedParams->QpcFrequency = freq.QuadPart;
+        }
+    }
+
+    LoopbackEngineSetSharedParameters(&Cable->Loopback, Cable->SharedParams);
+
+    if (!Cable->PositionMdl)
+    {
+        PVOID mapping;
+        Cable->PositionMdl  = AllocateMappedPages(sizeof(LeylinePositionPage), &mapping);
+        Cable->PositionPage = static_cast<LeylinePositionPage*>(mapping);
+    }
+
+    LoopbackEngineSetPositionPage(&Cable->Loopback, Cable->PositionPage);
+
+    if (LeylineTraceOn(LEYLINE_KEYWORD_CABLE))
+        LeylineTraceCableCreated(Id, KeQueryPerformanceCounter(nullptr).QuadPart);
+}
+
+void LeylineCableCleanup(LeylineCable* Cable)
+{
+    // Cancel the loopback timer before freeing anything the DPC touches.
+    LoopbackEngineStop(&Cable->Loopback);
+    LoopbackEngineCleanup(&Cable->Loopback);
+    LoopbackEngineSetTelemetry(&Cable->Loopback, nullptr);
+    LoopbackEngineSetSharedParameters(&Cable->Loopback, nullptr);
+    LoopbackEngineSetPositionPage(&Cable->Loopback, nullptr);
+
+    FreeMappedPages(&Cable->LoopbackMdl, Cable->LoopbackBuffer);
+    Cable->LoopbackBuffer = nullptr;
+    Cable->LoopbackSize   = 0;
+    FreeMappedPages(&Cable->TelemetryMdl, Cable->Telemetry);
+    Cable->Telemetry = nullptr;
+    FreeMappedPages(&Cable->SharedParamsMdl, Cable->SharedParams);
+    Cable->SharedParams = nullptr;
+    FreeMappedPages(&Cable->PositionMdl, Cable->PositionPage);
+    Cable->PositionPage = nullptr;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SPAWNED CABLES
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+LeylineCable* LeylineCableCreate(DeviceExtension* DevExt, ULONG Id)
+{
+    auto *cable = static_cast<LeylineCable*>(LeylineSlabAllocate(&g_ObjectSlabs.Cables, sizeof(LeylineCable)));
+    if (!cable) return nullptr;
+
+    LeylineCableInit(cable, DevExt, Id, 0);
+
+    KIRQL irql;
+    KeAcquireSpinLock(&DevExt->CableLock, &irql);
+    InsertTailList(&DevExt->Cables, &cable->ListEntry);
+    DevExt->CableCount++;
+    KeReleaseSpinLock(&DevExt->CableLock, irql);
+
+    LeylineCablesBalance(DevExt);
+    return cable;
+}
+
+LeylineCable* LeylineCableFind(DeviceExtension* DevExt, ULONG Id)
+{
+    if (Id == DevExt->Cable.Id) return &DevExt->Cable;
+
+    LeylineCable* found = nullptr;
+    KIRQL irql;
+    KeAcquireSpinLock(&DevExt->CableLock, &irql);
+    for (PLIST_ENTRY entry = DevExt->Cables.Flink; entry != &DevExt->Cables; entry = entry->Flink)
+    {
+        LeylineCable* cable = CONTAINING_RECORD(entry, LeylineCable, ListEntry);
+        if (cable->Id == Id) { found = cable; break; }
+    }
+    KeReleaseSpinLock(&DevExt->CableLock, irql);
+    return found;
+}
+
+// Cables are never removed before unload, so the walk can run each engine call without
+// the list lock held; each engine takes its own. Until the first StartDevice there are
+// no cables, not even cable 1, whose engine is still zeroed.
+void LeylineCablesStop(DeviceExtension* DevExt)
+{
+    if (!DevExt->Cables.Flink) return;
+
+    LoopbackEngineStop(&DevExt->Cable.Loopback);
+    for (PLIST_ENTRY entry = DevExt->Cables.Flink; entry != &DevExt->Cables; entry = entry->Flink)
+        LoopbackEngineStop(&CONTAINING_RECORD(entry, LeylineCable, ListEntry)->Loopback);
+}
+
+void LeylineCablesResume(DeviceExtension* DevExt)
+{
+    if (!DevExt->Cables.Flink) return;
+
+    LoopbackEngineResume(&DevExt->Cable.Loopback);
+    for (PLIST_ENTRY entry = DevExt->Cables.Flink; entry != &DevExt->Cables; entry = entry->Flink)
+        LoopbackEngineResume(&CONTAINING_RECORD(entry, LeylineCable, ListEntry)->Loopback);
+}
+
+void LeylineCablesDestroy(DeviceExtension* DevExt)
+{
+    if (!DevExt->Cables.Flink) return;
+
+    while (!IsListEmpty(&DevExt->Cables))
+    {
+        LeylineCable* cable = CONTAINING_RECORD(RemoveHeadList(&DevExt->Cables), LeylineCable, ListEntry);
+        LeylineCableCleanup(cable);
+        LeylineSlabFree(&g_ObjectSlabs.Cables, cable);
+    }
+    LeylineCableCleanup(&DevExt->Cable);
+    DevExt->CableCount = 1;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DPC PLACEMENT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Cable 1, then the spawned cables in creation order. Under CableLock.
+static LeylineCable* NextCable(DeviceExtension* DevExt, LeylineCable* Cable)
+{
+    PLIST_ENTRY next = (Cable == &DevExt->Cable) ? DevExt->Cables.Flink : Cable->ListEntry.Flink;
+    return (next == &DevExt->Cables) ? nullptr : CONTAINING_RECORD(next, LeylineCable, ListEntry);
+}
+
+static inline ULONG PlacementProcessors()
+{
+    ULONG processors = KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS);
+    return min(processors, (ULONG)LEYLINE_PLACEMENT_MAX_PROCESSORS);
+}
+
+void LeylineCablesBalance(DeviceExtension* DevExt)
+{
+    if (!DevExt->Cables.Flink) return;
+    ULONG processors = PlacementProcessors();
+
+    // Sized outside the lock; a cable created in between means another pass.
+    for (;;)
+    {
+        ULONG count = DevExt->CableCount;
+        auto *entries = static_cast<LeylinePlacementEntry*>(
+            ExAllocatePool2(POOL_FLAG_NON_PAGED, count * sizeof(LeylinePlacementEntry), LEYLINE_CABLE_TAG));
+        if (!entries) return;
+
+        KIRQL irql;
+        KeAcquireSpinLock(&DevExt->CableLock, &irql);
+        if (DevExt->CableCount != count)
+        {
+            KeReleaseSpinLock(&DevExt->CableLock, irql);
+            ExFreePoolWithTag(entries, LEYLINE_CABLE_TAG);
+            continue;
+        }
+
+        ULONG n = 0;
+        for (LeylineCable* cable = &DevExt->Cable; cable && n < count; cable = NextCable(DevExt, cable))
+        {
+            entries[n].CableId   = cable->Id;
+            entries[n].Override  = cable->ProcessorOverride;
+            entries[n].Processor = cable->Loopback.Processor;
+            entries[n].Cost      = LoopbackEngineTickCostNs(&cable->Loopback);
+            entries[n].Context   = cable;
+            n++;
+        }
+
+        LeylinePlacementBalance(entries, n, processors, nullptr);
+        for (ULONG i = 0; i < n; i++)
+        {
+            auto *cable = static_cast<LeylineCable*>(entries[i].Context);
+            LoopbackEngineSetProcessor(&cable->Loopback, entries[i].Processor);
+        }
+
+        KeReleaseSpinLock(&DevExt->CableLock, irql);
+        ExFreePoolWithTag(entries, LEYLINE_CABLE_TAG);
+        return;
+    }
+}
+
+NTSTATUS LeylineCablesGetPlacement(DeviceExtension* DevExt, LeylinePlacementInfo* Info,
+                                   ULONG Size, ULONG_PTR* Written)
+{
+    const ULONG header = (ULONG)FIELD_OFFSET(LeylinePlacementInfo, Cables);
+    if (Size < header) return STATUS_BUFFER_TOO_SMALL;
+    if (!DevExt->Cables.Flink) return STATUS_DEVICE_NOT_READY;
+
+    ULONG fit = (Size - header) / sizeof(LeylineCablePlacement);
+    ULONG n   = 0;
+
+    KIRQL irql;
+    KeAcquireSpinLock(&DevExt->CableLock, &irql);
+    Info->Processors = PlacementProcessors();
+    Info->CableCount = DevExt->CableCount;
+    for (LeylineCable* cable = &DevExt->Cable; cable && n < fit; cable = NextCable(DevExt, cable))
+    {
+        LeylineCablePlacement* out = &Info->Cables[n++];
+        out->CableId   = cable->Id;
+        out->Processor = cable->Loopback.Processor;
+        out->Override  = cable->ProcessorOverride;
+        out->CostNs    = LoopbackEngineTickCostNs(&cable->Loopback);
+    }
+    KeReleaseSpinLock(&DevExt->CableLock, irql);
+
+    *Written = header + n * sizeof(LeylineCablePlacement);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS LeylineCableGetSafety(DeviceExtension* DevExt, ULONG CableId, LeylineCableSafety* Info)
+{
+    LeylineCable* cable = LeylineCableFind(DevExt, CableId);
+    if (!cable) return STATUS_INVALID_PARAMETER;
+
+    LoopbackEngineQuerySafety(&cable->Loopback, Info);
+    Info->CableId = CableId;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS LeylineCableGetStats(DeviceExtension* DevExt, ULONG CableId, LeylineCableStats* Info)
+{
+    LeylineCable* cable = LeylineCableFind(DevExt, CableId);
+    if (!cable) return STATUS_INVALID_PARAMETER;
+
+    NTSTATUS status = LoopbackEngineQueryStats(&cable->Loopback, Info);
+    Info->CableId = CableId;
+    return status;
+}
+
+NTSTATUS LeylineCableSetSafety(DeviceExtension* DevExt, const LeylineSafetyRequest* Request)
+{
+    if (Request->OffsetUs > LEYLINE_SAFETY_MAX_US) return STATUS_INVALID_PARAMETER;
+
+    LeylineCable* cable = LeylineCableFind(DevExt, Request->CableId);
+    if (!cable) return STATUS_INVALID_PARAMETER;
+
+    LoopbackEngineSetSafetyOffset(&cable->Loopback, Request->OffsetUs, Request->Adaptive != 0);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS LeylineCableSetPlacement(DeviceExtension* DevExt, const LeylinePlacementRequest* Request)
+{
+    if (Request->Processor != LEYLINE_PROCESSOR_AUTO && Request->Processor >= PlacementProcessors())
+        return STATUS_INVALID_PARAMETER;
+
+    LeylineCable* cable = LeylineCableFind(DevExt, Request->CableId);
+    if (!cable) return STATUS_INVALID_PARAMETER;
+
+    InterlockedExchange(reinterpret_cast<volatile LONG*>(&cable->ProcessorOverride), (LONG)Request->Processor);
+    LeylineCablesBalance(DevExt);
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM CLOCK IMPLEMENTATION
+// The one-time reciprocal math behind leyline_clock.h. Runs at stream start or format
+// change, never in the tick.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_clock.h"
+
+void LeylineDivisorInit(LeylineDivisor* Divisor, ULONGLONG Value)
+{
+    Divisor->Divisor    = Value;
+    Divisor->Reciprocal = ~0ULL / Value;
+}
+
+// floor(Numerator * 2^64 / Denominator) for Numerator < Denominator < 2^63, one bit at a
+// time, so no 128-bit division is needed.
+static ULONGLONG BinaryFraction(ULONGLONG Numerator, ULONGLONG Denominator)
+{
+    ULONGLONG fraction = 0;
+    for (int bit = 0; bit < 64; bit++)
+    {
+        Numerator <<= 1;
+        fraction  <<= 1;
+        if (Numerator >= Denominator)
+        {
+            Numerator -= Denominator;
+            fraction  |= 1;
+        }
+    }
+    return fraction;
+}
+
+void LeylineClockInit(LeylineStreamClock* Clock, ULONG Rate, LONGLONG Frequency, LONGLONG Start)
+{
+    Clock->Start = Start;
+    if (Rate == 0 || Frequency <= 0)
+    {
+        Clock->Whole           = 0;
+        Clock->Fraction        = 0;
+        Clock->Rate            = 0;
+        Clock->Frequency       = 1;
+        Clock->InverseWhole    = 0;
+        Clock->InverseFraction = 0;
+        return;
+    }
+
+    Clock->Rate            = Rate;
+    Clock->Frequency       = (ULONGLONG)Frequency;
+    Clock->Whole           = Clock->Rate / Clock->Frequency;
+    Clock->Fraction        = BinaryFraction(Clock->Rate % Clock->Frequency, Clock->Frequency);
+    Clock->InverseWhole    = Clock->Frequency / Clock->Rate;
+    Clock->InverseFraction = BinaryFraction(Clock->Frequency % Clock->Rate, Clock->Rate);
+}
@@ -93,3 +93,56 @@ NTSTATUS HandleBasicSupportFull(PPCPROPERTY_REQUEST Req, ULONG AccessFlags, ULON
     }
     return STATUS_BUFFER_TOO_SMALL;
 }
+
+// Basic support for a VT_I4 property with one stepped range (volume, peak meter).
+NTSTATUS HandleBasicSupportStepped(PPCPROPERTY_REQUEST Req, ULONG AccessFlags,
+                                   LONG Minimum, LONG Maximum, ULONG Delta)
+{
+    struct STEPPED_BASIC
+    {
+        KSPROPERTY_DESCRIPTION   desc;
+        KSPROPERTY_MEMBERSHEADER hdr;
+        KSPROPERTY_STEPPING_LONG stepping;
+    };
+
+    const ULONG fullSize  = sizeof(STEPPED_BASIC);
+    const ULONG ulongSize = sizeof(ULONG);
+
+    if (Req->ValueSize == 0)
+    {
+        Req->ValueSize = fullSize;
+        return STATUS_BUFFER_OVERFLOW;
+    }
+    if (Req->ValueSize >= fullSize)
+    {
+        auto *v = reinterpret_cast<STEPPED_BASIC*>(Req->Value);
+        if (v)
+        {
+            v->desc.AccessFlags      = AccessFlags;
+            v->desc.DescriptionSize  = fullSize;
+            v->desc.PropTypeSet.Set  = KSPROPTYPESETID_General;
+            v->desc.PropTypeSet.Id   = VT_I4;
+            v->desc.PropTypeSet.Flags = 0;
+            v->desc.MembersListCount = 1;
+            v->desc.Reserved         = 0;
+            v->hdr.MembersFlags  = KSPROPERTY_MEMBER_STEPPEDRANGES;
+            v->hdr.MembersSize   = sizeof(KSPROPERTY_STEPPING_LONG);
+            v->hdr.MembersCount  = 1;
+            v->hdr.Flags         = 0;
+            v->stepping.Bounds.SignedMinimum = Minimum;
+            v->stepping.Bounds.SignedMaximum = Maximum;
+            v->stepping.SteppingDelta = Delta;
+            v->stepping.Reserved      = 0;
+        }
+        Req->ValueSize = fullSize;
+        return STATUS_SUCCESS;
+    }
+    if (Req->ValueSize >= ulongSize)
+    {
+        auto *flags = reinterpret_cast<ULONG*>(Req->Value);
+        if (flags) *flags = AccessFlags;
+        Req->ValueSize = ulongSize;
+        return STATUS_SUCCESS;
+    }
+    return STATUS_BUFFER_TOO_SMALL;
+}
@@ -10,16 +10,13 @@
 
 #include "leyline_miniport.h"
 
-// FDO global, needed by property handlers to recover DeviceExtension.
-extern PDEVICE_OBJECT g_FunctionalDeviceObject;
-
-extern PDEVICE_OBJECT g_FunctionalDeviceObject;
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // HANDLERS (Internal)
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 NTSTATUS HandleBasicSupportFull(PPCPROPERTY_REQUEST Req, ULONG AccessFlags, ULONG TypeId);
+NTSTATUS HandleBasicSupportStepped(PPCPROPERTY_REQUEST Req, ULONG AccessFlags,
+                                   LONG Minimum, LONG Maximum, ULONG Delta);
 NTSTATUS SignalProcessingModesHandler(PPCPROPERTY_REQUEST PropertyRequest);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -32,12 +29,13 @@ extern const PCAUTOMATION_TABLE g_TopoFilterAutomationTable;
 extern const PCAUTOMATION_TABLE g_PinAutomationTable;
 extern const PCAUTOMATION_TABLE g_VolumeAutomationTable;
 extern const PCAUTOMATION_TABLE g_MuteAutomationTable;
+extern const PCAUTOMATION_TABLE g_PeakMeterAutomationTable;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // PINS & NODES
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-extern const PCNODE_DESCRIPTOR      g_TopoNodes[2];
+extern const PCNODE_DESCRIPTOR      g_TopoNodes[3];
 extern const PCPIN_DESCRIPTOR       g_WaveRenderPins[2];
 extern const PCPIN_DESCRIPTOR       g_WaveCapturePins[2];
 extern const PCPIN_DESCRIPTOR       g_TopoRenderPins[2];
@@ -49,7 +47,7 @@ extern const PCPIN_DESCRIPTOR       g_TopoCapturePins[2];
 
 extern const PCCONNECTION_DESCRIPTOR g_WaveConnections[1];
 extern const PCCONNECTION_DESCRIPTOR g_WaveCaptureConnections[1];
-extern const PCCONNECTION_DESCRIPTOR g_TopoConnections[3];
+extern const PCCONNECTION_DESCRIPTOR g_TopoConnections[4];
 extern const PCCONNECTION_DESCRIPTOR g_TopoCaptureConnections[1];
 
 extern const GUID g_TopoFilterCategories[2];
@@ -91,60 +91,42 @@ NTSTATUS JackDescriptionHandler(PPCPROPERTY_REQUEST PropertyRequest)
     return STATUS_NOT_IMPLEMENTED;
 }
 
-NTSTATUS VolumeHandler(PPCPROPERTY_REQUEST PropertyRequest)
+// Push the current volume and mute to the DPC, which also publishes them on the
+// telemetry page, and to the legacy shared parameter block.
+static void ApplyMasterGain(LeylineCable* Cable)
 {
-    if (!PropertyRequest) return STATUS_INVALID_PARAMETER;
+    BOOLEAN mute = Cable->MuteState != 0;
+    float   gain = mute ? 0.0f : LeylineGainFromVolume(Cable->VolumeLevel);
 
-    struct VOL_BASIC
-    {
-        KSPROPERTY_DESCRIPTION  desc;
-        KSPROPERTY_MEMBERSHEADER hdr;
-        KSPROPERTY_STEPPING_LONG stepping;
-    };
+    Cable->GainLinear16 = (ULONG)(gain * 65536.0f + 0.5f);
+    LoopbackEngineSetMasterGain(&Cable->Loopback, Cable->VolumeLevel, mute);
 
-    if (PropertyRequest->Verb & KSPROPERTY_TYPE_BASICSUPPORT)
+    if (Cable->SharedParams)
     {
-        const ULONG fullSize  = sizeof(VOL_BASIC);
-        const ULONG ulongSize = sizeof(ULONG);
-
-        if (PropertyRequest->ValueSize == 0)
-        {
-            PropertyRequest->ValueSize = fullSize;
-            return STATUS_BUFFER_OVERFLOW;
-        }
-        if (PropertyRequest->ValueSize >= fullSize)
-        {
-            auto *v = reinterpret_cast<VOL_BASIC*>(PropertyRequest->Value);
-            if (v)
-            {
-                v->desc.AccessFlags      = KSPROPERTY_TYPE_GET | KSPROPERTY_TYPE_SET | KSPROPERTY_TYPE_BASICSUPPORT;
-                v->desc.DescriptionSize  = fullSize;
-                v->desc.PropTypeSet.Set  = KSPROPTYPESETID_General;
-                v->desc.PropTypeSet.Id   = VT_I4;
-                v->desc.PropTypeSet.Flags = 0;
-                v->desc.MembersListCount = 1;
-                v->desc.Reserved         = 0;
-                v->hdr.MembersFlags  = KSPROPERTY_MEMBER_STEPPEDRANGES;
-                v->hdr.MembersSize   = sizeof(KSPROPERTY_STEPPING_LONG);
-                v->hdr.MembersCount  = 1;
-                v->hdr.Flags         = 0;
-                v->stepping.Bounds.SignedMinimum  = -96 * 0x10000;
-                v->stepping.Bounds.SignedMaximum  = 0;
-                v->stepping.SteppingDelta  = 0x10000;
-                v->stepping.Reserved       = 0;
-            }
-            PropertyRequest->ValueSize = fullSize;
-            return STATUS_SUCCESS;
-        }
-        if (PropertyRequest->ValueSize >= ulongSize)
-        {
-            auto *f = reinterpret_cast<ULONG*>(PropertyRequest->Value);
-            if (f) *f = KSPROPERTY_TYPE_GET | KSPROPERTY_TYPE_SET | KSPROPERTY_TYPE_BASICSUPPORT;
-            PropertyRequest->ValueSize = ulongSize;
-            return STATUS_SUCCESS;
-        }
-        return STATUS_BUFFER_TOO_SMALL;
+        ULONG bits;
+        RtlCopyMemory(&bits, &gain, sizeof(bits));
+        InterlockedExchange(reinterpret_cast<volatile LONG*>(&Cable->SharedParams->MasterGainBits), (LONG)bits);
     }
+}
+
+// Volume, mute and peak meter nodes only exist on the topology filters, and PortCls
+// passes the miniport it was initialized with as the major target, so the request
+// already names its cable.
+static inline LeylineCable* HandlerCable(PPCPROPERTY_REQUEST PropertyRequest)
+{
+    if (!PropertyRequest->MajorTarget) return nullptr;
+    auto *miniport = static_cast<CMiniportTopology*>(static_cast<IMiniportTopology*>(PropertyRequest->MajorTarget));
+    return miniport->GetCable();
+}
+
+NTSTATUS VolumeHandler(PPCPROPERTY_REQUEST PropertyRequest)
+{
+    if (!PropertyRequest) return STATUS_INVALID_PARAMETER;
+
+    if (PropertyRequest->Verb & KSPROPERTY_TYPE_BASICSUPPORT)
+        return HandleBasicSupportStepped(PropertyRequest,
+                                         KSPROPERTY_TYPE_GET | KSPROPERTY_TYPE_SET | KSPROPERTY_TYPE_BASICSUPPORT,
+                                         LEYLINE_VOLUME_MIN, LEYLINE_VOLUME_MAX, LEYLINE_VOLUME_STEP);
 
     if (PropertyRequest->ValueSize == 0)
     {
@@ -154,10 +136,25 @@ NTSTATUS VolumeHandler(PPCPROPERTY_REQUEST PropertyRequest)
     if (PropertyRequest->ValueSize < sizeof(LONG))
         return STATUS_BUFFER_TOO_SMALL;
 
+    // One master gain: every channel reads and writes the same level.
+    auto *val = reinterpret_cast<LONG*>(PropertyRequest->Value);
+    LeylineCable *cable = HandlerCable(PropertyRequest);
+    if (!val) return STATUS_INVALID_PARAMETER;
+
     if (PropertyRequest->Verb & KSPROPERTY_TYPE_GET)
     {
-        auto *val = reinterpret_cast<LONG*>(PropertyRequest->Value);
-        if (val) *val = 0; // Lock to 0 dB (Unity Gain)
+        *val = cable ? cable->VolumeLevel : LEYLINE_VOLUME_MAX;
+        PropertyRequest->ValueSize = sizeof(LONG);
+    }
+    else if (PropertyRequest->Verb & KSPROPERTY_TYPE_SET)
+    {
+        if (!cable) return STATUS_INVALID_DEVICE_STATE;
+
+        LONG level = *val;
+        if (level < LEYLINE_VOLUME_MIN) level = LEYLINE_VOLUME_MIN;
+        if (level > LEYLINE_VOLUME_MAX) level = LEYLINE_VOLUME_MAX;
+        InterlockedExchange(&cable->VolumeLevel, level);
+        ApplyMasterGain(cable);
     }
     return STATUS_SUCCESS;
 }
@@ -174,12 +171,68 @@ NTSTATUS MuteHandler(PPCPROPERTY_REQUEST PropertyRequest)
     if (PropertyRequest->ValueSize == 0) { PropertyRequest->ValueSize = sizeof(LONG); return STATUS_BUFFER_OVERFLOW; }
     if (PropertyRequest->ValueSize < sizeof(LONG)) return STATUS_BUFFER_TOO_SMALL;
 
+    auto *val = reinterpret_cast<LONG*>(PropertyRequest->Value);
+    LeylineCable *cable = HandlerCable(PropertyRequest);
+    if (!val) return STATUS_INVALID_PARAMETER;
+
     if (PropertyRequest->Verb & KSPROPERTY_TYPE_GET)
     {
-        auto *val = reinterpret_cast<LONG*>(PropertyRequest->Value);
-        if (val) *val = 0; // Lock to unmuted
+        *val = cable ? cable->MuteState : 0;
+        PropertyRequest->ValueSize = sizeof(LONG);
     }
-    // Ignore sets.
+    else if (PropertyRequest->Verb & KSPROPERTY_TYPE_SET)
+    {
+        if (!cable) return STATUS_INVALID_DEVICE_STATE;
+
+        InterlockedExchange(&cable->MuteState, *val ? 1 : 0);
+        ApplyMasterGain(cable);
+    }
+    return STATUS_SUCCESS;
+}
+
+// PEAKMETER2 reports the largest linear peak since the previous read, full scale at
+// the positive end of the LONG range.
+#define LEYLINE_PEAKMETER_MINIMUM   (-2147483647L - 1)
+#define LEYLINE_PEAKMETER_MAXIMUM   2147483647L
+#define LEYLINE_PEAKMETER_STEP      1
+
+NTSTATUS PeakMeterHandler(PPCPROPERTY_REQUEST PropertyRequest)
+{
+    if (!PropertyRequest || !PropertyRequest->PropertyItem) return STATUS_INVALID_PARAMETER;
+
+    ULONG roFlags = KSPROPERTY_TYPE_GET | KSPROPERTY_TYPE_BASICSUPPORT;
+    BOOLEAN cpu   = PropertyRequest->PropertyItem->Id == KSPROPERTY_AUDIO_CPU_RESOURCES;
+
+    if (PropertyRequest->Verb & KSPROPERTY_TYPE_BASICSUPPORT)
+    {
+        if (cpu) return HandleBasicSupportFull(PropertyRequest, roFlags, VT_I4);
+        return HandleBasicSupportStepped(PropertyRequest, roFlags, LEYLINE_PEAKMETER_MINIMUM,
+                                         LEYLINE_PEAKMETER_MAXIMUM, LEYLINE_PEAKMETER_STEP);
+    }
+    if (!(PropertyRequest->Verb & KSPROPERTY_TYPE_GET)) return STATUS_INVALID_DEVICE_REQUEST;
+
+    if (PropertyRequest->ValueSize == 0) { PropertyRequest->ValueSize = sizeof(LONG); return STATUS_BUFFER_OVERFLOW; }
+    if (PropertyRequest->ValueSize < sizeof(LONG)) return STATUS_BUFFER_TOO_SMALL;
+
+    auto *val = reinterpret_cast<LONG*>(PropertyRequest->Value);
+    if (!val) return STATUS_INVALID_PARAMETER;
+    PropertyRequest->ValueSize = sizeof(LONG);
+
+    // Metered by the loopback tick on the worker thread or in its DPC, so it costs the
+    // host CPU.
+    if (cpu)
+    {
+        *val = KSAUDIO_CPU_RESOURCES_HOST_CPU;
+        return STATUS_SUCCESS;
+    }
+
+    if (PropertyRequest->InstanceSize < sizeof(LONG) || !PropertyRequest->Instance)
+        return STATUS_INVALID_PARAMETER;
+    LONG channel = *reinterpret_cast<LONG*>(PropertyRequest->Instance);
+
+    LeylineCable *cable = HandlerCable(PropertyRequest);
+    float peak = (cable && channel >= 0) ? LoopbackEngineTakePeak(&cable->Loopback, (ULONG)channel) : 0.0f;
+    *val = (peak >= 1.0f) ? LEYLINE_PEAKMETER_MAXIMUM : (LONG)(peak * (float)LEYLINE_PEAKMETER_MAXIMUM);
     return STATUS_SUCCESS;
 }
 
@@ -11,9 +11,31 @@
 
 PDEVICE_OBJECT g_FunctionalDeviceObject = nullptr;
 extern PDEVICE_OBJECT g_ControlDeviceObject;
-extern ULONGLONG      g_EtwRegHandle;
 extern "C" NTSTATUS NTAPI AddDevice(PDRIVER_OBJECT, PDEVICE_OBJECT);
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Object slabs
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+LeylineObjectSlabs g_ObjectSlabs;
+
+void LeylineObjectSlabsInit()
+{
+    LeylineSlabInit(&g_ObjectSlabs.Streams,       sizeof(CMiniportWaveRTStream), 'LLWS');
+    LeylineSlabInit(&g_ObjectSlabs.WaveMiniports, sizeof(CMiniportWaveRT),       'LLWM');
+    LeylineSlabInit(&g_ObjectSlabs.TopoMiniports, sizeof(CMiniportTopology),     'LLTM');
+    LeylineSlabInit(&g_ObjectSlabs.Cables,        sizeof(LeylineCable),          'LLCB');
+}
+
+// Every miniport, stream and spawned cable is gone by unload.
+void LeylineObjectSlabsCleanup()
+{
+    LeylineSlabCleanup(&g_ObjectSlabs.Streams);
+    LeylineSlabCleanup(&g_ObjectSlabs.WaveMiniports);
+    LeylineSlabCleanup(&g_ObjectSlabs.TopoMiniports);
+    LeylineSlabCleanup(&g_ObjectSlabs.Cables);
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // DriverUnload
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -27,29 +49,13 @@ static void NTAPI DriverUnload(PDRIVER_OBJECT /*DriverObject*/)
         DeviceExtension *ext = GetDeviceExtension(g_FunctionalDeviceObject);
         if (ext)
         {
-            // Cancel loopback timer before freeing any shared resources.
-            if (ext->TimerRunning)
-            {
-                KeCancelTimer(&ext->LoopbackTimer);
-                ext->TimerRunning = FALSE;
-            }
-
-            if (ext->LoopbackMdl)
-            {
-                if (ext->LoopbackBuffer) MmUnmapLockedPages(ext->LoopbackBuffer, ext->LoopbackMdl);
-                MmFreePagesFromMdl(ext->LoopbackMdl);
-                IoFreeMdl(ext->LoopbackMdl);
-                ext->LoopbackMdl = nullptr;
-            }
-            if (ext->SharedParamsMdl)
-            {
-                if (ext->SharedParams) MmUnmapLockedPages(ext->SharedParams, ext->SharedParamsMdl);
-                MmFreePagesFromMdl(ext->SharedParamsMdl);
-                IoFreeMdl(ext->SharedParamsMdl);
-                ext->SharedParamsMdl = nullptr;
-            }
+            // Stops every cable's timer before freeing its pages. Every stream buffer
+            // is back in the pool by now.
+            LeylineCablesDestroy(ext);
+            if (ext->Cables.Flink) LeylineBufferPoolCleanup(&ext->BufferPool);
         }
     }
+    LeylineObjectSlabsCleanup();
 
     if (g_ControlDeviceObject)
     {
@@ -61,11 +67,7 @@ static void NTAPI DriverUnload(PDRIVER_OBJECT /*DriverObject*/)
         DbgPrint("Leyline: CDO and Symbolic Link Cleaned Up\n");
     }
 
-    if (g_EtwRegHandle)
-    {
-        EtwUnregister(g_EtwRegHandle);
-        g_EtwRegHandle = 0;
-    }
+    LeylineTraceUnregister();
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -76,14 +78,17 @@ extern "C" NTSTATUS DriverEntry(PDRIVER_OBJECT DriverObject, PUNICODE_STRING Reg
 {
     DbgPrint("Leyline: DriverEntry v0.1.0\n");
 
-    EtwRegister(&ETW_PROVIDER_GUID, nullptr, nullptr, &g_EtwRegHandle);
+    LeylineTraceRegister(&ETW_PROVIDER_GUID);
 
     DriverObject->DriverUnload = DriverUnload;
+    LeylineObjectSlabsInit();
 
     NTSTATUS status = PcInitializeAdapterDriver(DriverObject, RegistryPath, AddDevice);
     if (!NT_SUCCESS(status))
     {
         DbgPrint("Leyline: PcInitializeAdapterDriver FAILED 0x%X\n", status);
+        LeylineObjectSlabsCleanup();
+        LeylineTraceUnregister();
         return status;
     }
 
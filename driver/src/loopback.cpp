@@ -0,0 +1,2771 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK ENGINE IMPLEMENTATION
+// Stream registration, position math, event signaling and the render -> capture mix.
+// Portable: builds against the WDK and against the host shim.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_loopback.h"
+#include "leyline_trace.h"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FRAME HELPERS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline ULONGLONG StreamCurrentFrame(const LoopbackStream* Stream, LONGLONG Now)
+{
+    return LeylineClockFrames(&Stream->Clock, Now) + Stream->FrameShift;
+}
+
+// QPC time at which the stream reaches Frame; the start for a frame it began past.
+static inline LONGLONG StreamFrameTime(const LoopbackStream* Stream, ULONGLONG Frame)
+{
+    ULONGLONG shift = Stream->FrameShift;
+    return LeylineClockTimeOf(&Stream->Clock, (Frame > shift) ? Frame - shift : 0);
+}
+
+static inline ULONG StreamBufferFrames(const LoopbackStream* Stream)
+{
+    return Stream->BufferFrames;
+}
+
+// Where absolute frame Frame falls in the buffer. The buffer must hold at least a frame.
+static inline ULONG StreamBufferOffset(const LoopbackStream* Stream, ULONGLONG Frame)
+{
+    return (ULONG)LeylineModulo(&Stream->BufferDivisor, Frame);
+}
+
+// Refresh the tick's copy of the buffer after the buffer or the frame size changes.
+static void StreamBufferChanged(LoopbackStream* Stream)
+{
+    Stream->BufferBase     = Stream->Buffer.GetBaseAddress();
+    Stream->BufferMirrored = Stream->Buffer.IsMirrored();
+    Stream->BufferFrames   = Stream->Buffer.GetSize() / Stream->FrameBytes;
+    LeylineDivisorInit(&Stream->BufferDivisor, max(Stream->BufferFrames, (ULONG)1));
+}
+
+static inline BOOLEAN StreamIsActive(const LoopbackStream* Stream)
+{
+    return Stream->State == KSSTATE_RUN && Stream->BufferBase && StreamBufferFrames(Stream) > 0;
+}
+
+// How far a reader may have got by Frame: a capture trails it by its read-behind.
+static inline ULONGLONG SafeFrame(ULONGLONG Frame, ULONG SafetyFrames)
+{
+    return (Frame > SafetyFrames) ? Frame - SafetyFrames : 0;
+}
+
+static inline ULONGLONG StreamReportedFrame(const LoopbackStream* Stream, LONGLONG Now)
+{
+    return SafeFrame(StreamCurrentFrame(Stream, Now), Stream->SafetyFrames);
+}
+
+// The same, for the tick: from the stream table entry, and the stream's first line.
+static inline ULONGLONG StreamCurrentFrame(const LoopbackTickStream* Tick, LONGLONG Now)
+{
+    return LeylineClockFrames(&Tick->Clock, Now) + Tick->FrameShift;
+}
+
+static inline ULONG StreamBufferFrames(const LoopbackTickStream* Tick)
+{
+    return Tick->Stream->BufferFrames;
+}
+
+static inline ULONG StreamBufferOffset(const LoopbackTickStream* Tick, ULONGLONG Frame)
+{
+    return (ULONG)LeylineModulo(&Tick->BufferDivisor, Frame);
+}
+
+// The state as published with the clock, so a stream never runs on a stale one.
+static inline BOOLEAN StreamIsActive(const LoopbackTickStream* Tick)
+{
+    return Tick->Running && Tick->Stream->BufferBase && StreamBufferFrames(Tick) > 0;
+}
+
+// Frames that can be addressed linearly from Offset: to the end of the buffer, or, over a
+// mirrored mapping, a whole buffer's worth.
+static inline ULONG StreamLinearFrames(const LoopbackTickStream* Tick, ULONG Frames, ULONG Offset)
+{
+    return Tick->BufferMirrored ? Frames : Frames - Offset;
+}
+
+static inline ULONG StreamSampleRate(const LoopbackStream* Stream)
+{
+    return Stream->FrameRate;
+}
+
+static inline ULONG StreamSampleRate(const LoopbackTickStream* Tick)
+{
+    return Tick->FrameRate;
+}
+
+// The stream's own kernels, or narrower ones if this tick couldn't save the AVX state.
+static inline const LeylineMixKernels* StreamKernels(const LoopbackTickStream* Tick, LeylineSimdLevel Level)
+{
+    if (Tick->Kernels->Level <= Level) return Tick->Kernels;
+    return LeylineSelectMixKernels(Tick->SampleFormat, Level);
+}
+
+// Copy Count frames between two rings of the same format, splitting at either buffer's
+// wrap point unless it is mirrored. Below unity gain the samples are scaled in the
+// same pass.
+static void CopyFrames(const LoopbackTickStream* Dst, ULONGLONG DstFrame,
+                       const LoopbackTickStream* Src, ULONGLONG SrcFrame, ULONG Count,
+                       float Gain, LeylineSimdLevel Level)
+{
+    ULONG frameBytes = Src->Stream->FrameBytes;
+    ULONG dstFrames  = StreamBufferFrames(Dst);
+    ULONG srcFrames  = StreamBufferFrames(Src);
+    ULONG dstOff     = StreamBufferOffset(Dst, DstFrame);
+    ULONG srcOff     = StreamBufferOffset(Src, SrcFrame);
+    const LeylineMixKernels* kernels = StreamKernels(Src, Level);
+
+    while (Count > 0)
+    {
+        ULONG  chunk = min(Count, min(StreamLinearFrames(Dst, dstFrames, dstOff),
+                                      StreamLinearFrames(Src, srcFrames, srcOff)));
+        PUCHAR dst   = Dst->Stream->BufferBase + (SIZE_T)dstOff * frameBytes;
+        PUCHAR src   = Src->Stream->BufferBase + (SIZE_T)srcOff * frameBytes;
+
+        // Bit-perfect absolute pass-through at unity gain.
+        if (Gain == 1.0f)
+            RtlCopyMemory(dst, src, (SIZE_T)chunk * frameBytes);
+        else
+            kernels->ScaleCopy(dst, src, chunk * Src->Channels, Gain);
+
+        dstOff += chunk;
+        srcOff += chunk;
+        if (dstOff >= dstFrames) dstOff -= dstFrames;
+        if (srcOff >= srcFrames) srcOff -= srcFrames;
+        Count -= chunk;
+    }
+}
+
+static void AccumulateFrames(float* Bus, ULONG BusChannels, const LoopbackTickStream* Src,
+                             ULONGLONG SrcFrame, ULONG Count, LeylineSimdLevel Level)
+{
+    ULONG srcFrames = StreamBufferFrames(Src);
+    ULONG srcOff    = StreamBufferOffset(Src, SrcFrame);
+    const LeylineMixKernels* kernels = StreamKernels(Src, Level);
+
+    while (Count > 0)
+    {
+        ULONG chunk = min(Count, StreamLinearFrames(Src, srcFrames, srcOff));
+        PUCHAR src  = Src->Stream->BufferBase + (SIZE_T)srcOff * Src->Stream->FrameBytes;
+
+        if (Src->Channels == BusChannels)
+            kernels->Accumulate(Bus, src, chunk * BusChannels);
+        else
+            MixAccumulate(Bus, BusChannels, src, Src->SampleFormat, Src->Channels, chunk);
+
+        Bus    += (SIZE_T)chunk * BusChannels;
+        srcOff += chunk;
+        if (srcOff >= srcFrames) srcOff -= srcFrames;
+        Count  -= chunk;
+    }
+}
+
+static void WriteFrames(const LoopbackTickStream* Dst, ULONGLONG DstFrame, const float* Bus, ULONG BusChannels,
+                        ULONG Count, float Gain, LeylineSimdLevel Level)
+{
+    ULONG dstFrames = StreamBufferFrames(Dst);
+    ULONG dstOff    = StreamBufferOffset(Dst, DstFrame);
+    const LeylineMixKernels* kernels = StreamKernels(Dst, Level);
+
+    while (Count > 0)
+    {
+        ULONG chunk = min(Count, StreamLinearFrames(Dst, dstFrames, dstOff));
+        PUCHAR dst  = Dst->Stream->BufferBase + (SIZE_T)dstOff * Dst->Stream->FrameBytes;
+
+        if (Dst->Channels == BusChannels)
+            kernels->WriteOut(dst, Bus, chunk * BusChannels, Gain);
+        else
+            MixWriteOut(dst, Dst->SampleFormat, Dst->Channels, Bus, BusChannels, chunk, Gain);
+
+        Bus    += (SIZE_T)chunk * BusChannels;
+        dstOff += chunk;
+        if (dstOff >= dstFrames) dstOff -= dstFrames;
+        Count  -= chunk;
+    }
+}
+
+// Re-align every render cursor to its stream clock (timer start, resume from D3).
+static void ResyncRenderCursors(LoopbackEngine* Engine, LONGLONG Now)
+{
+    for (PLIST_ENTRY entry = Engine->RenderStreams.Flink; entry != &Engine->RenderStreams; entry = entry->Flink)
+    {
+        LoopbackStream* renderStream = CONTAINING_RECORD(entry, LoopbackStream, ListEntry);
+        renderStream->Cursor = (renderStream->StartTime != 0) ? StreamCurrentFrame(renderStream, Now) : 0;
+        LeylineResamplerReset(&renderStream->Resampler, nullptr, 0);
+    }
+}
+
+// A capture that can take the only render stream's samples without the bus. A gain
+// ramp needs per-frame gains, which only the bus pass applies.
+static inline BOOLEAN CaptureTakesRawCopy(const LoopbackTickStream* Capture, const LoopbackTickStream* SoleSource,
+                                          ULONG MixCount, BOOLEAN Ramping)
+{
+    return MixCount == 1 && !Ramping && Capture->SampleFormat == SoleSource->SampleFormat &&
+           Capture->Channels == SoleSource->Channels && Capture->FrameRate == SoleSource->FrameRate;
+}
+
+// How a capture stream is fed when it shares a render stream's pages. While the render
+// stream runs, the only frames that may be written are those it has just played, and
+// only when it is the master, whose played frames are the tick's window. Paused or
+// stopped, it writes nothing, so the capture takes the mix at its own frames.
+enum LoopbackAliasRoute
+{
+    LoopbackAliasNone,          // Pages of its own: copied or mixed at its own frames
+    LoopbackAliasSkip,          // The master's samples are the capture's; nothing to write
+    LoopbackAliasInPlace,       // The mix is written over the master's frames just played
+    LoopbackAliasHeld,          // A running render stream that isn't the master owns them
+};
+
+static inline LoopbackAliasRoute CaptureAliasRoute(const LoopbackTickStream* Capture, const LoopbackTickStream* Master,
+                                                   ULONG MixCount, BOOLEAN Ramping, float Gain)
+{
+    if (!Capture->Pages || !Capture->OwnerRunning) return LoopbackAliasNone;
+    if (Capture->Pages != Master->Pages) return LoopbackAliasHeld;
+    return (MixCount == 1 && !Ramping && Gain == 1.0f) ? LoopbackAliasSkip : LoopbackAliasInPlace;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TICK PROBES
+// Each stage reads the time stamp counter as it ends and bins the cycles since the
+// last read in a log2 histogram: a read, a bit scan and an increment, no lock and no
+// division. Lateness and the worker's wake-up come from QPC reads the tick makes
+// anyway and are binned in nanoseconds. Built with LEYLINE_PROBES=0 these are empty
+// and the tick reads no extra counters.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#if LEYLINE_PROBES
+static inline ULONG ProbeBucket(ULONGLONG Value)
+{
+    ULONG bit;
+    if (!_BitScanReverse64(&bit, Value)) return 0;
+    return min(bit, (ULONG)LEYLINE_STATS_BUCKETS - 1);
+}
+
+static inline ULONGLONG ProbeStart()
+{
+    return ReadTimeStampCounter();
+}
+
+// Bin the cycles since Start under Probe; returns the read, to start the next stage.
+static inline ULONGLONG ProbeLap(LoopbackEngine* Engine, ULONG Probe, ULONGLONG Start)
+{
+    ULONGLONG now = ReadTimeStampCounter();
+    Engine->ProbeCounts[Probe][ProbeBucket(now - Start)]++;
+    return now;
+}
+
+static inline void ProbeQpc(LoopbackEngine* Engine, ULONG Probe, LONGLONG Qpc)
+{
+    ULONGLONG ns = (Qpc > 0 && Engine->QpcFrequency > 0)
+                 ? (ULONGLONG)Qpc * 1000000000ULL / (ULONGLONG)Engine->QpcFrequency : 0;
+    Engine->ProbeCounts[Probe][ProbeBucket(ns)]++;
+}
+#else
+static inline ULONGLONG ProbeStart() { return 0; }
+static inline ULONGLONG ProbeLap(LoopbackEngine*, ULONG, ULONGLONG) { return 0; }
+static inline void      ProbeQpc(LoopbackEngine*, ULONG, LONGLONG) {}
+#endif
+
+NTSTATUS LoopbackEngineQueryStats(const LoopbackEngine* Engine, LeylineCableStats* Info)
+{
+#if LEYLINE_PROBES
+    Info->GlitchCount   = Engine->GlitchCount;
+    Info->LostFrames    = Engine->LostFrames;
+    Info->ElapsedCycles = ReadTimeStampCounter() - Engine->ProbeCycleBase;
+    Info->ElapsedQpc    = (ULONGLONG)(KeQueryPerformanceCounter(nullptr).QuadPart - Engine->ProbeQpcBase);
+    Info->QpcFrequency  = (ULONGLONG)Engine->QpcFrequency;
+    RtlCopyMemory(Info->Histograms, Engine->ProbeCounts, sizeof(Info->Histograms));
+    return STATUS_SUCCESS;
+#else
+    UNREFERENCED_PARAMETER(Engine);
+    UNREFERENCED_PARAMETER(Info);
+    return STATUS_NOT_SUPPORTED;
+#endif
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM SNAPSHOT
+// The tick is the only reader, so the grace period before a replaced snapshot (or a
+// stream, or a table) may be freed is just the tick in flight when it was replaced:
+// TickSequence is odd while a tick runs, and a writer that sees it odd waits for it
+// to change. With a worker thread the timer's half of the tick has DpcSequence, and
+// a writer waits for both. Ticks are short, so writers wait microseconds at most; the
+// tick never waits for a writer. Nor does a writer wait holding StreamLock: the worker
+// runs at PASSIVE_LEVEL, and a callback that interrupts it on its processor may be
+// spinning on the lock.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LOOPBACK_SNAPSHOT_TAG 'LLSN'
+
+// A periodic DPC can be queued again while it still runs elsewhere; the second one
+// finds the sequence odd and skips, since positions are clock-based.
+static inline BOOLEAN EnterTick(volatile LONG* Sequence)
+{
+    LONG sequence = *Sequence;
+    if ((sequence & 1) || InterlockedCompareExchange(Sequence, sequence + 1, sequence) != sequence)
+        return FALSE;
+
+    // Pairs with the barrier in WaitForTick: either the writer sees this tick, or this
+    // tick sees everything the writer did before waiting.
+    KeMemoryBarrier();
+    return TRUE;
+}
+
+static inline void LeaveTick(volatile LONG* Sequence)
+{
+    InterlockedIncrement(Sequence);
+}
+
+static void WaitForSequence(volatile LONG* Sequence)
+{
+    LONG sequence = ReadAcquire(Sequence);
+    if (!(sequence & 1)) return;
+    while (ReadAcquire(Sequence) == sequence) YieldProcessor();
+}
+
+// Return once no tick that started before this call is still running, in the timer
+// callback or on the worker.
+static void WaitForTick(LoopbackEngine* Engine)
+{
+    KeMemoryBarrier();
+    WaitForSequence(&Engine->DpcSequence);
+    WaitForSequence(&Engine->TickSequence);
+}
+
+// A tick mixes only while the timer runs and no writer is stopping or retuning it.
+static inline BOOLEAN TimerTicking(const LoopbackEngine* Engine)
+{
+    return Engine->TimerRunning && !Engine->TimerChanging;
+}
+
+// Copy what the tick reads of a stream and only writers change into its table entry.
+static void FillTickStream(LoopbackTickStream* Tick, LoopbackStream* Stream)
+{
+    Tick->Stream         = Stream;
+    Tick->Clock          = Stream->Clock;
+    Tick->FrameShift     = Stream->FrameShift;
+    Tick->BufferDivisor  = Stream->BufferDivisor;
+    Tick->Kernels        = Stream->Kernels;
+    Tick->Pages          = Stream->Pages;
+    Tick->FrameRate      = Stream->FrameRate;
+    Tick->Channels       = Stream->Channels;
+    Tick->SampleFormat   = Stream->SampleFormat;
+    Tick->BufferMirrored = Stream->BufferMirrored;
+    Tick->Running        = Stream->State == KSSTATE_RUN;
+    Tick->OwnerRunning   = FALSE;
+    Tick->SafetyFrames   = Stream->SafetyFrames;
+}
+
+// Build a snapshot of the lists and tables and publish it. Caller holds StreamLock and
+// passes what this returns, the snapshot it replaced, to RetireSnapshot. With no
+// streams there is nothing for the tick to read, so no snapshot; without memory the
+// tick gets none either and idles until the next change.
+static LoopbackSnapshot* PublishSnapshot(LoopbackEngine* Engine)
+{
+    ULONG renderCount = 0, captureCount = 0;
+    for (PLIST_ENTRY entry = Engine->RenderStreams.Flink; entry != &Engine->RenderStreams; entry = entry->Flink)
+        renderCount++;
+    for (PLIST_ENTRY entry = Engine->CaptureStreams.Flink; entry != &Engine->CaptureStreams; entry = entry->Flink)
+        captureCount++;
+
+    LoopbackSnapshot* snapshot = nullptr;
+    if (renderCount + captureCount > 0)
+    {
+        SIZE_T bytes = FIELD_OFFSET(LoopbackSnapshot, Streams) + (SIZE_T)(renderCount + captureCount) * sizeof(LoopbackTickStream);
+        snapshot = static_cast<LoopbackSnapshot*>(ExAllocatePool2(POOL_FLAG_NON_PAGED | POOL_FLAG_CACHE_ALIGNED, bytes,
+                                                                  LOOPBACK_SNAPSHOT_TAG));
+        if (!snapshot) DbgPrint("Leyline: No memory for a stream snapshot; loopback idles until the next change\n");
+    }
+
+    if (snapshot)
+    {
+        snapshot->RenderCount        = renderCount;
+        snapshot->CaptureCount       = captureCount;
+        snapshot->ResampleQuality    = Engine->ResampleQuality;
+        snapshot->ResampleTableCount = Engine->ResampleTableCount;
+        snapshot->TableGeneration    = Engine->TableGeneration;
+        for (ULONG i = 0; i < LOOPBACK_MAX_RESAMPLE_TABLES; i++)
+            snapshot->ResampleTables[i] = Engine->ResampleTables[i];
+
+        ULONG n = 0;
+        for (PLIST_ENTRY entry = Engine->RenderStreams.Flink; entry != &Engine->RenderStreams; entry = entry->Flink)
+            FillTickStream(&snapshot->Streams[n++], CONTAINING_RECORD(entry, LoopbackStream, ListEntry));
+        for (PLIST_ENTRY entry = Engine->CaptureStreams.Flink; entry != &Engine->CaptureStreams; entry = entry->Flink)
+            FillTickStream(&snapshot->Streams[n++], CONTAINING_RECORD(entry, LoopbackStream, ListEntry));
+
+        // Render streams republish whenever they start or stop running.
+        for (ULONG c = renderCount; c < n; c++)
+        {
+            LoopbackTickStream* capture = &snapshot->Streams[c];
+            for (ULONG r = 0; r < renderCount && capture->Pages && !capture->OwnerRunning; r++)
+                capture->OwnerRunning = snapshot->Streams[r].Running && snapshot->Streams[r].Pages == capture->Pages;
+        }
+    }
+
+    return static_cast<LoopbackSnapshot*>(
+        InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&Engine->Snapshot), snapshot));
+}
+
+// Free a replaced snapshot once the tick can no longer be reading it. Without
+// StreamLock, so other writers don't wait on the tick too.
+static void RetireSnapshot(LoopbackEngine* Engine, LoopbackSnapshot* Retired)
+{
+    if (!Retired) return;
+    WaitForTick(Engine);
+    ExFreePoolWithTag(Retired, LOOPBACK_SNAPSHOT_TAG);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// NOTIFICATION SCHEDULER
+// Each running stream with notifications has a next boundary frame; its clock gives
+// the exact QPC at which that frame begins. One high-resolution timer is armed for the
+// earliest boundary across the engine's streams, paired or not, and its callback
+// signals whatever is due and re-arms. Everything here runs under StreamLock: the
+// callback runs once per notification period rather than every millisecond, and the
+// lock keeps the streams it walks registered while it does, and their events too,
+// since a stream's events are only ever added or removed under it.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Also called from the tick without StreamLock; a removed event stays referenced until
+// any tick that may still hold it is done (LoopbackStreamRemoveEvent).
+static void SetStreamEvents(LoopbackStream* Stream)
+{
+    for (int i = 0; i < LEYLINE_MAX_NOTIFICATION_EVENTS; i++)
+    {
+        PKEVENT event = static_cast<PKEVENT>(
+            ReadPointerAcquire(reinterpret_cast<PVOID const volatile*>(&Stream->NotificationEvents[i])));
+        if (event)
+        {
+            KeSetEvent(event, 0, FALSE);
+        }
+    }
+}
+
+// Signal the list's streams whose boundary has passed and lower Due to the earliest
+// boundary still ahead.
+static void NotifyStreams(PLIST_ENTRY Head, LONGLONG Now, LONGLONG* Due)
+{
+    for (PLIST_ENTRY entry = Head->Flink; entry != Head; entry = entry->Flink)
+    {
+        LoopbackStream* stream = CONTAINING_RECORD(entry, LoopbackStream, ListEntry);
+        if (stream->NotifyFrames == 0 || !StreamIsActive(stream)) continue;
+
+        ULONGLONG frame = StreamReportedFrame(stream, Now);
+        if (frame >= stream->NotifyNext)
+        {
+            SetStreamEvents(stream);
+
+            // One signal however many boundaries a late wakeup covered, as the tick did.
+            stream->NotifyNext += stream->NotifyFrames;
+            if (stream->NotifyNext <= frame)
+                stream->NotifyNext = frame - frame % stream->NotifyFrames + stream->NotifyFrames;
+        }
+        *Due = min(*Due, StreamFrameTime(stream, stream->NotifyNext + stream->SafetyFrames));
+    }
+}
+
+// Caller holds StreamLock.
+static void ScheduleNotifications(LoopbackEngine* Engine, LONGLONG Now)
+{
+    if (!Engine->NotifyTimer || !Engine->NotifyEnabled) return;
+
+    LONGLONG due = MAXLONGLONG;
+    NotifyStreams(&Engine->RenderStreams, Now, &due);
+    NotifyStreams(&Engine->CaptureStreams, Now, &due);
+
+    // Nothing pending: an armed timer just finds nothing to do. Armed early enough
+    // already: its callback reschedules.
+    if (due == MAXLONGLONG || (Engine->NotifyDue != 0 && Engine->NotifyDue <= due)) return;
+
+    // Relative, in 100 ns units, rounded up so the timer never fires before the frame.
+    LARGE_INTEGER frequency;
+    KeQueryPerformanceCounter(&frequency);
+    LONGLONG relative = ((due - Now) * 10000000LL + frequency.QuadPart - 1) / frequency.QuadPart;
+    ExSetTimer(Engine->NotifyTimer, -max(relative, (LONGLONG)1), 0, nullptr);
+    Engine->NotifyDue = due;
+}
+
+extern "C" void LoopbackNotifyRoutine(PEX_TIMER /*Timer*/, PVOID Context)
+{
+    LoopbackEngine* engine = reinterpret_cast<LoopbackEngine*>(Context);
+    if (!engine) return;
+
+    ULONGLONG probe = ProbeStart();
+    KeAcquireSpinLockAtDpcLevel(&engine->StreamLock);
+    probe = ProbeLap(engine, LEYLINE_PROBE_LOCK_WAIT, probe);
+    engine->NotifyDue = 0;
+    ScheduleNotifications(engine, KeQueryPerformanceCounter(nullptr).QuadPart);
+    ProbeLap(engine, LEYLINE_PROBE_SIGNAL, probe);
+    KeReleaseSpinLockFromDpcLevel(&engine->StreamLock);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// RATE CONVERSION
+// The bus runs at the master's rate. A render stream at another rate is resampled on
+// its way in and a capture stream at another rate on its way out; each keeps its own
+// filter history. Tables are shared per rate pair and only ever built at PASSIVE_LEVEL.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// In the engine's tables under StreamLock, or in the tick's snapshot.
+static const LeylineResampleTable* FindResampleTable(const LeylineResampleTable* const* Tables, ULONG Count,
+                                                     ULONG InRate, ULONG OutRate, LeylineResampleQuality Quality)
+{
+    for (ULONG i = 0; i < Count; i++)
+    {
+        const LeylineResampleTable* table = Tables[i];
+        if (table->InRate == InRate && table->OutRate == OutRate && table->Quality == Quality) return table;
+    }
+    return nullptr;
+}
+
+static void EnsureResampleTable(LoopbackEngine* Engine, ULONG InRate, ULONG OutRate, LeylineResampleQuality Quality)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    BOOLEAN present = FindResampleTable(Engine->ResampleTables, Engine->ResampleTableCount, InRate, OutRate, Quality) != nullptr;
+    BOOLEAN full    = Engine->ResampleTableCount >= LOOPBACK_MAX_RESAMPLE_TABLES;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    if (present) return;
+    if (full)
+    {
+        DbgPrint("Leyline: No room for a %u -> %u Hz resampler table\n", InRate, OutRate);
+        return;
+    }
+
+    LeylineResampleTable* table = nullptr;
+    NTSTATUS status = LeylineResampleTableCreate(InRate, OutRate, Quality, &table);
+    if (!NT_SUCCESS(status))
+    {
+        DbgPrint("Leyline: Resampler table %u -> %u Hz failed: 0x%08X\n", InRate, OutRate, status);
+        return;
+    }
+
+    LoopbackSnapshot* retired = nullptr;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    if (!FindResampleTable(Engine->ResampleTables, Engine->ResampleTableCount, InRate, OutRate, Quality) &&
+        Engine->ResampleTableCount < LOOPBACK_MAX_RESAMPLE_TABLES)
+    {
+        Engine->ResampleTables[Engine->ResampleTableCount++] = table;
+        table   = nullptr;
+        retired = PublishSnapshot(Engine);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    RetireSnapshot(Engine, retired);
+
+    // Another thread published the same pair first, or the cache filled up meanwhile.
+    LeylineResampleTableFree(table);
+}
+
+static void AddRate(ULONG* Rates, ULONG* Count, ULONG Rate)
+{
+    for (ULONG i = 0; i < *Count; i++)
+    {
+        if (Rates[i] == Rate) return;
+    }
+    if (*Count < LOOPBACK_MAX_RESAMPLE_TABLES) Rates[(*Count)++] = Rate;
+}
+
+// Any render rate can become the bus rate, so every other render rate needs a table
+// into it and every capture rate a table out of it. Joining may be null.
+static void PrepareResampleTables(LoopbackEngine* Engine, const LoopbackStream* Joining)
+{
+    ULONG renderRates[LOOPBACK_MAX_RESAMPLE_TABLES];
+    ULONG captureRates[LOOPBACK_MAX_RESAMPLE_TABLES];
+    ULONG renderCount  = 0;
+    ULONG captureCount = 0;
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LeylineResampleQuality quality = Engine->ResampleQuality;
+
+    if (Joining)
+        AddRate(Joining->IsCapture ? captureRates : renderRates,
+                Joining->IsCapture ? &captureCount : &renderCount, StreamSampleRate(Joining));
+
+    for (PLIST_ENTRY entry = Engine->RenderStreams.Flink; entry != &Engine->RenderStreams; entry = entry->Flink)
+        AddRate(renderRates, &renderCount, StreamSampleRate(CONTAINING_RECORD(entry, LoopbackStream, ListEntry)));
+    for (PLIST_ENTRY entry = Engine->CaptureStreams.Flink; entry != &Engine->CaptureStreams; entry = entry->Flink)
+        AddRate(captureRates, &captureCount, StreamSampleRate(CONTAINING_RECORD(entry, LoopbackStream, ListEntry)));
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    for (ULONG b = 0; b < renderCount; b++)
+    {
+        ULONG busRate = renderRates[b];
+        for (ULONG r = 0; r < renderCount; r++)
+        {
+            if (renderRates[r] != busRate) EnsureResampleTable(Engine, renderRates[r], busRate, quality);
+        }
+        for (ULONG c = 0; c < captureCount; c++)
+        {
+            if (captureRates[c] != busRate) EnsureResampleTable(Engine, busRate, captureRates[c], quality);
+        }
+    }
+}
+
+// Restart a converted render stream so the input this tick needs ends at its clock. A
+// stream younger than that window is padded with silence rather than read ahead.
+static void ResyncResampledRender(const LoopbackTickStream* Tick, const LeylineResampleTable* Table,
+                                  ULONGLONG CurrentFrame, ULONG BusFrames)
+{
+    LoopbackStream* Stream = Tick->Stream;
+    LeylineResamplerReset(&Stream->Resampler, Table, min(Tick->Channels, (ULONG)LEYLINE_MAX_CHANNELS));
+    ULONG need = LeylineResamplerInputNeeded(&Stream->Resampler, BusFrames);
+    if (CurrentFrame < need)
+        LeylineResamplerPush(&Stream->Resampler, nullptr, 0, need - (ULONG)CurrentFrame);
+
+    Stream->Cursor = (CurrentFrame > need) ? CurrentFrame - need : 0;
+}
+
+// Add Count bus-rate frames of a converted render stream, reading its ring on demand.
+static void ResampleIntoBus(LoopbackEngine* Engine, const LoopbackTickStream* Src, ULONG BusChannels,
+                            ULONG Count, LeylineSimdLevel Level)
+{
+    LeylineResampler* resampler = &Src->Stream->Resampler;
+    ULONG channels = resampler->Channels;
+    ULONG produced = 0;
+
+    for (;;)
+    {
+        produced += LeylineResamplerPull(resampler, Engine->MixBus + (SIZE_T)produced * BusChannels, BusChannels,
+                                         Count - produced, TRUE, Level);
+        if (produced >= Count) break;
+
+        ULONG feed = min(LeylineResamplerInputNeeded(resampler, Count - produced), (ULONG)LEYLINE_MIX_BLOCK_FRAMES);
+        RtlZeroMemory(Engine->ResampleScratch, (SIZE_T)feed * channels * sizeof(float));
+        AccumulateFrames(Engine->ResampleScratch, channels, Src, Src->Stream->Cursor, feed, Level);
+
+        feed = LeylineResamplerPush(resampler, Engine->ResampleScratch, channels, feed);
+        if (feed == 0) break;
+        Src->Stream->Cursor += feed;
+    }
+}
+
+// Convert Count frames of the bus to a capture stream's rate and write what comes out.
+static void ResampleFromBus(LoopbackEngine* Engine, const LoopbackTickStream* Dst, const float* Bus, ULONG BusChannels,
+                            ULONG Count, float Gain, LeylineSimdLevel Level)
+{
+    LeylineResampler* resampler = &Dst->Stream->Resampler;
+
+    for (ULONG pushed = 0; pushed < Count; )
+    {
+        ULONG accepted = LeylineResamplerPush(resampler, Bus + (SIZE_T)pushed * BusChannels, BusChannels, Count - pushed);
+        if (accepted == 0) break;
+        pushed += accepted;
+
+        ULONG produced;
+        while ((produced = LeylineResamplerPull(resampler, Engine->ResampleScratch, resampler->Channels,
+                                                LEYLINE_MIX_BLOCK_FRAMES, FALSE, Level)) > 0)
+        {
+            WriteFrames(Dst, Dst->Stream->Cursor, Engine->ResampleScratch, resampler->Channels, produced, Gain, Level);
+            Dst->Stream->Cursor += produced;
+        }
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK TIMER
+// Armed when a render and a capture stream are both running and stopped as soon as
+// either side has none, whether the last one left or only paused, so an idle cable
+// takes no wakeups at all. It ticks at the shortest period a running stream asked for
+// and is retuned whenever one starts, pauses or leaves; the first tick after a retune
+// keeps the old cadence's phase, so none comes later than the longer of the two. The
+// capture read-behind floor covers a tick that comes up to the floor less one base
+// period late, so the millisecond timer may be coalesced by that much, at most a
+// period. The floor sets it rather than the adaptive estimate, which would grow with
+// the lateness the tolerance itself allows. Arming is under StreamLock. Stopping and
+// retuning need the tick out of the way too, and it may be on the worker thread, which
+// the notification callback can interrupt to spin on StreamLock: so they cancel under
+// the lock and wait for the tick without it, TimerGate keeping any other change out
+// until they are done.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static BOOLEAN ListHasRunningStream(const LIST_ENTRY* Head)
+{
+    for (const LIST_ENTRY* entry = Head->Flink; entry != Head; entry = entry->Flink)
+        if (CONTAINING_RECORD(entry, LoopbackStream, ListEntry)->State == KSSTATE_RUN) return TRUE;
+    return FALSE;
+}
+
+static BOOLEAN EngineNeedsTimer(const LoopbackEngine* Engine)
+{
+    return ListHasRunningStream(&Engine->RenderStreams) && ListHasRunningStream(&Engine->CaptureStreams);
+}
+
+// Down to what the timers can do: whole milliseconds, or high-resolution steps below.
+static ULONG RoundPeriod(const LoopbackEngine* Engine, ULONG PeriodUs)
+{
+    if (PeriodUs >= LOOPBACK_PERIOD_US || !Engine->FastTimer)
+        return max(PeriodUs / LOOPBACK_PERIOD_US * LOOPBACK_PERIOD_US, LOOPBACK_PERIOD_US);
+    return max(PeriodUs / LOOPBACK_FAST_STEP_US * LOOPBACK_FAST_STEP_US, (ULONG)LOOPBACK_FAST_STEP_US);
+}
+
+// What a stream asks for: an eighth of its buffer, or half its notification interval if
+// that is shorter, within the engine's range. A capture on a render stream's pages is
+// only LOOPBACK_ALIAS_LAG_MS behind the frames a tick rewrites, so asks for half that.
+static ULONG StreamPeriodUs(const LoopbackEngine* Engine, const LoopbackStream* Stream)
+{
+    ULONG want = Engine->MaxPeriodUs;
+    if (Stream->FrameRate)
+        want = (ULONG)min((ULONGLONG)StreamBufferFrames(Stream) * 1000000 / ((ULONGLONG)Stream->FrameRate * LOOPBACK_BUFFER_TICKS),
+                          (ULONGLONG)want);
+    if (Stream->NotificationBytes && Stream->ByteRate)
+        want = (ULONG)min((ULONGLONG)Stream->NotificationBytes * 1000000 / Stream->ByteRate / 2, (ULONGLONG)want);
+    if (Stream->IsCapture && Stream->Pages && Stream->Pages->RefCount > 1)
+        want = min(want, (ULONG)(LOOPBACK_ALIAS_LAG_MS * 1000 / 2));
+    return RoundPeriod(Engine, min(max(want, Engine->MinPeriodUs), Engine->MaxPeriodUs));
+}
+
+// The shortest period a running stream asked for, and no longer than the range allows.
+static ULONG EnginePeriodUs(const LoopbackEngine* Engine)
+{
+    ULONG period = Engine->MaxPeriodUs;
+    const LIST_ENTRY* heads[] = { &Engine->RenderStreams, &Engine->CaptureStreams };
+    for (const LIST_ENTRY* head : heads)
+    {
+        for (const LIST_ENTRY* entry = head->Flink; entry != head; entry = entry->Flink)
+        {
+            const LoopbackStream* stream = CONTAINING_RECORD(entry, LoopbackStream, ListEntry);
+            if (stream->State == KSSTATE_RUN) period = min(period, stream->PeriodUs);
+        }
+    }
+    return RoundPeriod(Engine, period);
+}
+
+static ULONG TimerToleranceMs(const LoopbackEngine* Engine)
+{
+    if (Engine->TickFast || Engine->SafetyFloorUs <= LOOPBACK_PERIOD_US) return 0;
+    return min((Engine->SafetyFloorUs - LOOPBACK_PERIOD_US) / 1000, Engine->TickPeriodUs / 1000);
+}
+
+// The timer section of the telemetry page. By the tick, or by a writer while the timer
+// is stopped.
+static void PublishTimer(LoopbackEngine* Engine)
+{
+    LeylineTelemetryPage* page = Engine->Telemetry;
+    if (!page) return;
+
+    LeylineTelemetryTimer* timer = &page->Timer;
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&timer->Sequence));
+    timer->Running     = Engine->TimerRunning;
+    timer->ToleranceMs = Engine->TimerToleranceMs;
+    timer->PeriodUs    = Engine->TickPeriodUs;
+    timer->Wakeups     = Engine->TimerWakeups;
+    timer->IdleWakeups = Engine->IdleWakeups;
+    timer->Arms        = Engine->TimerArms;
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&timer->Sequence));
+}
+
+// Only while the timer is stopped: the tick measures its lateness against the period.
+static void SetTickPeriod(LoopbackEngine* Engine, ULONG PeriodUs)
+{
+    Engine->TickPeriodUs     = PeriodUs;
+    Engine->TickPeriodQpc    = Engine->QpcFrequency * PeriodUs / 1000000;
+    Engine->TickFast         = PeriodUs < LOOPBACK_PERIOD_US;
+    Engine->TimerToleranceMs = TimerToleranceMs(Engine);
+    Engine->LastTickQpc      = 0;
+}
+
+// First tick DueUs from now, then every period.
+static void SetLoopbackTimer(LoopbackEngine* Engine, ULONG DueUs)
+{
+    LONGLONG due    = -(LONGLONG)DueUs * 10;                    // Relative, 100 ns units
+    LONGLONG period = (LONGLONG)Engine->TickPeriodUs * 10;
+    if (Engine->TickFast)
+    {
+        ExSetTimer(Engine->FastTimer, due, period, nullptr);
+        return;
+    }
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = due;
+    KeSetCoalescableTimer(&Engine->LoopbackTimer, dueTime, Engine->TickPeriodUs / 1000, Engine->TimerToleranceMs,
+                          &Engine->LoopbackDpc);
+}
+
+static void CancelLoopbackTimer(LoopbackEngine* Engine)
+{
+    if (Engine->TickFast)
+        ExCancelTimer(Engine->FastTimer, nullptr);
+    else
+        KeCancelTimer(&Engine->LoopbackTimer);
+}
+
+// No tick is in flight, so the cursors are still the writers' to set.
+static void ArmTimer(LoopbackEngine* Engine)
+{
+    ResyncRenderCursors(Engine, KeQueryPerformanceCounter(nullptr).QuadPart);
+    SetTickPeriod(Engine, EnginePeriodUs(Engine));
+    Engine->TimerArms++;
+    Engine->TimerRunning = TRUE;
+    PublishTimer(Engine);
+    SetLoopbackTimer(Engine, Engine->TickPeriodUs);
+}
+
+// What a writer still owes the timer once it drops StreamLock; see FinishTimerChange.
+enum LoopbackTimerChange
+{
+    LoopbackTimerSettled,       // Nothing left to do
+    LoopbackTimerStopping,      // Stops once no tick is in flight
+    LoopbackTimerRetuning,      // Re-arms at the running streams' period once none is
+};
+
+// A tick that starts from here on mixes nothing; the mix state is the writer's once
+// FinishTimerChange returns.
+static LoopbackTimerChange DisarmTimer(LoopbackEngine* Engine)
+{
+    CancelLoopbackTimer(Engine);
+    Engine->TimerChanging = TRUE;
+    return LoopbackTimerStopping;
+}
+
+// Move a running timer to the period the running streams ask for now.
+static LoopbackTimerChange RetuneTimer(LoopbackEngine* Engine)
+{
+    if (!Engine->TimerRunning || EnginePeriodUs(Engine) == Engine->TickPeriodUs) return LoopbackTimerSettled;
+
+    CancelLoopbackTimer(Engine);
+    Engine->TimerChanging = TRUE;
+    return LoopbackTimerRetuning;
+}
+
+// The render cursors stay where the last tick left them, so the next tick mixes
+// everything since.
+static void RearmTimer(LoopbackEngine* Engine)
+{
+    ULONG    period = EnginePeriodUs(Engine);
+    ULONG    due    = period;
+    LONGLONG last   = Engine->LastTickQpc;
+    if (last != 0 && Engine->QpcFrequency > 0)
+    {
+        LONGLONG since = (KeQueryPerformanceCounter(nullptr).QuadPart - last) * 1000000 / Engine->QpcFrequency;
+        due = (ULONG)min(max((LONGLONG)period - since, (LONGLONG)LOOPBACK_FAST_STEP_US), (LONGLONG)period);
+    }
+    SetTickPeriod(Engine, period);
+    PublishTimer(Engine);
+    SetLoopbackTimer(Engine, due);
+}
+
+static void QuietMeter(LoopbackEngine* Engine);     // METERING
+
+// Complete a change once no tick is in flight. Caller holds TimerGate and not
+// StreamLock.
+static void FinishTimerChange(LoopbackEngine* Engine, LoopbackTimerChange Change)
+{
+    if (Change == LoopbackTimerSettled) return;
+    WaitForTick(Engine);
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->TimerChanging = FALSE;
+    if (Change == LoopbackTimerRetuning)
+        RearmTimer(Engine);
+    else
+    {
+        Engine->TimerRunning = FALSE;
+        Engine->TickCost     = 0;
+        QuietMeter(Engine);
+        PublishTimer(Engine);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+}
+
+void LoopbackEngineSetTickRange(LoopbackEngine* Engine, ULONG MinPeriodUs, ULONG MaxPeriodUs)
+{
+    ULONG maxUs = max(MaxPeriodUs, (ULONG)LOOPBACK_FAST_STEP_US);
+    if (maxUs >= LOOPBACK_PERIOD_US) maxUs = maxUs / LOOPBACK_PERIOD_US * LOOPBACK_PERIOD_US;
+
+    ExAcquireFastMutex(&Engine->TimerGate);
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->MaxPeriodUs = maxUs;
+    Engine->MinPeriodUs = min(max(MinPeriodUs, (ULONG)LOOPBACK_FAST_STEP_US), maxUs);
+    LoopbackTimerChange change = RetuneTimer(Engine);
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    FinishTimerChange(Engine, change);
+    ExReleaseFastMutex(&Engine->TimerGate);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ENGINE LIFECYCLE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LoopbackEngineInit(LoopbackEngine* Engine)
+{
+    KeInitializeSpinLock(&Engine->StreamLock);
+    InitializeListHead(&Engine->RenderStreams);
+    InitializeListHead(&Engine->CaptureStreams);
+    ExInitializeFastMutex(&Engine->TimerGate);
+    Engine->TimerRunning  = FALSE;
+    Engine->TimerChanging = FALSE;
+    Engine->GlitchCount  = 0;
+    Engine->LostFrames   = 0;
+    Engine->CableId      = 0;
+    Engine->NotifyDue     = 0;
+    Engine->NotifyEnabled = TRUE;
+    Engine->NotifyTimer   = ExAllocateTimer(LoopbackNotifyRoutine, Engine, EX_TIMER_HIGH_RESOLUTION);
+    if (!Engine->NotifyTimer) DbgPrint("Leyline: No notification timer; events follow the loopback tick\n");
+    Engine->FastTimer     = ExAllocateTimer(LoopbackFastTimerRoutine, Engine, EX_TIMER_HIGH_RESOLUTION);
+    if (!Engine->FastTimer) DbgPrint("Leyline: No high-resolution tick; periods stay whole milliseconds\n");
+    Engine->TickFast      = FALSE;
+    Engine->MinPeriodUs   = LOOPBACK_PERIOD_US;
+    Engine->MaxPeriodUs   = LOOPBACK_PERIOD_US;
+    Engine->Snapshot           = nullptr;
+    Engine->TickSequence       = 0;
+    Engine->ResampleQuality    = LeylineResampleMedium;
+    Engine->ResampleTableCount = 0;
+    Engine->TableGeneration    = 0;
+    Engine->TableGenerationSeen = 0;
+    Engine->GainTarget         = 1.0f;
+    Engine->GainFrom           = 1.0f;
+    Engine->GainCurrent        = 1.0f;
+    Engine->GainRampTarget     = 1.0f;
+    Engine->MeterLevels        = TRUE;
+    Engine->MeterLoudness      = FALSE;
+    Engine->Telemetry          = nullptr;
+    Engine->SharedParams       = nullptr;
+    Engine->PublishPending     = 0;
+    Engine->VolumeLevel        = 0;
+    Engine->Mute               = FALSE;
+    Engine->PositionPage       = nullptr;
+    Engine->PositionSlots      = 0;
+    Engine->PositionLock       = 0;
+    Engine->PositionNextId     = 0;
+    Engine->Processor          = LEYLINE_PROCESSOR_AUTO;
+    Engine->TickCost           = 0;
+    Engine->TimerToleranceMs   = 0;
+    Engine->TimerArms          = 0;
+    Engine->TimerWakeups       = 0;
+    Engine->IdleWakeups        = 0;
+    Engine->WorkerThread       = nullptr;
+    Engine->WorkerStop         = 0;
+    Engine->DpcSequence        = 0;
+    Engine->RequestSequence    = 0;
+    Engine->RequestTaken       = 0;
+    Engine->WorkerProcessor    = LEYLINE_PROCESSOR_AUTO;
+    Engine->Requests[0]        = 0;
+    Engine->Requests[1]        = 0;
+    Engine->WorkerLatency      = 0;
+    Engine->WorkerBatches      = 0;
+    Engine->CoalescedTicks     = 0;
+    KeInitializeEvent(&Engine->WorkerWake, SynchronizationEvent, FALSE);
+    Engine->SafetyFloorUs      = 0;
+    Engine->SafetyAdaptive     = FALSE;
+    Engine->SafetyEstimateUs   = 0;
+    Engine->LatenessP50Us      = 0;
+    Engine->LatenessP99Us      = 0;
+    Engine->LatenessMaxUs      = 0;
+    Engine->LastTickQpc        = 0;
+    Engine->LatenessMaxQpc     = 0;
+    Engine->LatenessTicks      = 0;
+    RtlZeroMemory(Engine->LatenessCounts, sizeof(Engine->LatenessCounts));
+
+    LARGE_INTEGER frequency;
+    KeQueryPerformanceCounter(&frequency);
+    Engine->QpcFrequency = frequency.QuadPart;
+#if LEYLINE_PROBES
+    RtlZeroMemory(Engine->ProbeCounts, sizeof(Engine->ProbeCounts));
+    Engine->ProbeCycleBase = ReadTimeStampCounter();
+    Engine->ProbeQpcBase   = KeQueryPerformanceCounter(nullptr).QuadPart;
+#endif
+    SetTickPeriod(Engine, LOOPBACK_PERIOD_US);
+    LeylineMeterReset(&Engine->Meter, 0, 0, FALSE);
+    RtlZeroMemory(Engine->ResampleTables, sizeof(Engine->ResampleTables));
+    KeInitializeTimer(&Engine->LoopbackTimer);
+    KeInitializeDpc(&Engine->LoopbackDpc, LoopbackDpcRoutine, Engine);
+}
+
+void LoopbackEngineStop(LoopbackEngine* Engine)
+{
+    ExAcquireFastMutex(&Engine->TimerGate);
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LoopbackTimerChange change = Engine->TimerRunning ? DisarmTimer(Engine) : LoopbackTimerSettled;
+    // A notification callback already running finds the scheduler disabled.
+    if (Engine->NotifyTimer) ExCancelTimer(Engine->NotifyTimer, nullptr);
+    Engine->NotifyDue     = 0;
+    Engine->NotifyEnabled = FALSE;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    FinishTimerChange(Engine, change);
+    KeRemoveQueueDpc(&Engine->LoopbackDpc);
+    ExReleaseFastMutex(&Engine->TimerGate);
+}
+
+void LoopbackEngineResume(LoopbackEngine* Engine)
+{
+    ExAcquireFastMutex(&Engine->TimerGate);
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    if (!Engine->TimerRunning && EngineNeedsTimer(Engine)) ArmTimer(Engine);
+    Engine->NotifyEnabled = TRUE;
+    ScheduleNotifications(Engine, KeQueryPerformanceCounter(nullptr).QuadPart);
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    ExReleaseFastMutex(&Engine->TimerGate);
+}
+
+void LoopbackEngineCleanup(LoopbackEngine* Engine)
+{
+    // The timer is stopped, so the worker is waiting, or about to, for nothing more.
+    if (Engine->WorkerThread)
+    {
+        InterlockedExchange(&Engine->WorkerStop, 1);
+        KeSetEvent(&Engine->WorkerWake, IO_NO_INCREMENT, FALSE);
+        ZwWaitForSingleObject(Engine->WorkerThread, FALSE, nullptr);
+        ZwClose(Engine->WorkerThread);
+        Engine->WorkerThread = nullptr;
+    }
+
+    // Waits for a callback in flight.
+    if (Engine->NotifyTimer)
+    {
+        ExDeleteTimer(Engine->NotifyTimer, TRUE, TRUE, nullptr);
+        Engine->NotifyTimer = nullptr;
+    }
+    if (Engine->FastTimer)
+    {
+        ExDeleteTimer(Engine->FastTimer, TRUE, TRUE, nullptr);
+        Engine->FastTimer = nullptr;
+    }
+
+    for (ULONG i = 0; i < Engine->ResampleTableCount; i++)
+    {
+        LeylineResampleTableFree(Engine->ResampleTables[i]);
+        Engine->ResampleTables[i] = nullptr;
+    }
+    Engine->ResampleTableCount = 0;
+
+    LoopbackSnapshot* snapshot = static_cast<LoopbackSnapshot*>(
+        InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&Engine->Snapshot), nullptr));
+    RetireSnapshot(Engine, snapshot);
+}
+
+NTSTATUS LoopbackEngineStartWorker(LoopbackEngine* Engine)
+{
+    if (Engine->WorkerThread) return STATUS_SUCCESS;
+
+    // A kernel handle: cables are spawned in whichever process sent the request.
+    OBJECT_ATTRIBUTES attributes;
+    InitializeObjectAttributes(&attributes, nullptr, OBJ_KERNEL_HANDLE, nullptr, nullptr);
+    HANDLE   thread = nullptr;
+    NTSTATUS status = PsCreateSystemThread(&thread, THREAD_ALL_ACCESS, &attributes, nullptr, nullptr,
+                                           LoopbackWorkerRoutine, Engine);
+    if (!NT_SUCCESS(status))
+    {
+        DbgPrint("Leyline: No worker thread (0x%08X); the tick mixes in the DPC\n", status);
+        return status;
+    }
+    Engine->WorkerThread = thread;
+    return STATUS_SUCCESS;
+}
+
+extern "C" void LoopbackWorkerRoutine(PVOID StartContext)
+{
+    LoopbackEngine* engine = static_cast<LoopbackEngine*>(StartContext);
+    KeSetPriorityThread(KeGetCurrentThread(), LOOPBACK_WORKER_PRIORITY);
+
+    for (;;)
+    {
+        KeWaitForSingleObject(&engine->WorkerWake, Executive, KernelMode, FALSE, nullptr);
+        if (ReadAcquire(&engine->WorkerStop)) break;
+        LoopbackEngineWork(engine);
+    }
+    PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+void LoopbackEngineSetResampleQuality(LoopbackEngine* Engine, LeylineResampleQuality Quality)
+{
+    if ((ULONG)Quality >= LeylineResampleQualityCount) return;
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->ResampleQuality = Quality;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    PrepareResampleTables(Engine, nullptr);
+
+    // Retire the other tiers. The new generation tells the tick to start every
+    // converter over, so none of them touches a retired table once it is freed.
+    LeylineResampleTable* retired[LOOPBACK_MAX_RESAMPLE_TABLES];
+    ULONG retiredCount = 0;
+    LoopbackSnapshot* retiredSnapshot = nullptr;
+
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    for (ULONG i = 0; i < Engine->ResampleTableCount; )
+    {
+        LeylineResampleTable* table = Engine->ResampleTables[i];
+        if (table->Quality == Engine->ResampleQuality)
+        {
+            i++;
+            continue;
+        }
+
+        retired[retiredCount++] = table;
+        Engine->ResampleTables[i] = Engine->ResampleTables[--Engine->ResampleTableCount];
+        Engine->ResampleTables[Engine->ResampleTableCount] = nullptr;
+    }
+    if (retiredCount > 0)
+    {
+        Engine->TableGeneration++;
+        retiredSnapshot = PublishSnapshot(Engine);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    // The wait covers the tables too: the tick only finds them through the snapshot.
+    RetireSnapshot(Engine, retiredSnapshot);
+    for (ULONG i = 0; i < retiredCount; i++) LeylineResampleTableFree(retired[i]);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MASTER GAIN
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline ULONG FloatBits(float Value)
+{
+    ULONG bits;
+    RtlCopyMemory(&bits, &Value, sizeof(bits));
+    return bits;
+}
+
+// Under StreamLock, so there is one writer; the tick never touches the gain line.
+static void PublishGain(LoopbackEngine* Engine)
+{
+    LeylineTelemetryPage* page = Engine->Telemetry;
+    if (!page) return;
+
+    // Odd while writing; the interlocked increments order the stores for readers.
+    LeylineTelemetryGain* gain = &page->Gain;
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&gain->Sequence));
+    gain->GainBits    = FloatBits(Engine->GainTarget);
+    gain->VolumeLevel = Engine->VolumeLevel;
+    gain->Mute        = Engine->Mute ? 1 : 0;
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&gain->Sequence));
+}
+
+void LoopbackEngineSetMasterGain(LoopbackEngine* Engine, LONG VolumeLevel, BOOLEAN Mute)
+{
+    float target = Mute ? 0.0f : LeylineGainFromVolume(VolumeLevel);
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->GainTarget  = target;
+    Engine->VolumeLevel = VolumeLevel;
+    Engine->Mute        = Mute;
+    PublishGain(Engine);
+
+    // The tick ramps from wherever the gain is now; with nothing playing, just jump.
+    if (!Engine->TimerRunning)
+    {
+        Engine->GainFrom       = target;
+        Engine->GainCurrent    = target;
+        Engine->GainRampTarget = target;
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METERING
+// Levels are measured on the bus inside the tick and settle every 100 ms. Called by
+// the tick, or by a writer under StreamLock while the timer is stopped.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void PublishLevels(LoopbackEngine* Engine)
+{
+    const LeylineMeterLevels* levels = &Engine->Meter.Levels;
+    ULONG right = (Engine->Meter.Channels > 1) ? 1 : 0;
+
+    // Odd while writing; the interlocked increments order the stores for readers.
+    LeylineTelemetryPage* page = Engine->Telemetry;
+    if (page)
+    {
+        LeylineTelemetryMeter* meter = &page->Meter;
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&meter->Sequence));
+        meter->Channels     = Engine->Meter.Channels;
+        meter->PeakBits[0]  = FloatBits(levels->Peak[0]);
+        meter->PeakBits[1]  = FloatBits(levels->Peak[right]);
+        meter->RmsBits[0]   = FloatBits(levels->Rms[0]);
+        meter->RmsBits[1]   = FloatBits(levels->Rms[right]);
+        meter->LoudnessBits = FloatBits(levels->Loudness);
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&meter->Sequence));
+    }
+
+    LeylineSharedParameters* params = Engine->SharedParams;
+    if (params)
+    {
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&params->MeterSequence));
+        params->PeakLBits    = FloatBits(levels->Peak[0]);
+        params->PeakRBits    = FloatBits(levels->Peak[right]);
+        params->RmsLBits     = FloatBits(levels->Rms[0]);
+        params->RmsRBits     = FloatBits(levels->Rms[right]);
+        params->LoudnessBits = FloatBits(levels->Loudness);
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&params->MeterSequence));
+    }
+}
+
+// Nothing is playing through the loopback any more: drop to silence once.
+static void QuietMeter(LoopbackEngine* Engine)
+{
+    if (Engine->Meter.SampleRate == 0) return;
+    LeylineMeterReset(&Engine->Meter, 0, 0, FALSE);
+    PublishLevels(Engine);
+}
+
+void LoopbackEngineSetMetering(LoopbackEngine* Engine, BOOLEAN Levels, BOOLEAN Loudness)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->MeterLevels   = Levels;
+    Engine->MeterLoudness = Loudness;
+    if (!Levels && !Engine->TimerRunning) QuietMeter(Engine);     // Otherwise the tick does
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+}
+
+void LoopbackEngineSetTelemetry(LoopbackEngine* Engine, LeylineTelemetryPage* Page)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LeylineTelemetryPage* previous = Engine->Telemetry;
+    Engine->Telemetry = Page;
+    PublishGain(Engine);
+    if (Engine->TimerRunning)
+        InterlockedExchange(&Engine->PublishPending, 1);
+    else if (Page)
+    {
+        PublishLevels(Engine);
+        PublishTimer(Engine);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    // The caller unmaps the old page next; outlast a tick that may still write to it.
+    if (previous && previous != Page) WaitForTick(Engine);
+}
+
+void LoopbackEngineSetSharedParameters(LoopbackEngine* Engine, LeylineSharedParameters* Params)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LeylineSharedParameters* previous = Engine->SharedParams;
+    Engine->SharedParams = Params;
+    if (Engine->TimerRunning)
+        InterlockedExchange(&Engine->PublishPending, 1);
+    else if (Params)
+        PublishLevels(Engine);
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    // The caller unmaps the old page next; outlast a tick that may still write to it.
+    if (previous && previous != Params) WaitForTick(Engine);
+}
+
+float LoopbackEngineTakePeak(LoopbackEngine* Engine, ULONG Channel)
+{
+    return LeylineMeterTakePeak(&Engine->Meter, Channel);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POSITION RECORDS
+// Each registered stream owns a record in the position page. Writers rewrite the whole
+// record under StreamLock; the tick only moves Position and Qpc of a running one.
+// PositionLock keeps the two apart: a writer waits out the tick's few stores, and the
+// tick skips its refresh rather than wait for a writer. Writers spin for it at
+// DISPATCH_LEVEL under StreamLock, so it is only ever held at DISPATCH_LEVEL: the
+// worker raises to it for its refresh, which can then never be preempted with the
+// lock held, or a record's sequence left odd. The lock is the engine's, not the
+// page's, since user mode can write to the page; the sequence in each record is only
+// ever incremented, never waited on.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline BOOLEAN TryLockPositions(LoopbackEngine* Engine)
+{
+    return InterlockedCompareExchange(&Engine->PositionLock, 1, 0) == 0;
+}
+
+static inline void LockPositions(LoopbackEngine* Engine)
+{
+    while (!TryLockPositions(Engine)) YieldProcessor();
+}
+
+static inline void UnlockPositions(LoopbackEngine* Engine)
+{
+    InterlockedExchange(&Engine->PositionLock, 0);
+}
+
+// Odd while writing; the interlocked increments order the stores for readers.
+static inline void BeginRecord(LeylinePositionRecord* Record)
+{
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&Record->Sequence));
+}
+
+static inline void EndRecord(LeylinePositionRecord* Record)
+{
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&Record->Sequence));
+}
+
+static LeylinePositionRecord* StreamRecord(LoopbackEngine* Engine, const LoopbackStream* Stream)
+{
+    LeylinePositionPage* page = Engine->PositionPage;
+    if (!page || Stream->PositionSlot >= LEYLINE_MAX_POSITION_RECORDS) return nullptr;
+    return &page->Records[Stream->PositionSlot];
+}
+
+// The stream's whole record, positioned at Now. Caller holds StreamLock.
+static void WriteStreamRecord(LoopbackEngine* Engine, const LoopbackStream* Stream, LONGLONG Now)
+{
+    LeylinePositionRecord* record = StreamRecord(Engine, Stream);
+    if (!record) return;
+
+    LockPositions(Engine);
+    BeginRecord(record);
+    record->StreamId   = Stream->PositionId;
+    record->Flags      = Stream->IsCapture ? LEYLINE_POSITION_CAPTURE : 0;
+    record->State      = (ULONG)Stream->State;
+    record->Position   = StreamReportedFrame(Stream, Now) * Stream->FrameBytes;
+    record->Qpc        = Now;
+    record->StartQpc   = Stream->StartTime;
+    record->ByteRate   = Stream->ByteRate;
+    record->FrameBytes = Stream->FrameBytes;
+    record->BufferSize = StreamBufferFrames(Stream) * Stream->FrameBytes;
+    record->SafetyBytes = Stream->SafetyFrames * Stream->FrameBytes;
+    EndRecord(record);
+    UnlockPositions(Engine);
+}
+
+// A free record for a joining stream, if any is left, under a new StreamId. Caller
+// holds StreamLock.
+static void ClaimPositionSlot(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    if (Stream->PositionSlot != LOOPBACK_NO_POSITION_SLOT) return;
+
+    for (ULONG slot = 0; slot < LEYLINE_MAX_POSITION_RECORDS; slot++)
+    {
+        if (Engine->PositionSlots & (1u << slot)) continue;
+
+        Engine->PositionSlots |= 1u << slot;
+        if (++Engine->PositionNextId == 0) Engine->PositionNextId = 1;
+        Stream->PositionSlot = slot;
+        Stream->PositionId   = Engine->PositionNextId;
+        return;
+    }
+}
+
+// Empty the leaving stream's record and free it. Caller holds StreamLock.
+static void ReleasePositionSlot(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    if (Stream->PositionSlot == LOOPBACK_NO_POSITION_SLOT) return;
+
+    LockPositions(Engine);
+    LeylinePositionRecord* record = StreamRecord(Engine, Stream);
+    if (record)
+    {
+        BeginRecord(record);
+        RtlZeroMemory(reinterpret_cast<PUCHAR>(record) + sizeof(record->Sequence),
+                      sizeof(*record) - sizeof(record->Sequence));
+        EndRecord(record);
+    }
+    Engine->PositionSlots &= ~(1u << Stream->PositionSlot);
+    Stream->PositionSlot = LOOPBACK_NO_POSITION_SLOT;
+    Stream->PositionId   = 0;
+    UnlockPositions(Engine);
+}
+
+// Refresh every running stream's position from the tick. A stream that paused or left
+// since the snapshot was taken did so before its writer took the lock, so it is skipped.
+static void PublishPositions(LoopbackEngine* Engine, const LoopbackSnapshot* Snapshot)
+{
+    if (!Engine->PositionPage) return;
+
+    KIRQL oldIrql;
+    KeRaiseIrql(DISPATCH_LEVEL, &oldIrql);
+    if (!TryLockPositions(Engine))
+    {
+        KeLowerIrql(oldIrql);
+        return;
+    }
+
+    LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+    for (ULONG i = 0; i < Snapshot->RenderCount + Snapshot->CaptureCount; i++)
+    {
+        const LoopbackTickStream* tick = &Snapshot->Streams[i];
+        LeylinePositionRecord* record = StreamRecord(Engine, tick->Stream);
+        if (!record || !StreamIsActive(tick)) continue;
+
+        BeginRecord(record);
+        record->Position = SafeFrame(StreamCurrentFrame(tick, now), tick->SafetyFrames) * tick->Stream->FrameBytes;
+        record->Qpc      = now;
+        EndRecord(record);
+    }
+    UnlockPositions(Engine);
+    KeLowerIrql(oldIrql);
+}
+
+void LoopbackEngineSetPositionPage(LoopbackEngine* Engine, LeylinePositionPage* Page)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LeylinePositionPage* previous = Engine->PositionPage;
+    if (Page)
+    {
+        LARGE_INTEGER frequency;
+        KeQueryPerformanceCounter(&frequency);
+        Page->Version      = LEYLINE_POSITION_VERSION;
+        Page->HeaderSize   = FIELD_OFFSET(LeylinePositionPage, Records);
+        Page->RecordSize   = sizeof(LeylinePositionRecord);
+        Page->RecordCount  = LEYLINE_MAX_POSITION_RECORDS;
+        Page->QpcFrequency = frequency.QuadPart;
+    }
+    Engine->PositionPage = Page;
+
+    LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+    for (PLIST_ENTRY entry = Engine->RenderStreams.Flink; entry != &Engine->RenderStreams; entry = entry->Flink)
+        WriteStreamRecord(Engine, CONTAINING_RECORD(entry, LoopbackStream, ListEntry), now);
+    for (PLIST_ENTRY entry = Engine->CaptureStreams.Flink; entry != &Engine->CaptureStreams; entry = entry->Flink)
+        WriteStreamRecord(Engine, CONTAINING_RECORD(entry, LoopbackStream, ListEntry), now);
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    // The caller unmaps the old page next; outlast a tick that may still write to it.
+    if (previous && previous != Page) WaitForTick(Engine);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CAPTURE READ-BEHIND
+// The tick writes a capture up to its clock, then nothing more until the next tick, so
+// a reader following the clock itself would read frames that are still stale. Between
+// writes the clock runs a period plus however late the next tick comes, and frames
+// are written for a while after the tick reads the clock, so a capture reports its
+// position that far behind. The tick bins each tick's lateness; every window it turns
+// the 99th percentile into an estimate, taken at once when higher and approached by
+// halves when lower, so one quiet second doesn't undo a noisy one.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline ULONG QpcToUs(const LoopbackEngine* Engine, LONGLONG Qpc)
+{
+    if (Qpc <= 0 || Engine->QpcFrequency <= 0) return 0;
+    ULONGLONG us = (ULONGLONG)Qpc * 1000000ULL / (ULONGLONG)Engine->QpcFrequency;
+    return (us > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (ULONG)us;
+}
+
+// What a capture starting now reads behind by. Caller holds StreamLock.
+static ULONG SafetyOffsetUs(const LoopbackEngine* Engine)
+{
+    ULONG offset = Engine->SafetyFloorUs;
+    if (Engine->SafetyAdaptive) offset = max(offset, (ULONG)Engine->SafetyEstimateUs);
+    return min(offset, (ULONG)LEYLINE_SAFETY_MAX_US);
+}
+
+// The same in the stream's frames, rounded up, and never more than half its buffer.
+// The offset covers a 1 ms tick; a capture that lets the engine tick slower waits that
+// much longer between writes, so it reads behind by the difference too. Caller holds
+// StreamLock.
+static ULONG SafetyFramesFor(const LoopbackEngine* Engine, const LoopbackStream* Stream, ULONG PeriodUs)
+{
+    if (!Stream->IsCapture) return 0;
+    ULONG     offset = SafetyOffsetUs(Engine) + (PeriodUs > LOOPBACK_PERIOD_US ? PeriodUs - LOOPBACK_PERIOD_US : 0);
+    ULONGLONG frames = ((ULONGLONG)offset * Stream->FrameRate + 999999) / 1000000;
+    return (ULONG)min(frames, (ULONGLONG)(StreamBufferFrames(Stream) / 2));
+}
+
+// Upper edge of the bucket holding the Percent'th percentile of the window.
+static ULONG LatenessPercentile(const LoopbackEngine* Engine, ULONG Percent)
+{
+    ULONG rank = (Engine->LatenessTicks * Percent + 99) / 100;
+    ULONG seen = 0;
+    for (ULONG b = 0; b < LOOPBACK_LATENESS_BUCKETS; b++)
+    {
+        seen += Engine->LatenessCounts[b];
+        if (seen >= rank) return (b + 1) * LOOPBACK_LATENESS_BUCKET_US;
+    }
+    return LOOPBACK_LATENESS_BUCKETS * LOOPBACK_LATENESS_BUCKET_US;
+}
+
+// Bin how late this tick came and, once a window is full, publish it. The tick's own.
+static void TrackLateness(LoopbackEngine* Engine, LONGLONG Now)
+{
+    LONGLONG last = Engine->LastTickQpc;
+    Engine->LastTickQpc = Now;
+    if (last == 0) return;
+
+    LONGLONG late   = max(Now - last - Engine->TickPeriodQpc, (LONGLONG)0);
+    ProbeQpc(Engine, LEYLINE_PROBE_LATENESS, late);
+    ULONG    bucket = min(QpcToUs(Engine, late) / LOOPBACK_LATENESS_BUCKET_US, (ULONG)LOOPBACK_LATENESS_BUCKETS - 1);
+    Engine->LatenessCounts[bucket]++;
+    Engine->LatenessMaxQpc = max(Engine->LatenessMaxQpc, late);
+    if (++Engine->LatenessTicks < LOOPBACK_LATENESS_WINDOW) return;
+
+    ULONG p99 = LatenessPercentile(Engine, 99);
+    Engine->LatenessP50Us = LatenessPercentile(Engine, 50);
+    Engine->LatenessP99Us = p99;
+    Engine->LatenessMaxUs = QpcToUs(Engine, Engine->LatenessMaxQpc);
+
+    // A worker writes the tick's frames its wake-up and its mix after the timer fired.
+    LONGLONG work     = Engine->WorkerThread ? Engine->WorkerLatency : Engine->TickCost;
+    ULONG    need     = LOOPBACK_PERIOD_US + p99 + QpcToUs(Engine, work >> LOOPBACK_COST_SHIFT);
+    ULONG    estimate = Engine->SafetyEstimateUs;
+    need = (need + LOOPBACK_LATENESS_BUCKET_US - 1) / LOOPBACK_LATENESS_BUCKET_US * LOOPBACK_LATENESS_BUCKET_US;
+    Engine->SafetyEstimateUs = (need >= estimate) ? need : estimate - (estimate - need) / 2;
+
+    RtlZeroMemory(Engine->LatenessCounts, sizeof(Engine->LatenessCounts));
+    Engine->LatenessTicks  = 0;
+    Engine->LatenessMaxQpc = 0;
+}
+
+void LoopbackEngineSetSafetyOffset(LoopbackEngine* Engine, ULONG OffsetUs, BOOLEAN Adaptive)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Engine->SafetyFloorUs  = min(OffsetUs, (ULONG)LEYLINE_SAFETY_MAX_US);
+    Engine->SafetyAdaptive = Adaptive;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+}
+
+void LoopbackEngineQuerySafety(LoopbackEngine* Engine, LeylineCableSafety* Info)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    Info->OffsetUs = SafetyOffsetUs(Engine);
+    Info->FloorUs  = Engine->SafetyFloorUs;
+    Info->Adaptive = Engine->SafetyAdaptive;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+
+    Info->EstimateUs    = Engine->SafetyEstimateUs;
+    Info->LatenessP50Us = Engine->LatenessP50Us;
+    Info->LatenessP99Us = Engine->LatenessP99Us;
+    Info->LatenessMaxUs = Engine->LatenessMaxUs;
+}
+
+ULONG LoopbackStreamSafetyBytes(LoopbackEngine* Engine, const LoopbackStream* Stream)
+{
+    if (!Stream->IsCapture) return 0;
+    if (!Engine) return Stream->SafetyFrames * Stream->FrameBytes;
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    ULONG frames = Stream->SafetyFrames;
+    if (IsListEmpty(&Stream->ListEntry)) frames = SafetyFramesFor(Engine, Stream, StreamPeriodUs(Engine, Stream));
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    return frames * Stream->FrameBytes;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK TICK
+// Sums every running render stream into every running capture stream. The first
+// running render stream is the master: its clock decides how many frames this tick
+// covers and its rate is the bus rate. Every other render stream is read through its
+// own cursor, resampled if its rate differs. A capture that matches a lone render
+// stream's format and rate gets a raw copy, and one aliased onto the master's pages
+// gets nothing at all unless the mix differs from the master's samples, when the mix is
+// written over the frames the master has just played. Master gain is applied as each
+// capture is written; a gain ramp is applied to the bus, one frame at a time. The meter
+// reads each bus block after the ramp. Streams and tables come from the snapshot, so the
+// tick never waits for a stream opening or closing on another processor. With a worker
+// thread the timer callback only stamps the tick and wakes the worker, which mixes up
+// to the clock as it stood then; a late worker takes the newest tick and skips the
+// rest, since each mix covers everything since the last.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Vector state for a tick or a worker batch: saved the first time a mix needs it and
+// restored once at the end.
+struct LoopbackSimd
+{
+    BOOLEAN          Saved;
+    LeylineSimdLevel Level;
+    XSTATE_SAVE      Save;
+};
+
+static inline LeylineSimdLevel SimdNeed(LoopbackSimd* Simd)
+{
+    if (!Simd->Saved)
+    {
+        Simd->Level = LeylineSimdBegin(LeylineDetectSimdLevel(), &Simd->Save);
+        Simd->Saved = TRUE;
+    }
+    return Simd->Level;
+}
+
+static inline void SimdDone(LoopbackSimd* Simd)
+{
+    if (Simd->Saved) LeylineSimdEnd(Simd->Level, &Simd->Save);
+    Simd->Saved = FALSE;
+}
+
+// Pick up what writers changed while the timer ran.
+static void TakeWriterChanges(LoopbackEngine* Engine, const LoopbackSnapshot* Snapshot)
+{
+    float target = Engine->GainTarget;
+    if (target != Engine->GainRampTarget)
+    {
+        Engine->GainFrom       = Engine->GainCurrent;
+        Engine->GainRampTarget = target;
+    }
+
+    // Retired tables may be freed: every converter starts over with a current one.
+    if (Snapshot->TableGeneration != Engine->TableGenerationSeen)
+    {
+        for (ULONG i = 0; i < Snapshot->RenderCount + Snapshot->CaptureCount; i++)
+            LeylineResamplerReset(&Snapshot->Streams[i].Stream->Resampler, nullptr, 0);
+        Engine->TableGenerationSeen = Snapshot->TableGeneration;
+    }
+
+    if (!Engine->MeterLevels) QuietMeter(Engine);
+    if (Engine->PublishPending && InterlockedExchange(&Engine->PublishPending, 0))
+    {
+        PublishLevels(Engine);
+        PublishTimer(Engine);
+    }
+}
+
+// Mix up to the clocks at Now; the cost is counted from Start. False if no render
+// stream is running to mix from.
+static BOOLEAN MixTick(LoopbackEngine* Engine, const LoopbackSnapshot* Snapshot, LONGLONG Now, LONGLONG Start,
+                       LoopbackSimd* Simd)
+{
+    ULONGLONG probe = ProbeStart();
+    const LoopbackTickStream* renders  = Snapshot->Streams;
+    const LoopbackTickStream* captures = Snapshot->Streams + Snapshot->RenderCount;
+    ULONG renderCount  = Snapshot->RenderCount;
+    ULONG captureCount = Snapshot->CaptureCount;
+    if (renderCount == 0 || captureCount == 0) return FALSE;
+
+    const LoopbackTickStream* master = nullptr;
+    for (ULONG r = 0; r < renderCount; r++)
+    {
+        if (StreamIsActive(&renders[r]))
+        {
+            master = &renders[r];
+            break;
+        }
+    }
+
+    if (!master)
+    {
+        QuietMeter(Engine);
+        return FALSE;
+    }
+
+    LONGLONG now = Now;
+    ULONGLONG masterFrame = StreamCurrentFrame(master, now);
+    if (masterFrame <= master->Stream->Cursor) return TRUE;
+
+    ULONGLONG framesToMix = masterFrame - master->Stream->Cursor;
+    ULONG     sampleRate  = StreamSampleRate(master);
+    ULONG     maxFrames   = StreamBufferFrames(master);
+    ULONG     busChannels = 0;
+    ULONG     mixCount    = 0;
+    const LoopbackTickStream* soleSource = nullptr;
+
+    ULONG   rampFrames = max(sampleRate / 1000 * LOOPBACK_GAIN_RAMP_MS, (ULONG)1);
+    BOOLEAN ramping    = Engine->GainCurrent != Engine->GainRampTarget;
+    float   gainStep   = (Engine->GainRampTarget - Engine->GainFrom) / (float)rampFrames;
+
+    // Render side: publish positions, signal events and pick the contributors.
+    for (ULONG r = 0; r < renderCount; r++)
+    {
+        const LoopbackTickStream* render = &renders[r];
+        LoopbackStream* renderStream = render->Stream;
+        renderStream->Mixing     = FALSE;
+        renderStream->Resampling = FALSE;
+
+        if (!StreamIsActive(render)) continue;
+
+        ULONGLONG currentFrame = StreamCurrentFrame(render, now);
+        ULONGLONG currentByte  = currentFrame * renderStream->FrameBytes;
+
+        if (!Engine->NotifyTimer)
+            LoopbackStreamSignalEvents(renderStream, renderStream->HwPositionRegister, currentByte);
+        renderStream->HwPositionRegister = currentByte;
+        renderStream->HwClockRegister    = (ULONGLONG)now;
+
+        ULONG rate = StreamSampleRate(render);
+        if (rate != sampleRate)
+        {
+            const LeylineResampleTable* table = FindResampleTable(Snapshot->ResampleTables, Snapshot->ResampleTableCount,
+                                                                    rate, sampleRate, Snapshot->ResampleQuality);
+            if (!table || !renderStream->Resampler.History)
+            {
+                // Not prepared for this pair: keep the cursor live but leave it out of the mix.
+                renderStream->Cursor = currentFrame;
+                continue;
+            }
+
+            ULONG busFrames = (ULONG)min(framesToMix, (ULONGLONG)MAXULONG);
+            if (renderStream->Resampler.Table != table)
+            {
+                ResyncResampledRender(render, table, currentFrame, busFrames);
+            }
+            else
+            {
+                // Never read past the stream's clock; rounding alone stays within a frame.
+                ULONGLONG expected = renderStream->Cursor + LeylineResamplerInputNeeded(&renderStream->Resampler, busFrames);
+                if (expected > currentFrame + 1 || expected + LOOPBACK_RESYNC_FRAMES < currentFrame)
+                    ResyncResampledRender(render, table, currentFrame, busFrames);
+            }
+
+            renderStream->Resampling = TRUE;
+            maxFrames = min(maxFrames, (ULONG)((ULONGLONG)StreamBufferFrames(render) * sampleRate / rate));
+        }
+        else if (render != master)
+        {
+            ULONGLONG expected = renderStream->Cursor + framesToMix;
+            if (expected > currentFrame + LOOPBACK_RESYNC_FRAMES || expected + LOOPBACK_RESYNC_FRAMES < currentFrame)
+                renderStream->Cursor = (currentFrame > framesToMix) ? currentFrame - framesToMix : 0;
+        }
+
+        renderStream->Mixing = TRUE;
+        soleSource  = render;
+        busChannels = max(busChannels, min(render->Channels, (ULONG)LEYLINE_MAX_CHANNELS));
+        maxFrames   = min(maxFrames, StreamBufferFrames(render));
+        mixCount++;
+    }
+
+    // The meter follows the bus; a new rate or width starts it over.
+    BOOLEAN metering = Engine->MeterLevels && mixCount > 0;
+    if (metering && (Engine->Meter.SampleRate != sampleRate || Engine->Meter.Channels != busChannels ||
+                     Engine->Meter.Loudness != Engine->MeterLoudness))
+    {
+        LeylineMeterReset(&Engine->Meter, sampleRate, busChannels, Engine->MeterLoudness);
+    }
+
+    // Capture side: publish positions and signal events.
+    BOOLEAN needsMix = FALSE;
+    BOOLEAN rawGain  = FALSE;
+    for (ULONG c = 0; c < captureCount; c++)
+    {
+        const LoopbackTickStream* capture = &captures[c];
+        LoopbackStream* captureStream = capture->Stream;
+        captureStream->Resampling = FALSE;
+        if (!StreamIsActive(capture)) continue;
+
+        ULONGLONG currentFrame = StreamCurrentFrame(capture, now);
+        ULONGLONG currentByte  = SafeFrame(currentFrame, capture->SafetyFrames) * captureStream->FrameBytes;
+
+        if (!Engine->NotifyTimer)
+            LoopbackStreamSignalEvents(captureStream, captureStream->HwPositionRegister, currentByte);
+        captureStream->HwPositionRegister = currentByte;
+        captureStream->HwClockRegister    = (ULONGLONG)now;
+
+        // Written, if at all, over the master's window, which already bounds the tick.
+        LoopbackAliasRoute route = CaptureAliasRoute(capture, master, mixCount, ramping, Engine->GainCurrent);
+        if (route != LoopbackAliasNone)
+        {
+            if (route == LoopbackAliasInPlace) needsMix = TRUE;
+            continue;
+        }
+
+        ULONG rate = StreamSampleRate(capture);
+        if (rate == sampleRate)
+        {
+            // A reader trails the clock by the read-behind; a tick later than that has
+            // let it past frames the tick is only now writing.
+            if (LeylineTraceOn(LEYLINE_KEYWORD_GLITCH) && capture->SafetyFrames &&
+                SafeFrame(currentFrame, capture->SafetyFrames) > captureStream->Cursor)
+            {
+                LeylineTraceUnderrun(Engine->CableId, captureStream, currentByte,
+                                     (SafeFrame(currentFrame, capture->SafetyFrames) - captureStream->Cursor) *
+                                     captureStream->FrameBytes, now);
+            }
+            captureStream->Cursor = currentFrame;
+            maxFrames = min(maxFrames, StreamBufferFrames(capture));
+            if (!CaptureTakesRawCopy(capture, soleSource, mixCount, ramping))
+                needsMix = TRUE;
+            else if (Engine->GainCurrent != 1.0f)
+                rawGain = TRUE;
+            continue;
+        }
+
+        const LeylineResampleTable* table = FindResampleTable(Snapshot->ResampleTables, Snapshot->ResampleTableCount,
+                                                                sampleRate, rate, Snapshot->ResampleQuality);
+        if (!table || !captureStream->Resampler.History)
+        {
+            captureStream->Cursor = currentFrame;
+            continue;
+        }
+
+        // Writes run ahead of the clock by the filter delay on the first tick, so that
+        // once the history is primed they land on it; allow that much slack.
+        ULONGLONG produced = framesToMix * rate / sampleRate;
+        ULONGLONG delay    = (ULONGLONG)(table->Taps / 2) * rate / sampleRate;
+        ULONGLONG expected = captureStream->Cursor + produced;
+        if (captureStream->Resampler.Table != table || captureStream->Resampler.Channels != busChannels ||
+            expected > currentFrame + delay + LOOPBACK_RESYNC_FRAMES ||
+            expected + delay + LOOPBACK_RESYNC_FRAMES < currentFrame)
+        {
+            LeylineResamplerReset(&captureStream->Resampler, table, busChannels);
+            captureStream->Cursor = (currentFrame + delay > produced) ? currentFrame + delay - produced : 0;
+        }
+
+        captureStream->Resampling = TRUE;
+        needsMix  = TRUE;
+        maxFrames = min(maxFrames, (ULONG)((ULONGLONG)StreamBufferFrames(capture) * sampleRate / rate));
+    }
+
+    if (framesToMix > (ULONGLONG)maxFrames)
+    {
+        // Older frames have already been overwritten by the renderer; drop them.
+        ULONGLONG lost = framesToMix - maxFrames;
+        Engine->GlitchCount++;
+        Engine->LostFrames += lost;
+        if (LeylineTraceOn(LEYLINE_KEYWORD_GLITCH))
+            LeylineTraceOverrun(Engine->CableId, lost, lost * master->Stream->FrameBytes, now);
+
+        for (ULONG r = 0; r < renderCount; r++)
+        {
+            const LoopbackTickStream* render = &renders[r];
+            LoopbackStream* renderStream = render->Stream;
+            if (renderStream->Resampling)
+                ResyncResampledRender(render, renderStream->Resampler.Table,
+                                      StreamCurrentFrame(render, now), maxFrames);
+            else if (renderStream->Mixing)
+                renderStream->Cursor += lost;
+        }
+        for (ULONG c = 0; c < captureCount; c++)
+        {
+            const LoopbackTickStream* capture = &captures[c];
+            if (capture->Stream->Resampling)
+                capture->Stream->Cursor += lost * StreamSampleRate(capture) / sampleRate;
+        }
+        framesToMix = maxFrames;
+    }
+
+    ULONG frames = (ULONG)framesToMix;
+    probe = ProbeLap(Engine, LEYLINE_PROBE_POSITIONS, probe);
+
+    // A bit-perfect raw copy at unity gain with the meter off needs no vector state.
+    BOOLEAN runBus  = needsMix || metering;
+    BOOLEAN settled = FALSE;
+    LeylineSimdLevel level = (runBus || rawGain) ? SimdNeed(Simd) : LeylineSimdScalar;
+
+    // Matching captures: raw frame copy from the only source, scaled in the same pass.
+    if (mixCount == 1)
+    {
+        for (ULONG c = 0; c < captureCount; c++)
+        {
+            const LoopbackTickStream* capture = &captures[c];
+            if (!StreamIsActive(capture) || !CaptureTakesRawCopy(capture, soleSource, mixCount, ramping) ||
+                CaptureAliasRoute(capture, master, mixCount, ramping, Engine->GainCurrent) != LoopbackAliasNone)
+            {
+                continue;
+            }
+
+            // A capture younger than the window only receives its newest frames.
+            ULONGLONG cursor = capture->Stream->Cursor;
+            ULONG     skip   = (cursor < frames) ? frames - (ULONG)cursor : 0;
+            CopyFrames(capture, cursor - frames + skip,
+                       soleSource, soleSource->Stream->Cursor + skip, frames - skip, Engine->GainCurrent, level);
+        }
+    }
+
+    // Everything else goes through the float bus, one block at a time. With only raw
+    // copies the bus is still summed for the meter, but not written anywhere.
+    if (runBus)
+    {
+        for (ULONG done = 0; done < frames; )
+        {
+            ULONG block = min(frames - done, (ULONG)LEYLINE_MIX_BLOCK_FRAMES);
+            RtlZeroMemory(Engine->MixBus, (SIZE_T)block * busChannels * sizeof(float));
+
+            for (ULONG r = 0; r < renderCount; r++)
+            {
+                const LoopbackTickStream* render = &renders[r];
+                if (render->Stream->Resampling)
+                    ResampleIntoBus(Engine, render, busChannels, block, level);
+                else if (render->Stream->Mixing)
+                    AccumulateFrames(Engine->MixBus, busChannels, render, render->Stream->Cursor + done, block, level);
+            }
+
+            // Steady gain is folded into the write-out; a ramp is applied here instead.
+            float gain = Engine->GainCurrent;
+            if (gain != Engine->GainRampTarget)
+            {
+                Engine->GainCurrent = MixApplyGainRamp(Engine->MixBus, busChannels, block, gain,
+                                                       Engine->GainRampTarget, gainStep);
+                gain = 1.0f;
+            }
+
+            if (metering && LeylineMeterProcess(&Engine->Meter, Engine->MixBus, block, gain, level))
+                settled = TRUE;
+
+            for (ULONG c = 0; c < captureCount; c++)
+            {
+                const LoopbackTickStream* capture = &captures[c];
+                if (!StreamIsActive(capture)) continue;
+
+                // The master's frames have been summed into this block; nothing reads them again.
+                LoopbackAliasRoute route = CaptureAliasRoute(capture, master, mixCount, ramping, Engine->GainCurrent);
+                if (route != LoopbackAliasNone)
+                {
+                    if (route == LoopbackAliasInPlace)
+                        WriteFrames(capture, master->Stream->Cursor + done, Engine->MixBus, busChannels, block, gain, level);
+                    continue;
+                }
+                if (capture->Stream->Resampling)
+                {
+                    ResampleFromBus(Engine, capture, Engine->MixBus, busChannels, block, gain, level);
+                    continue;
+                }
+                if (StreamSampleRate(capture) != sampleRate ||
+                    CaptureTakesRawCopy(capture, soleSource, mixCount, ramping))
+                {
+                    continue;
+                }
+
+                ULONGLONG cursor = capture->Stream->Cursor;
+                ULONG     skip   = (cursor < frames) ? frames - (ULONG)cursor : 0;
+                ULONG     first  = max(done, skip);
+                if (first >= done + block) continue;
+
+                WriteFrames(capture, cursor - frames + first,
+                            Engine->MixBus + (SIZE_T)(first - done) * busChannels, busChannels,
+                            done + block - first, gain, level);
+            }
+
+            done += block;
+        }
+    }
+
+    if (settled) PublishLevels(Engine);
+
+    for (ULONG r = 0; r < renderCount; r++)
+    {
+        LoopbackStream* renderStream = renders[r].Stream;
+        if (renderStream->Mixing && !renderStream->Resampling) renderStream->Cursor += frames;
+    }
+    ProbeLap(Engine, LEYLINE_PROBE_MIX, probe);
+
+    LONGLONG cost = (KeQueryPerformanceCounter(nullptr).QuadPart - Start) << LOOPBACK_COST_SHIFT;
+    Engine->TickCost += (cost - Engine->TickCost) >> LOOPBACK_COST_SHIFT;
+    return TRUE;
+}
+
+// The timer's half of a tick with a worker: stamp it, bin its lateness and wake the
+// worker. Nothing here touches a stream. Probe is when the callback began.
+static void PostTick(LoopbackEngine* Engine, ULONGLONG Probe)
+{
+    if (!EnterTick(&Engine->DpcSequence)) return;
+
+    if (TimerTicking(Engine))
+    {
+        LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+        TrackLateness(Engine, now);
+
+        LONG next = Engine->RequestSequence + 1;
+        Engine->Requests[next & 1] = now;
+        InterlockedExchange(&Engine->RequestSequence, next);
+        KeSetEvent(&Engine->WorkerWake, IO_NO_INCREMENT, FALSE);
+    }
+    Engine->TimerWakeups++;
+    ProbeLap(Engine, LEYLINE_PROBE_TICK, Probe);
+
+    LeaveTick(&Engine->DpcSequence);
+}
+
+// The newest tick posted and not yet taken. The slot it is in is rewritten only two
+// posts later, so a copy is good if fewer than two came in while it was made.
+static BOOLEAN TakeRequest(LoopbackEngine* Engine, LONG* Sequence, LONGLONG* Posted)
+{
+    for (;;)
+    {
+        LONG sequence = ReadAcquire(&Engine->RequestSequence);
+        if (sequence == Engine->RequestTaken) return FALSE;
+
+        LONGLONG posted = Engine->Requests[sequence & 1];
+        KeMemoryBarrier();
+        if (ReadAcquire(&Engine->RequestSequence) - sequence < 2)
+        {
+            *Sequence = sequence;
+            *Posted   = posted;
+            return TRUE;
+        }
+    }
+}
+
+void LoopbackEngineTick(LoopbackEngine* Engine)
+{
+    ULONGLONG probe = ProbeStart();
+    if (Engine->WorkerThread)
+    {
+        PostTick(Engine, probe);
+        return;
+    }
+    if (!EnterTick(&Engine->TickSequence)) return;
+
+    // A DPC queued before the timer stopped or began retuning finds it so and leaves:
+    // the writer that stopped it owns the mix state now.
+    const LoopbackSnapshot* snapshot = static_cast<const LoopbackSnapshot*>(
+        ReadPointerAcquire(reinterpret_cast<PVOID const volatile*>(&Engine->Snapshot)));
+    BOOLEAN running = TimerTicking(Engine) && snapshot;
+    BOOLEAN mixed   = FALSE;
+    if (running)
+    {
+        LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+        TrackLateness(Engine, now);
+        TakeWriterChanges(Engine, snapshot);
+
+        LoopbackSimd simd;
+        simd.Saved = FALSE;
+        mixed = MixTick(Engine, snapshot, now, now, &simd);
+        SimdDone(&simd);
+
+        ULONGLONG publish = ProbeStart();
+        PublishPositions(Engine, snapshot);
+        ProbeLap(Engine, LEYLINE_PROBE_PUBLISH, publish);
+    }
+
+    // Counted either way; published only while the timer section is the tick's.
+    Engine->TimerWakeups++;
+    if (!mixed) Engine->IdleWakeups++;
+    if (running && Engine->TimerWakeups % LOOPBACK_TIMER_PUBLISH_TICKS == 0) PublishTimer(Engine);
+    ProbeLap(Engine, LEYLINE_PROBE_TICK, probe);
+
+    LeaveTick(&Engine->TickSequence);
+}
+
+// SetProcessor runs under the cable lock, too high an IRQL to move a thread, so the
+// worker moves itself when it wakes. Its ideal processor, not its affinity: it runs
+// beside the DPC's cache when it can, and elsewhere rather than wait for a busy one.
+// A processor that cannot be taken is not asked for again until the DPC moves.
+static void FollowDpc(LoopbackEngine* Engine)
+{
+    ULONG processor = ReadULongNoFence(&Engine->Processor);
+    if (processor == Engine->WorkerProcessor) return;
+    Engine->WorkerProcessor = processor;
+
+    PROCESSOR_NUMBER number;
+    if (!NT_SUCCESS(KeGetProcessorNumberFromIndex(processor, &number))) return;
+    ZwSetInformationThread(ZwCurrentThread(), ThreadIdealProcessorEx, &number, sizeof(number));
+}
+
+void LoopbackEngineWork(LoopbackEngine* Engine)
+{
+    FollowDpc(Engine);
+    if (!EnterTick(&Engine->TickSequence)) return;
+
+    LoopbackSimd simd;
+    simd.Saved = FALSE;
+    BOOLEAN  running = FALSE;
+    LONG     sequence;
+    LONGLONG posted;
+    for (ULONG pass = 0; pass < LOOPBACK_WORKER_BATCH && TakeRequest(Engine, &sequence, &posted); pass++)
+    {
+        LONG ticks = sequence - Engine->RequestTaken;
+        Engine->CoalescedTicks += (ULONG)(ticks - 1);
+        Engine->RequestTaken    = sequence;
+
+        // As in the callback: a tick posted before the timer stopped mixes nothing.
+        const LoopbackSnapshot* snapshot = static_cast<const LoopbackSnapshot*>(
+            ReadPointerAcquire(reinterpret_cast<PVOID const volatile*>(&Engine->Snapshot)));
+        BOOLEAN mixed = FALSE;
+        if (TimerTicking(Engine) && snapshot)
+        {
+            running = TRUE;
+            LONGLONG start = KeQueryPerformanceCounter(nullptr).QuadPart;
+            ProbeQpc(Engine, LEYLINE_PROBE_WAKE, start - posted);
+            TakeWriterChanges(Engine, snapshot);
+            mixed = MixTick(Engine, snapshot, posted, start, &simd);
+
+            ULONGLONG publish = ProbeStart();
+            PublishPositions(Engine, snapshot);
+            ProbeLap(Engine, LEYLINE_PROBE_PUBLISH, publish);
+
+            LONGLONG latency = (KeQueryPerformanceCounter(nullptr).QuadPart - posted) << LOOPBACK_COST_SHIFT;
+            Engine->WorkerLatency += (latency - Engine->WorkerLatency) >> LOOPBACK_COST_SHIFT;
+        }
+        if (!mixed) Engine->IdleWakeups += (ULONG)ticks;
+    }
+    SimdDone(&simd);
+
+    if (running && ++Engine->WorkerBatches % LOOPBACK_TIMER_PUBLISH_TICKS == 0) PublishTimer(Engine);
+
+    LeaveTick(&Engine->TickSequence);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DPC PLACEMENT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LoopbackEngineSetProcessor(LoopbackEngine* Engine, ULONG Processor)
+{
+    PROCESSOR_NUMBER number;
+    if (!NT_SUCCESS(KeGetProcessorNumberFromIndex(Processor, &number))) return;
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    if (Engine->Processor != Processor)
+    {
+        // A DPC may not be retargeted while queued: stop the timer, pull a pending
+        // DPC, retarget, and re-arm. A tick already running finishes where it is, and
+        // the worker follows on its next wakeup. The high-resolution timer ticks in
+        // its own callback, not the DPC, so it is left running in phase.
+        // Called under the cable lock, so no TimerGate: a timer that a writer is
+        // stopping or retuning is already cancelled, and that writer re-arms it.
+        BOOLEAN armed = TimerTicking(Engine) && !Engine->TickFast;
+        if (armed) CancelLoopbackTimer(Engine);
+        KeRemoveQueueDpc(&Engine->LoopbackDpc);
+        KeSetTargetProcessorDpcEx(&Engine->LoopbackDpc, &number);
+        WriteULongNoFence(&Engine->Processor, Processor);
+
+        if (armed) SetLoopbackTimer(Engine, Engine->TickPeriodUs);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+}
+
+ULONG LoopbackEngineTickCostNs(const LoopbackEngine* Engine)
+{
+    LONGLONG cost   = Engine->TickCost >> LOOPBACK_COST_SHIFT;
+    ULONG    period = Engine->TickPeriodUs;
+    if (cost <= 0 || Engine->QpcFrequency <= 0 || period == 0) return 0;
+
+    // Per millisecond of audio, so cables ticking at different periods compare.
+    ULONGLONG ns = (ULONGLONG)cost * 1000000000ULL / (ULONGLONG)Engine->QpcFrequency * LOOPBACK_PERIOD_US / period;
+    return (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (ULONG)ns;
+}
+
+BOOLEAN LoopbackEngineRunning(LoopbackEngine* Engine)
+{
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    BOOLEAN running = Engine->TimerRunning;
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    return running;
+}
+
+extern "C" void LoopbackDpcRoutine(PKDPC /*Dpc*/, PVOID DeferredContext,
+                                   PVOID /*SystemArgument1*/, PVOID /*SystemArgument2*/)
+{
+    LoopbackEngine* engine = reinterpret_cast<LoopbackEngine*>(DeferredContext);
+    if (!engine) return;
+
+    LoopbackEngineTick(engine);
+}
+
+// Periods under a millisecond: the high-resolution timer calls back at DISPATCH_LEVEL,
+// where the DPC would run, so it ticks directly.
+extern "C" void LoopbackFastTimerRoutine(PEX_TIMER /*Timer*/, PVOID Context)
+{
+    LoopbackEngine* engine = reinterpret_cast<LoopbackEngine*>(Context);
+    if (!engine) return;
+
+    LoopbackEngineTick(engine);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ALIASED CAPTURE
+// A capture stream on a render stream's pages reads at the render stream's offsets, so
+// its frame count is shifted to reach each offset LOOPBACK_ALIAS_LAG_MS after the
+// render stream does. Both clocks count the same frames per QPC tick, so the gap holds
+// to within a frame until one of them restarts; each start aligns them again. The
+// shift only grows, so the capture's position never runs backwards; a realignment
+// while it runs is a jump forward of less than a buffer.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Caller holds StreamLock.
+static void AlignAliasedCapture(LoopbackStream* Capture, const LoopbackStream* Render, LONGLONG Now)
+{
+    ULONG frames = Capture->BufferFrames;
+    if (frames == 0) return;
+
+    ULONG     lag    = min(Capture->FrameRate / 1000 * LOOPBACK_ALIAS_LAG_MS, frames / 2);
+    ULONGLONG target = (StreamCurrentFrame(Render, Now) + frames - lag) % frames;
+    ULONGLONG at     = StreamCurrentFrame(Capture, Now) % frames;
+    Capture->FrameShift += (target + frames - at) % frames;
+}
+
+// Align a starting stream with the streams it shares pages with, if they are running.
+// TRUE if that moved a running capture. Caller holds StreamLock.
+static BOOLEAN AlignAliases(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    BOOLEAN moved = FALSE;
+    if (!Stream->Pages) return moved;
+
+    PLIST_ENTRY head = Stream->IsCapture ? &Engine->RenderStreams : &Engine->CaptureStreams;
+    for (PLIST_ENTRY entry = head->Flink; entry != head; entry = entry->Flink)
+    {
+        LoopbackStream* other = CONTAINING_RECORD(entry, LoopbackStream, ListEntry);
+        if (other->Pages != Stream->Pages || other->StartTime == 0) continue;
+
+        if (Stream->IsCapture)
+        {
+            if (other->State == KSSTATE_RUN) AlignAliasedCapture(Stream, other, Stream->StartTime);
+        }
+        else
+        {
+            // The tick may read the capture's old shift or its new one, never a mix.
+            AlignAliasedCapture(other, Stream, Stream->StartTime);
+            moved = TRUE;
+        }
+    }
+    return moved;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HELPER: Register or unregister a stream with the loopback engine.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// A stream started, paused or left: start the timer, retune it, or stop it if nothing
+// is left to mix. Caller holds TimerGate and StreamLock, and passes what this returns
+// to FinishTimerChange once it has dropped the lock.
+static LoopbackTimerChange UpdateTimer(LoopbackEngine* Engine)
+{
+    if (!EngineNeedsTimer(Engine))
+        return Engine->TimerRunning ? DisarmTimer(Engine) : LoopbackTimerSettled;
+    if (Engine->TimerRunning) return RetuneTimer(Engine);
+
+    ArmTimer(Engine);
+    return LoopbackTimerSettled;
+}
+
+// RUN restarts the stream clock. The tick reads the state with the clock and shift in
+// its snapshot, so a stream it can see stays paused until this returns.
+static void StartStream(LoopbackStream* Stream)
+{
+    Stream->StartTime = KeQueryPerformanceCounter(nullptr).QuadPart;
+    LeylineClockInit(&Stream->Clock, Stream->FrameRate, Stream->Frequency, Stream->StartTime);
+    Stream->State     = KSSTATE_RUN;
+}
+
+// Start a stream and hand it to the tick.
+static void RegisterStreamForLoopback(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    ExAcquireFastMutex(&Engine->TimerGate);
+
+    // PAUSE -> RUN re-enters without a STOP. Never link the same entry twice, and take
+    // the stream out of the tick's view before resetting what the tick updates.
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+    LoopbackSnapshot* retired = nullptr;
+    if (!IsListEmpty(&Stream->ListEntry))
+    {
+        RemoveEntryList(&Stream->ListEntry);
+        InitializeListHead(&Stream->ListEntry);
+        retired = PublishSnapshot(Engine);
+    }
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    RetireSnapshot(Engine, retired);
+
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+
+    // The stream clock restarts at RUN, so the cursor, position registers and any
+    // filter history do too; an aliased capture starts wherever its render stream is.
+    // A capture's read-behind is fixed until it next starts, so its position only
+    // ever moves forward.
+    StartStream(Stream);
+    Stream->Cursor       = 0;
+    Stream->FrameShift   = 0;
+    Stream->PeriodUs     = StreamPeriodUs(Engine, Stream);
+    Stream->SafetyFrames = SafetyFramesFor(Engine, Stream, Stream->PeriodUs);
+    BOOLEAN moved = AlignAliases(Engine, Stream);
+
+    ULONGLONG first = StreamReportedFrame(Stream, Stream->StartTime);
+    Stream->HwPositionRegister = first * Stream->FrameBytes;
+    Stream->NotifyFrames       = Stream->NotificationBytes / Stream->FrameBytes;
+    Stream->NotifyNext         = Stream->NotifyFrames;
+    if (Stream->NotifyFrames) Stream->NotifyNext += first - first % Stream->NotifyFrames;
+    LeylineResamplerReset(&Stream->Resampler, nullptr, 0);
+
+    if (Stream->IsCapture)
+        InsertTailList(&Engine->CaptureStreams, &Stream->ListEntry);
+    else
+        InsertTailList(&Engine->RenderStreams, &Stream->ListEntry);
+    ClaimPositionSlot(Engine, Stream);
+    WriteStreamRecord(Engine, Stream, Stream->StartTime);
+
+    // Start the timer once a render and a capture stream are both running.
+    retired = PublishSnapshot(Engine);
+    LoopbackTimerChange change = UpdateTimer(Engine);
+    // A capture moved forward may have a boundary due sooner than the timer is armed for.
+    if (Stream->NotifyFrames || moved) ScheduleNotifications(Engine, KeQueryPerformanceCounter(nullptr).QuadPart);
+
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    RetireSnapshot(Engine, retired);
+    FinishTimerChange(Engine, change);
+    ExReleaseFastMutex(&Engine->TimerGate);
+}
+
+void LoopbackStreamUnregister(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    if (Engine)
+    {
+        ExAcquireFastMutex(&Engine->TimerGate);
+        KIRQL oldIrql;
+        KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+
+        // Nothing to publish for a stream that never joined or already left.
+        LoopbackSnapshot*   retired = nullptr;
+        LoopbackTimerChange change  = LoopbackTimerSettled;
+        if (!IsListEmpty(&Stream->ListEntry))
+        {
+            RemoveEntryList(&Stream->ListEntry);
+            InitializeListHead(&Stream->ListEntry);
+            ReleasePositionSlot(Engine, Stream);
+            retired = PublishSnapshot(Engine);
+
+            change = UpdateTimer(Engine);
+        }
+
+        KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+        RetireSnapshot(Engine, retired);
+        FinishTimerChange(Engine, change);
+        ExReleaseFastMutex(&Engine->TimerGate);
+    }
+
+    // Out of the snapshot, and the last tick that saw it is done: nothing reads the
+    // history any more.
+    LeylineResamplerFree(&Stream->Resampler);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM STATE & POSITION
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LoopbackStreamInit(LoopbackStream* Stream, BOOLEAN Capture)
+{
+    InitializeListHead(&Stream->ListEntry);
+    Stream->Buffer.Init(nullptr, 0);
+    Stream->BufferBase         = nullptr;
+    Stream->BufferMirrored     = FALSE;
+    Stream->Mdl                = nullptr;
+    Stream->Mapping            = nullptr;
+    Stream->Pages              = nullptr;
+    Stream->BufferFrames       = 0;
+    LeylineDivisorInit(&Stream->BufferDivisor, 1);
+    Stream->IsCapture          = Capture;
+    Stream->State              = KSSTATE_STOP;
+    Stream->StartTime          = 0;
+    Stream->FrameShift         = 0;
+    Stream->ByteRate           = 48000 * 4;
+    Stream->FrameRate          = 48000;
+    Stream->BitsPerSample      = 16;
+    Stream->Channels           = 2;
+    Stream->IsFloat            = FALSE;
+    Stream->FrameBytes         = 4;
+    Stream->SampleFormat       = LeylineSampleInt16;
+    Stream->Kernels            = LeylineSelectMixKernels(LeylineSampleInt16, LeylineDetectSimdLevel());
+    Stream->Cursor             = 0;
+    Stream->Mixing             = FALSE;
+    Stream->Resampling         = FALSE;
+    Stream->NotificationBytes  = 0;
+    Stream->NotifyFrames       = 0;
+    Stream->NotifyNext         = 0;
+    Stream->SafetyFrames       = 0;
+    Stream->HwPositionRegister = 0;
+    Stream->HwClockRegister    = 0;
+    Stream->PositionSlot       = LOOPBACK_NO_POSITION_SLOT;
+    Stream->PositionId         = 0;
+    RtlZeroMemory(Stream->NotificationEvents, sizeof(Stream->NotificationEvents));
+    RtlZeroMemory(&Stream->Resampler, sizeof(Stream->Resampler));
+
+    LARGE_INTEGER freq = {};
+    KeQueryPerformanceCounter(&freq);
+    Stream->Frequency = freq.QuadPart;
+    LeylineClockInit(&Stream->Clock, Stream->FrameRate, Stream->Frequency, 0);
+}
+
+void LoopbackStreamSetFormat(LoopbackStream* Stream, ULONG ByteRate, ULONG BitsPerSample,
+                             ULONG ValidBitsPerSample, ULONG Channels, BOOLEAN IsFloat)
+{
+    Stream->ByteRate      = ByteRate;
+    Stream->BitsPerSample = BitsPerSample;
+    Stream->Channels      = Channels;
+    Stream->IsFloat       = IsFloat;
+    Stream->SampleFormat  = LeylineSampleFormatOf(BitsPerSample, ValidBitsPerSample, IsFloat);
+    Stream->Kernels       = LeylineSelectMixKernels(Stream->SampleFormat, LeylineDetectSimdLevel());
+
+    Stream->FrameBytes = (BitsPerSample / 8) * Channels;
+    if (Stream->FrameBytes == 0) Stream->FrameBytes = 4;
+    Stream->FrameRate  = ByteRate / Stream->FrameBytes;
+    LeylineClockInit(&Stream->Clock, Stream->FrameRate, Stream->Frequency, Stream->StartTime);
+    StreamBufferChanged(Stream);
+
+    if (LeylineTraceOn(LEYLINE_KEYWORD_STREAM))
+    {
+        LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+        LeylineTraceStreamFormat(Stream, Stream->IsCapture, Stream->FrameRate, BitsPerSample, ValidBitsPerSample,
+                                 Channels, IsFloat, now);
+    }
+}
+
+void LoopbackStreamSetState(LoopbackEngine* Engine, LoopbackStream* Stream, KSSTATE State)
+{
+    KSSTATE prevState = Stream->State;
+    if (LeylineTraceOn(LEYLINE_KEYWORD_STREAM))
+    {
+        LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+        LeylineTraceStreamState(Engine ? Engine->CableId : 0, Stream, Stream->IsCapture, prevState, State,
+                                LoopbackStreamPosition(Stream, now), now);
+    }
+    if (State == KSSTATE_STOP)
+    {
+        // Out of the lists first: writers read a listed stream's state under StreamLock.
+        LoopbackStreamUnregister(Engine, Stream);
+        Stream->State     = State;
+        Stream->StartTime = 0;
+    }
+    else if (State == KSSTATE_RUN && prevState != KSSTATE_RUN)
+    {
+        if (Engine)
+        {
+            // Everything rate conversion needs is allocated here, never in the DPC.
+            if (!Stream->Resampler.History)
+            {
+                ULONG maxChannels = Stream->IsCapture ? LEYLINE_MAX_CHANNELS
+                                                      : min(Stream->Channels, (ULONG)LEYLINE_MAX_CHANNELS);
+                if (!NT_SUCCESS(LeylineResamplerAllocate(&Stream->Resampler, maxChannels)))
+                    DbgPrint("Leyline: No resampler history; stream stays at its own rate\n");
+            }
+            PrepareResampleTables(Engine, Stream);
+
+            // A paused stream is still in the tick's view; it starts once out of it.
+            RegisterStreamForLoopback(Engine, Stream);
+        }
+        else
+            StartStream(Stream);
+    }
+    else if (!Engine)
+        Stream->State = State;
+    else
+    {
+        ExAcquireFastMutex(&Engine->TimerGate);
+        KIRQL oldIrql;
+        KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+        Stream->State = State;
+
+        // Paused: the record keeps the position it stopped at, and the stream stays in
+        // the lists, but the tick's copy of it stops, and it may have been the last
+        // thing keeping the timer running.
+        LoopbackSnapshot*   retired = nullptr;
+        LoopbackTimerChange change  = LoopbackTimerSettled;
+        if (prevState == KSSTATE_RUN)
+        {
+            retired = PublishSnapshot(Engine);
+            WriteStreamRecord(Engine, Stream, KeQueryPerformanceCounter(nullptr).QuadPart);
+            change = UpdateTimer(Engine);
+        }
+        KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+        RetireSnapshot(Engine, retired);
+        FinishTimerChange(Engine, change);
+        ExReleaseFastMutex(&Engine->TimerGate);
+    }
+}
+
+ULONGLONG LoopbackStreamPosition(const LoopbackStream* Stream, LONGLONG Now)
+{
+    if (Stream->State != KSSTATE_RUN || Stream->StartTime == 0) return 0;
+
+    ULONGLONG frame = StreamReportedFrame(Stream, Now);
+    if (Stream->BufferFrames > 0) frame = StreamBufferOffset(Stream, frame);
+    return frame * Stream->FrameBytes;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM BUFFER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LOOPBACK_PAGES_TAG 'LLPG'
+
+// Take a reference to Pages as the stream's buffer.
+static void UseBufferPages(LoopbackStream* Stream, LoopbackPages* Pages)
+{
+    Stream->Mdl     = Pages->Mdl;
+    Stream->Mapping = Pages->Mapping;
+    Stream->Pages   = Pages;
+    Stream->Buffer.Init(reinterpret_cast<PUCHAR>(Pages->Mapping), Pages->Size, Pages->MirrorMdl != nullptr);
+    StreamBufferChanged(Stream);
+}
+
+NTSTATUS LoopbackStreamAllocateBuffer(LoopbackStream* Stream, ULONG RequestedSize, ULONG Flags,
+                                      ULONG* ActualSize)
+{
+    return LoopbackStreamAllocatePooledBuffer(Stream, nullptr, RequestedSize, Flags, ActualSize);
+}
+
+static NTSTATUS AllocateStreamBuffer(LoopbackStream* Stream, LeylineBufferPool* Pool, ULONG RequestedSize,
+                                     ULONG Flags, ULONG* ActualSize)
+{
+    if (Stream->Mdl) return STATUS_ALREADY_COMMITTED;
+
+    ULONG frameSize = Stream->FrameBytes;
+
+    ULONG minBytes = (Stream->ByteRate / 1000); // 1ms
+    if (minBytes == 0) minBytes = 128 * frameSize;
+
+    ULONG maxBytes = Stream->ByteRate * 5; // 5 seconds
+
+    ULONG safeSize = RequestedSize;
+    if (safeSize < minBytes) safeSize = minBytes;
+    if (safeSize > maxBytes) safeSize = maxBytes;
+
+    // Whole frames. Not a mask: 24-bit stereo and 5.1 frames aren't powers of two.
+    safeSize = ((safeSize + frameSize - 1) / frameSize) * frameSize;
+    if (safeSize > maxBytes) safeSize -= frameSize;
+
+    // A mirror's second view starts right after the last page, so it needs whole pages
+    // that are also whole frames: a multiple of lcm(frame, page). Page sizes are powers
+    // of two, so the gcd is the frame's lowest set bit. Any other size is kept and split
+    // at the wrap: the notification period follows the buffer size, so rounding a 10 ms
+    // buffer up to whole pages would give the client twice the latency it asked for.
+    if (Flags & LOOPBACK_BUFFER_MIRRORED)
+    {
+        ULONG unit = frameSize * (PAGE_SIZE / min(frameSize & (0 - frameSize), (ULONG)PAGE_SIZE));
+        if (safeSize % unit != 0) Flags &= ~LOOPBACK_BUFFER_MIRRORED;
+    }
+
+    LoopbackPages* pages = static_cast<LoopbackPages*>(
+        ExAllocatePool2(POOL_FLAG_NON_PAGED, sizeof(LoopbackPages), LOOPBACK_PAGES_TAG));
+    if (!pages) return STATUS_INSUFFICIENT_RESOURCES;
+
+    // A pooled block already holds its mappings; the pool says if the size has no class.
+    LeylinePoolBlock* block = nullptr;
+    if (Pool)
+    {
+        NTSTATUS status = LeylineBufferPoolAcquire(Pool, safeSize, (Flags & LOOPBACK_BUFFER_MIRRORED) != 0, &block);
+        if (!NT_SUCCESS(status) && status != STATUS_NOT_SUPPORTED)
+        {
+            ExFreePoolWithTag(pages, LOOPBACK_PAGES_TAG);
+            return status;
+        }
+    }
+
+    PMDL  mdl       = nullptr;
+    PMDL  mirrorMdl = nullptr;
+    PVOID mapping   = nullptr;
+    if (block)
+    {
+        mdl       = block->ViewMdl;
+        mirrorMdl = block->MirrorMdl;
+        mapping   = mirrorMdl ? block->MirrorMapping : block->Mapping;
+    }
+    else
+    {
+        // Nothing DMAs from these pages, so they may come from anywhere in physical memory.
+        PHYSICAL_ADDRESS low = { 0 }, high = { 0 }, skip = { 0 };
+        high.QuadPart = -1;
+
+        mdl = MmAllocatePagesForMdlEx(low, high, skip, safeSize, MmCached, MM_ALLOCATE_FULLY_REQUIRED);
+        if (!mdl)
+        {
+            ExFreePoolWithTag(pages, LOOPBACK_PAGES_TAG);
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+
+        if (Flags & LOOPBACK_BUFFER_MIRRORED) mapping = LeylineMapMirrored(mdl, safeSize, &mirrorMdl);
+        if (!mapping)
+            mapping = MmMapLockedPagesSpecifyCache(mdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
+        if (!mapping)
+        {
+            MmFreePagesFromMdl(mdl);
+            IoFreeMdl(mdl);
+            ExFreePoolWithTag(pages, LOOPBACK_PAGES_TAG);
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+    }
+
+    // Without the address space for a mirror the stream still works, splitting copies.
+    if ((Flags & LOOPBACK_BUFFER_MIRRORED) && !mirrorMdl)
+        DbgPrint("Leyline: Buffer not mirrored; copies split at the wrap\n");
+
+    pages->RefCount  = 1;
+    pages->Mdl       = mdl;
+    pages->Mapping   = mapping;
+    pages->MirrorMdl = mirrorMdl;
+    pages->Size      = safeSize;
+    pages->Pool      = block ? Pool : nullptr;
+    pages->Block     = block;
+    UseBufferPages(Stream, pages);
+
+    if (ActualSize) *ActualSize = safeSize;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS LoopbackStreamAllocatePooledBuffer(LoopbackStream* Stream, LeylineBufferPool* Pool,
+                                            ULONG RequestedSize, ULONG Flags, ULONG* ActualSize)
+{
+    ULONG    size   = 0;
+    NTSTATUS status = AllocateStreamBuffer(Stream, Pool, RequestedSize, Flags, &size);
+    if (ActualSize && NT_SUCCESS(status)) *ActualSize = size;
+
+    if (LeylineTraceOn(LEYLINE_KEYWORD_STREAM))
+    {
+        BOOLEAN  ok  = NT_SUCCESS(status);
+        LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
+        LeylineTraceStreamBuffer(Stream, RequestedSize, size, ok && Stream->Pages && Stream->Pages->Block,
+                                 ok && Stream->BufferMirrored, status, now);
+    }
+    return status;
+}
+
+void LoopbackStreamAttachBuffer(LoopbackStream* Stream, PMDL Mdl, PUCHAR Base, ULONG Size)
+{
+    Stream->Mdl     = Mdl;
+    Stream->Mapping = Base;
+    Stream->Pages   = nullptr;
+    Stream->Buffer.Init(Base, Size);
+    StreamBufferChanged(Stream);
+}
+
+void LoopbackStreamFreeBuffer(LoopbackStream* Stream)
+{
+    LoopbackPages* pages = Stream->Pages;
+    if (pages && InterlockedDecrement(&pages->RefCount) == 0)
+    {
+        if (pages->Block)
+        {
+            LeylineBufferPoolRelease(pages->Pool, pages->Block);
+        }
+        else
+        {
+            if (pages->MirrorMdl)
+            {
+                MmUnmapLockedPages(pages->Mapping, pages->MirrorMdl);
+                IoFreeMdl(pages->MirrorMdl);
+            }
+            else
+                MmUnmapLockedPages(pages->Mapping, pages->Mdl);
+            MmFreePagesFromMdl(pages->Mdl);
+            IoFreeMdl(pages->Mdl);
+        }
+        ExFreePoolWithTag(pages, LOOPBACK_PAGES_TAG);
+    }
+    Stream->Mdl     = nullptr;
+    Stream->Mapping = nullptr;
+    Stream->Pages   = nullptr;
+    Stream->Buffer.Init(nullptr, 0);
+    StreamBufferChanged(Stream);
+}
+
+// The render stream's pages count one reference more, taken under StreamLock while it
+// is registered, so it cannot be freeing them; the capture's reference outlives it.
+// The capture reads the frames the render stream played a lag (plus the capture's
+// SafetyFrames) ago, which lie inside the render client's writable window: a client
+// that writes more than the buffer less that lag ahead of its play position overwrites
+// them before the capture reads them. Shared-mode clients keep a period or two queued,
+// so a render buffer of at least 2 x (period + SafetyFrames) leaves them room; nothing
+// here can see how far ahead the client writes, so this is not enforced.
+NTSTATUS LoopbackEngineAliasBuffer(LoopbackEngine* Engine, LoopbackStream* Capture, ULONG RequestedSize,
+                                   ULONG* ActualSize)
+{
+    if (Capture->Mdl) return STATUS_ALREADY_COMMITTED;
+    if (!Capture->IsCapture) return STATUS_NOT_SUPPORTED;
+
+    KIRQL oldIrql;
+    KeAcquireSpinLock(&Engine->StreamLock, &oldIrql);
+
+    LoopbackStream* render = nullptr;
+    PLIST_ENTRY     first  = Engine->RenderStreams.Flink;
+    if (first != &Engine->RenderStreams && first->Flink == &Engine->RenderStreams)
+        render = CONTAINING_RECORD(first, LoopbackStream, ListEntry);
+
+    NTSTATUS status = STATUS_NOT_SUPPORTED;
+    if (render && render->Pages && render->Pages->RefCount == 1 && render->Pages->Size >= RequestedSize &&
+        render->SampleFormat == Capture->SampleFormat && render->Channels == Capture->Channels &&
+        render->ByteRate == Capture->ByteRate && render->FrameBytes == Capture->FrameBytes)
+    {
+        InterlockedIncrement(&render->Pages->RefCount);
+        UseBufferPages(Capture, render->Pages);
+        if (ActualSize) *ActualSize = render->Pages->Size;
+        status = STATUS_SUCCESS;
+    }
+
+    KeReleaseSpinLock(&Engine->StreamLock, oldIrql);
+    return status;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// NOTIFICATION EVENTS
+// The slots change under StreamLock, which the notification callback signals under.
+// The tick signals without it, so a removed event is only dereferenced once the tick
+// that may have read its slot is done: cleared under the lock, then WaitForTick
+// without it. A stream with no engine has neither to race.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline void LockEvents(LoopbackEngine* Engine, KIRQL* OldIrql)
+{
+    if (Engine) KeAcquireSpinLock(&Engine->StreamLock, OldIrql);
+}
+
+static inline void UnlockEvents(LoopbackEngine* Engine, KIRQL OldIrql)
+{
+    if (Engine) KeReleaseSpinLock(&Engine->StreamLock, OldIrql);
+}
+
+static inline void SetEventSlot(LoopbackStream* Stream, int Slot, PKEVENT Event)
+{
+    InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&Stream->NotificationEvents[Slot]), Event);
+}
+
+NTSTATUS LoopbackStreamAddEvent(LoopbackEngine* Engine, LoopbackStream* Stream, PKEVENT Event)
+{
+    if (!Event) return STATUS_INVALID_PARAMETER;
+
+    NTSTATUS status  = STATUS_INSUFFICIENT_RESOURCES;
+    KIRQL    oldIrql = PASSIVE_LEVEL;
+    ObReferenceObject(Event);
+    LockEvents(Engine, &oldIrql);
+    for (int i = 0; i < LEYLINE_MAX_NOTIFICATION_EVENTS; i++)
+    {
+        if (Stream->NotificationEvents[i] == nullptr)
+        {
+            SetEventSlot(Stream, i, Event);
+            status = STATUS_SUCCESS;
+            break;
+        }
+    }
+    UnlockEvents(Engine, oldIrql);
+    if (!NT_SUCCESS(status)) ObDereferenceObject(Event);
+    return status;
+}
+
+NTSTATUS LoopbackStreamRemoveEvent(LoopbackEngine* Engine, LoopbackStream* Stream, PKEVENT Event)
+{
+    if (!Event) return STATUS_INVALID_PARAMETER;
+
+    BOOLEAN found   = FALSE;
+    KIRQL   oldIrql = PASSIVE_LEVEL;
+    LockEvents(Engine, &oldIrql);
+    for (int i = 0; i < LEYLINE_MAX_NOTIFICATION_EVENTS; i++)
+    {
+        if (Stream->NotificationEvents[i] == Event)
+        {
+            SetEventSlot(Stream, i, nullptr);
+            found = TRUE;
+            break;
+        }
+    }
+    UnlockEvents(Engine, oldIrql);
+    if (!found) return STATUS_NOT_FOUND;
+
+    if (Engine) WaitForTick(Engine);
+    ObDereferenceObject(Event);
+    return STATUS_SUCCESS;
+}
+
+void LoopbackStreamReleaseEvents(LoopbackEngine* Engine, LoopbackStream* Stream)
+{
+    PKEVENT released[LEYLINE_MAX_NOTIFICATION_EVENTS];
+    KIRQL   oldIrql = PASSIVE_LEVEL;
+    LockEvents(Engine, &oldIrql);
+    for (int i = 0; i < LEYLINE_MAX_NOTIFICATION_EVENTS; i++)
+    {
+        released[i] = Stream->NotificationEvents[i];
+        if (released[i]) SetEventSlot(Stream, i, nullptr);
+    }
+    UnlockEvents(Engine, oldIrql);
+
+    if (Engine) WaitForTick(Engine);
+    for (int i = 0; i < LEYLINE_MAX_NOTIFICATION_EVENTS; i++)
+    {
+        if (released[i]) ObDereferenceObject(released[i]);
+    }
+}
+
+void LoopbackStreamSignalEvents(LoopbackStream* Stream, ULONGLONG LastPosBytes, ULONGLONG CurrentPosBytes)
+{
+    if (Stream->NotificationBytes == 0) return;
+
+    ULONGLONG lastBoundary    = LastPosBytes / Stream->NotificationBytes;
+    ULONGLONG currentBoundary = CurrentPosBytes / Stream->NotificationBytes;
+
+    if (currentBoundary > lastBoundary) SetStreamEvents(Stream);
+}
@@ -0,0 +1,317 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// AVX2 MIX KERNELS
+// Eight samples per step. The caller must bracket these with LeylineSimdBegin/End so
+// the upper YMM state is saved at DISPATCH_LEVEL. Built with AVX2 code generation
+// enabled for this file only (see CMakeLists.txt / leyline.vcxproj).
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+
+#if LEYLINE_MIXER_X86
+
+#include <immintrin.h>
+
+static inline __m256i Quantize(__m256 bus, __m256 scale, __m256 lo, __m256 hi)
+{
+    __m256 v    = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(bus, scale), lo), hi);
+    __m256 half = _mm256_or_ps(_mm256_and_ps(v, _mm256_set1_ps(-0.0f)), _mm256_set1_ps(0.5f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(v, half));
+}
+
+static inline void StoreInt24x4(UCHAR* Dst, __m128i Packed)
+{
+    // Exactly 12 bytes: never touch the frame after the last sample.
+    LONG tail = _mm_cvtsi128_si32(_mm_srli_si128(Packed, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(Dst), Packed);
+    RtlCopyMemory(Dst + 8, &tail, sizeof(tail));
+}
+
+// Packed int24 <-> one dword per sample, shared by the decode and encode sides. Decoded
+// values are sample << 8, which shares the int32 scale.
+static inline __m256i UnpackInt24x8(const UCHAR* Src)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    __m256i x = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + 12)), 1);
+    return _mm256_shuffle_epi8(x, shuffle);
+}
+
+static inline void PackInt24x8(UCHAR* Dst, __m256i Samples)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i q = _mm256_shuffle_epi8(Samples, shuffle);
+    StoreInt24x4(Dst,      _mm256_castsi256_si128(q));
+    StoreInt24x4(Dst + 12, _mm256_extracti128_si256(q, 1));
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ACCUMULATE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Avx2AccumulateInt16(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / LEYLINE_INT16_SCALE);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 2));
+        __m256  v = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x));
+        _mm256_storeu_ps(Bus + i, _mm256_add_ps(_mm256_loadu_ps(Bus + i), _mm256_mul_ps(v, scale)));
+    }
+    ScalarAccumulateInt16(Bus + i, Src + i * 2, Samples - i);
+}
+
+static void Avx2AccumulateInt24(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    // Each 128-bit lane loads 16 bytes and keeps the first four packed samples. Stop
+    // while the second load still fits in the buffer.
+    const __m256 scale = _mm256_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    ULONG i = 0;
+    for (; (i + 8) * 3 + 4 <= Samples * 3; i += 8)
+    {
+        __m256 v = _mm256_cvtepi32_ps(UnpackInt24x8(Src + i * 3));
+        _mm256_storeu_ps(Bus + i, _mm256_add_ps(_mm256_loadu_ps(Bus + i), _mm256_mul_ps(v, scale)));
+    }
+    ScalarAccumulateInt24(Bus + i, Src + i * 3, Samples - i);
+}
+
+static void Avx2AccumulateInt32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + i * 4)));
+        _mm256_storeu_ps(Bus + i, _mm256_add_ps(_mm256_loadu_ps(Bus + i), _mm256_mul_ps(v, scale)));
+    }
+    ScalarAccumulateInt32(Bus + i, Src + i * 4, Samples - i);
+}
+
+static void Avx2AccumulateFloat32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const float* s = reinterpret_cast<const float*>(Src);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+        _mm256_storeu_ps(Bus + i, _mm256_add_ps(_mm256_loadu_ps(Bus + i), _mm256_loadu_ps(s + i)));
+    ScalarAccumulateFloat32(Bus + i, Src + i * 4, Samples - i);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// WRITE OUT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Avx2WriteOutInt16(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT16_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-32768.0f);
+    const __m256 hi    = _mm256_set1_ps(32767.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256i q = Quantize(_mm256_loadu_ps(Bus + i), scale, lo, hi);
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 2), packed);
+    }
+    ScalarWriteOutInt16(Dst + i * 2, Bus + i, Samples - i, Gain);
+}
+
+static void Avx2WriteOutInt24(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi    = _mm256_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+        PackInt24x8(Dst + i * 3, Quantize(_mm256_loadu_ps(Bus + i), scale, lo, hi));
+    ScalarWriteOutInt24(Dst + i * 3, Bus + i, Samples - i, Gain);
+}
+
+static void Avx2WriteOutInt24In32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi    = _mm256_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256i v = _mm256_slli_epi32(Quantize(_mm256_loadu_ps(Bus + i), scale, lo, hi), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i * 4), v);
+    }
+    ScalarWriteOutInt24In32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+static void Avx2WriteOutInt32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT32_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-LEYLINE_INT32_SCALE);
+    const __m256 hi    = _mm256_set1_ps(LEYLINE_INT32_MAX_FLOAT);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i * 4),
+                            Quantize(_mm256_loadu_ps(Bus + i), scale, lo, hi));
+    }
+    ScalarWriteOutInt32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+static void Avx2WriteOutFloat32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m256 gain = _mm256_set1_ps(Gain);
+    const __m256 lo   = _mm256_set1_ps(-1.0f);
+    const __m256 hi   = _mm256_set1_ps(1.0f);
+    float* d = reinterpret_cast<float*>(Dst);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+        _mm256_storeu_ps(d + i, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(Bus + i), gain), lo), hi));
+    ScalarWriteOutFloat32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALE COPY
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Avx2ScaleCopyInt16(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m256 unit  = _mm256_set1_ps(1.0f / LEYLINE_INT16_SCALE);
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT16_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-32768.0f);
+    const __m256 hi    = _mm256_set1_ps(32767.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 2));
+        __m256  v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x)), unit);
+        __m256i q = Quantize(v, scale, lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 2),
+                         _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1)));
+    }
+    ScalarScaleCopyInt16(Dst + i * 2, Src + i * 2, Samples - i, Gain);
+}
+
+static void Avx2ScaleCopyInt24(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m256 unit  = _mm256_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi    = _mm256_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; (i + 8) * 3 + 4 <= Samples * 3; i += 8)
+    {
+        __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(UnpackInt24x8(Src + i * 3)), unit);
+        PackInt24x8(Dst + i * 3, Quantize(v, scale, lo, hi));
+    }
+    ScalarScaleCopyInt24(Dst + i * 3, Src + i * 3, Samples - i, Gain);
+}
+
+static void Avx2ScaleCopyInt24In32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m256 unit  = _mm256_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi    = _mm256_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + i * 4))), unit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i * 4), _mm256_slli_epi32(Quantize(v, scale, lo, hi), 8));
+    }
+    ScalarScaleCopyInt24In32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+static void Avx2ScaleCopyInt32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m256 unit  = _mm256_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    const __m256 scale = _mm256_set1_ps(LEYLINE_INT32_SCALE * Gain);
+    const __m256 lo    = _mm256_set1_ps(-LEYLINE_INT32_SCALE);
+    const __m256 hi    = _mm256_set1_ps(LEYLINE_INT32_MAX_FLOAT);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + i * 4))), unit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i * 4), Quantize(v, scale, lo, hi));
+    }
+    ScalarScaleCopyInt32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+static void Avx2ScaleCopyFloat32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m256 gain = _mm256_set1_ps(Gain);
+    const __m256 lo   = _mm256_set1_ps(-1.0f);
+    const __m256 hi   = _mm256_set1_ps(1.0f);
+    const float* s = reinterpret_cast<const float*>(Src);
+    float* d = reinterpret_cast<float*>(Dst);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+        _mm256_storeu_ps(d + i, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(s + i), gain), lo), hi));
+    ScalarScaleCopyFloat32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FILTER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+float Avx2Dot(const float* A, const float* B, ULONG Count)
+{
+    // Separate multiply and add: FMA isn't part of the AVX2 baseline we detect.
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    ULONG i = 0;
+    for (; i + 16 <= Count; i += 16)
+    {
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(A + i),     _mm256_loadu_ps(B + i)));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(A + i + 8), _mm256_loadu_ps(B + i + 8)));
+    }
+    if (i < Count)
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(A + i), _mm256_loadu_ps(B + i)));
+
+    __m256 s8 = _mm256_add_ps(s0, s1);
+    __m128 s  = _mm_add_ps(_mm256_castps256_ps128(s8), _mm256_extractf128_ps(s8, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void Avx2Measure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 p = _mm256_loadu_ps(Peak);
+    __m256 s = _mm256_loadu_ps(SumSquares);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m256 v = _mm256_loadu_ps(Bus + i);
+        p = _mm256_max_ps(p, _mm256_and_ps(v, absMask));
+        s = _mm256_add_ps(s, _mm256_mul_ps(v, v));
+    }
+    _mm256_storeu_ps(Peak,       p);
+    _mm256_storeu_ps(SumSquares, s);
+    ScalarMeasure(Bus + i, Samples - i, Peak, SumSquares);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TABLE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+const LeylineMixKernels g_Avx2MixKernels[LeylineSampleFormatCount] =
+{
+    { ScalarAccumulateNone,  ScalarWriteOutNone,    ScalarScaleCopyNone,    LeylineSimdScalar }, // Unsupported
+    { Avx2AccumulateInt16,   Avx2WriteOutInt16,     Avx2ScaleCopyInt16,     LeylineSimdAvx2 },
+    { Avx2AccumulateInt24,   Avx2WriteOutInt24,     Avx2ScaleCopyInt24,     LeylineSimdAvx2 },
+    { Avx2AccumulateInt32,   Avx2WriteOutInt24In32, Avx2ScaleCopyInt24In32, LeylineSimdAvx2 },
+    { Avx2AccumulateInt32,   Avx2WriteOutInt32,     Avx2ScaleCopyInt32,     LeylineSimdAvx2 },
+    { Avx2AccumulateFloat32, Avx2WriteOutFloat32,   Avx2ScaleCopyFloat32,   LeylineSimdAvx2 },
+};
+
+#endif // LEYLINE_MIXER_X86
@@ -0,0 +1,282 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER IMPLEMENTATION
+// Runs in the loopback tick at DISPATCH_LEVEL: no allocation, no CRT. The per-sample
+// work is the lane kernels plus, with loudness on, two biquads per channel.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+#include "leyline_meter.h"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// K-WEIGHTING
+// ITU-R BS.1770 pre-filter, redesigned for the bus rate from its analog prototype so
+// every rate gets the response the standard tabulates at 48 kHz.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static const double c_ShelfHz     = 1681.974450955533;
+static const double c_ShelfQ      = 0.7071752369554196;
+static const double c_ShelfVh     = 1.5848647011308556;   // 10^(3.9998 dB / 20)
+static const double c_ShelfVb     = 1.2587209302325617;   // Vh^0.49967
+static const double c_HighPassHz  = 38.13547087602444;
+static const double c_HighPassQ   = 0.5003270373238773;
+
+// Mean square of a full-scale 997 Hz sine on two channels reads 0 LUFS.
+static const double c_LoudnessOffset = -0.691;
+
+static double TanPi(double x)
+{
+    return MixSinPi(x) / MixCosPi(x);
+}
+
+static void DesignKWeighting(LeylineMeter* Meter)
+{
+    double k  = TanPi(c_ShelfHz / Meter->SampleRate);
+    double kq = k / c_ShelfQ;
+    double a0 = 1.0 + kq + k * k;
+    Meter->Shelf.B0 = (c_ShelfVh + c_ShelfVb * kq + k * k) / a0;
+    Meter->Shelf.B1 = 2.0 * (k * k - c_ShelfVh) / a0;
+    Meter->Shelf.B2 = (c_ShelfVh - c_ShelfVb * kq + k * k) / a0;
+    Meter->Shelf.A1 = 2.0 * (k * k - 1.0) / a0;
+    Meter->Shelf.A2 = (1.0 - kq + k * k) / a0;
+
+    k  = TanPi(c_HighPassHz / Meter->SampleRate);
+    kq = k / c_HighPassQ;
+    a0 = 1.0 + kq + k * k;
+    Meter->HighPass.B0 = 1.0;
+    Meter->HighPass.B1 = -2.0;
+    Meter->HighPass.B2 = 1.0;
+    Meter->HighPass.A1 = 2.0 * (k * k - 1.0) / a0;
+    Meter->HighPass.A2 = (1.0 - kq + k * k) / a0;
+}
+
+// BS.1770 channel weights in WAVEFORMATEXTENSIBLE order: surrounds count 1.41, the
+// LFE of a 5.1 or 7.1 layout not at all.
+static double ChannelWeight(ULONG Channel, ULONG Channels)
+{
+    if (Channels >= 6) return (Channel == 3) ? 0.0 : (Channel >= 4) ? 1.41 : 1.0;
+    if (Channels == 4) return (Channel >= 2) ? 1.41 : 1.0;
+    return 1.0;
+}
+
+static inline double RunBiquad(const LeylineBiquad& F, double* s, double x)
+{
+    // s: x1, x2, y1, y2
+    double y = F.B0 * x + F.B1 * s[0] + F.B2 * s[1] - F.A1 * s[2] - F.A2 * s[3];
+    s[1] = s[0];
+    s[0] = x;
+    s[3] = s[2];
+    s[2] = y;
+    return y;
+}
+
+static void WeightChannels(LeylineMeter* Meter, const float* Bus, ULONG Frames, float Gain)
+{
+    ULONG channels = Meter->Channels;
+    for (ULONG c = 0; c < channels; c++)
+    {
+        double* state = Meter->State[c];
+        double  sum   = 0.0;
+        for (ULONG f = 0; f < Frames; f++)
+        {
+            double x = (double)(Bus[(SIZE_T)f * channels + c] * Gain);
+            double z = RunBiquad(Meter->HighPass, state + 4, RunBiquad(Meter->Shelf, state, x));
+            sum += z * z;
+        }
+        Meter->BlockWeighted[c] += sum;
+
+        // Flush decaying tails before they turn denormal on silence.
+        for (ULONG i = 0; i < 8; i++)
+        {
+            if (state[i] > -1e-20 && state[i] < 1e-20) state[i] = 0.0;
+        }
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MATH
+// Once per block, so accuracy matters more than speed.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static double MeterSqrt(double x)
+{
+    if (x <= 0.0) return 0.0;
+
+    // Halving the exponent is within 6%; Newton doubles the correct digits each step.
+    ULONGLONG bits;
+    RtlCopyMemory(&bits, &x, sizeof(bits));
+    bits = (bits >> 1) + (0x3FF0000000000000ULL >> 1);
+    double y;
+    RtlCopyMemory(&y, &bits, sizeof(y));
+    for (int i = 0; i < 5; i++) y = 0.5 * (y + x / y);
+    return y;
+}
+
+static double MeterLog10(double x)
+{
+    // x = m * 2^e with m in [sqrt(1/2), sqrt(2)), then ln(m) = 2 atanh((m - 1) / (m + 1)).
+    ULONGLONG bits;
+    RtlCopyMemory(&bits, &x, sizeof(bits));
+    LONG e = (LONG)((bits >> 52) & 0x7FF) - 1023;
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    RtlCopyMemory(&m, &bits, sizeof(m));
+    if (m > 1.4142135623730951)
+    {
+        m *= 0.5;
+        e++;
+    }
+
+    double z  = (m - 1.0) / (m + 1.0);
+    double z2 = z * z;
+    double ln = 2.0 * z * (1.0 + z2 * (1.0 / 3 + z2 * (1.0 / 5 + z2 * (1.0 / 7 + z2 * (1.0 / 9 + z2 / 11)))));
+    return (e * 0.6931471805599453 + ln) * 0.4342944819032518;
+}
+
+static float LoudnessFromPower(double power)
+{
+    // Below -120 LUFS is silence for any practical reader.
+    if (power < 1e-12) return LEYLINE_METER_SILENCE_LUFS;
+    return (float)(c_LoudnessOffset + 10.0 * MeterLog10(power));
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MEASUREMENT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LeylineMeasureFn SelectMeasure(LeylineSimdLevel Level)
+{
+#if LEYLINE_MIXER_X86
+    if (Level >= LeylineSimdAvx2) return Avx2Measure;
+    if (Level >= LeylineSimdSse2) return Sse2Measure;
+#else
+    UNREFERENCED_PARAMETER(Level);
+#endif
+    return ScalarMeasure;
+}
+
+void LeylineMeterReset(LeylineMeter* Meter, ULONG SampleRate, ULONG Channels, BOOLEAN Loudness)
+{
+    RtlZeroMemory(Meter, sizeof(*Meter));
+    Meter->Levels.Loudness = LEYLINE_METER_SILENCE_LUFS;
+    if (SampleRate == 0 || Channels == 0) return;
+
+    Meter->SampleRate  = SampleRate;
+    Meter->Channels    = min(Channels, (ULONG)LEYLINE_MAX_CHANNELS);
+    Meter->Loudness    = Loudness;
+    Meter->BlockFrames = max(SampleRate / 1000 * LEYLINE_METER_BLOCK_MS, (ULONG)1);
+    DesignKWeighting(Meter);
+}
+
+static void MeasureFrames(LeylineMeter* Meter, const float* Bus, ULONG Frames, float Gain, LeylineSimdLevel Level)
+{
+    ULONG channels = Meter->Channels;
+    float peak[LEYLINE_METER_LANES] = {};
+    float sum[LEYLINE_METER_LANES]  = {};
+
+    if (LEYLINE_METER_LANES % channels == 0)
+    {
+        // Lane l holds channel l % channels; fold in a fixed order.
+        SelectMeasure(Level)(Bus, Frames * channels, peak, sum);
+        for (ULONG l = channels; l < LEYLINE_METER_LANES; l++)
+        {
+            ULONG c = l % channels;
+            if (peak[l] > peak[c]) peak[c] = peak[l];
+            sum[c] += sum[l];
+        }
+    }
+    else
+    {
+        for (ULONG f = 0; f < Frames; f++)
+        {
+            for (ULONG c = 0; c < channels; c++)
+            {
+                float v = Bus[(SIZE_T)f * channels + c];
+                float a = (v < 0.0f) ? -v : v;
+                if (a > peak[c]) peak[c] = a;
+                sum[c] += v * v;
+            }
+        }
+    }
+
+    double power = (double)Gain * Gain;
+    for (ULONG c = 0; c < channels; c++)
+    {
+        float p = peak[c] * Gain;
+        if (p > Meter->BlockPeak[c]) Meter->BlockPeak[c] = p;
+        if (p > Meter->PeakHold[c])  Meter->PeakHold[c]  = p;
+        Meter->BlockEnergy[c] += sum[c] * power;
+    }
+
+    if (Meter->Loudness) WeightChannels(Meter, Bus, Frames, Gain);
+}
+
+static void SettleBlock(LeylineMeter* Meter)
+{
+    ULONG  channels = Meter->Channels;
+    double frames   = (double)Meter->BlockFrames;
+    double power    = 0.0;
+
+    for (ULONG c = 0; c < LEYLINE_MAX_CHANNELS; c++)
+    {
+        BOOLEAN live = c < channels;
+        Meter->Levels.Peak[c] = live ? Meter->BlockPeak[c] : 0.0f;
+        Meter->Levels.Rms[c]  = live ? (float)MeterSqrt(Meter->BlockEnergy[c] / frames) : 0.0f;
+        if (live) power += ChannelWeight(c, channels) * Meter->BlockWeighted[c] / frames;
+
+        Meter->BlockPeak[c]     = 0.0f;
+        Meter->BlockEnergy[c]   = 0.0;
+        Meter->BlockWeighted[c] = 0.0;
+    }
+
+    if (Meter->Loudness)
+    {
+        Meter->LoudnessHistory[Meter->LoudnessIndex] = power;
+        Meter->LoudnessIndex = (Meter->LoudnessIndex + 1) % LEYLINE_METER_LOUDNESS_BLOCKS;
+        if (Meter->LoudnessCount < LEYLINE_METER_LOUDNESS_BLOCKS) Meter->LoudnessCount++;
+
+        double mean = 0.0;
+        for (ULONG i = 0; i < Meter->LoudnessCount; i++) mean += Meter->LoudnessHistory[i];
+        Meter->Levels.Loudness = LoudnessFromPower(mean / Meter->LoudnessCount);
+    }
+
+    Meter->BlockFill = 0;
+    Meter->Blocks++;
+}
+
+BOOLEAN LeylineMeterProcess(LeylineMeter* Meter, const float* Bus, ULONG Frames, float Gain,
+                            LeylineSimdLevel Level)
+{
+    if (Meter->SampleRate == 0) return FALSE;
+
+    BOOLEAN settled = FALSE;
+    while (Frames > 0)
+    {
+        ULONG n = min(Frames, Meter->BlockFrames - Meter->BlockFill);
+        MeasureFrames(Meter, Bus, n, Gain, Level);
+        Bus              += (SIZE_T)n * Meter->Channels;
+        Frames           -= n;
+        Meter->BlockFill += n;
+
+        if (Meter->BlockFill == Meter->BlockFrames)
+        {
+            SettleBlock(Meter);
+            settled = TRUE;
+        }
+    }
+    return settled;
+}
+
+float LeylineMeterTakePeak(LeylineMeter* Meter, ULONG Channel)
+{
+    if (Channel >= LEYLINE_MAX_CHANNELS) return 0.0f;
+
+    // Exchanged, as the tick may be raising it: a peak that lands meanwhile is
+    // reported now or by the next take, never lost.
+    LONG bits = InterlockedExchange(reinterpret_cast<volatile LONG*>(&Meter->PeakHold[Channel]), 0);
+    float peak;
+    RtlCopyMemory(&peak, &bits, sizeof(peak));
+    return peak;
+}
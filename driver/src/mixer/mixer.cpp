@@ -0,0 +1,192 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MIXER IMPLEMENTATION
+// Format classification, CPU feature detection and kernel selection, the scalar
+// strided paths used when render and capture channel counts differ, and master gain.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+
+LeylineSampleFormat LeylineSampleFormatOf(ULONG BitsPerSample, ULONG ValidBitsPerSample, BOOLEAN IsFloat)
+{
+    if (IsFloat) return (BitsPerSample == 32) ? LeylineSampleFloat32 : LeylineSampleUnsupported;
+
+    switch (BitsPerSample)
+    {
+    case 16: return LeylineSampleInt16;
+    case 24: return LeylineSampleInt24;
+    case 32: return (ValidBitsPerSample == 24) ? LeylineSampleInt24In32 : LeylineSampleInt32;
+    default: return LeylineSampleUnsupported;
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// KERNEL SELECTION
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LONG s_SimdLevel = -1;
+
+LeylineSimdLevel LeylineDetectSimdLevel()
+{
+    LONG level = s_SimdLevel;
+    if (level >= 0) return (LeylineSimdLevel)level;
+
+#if LEYLINE_MIXER_X86
+    level = LeylineSimdSse2; // Architectural on x64
+
+#if defined(PF_AVX2_INSTRUCTIONS_AVAILABLE)
+    // The CPU must have AVX2 and the OS must be managing the YMM state.
+    if (ExIsProcessorFeaturePresent(PF_AVX2_INSTRUCTIONS_AVAILABLE) &&
+        (RtlGetEnabledExtendedFeatures(XSTATE_MASK_AVX) & XSTATE_MASK_AVX))
+    {
+        level = LeylineSimdAvx2;
+    }
+#endif
+#else
+    level = LeylineSimdScalar;
+#endif
+
+    // Benign race: every caller computes the same answer.
+    InterlockedExchange(&s_SimdLevel, level);
+    return (LeylineSimdLevel)level;
+}
+
+const LeylineMixKernels* LeylineSelectMixKernels(LeylineSampleFormat Format, LeylineSimdLevel Level)
+{
+    if ((ULONG)Format >= LeylineSampleFormatCount) Format = LeylineSampleUnsupported;
+
+#if LEYLINE_MIXER_X86
+    if (Level >= LeylineSimdAvx2) return &g_Avx2MixKernels[Format];
+    if (Level >= LeylineSimdSse2) return &g_Sse2MixKernels[Format];
+#else
+    UNREFERENCED_PARAMETER(Level);
+#endif
+    return &g_ScalarMixKernels[Format];
+}
+
+LeylineSimdLevel LeylineSimdBegin(LeylineSimdLevel Wanted, PXSTATE_SAVE Save)
+{
+    if (Wanted < LeylineSimdAvx2) return Wanted;
+
+    // Fall back to SSE2 for this batch rather than fail the tick.
+    if (!NT_SUCCESS(KeSaveExtendedProcessorState(XSTATE_MASK_AVX, Save))) return LeylineSimdSse2;
+    return LeylineSimdAvx2;
+}
+
+void LeylineSimdEnd(LeylineSimdLevel Level, PXSTATE_SAVE Save)
+{
+    if (Level >= LeylineSimdAvx2) KeRestoreExtendedProcessorState(Save);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STRIDED PATHS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void MixAccumulate(float* Bus, ULONG BusChannels,
+                   const UCHAR* Src, LeylineSampleFormat Format, ULONG SrcChannels,
+                   ULONG Frames)
+{
+    if (SrcChannels == BusChannels)
+    {
+        LeylineSelectMixKernels(Format, LeylineSimdScalar)->Accumulate(Bus, Src, Frames * BusChannels);
+        return;
+    }
+
+    ULONG channels = min(SrcChannels, BusChannels);
+    for (ULONG f = 0; f < Frames; f++)
+    {
+        for (ULONG c = 0; c < channels; c++)
+            Bus[f * BusChannels + c] += MixDecodeSample(Src, Format, f * SrcChannels + c);
+    }
+}
+
+void MixWriteOut(UCHAR* Dst, LeylineSampleFormat Format, ULONG DstChannels,
+                 const float* Bus, ULONG BusChannels, ULONG Frames, float Gain)
+{
+    if (DstChannels == BusChannels)
+    {
+        LeylineSelectMixKernels(Format, LeylineSimdScalar)->WriteOut(Dst, Bus, Frames * BusChannels, Gain);
+        return;
+    }
+
+    // The encode scales are powers of two, so scaling first rounds the same way as
+    // the kernels' folded scale.
+    for (ULONG f = 0; f < Frames; f++)
+    {
+        for (ULONG c = 0; c < DstChannels; c++)
+        {
+            float v = (c < BusChannels) ? Bus[f * BusChannels + c] * Gain : 0.0f;
+            MixEncodeSample(Dst, Format, f * DstChannels + c, v);
+        }
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MASTER GAIN
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// 10^(-dB/20) for 0..96 dB.
+static const float c_GainWholeDb[97] =
+{
+    1.000000000e+00f, 8.912509381e-01f, 7.943282347e-01f, 7.079457844e-01f,
+    6.309573445e-01f, 5.623413252e-01f, 5.011872336e-01f, 4.466835922e-01f,
+    3.981071706e-01f, 3.548133892e-01f, 3.162277660e-01f, 2.818382931e-01f,
+    2.511886432e-01f, 2.238721139e-01f, 1.995262315e-01f, 1.778279410e-01f,
+    1.584893192e-01f, 1.412537545e-01f, 1.258925412e-01f, 1.122018454e-01f,
+    1.000000000e-01f, 8.912509381e-02f, 7.943282347e-02f, 7.079457844e-02f,
+    6.309573445e-02f, 5.623413252e-02f, 5.011872336e-02f, 4.466835922e-02f,
+    3.981071706e-02f, 3.548133892e-02f, 3.162277660e-02f, 2.818382931e-02f,
+    2.511886432e-02f, 2.238721139e-02f, 1.995262315e-02f, 1.778279410e-02f,
+    1.584893192e-02f, 1.412537545e-02f, 1.258925412e-02f, 1.122018454e-02f,
+    1.000000000e-02f, 8.912509381e-03f, 7.943282347e-03f, 7.079457844e-03f,
+    6.309573445e-03f, 5.623413252e-03f, 5.011872336e-03f, 4.466835922e-03f,
+    3.981071706e-03f, 3.548133892e-03f, 3.162277660e-03f, 2.818382931e-03f,
+    2.511886432e-03f, 2.238721139e-03f, 1.995262315e-03f, 1.778279410e-03f,
+    1.584893192e-03f, 1.412537545e-03f, 1.258925412e-03f, 1.122018454e-03f,
+    1.000000000e-03f, 8.912509381e-04f, 7.943282347e-04f, 7.079457844e-04f,
+    6.309573445e-04f, 5.623413252e-04f, 5.011872336e-04f, 4.466835922e-04f,
+    3.981071706e-04f, 3.548133892e-04f, 3.162277660e-04f, 2.818382931e-04f,
+    2.511886432e-04f, 2.238721139e-04f, 1.995262315e-04f, 1.778279410e-04f,
+    1.584893192e-04f, 1.412537545e-04f, 1.258925412e-04f, 1.122018454e-04f,
+    1.000000000e-04f, 8.912509381e-05f, 7.943282347e-05f, 7.079457844e-05f,
+    6.309573445e-05f, 5.623413252e-05f, 5.011872336e-05f, 4.466835922e-05f,
+    3.981071706e-05f, 3.548133892e-05f, 3.162277660e-05f, 2.818382931e-05f,
+    2.511886432e-05f, 2.238721139e-05f, 1.995262315e-05f, 1.778279410e-05f,
+    1.584893192e-05f
+};
+
+// 10^(-dB/20) for 0..15/16 dB.
+static const float c_GainSixteenthDb[16] =
+{
+    1.000000000f, 0.992830248f, 0.985711901f, 0.978644591f,
+    0.971627952f, 0.964661620f, 0.957745235f, 0.950878439f,
+    0.944060876f, 0.937292194f, 0.930572041f, 0.923900070f,
+    0.917275935f, 0.910699294f, 0.904169806f, 0.897687132f
+};
+
+float LeylineGainFromVolume(LONG Level)
+{
+    if (Level >= LEYLINE_VOLUME_MAX) return 1.0f;
+    if (Level <= LEYLINE_VOLUME_MIN) return c_GainWholeDb[96];
+
+    // Attenuation in 1/16 dB, rounded to nearest.
+    ULONG sixteenths = ((ULONG)(-Level) + 0x800) >> 12;
+    ULONG whole      = sixteenths >> 4;
+    if (whole >= 96) return c_GainWholeDb[96];
+    return c_GainWholeDb[whole] * c_GainSixteenthDb[sixteenths & 15];
+}
+
+float MixApplyGainRamp(float* Bus, ULONG Channels, ULONG Frames, float Gain, float Target, float Step)
+{
+    for (ULONG f = 0; f < Frames; f++)
+    {
+        Gain += Step;
+        if ((Step >= 0.0f) ? (Gain >= Target) : (Gain <= Target)) Gain = Target;
+
+        float* frame = Bus + (SIZE_T)f * Channels;
+        for (ULONG c = 0; c < Channels; c++) frame[c] *= Gain;
+    }
+    return Gain;
+}
@@ -0,0 +1,196 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// INTERNAL LEYLINE MIXER DECLARATIONS
+// These are only shared within the mixer/ folder.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_mixer.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define LEYLINE_MIXER_X86 1
+#else
+#define LEYLINE_MIXER_X86 0
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALE FACTORS
+// Powers of two, so decode is exact and every level rounds identically.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_INT16_SCALE     32768.0f
+#define LEYLINE_INT24_SCALE     8388608.0f
+#define LEYLINE_INT32_SCALE     2147483648.0f
+
+// Largest float below 2^31; anything above would overflow the LONG conversion.
+#define LEYLINE_INT32_MAX_FLOAT 2147483520.0f
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALAR SAMPLE HELPERS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline float MixClamp(float v, float lo, float hi)
+{
+    v = (v < lo) ? lo : v;
+    return (v > hi) ? hi : v;
+}
+
+// Round half away from zero without the CRT. The SIMD kernels add the same signed
+// half and truncate, so results match the scalar path bit for bit.
+static inline LONG MixRound(float v)
+{
+    return (LONG)(v + ((v >= 0.0f) ? 0.5f : -0.5f));
+}
+
+static inline LONG MixReadInt24(const UCHAR* p)
+{
+    return (LONG)(((ULONG)p[0] << 8) | ((ULONG)p[1] << 16) | ((ULONG)p[2] << 24)) >> 8;
+}
+
+static inline void MixWriteInt24(UCHAR* p, LONG s)
+{
+    p[0] = (UCHAR)(s);
+    p[1] = (UCHAR)(s >> 8);
+    p[2] = (UCHAR)(s >> 16);
+}
+
+static inline float MixDecodeSample(const UCHAR* src, LeylineSampleFormat format, ULONG index)
+{
+    switch (format)
+    {
+    case LeylineSampleInt16:
+        return reinterpret_cast<const SHORT*>(src)[index] * (1.0f / LEYLINE_INT16_SCALE);
+    case LeylineSampleInt24:
+        return MixReadInt24(src + index * 3) * (1.0f / LEYLINE_INT24_SCALE);
+    case LeylineSampleInt24In32:
+    case LeylineSampleInt32:
+        return reinterpret_cast<const LONG*>(src)[index] * (1.0f / LEYLINE_INT32_SCALE);
+    case LeylineSampleFloat32:
+        return reinterpret_cast<const float*>(src)[index];
+    default:
+        return 0.0f;
+    }
+}
+
+static inline void MixEncodeSample(UCHAR* dst, LeylineSampleFormat format, ULONG index, float v)
+{
+    switch (format)
+    {
+    case LeylineSampleInt16:
+        reinterpret_cast<SHORT*>(dst)[index] =
+            (SHORT)MixRound(MixClamp(v * LEYLINE_INT16_SCALE, -32768.0f, 32767.0f));
+        break;
+    case LeylineSampleInt24:
+        MixWriteInt24(dst + index * 3, MixRound(MixClamp(v * LEYLINE_INT24_SCALE, -8388608.0f, 8388607.0f)));
+        break;
+    case LeylineSampleInt24In32:
+        reinterpret_cast<LONG*>(dst)[index] =
+            (LONG)((ULONG)MixRound(MixClamp(v * LEYLINE_INT24_SCALE, -8388608.0f, 8388607.0f)) << 8);
+        break;
+    case LeylineSampleInt32:
+        reinterpret_cast<LONG*>(dst)[index] =
+            MixRound(MixClamp(v * LEYLINE_INT32_SCALE, -LEYLINE_INT32_SCALE, LEYLINE_INT32_MAX_FLOAT));
+        break;
+    case LeylineSampleFloat32:
+        reinterpret_cast<float*>(dst)[index] = MixClamp(v, -1.0f, 1.0f);
+        break;
+    default:
+        break;
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// KERNEL TABLES
+// Indexed by LeylineSampleFormat. SIMD levels hand their tails to the scalar kernels.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void ScalarAccumulateNone(float* Bus, const UCHAR* Src, ULONG Samples);
+void ScalarAccumulateInt16(float* Bus, const UCHAR* Src, ULONG Samples);
+void ScalarAccumulateInt24(float* Bus, const UCHAR* Src, ULONG Samples);
+void ScalarAccumulateInt32(float* Bus, const UCHAR* Src, ULONG Samples);
+void ScalarAccumulateFloat32(float* Bus, const UCHAR* Src, ULONG Samples);
+
+void ScalarWriteOutNone(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+void ScalarWriteOutInt16(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+void ScalarWriteOutInt24(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+void ScalarWriteOutInt24In32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+void ScalarWriteOutInt32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+void ScalarWriteOutFloat32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain);
+
+void ScalarScaleCopyNone(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+void ScalarScaleCopyInt16(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+void ScalarScaleCopyInt24(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+void ScalarScaleCopyInt24In32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+void ScalarScaleCopyInt32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+void ScalarScaleCopyFloat32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain);
+
+extern const LeylineMixKernels g_ScalarMixKernels[LeylineSampleFormatCount];
+
+#if LEYLINE_MIXER_X86
+extern const LeylineMixKernels g_Sse2MixKernels[LeylineSampleFormatCount];
+extern const LeylineMixKernels g_Avx2MixKernels[LeylineSampleFormatCount];
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FILTER KERNELS
+// Dot product for the resampler's polyphase filters. Count is a multiple of 8. The
+// SIMD levels sum in a different order, so they are close to scalar but not identical.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef float (*LeylineDotFn)(const float* A, const float* B, ULONG Count);
+
+float ScalarDot(const float* A, const float* B, ULONG Count);
+
+#if LEYLINE_MIXER_X86
+float Sse2Dot(const float* A, const float* B, ULONG Count);
+float Avx2Dot(const float* A, const float* B, ULONG Count);
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER KERNELS
+// Peak and sum of squares of interleaved bus samples, kept per lane (sample index mod
+// 8) and added into Peak[8] and SumSquares[8]. Every level adds in the same lane order,
+// so results are bit-identical; the caller folds lanes into channels.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_METER_LANES 8
+
+typedef void (*LeylineMeasureFn)(const float* Bus, ULONG Samples, float* Peak, float* SumSquares);
+
+void ScalarMeasure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares);
+
+#if LEYLINE_MIXER_X86
+void Sse2Measure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares);
+void Avx2Measure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares);
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DOUBLE-PRECISION MATH
+// No CRT in the driver, so filter design does its own trigonometry.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define LEYLINE_PI 3.14159265358979323846
+
+static inline double MixFloor(double x)
+{
+    double n = (double)(LONGLONG)x;
+    return (x < n) ? n - 1.0 : n;
+}
+
+// sin(pi * x): reduce to [-1/2, 1/2], where the Taylor series below is good to 1e-12.
+static inline double MixSinPi(double x)
+{
+    x -= 2.0 * MixFloor((x + 1.0) * 0.5);
+    if (x > 0.5)  x = 1.0 - x;
+    if (x < -0.5) x = -1.0 - x;
+
+    double y  = x * LEYLINE_PI;
+    double y2 = y * y;
+    return y * (1.0 - y2 / 6.0 * (1.0 - y2 / 20.0 * (1.0 - y2 / 42.0 * (1.0 - y2 / 72.0 *
+           (1.0 - y2 / 110.0 * (1.0 - y2 / 156.0 * (1.0 - y2 / 210.0)))))));
+}
+
+static inline double MixCosPi(double x) { return MixSinPi(x + 0.5); }
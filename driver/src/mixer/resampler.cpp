@@ -0,0 +1,241 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// RESAMPLER IMPLEMENTATION
+// Filter design runs once per rate pair at PASSIVE_LEVEL; the streaming half is a
+// phase walk and one dot product per output sample, safe at DISPATCH_LEVEL.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+#include "leyline_resampler.h"
+
+#define LEYLINE_RESAMPLE_TAG 'LLRS'
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FILTER DESIGN
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static const ULONG  c_BaseTaps[LeylineResampleQualityCount] = { 16, 32, 64 };
+static const double c_Cutoff[LeylineResampleQualityCount]   = { 0.70, 0.85, 0.92 };
+
+static inline double Sinc(double x)
+{
+    return (x == 0.0) ? 1.0 : MixSinPi(x) / (LEYLINE_PI * x);
+}
+
+// Four-term Blackman-Harris over [-1, 1]; about 92 dB of sidelobe rejection.
+static inline double Window(double x)
+{
+    return 0.35875 + 0.48829 * MixCosPi(x) + 0.14128 * MixCosPi(2.0 * x) + 0.01168 * MixCosPi(3.0 * x);
+}
+
+static ULONG Gcd(ULONG a, ULONG b)
+{
+    while (b)
+    {
+        ULONG t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+NTSTATUS LeylineResampleTableCreate(ULONG InRate, ULONG OutRate, LeylineResampleQuality Quality,
+                                    LeylineResampleTable** Table)
+{
+    if (!Table) return STATUS_INVALID_PARAMETER;
+    *Table = nullptr;
+    if (InRate == 0 || OutRate == 0 || (ULONG)Quality >= LeylineResampleQualityCount)
+        return STATUS_INVALID_PARAMETER;
+
+    ULONG gcd    = Gcd(InRate, OutRate);
+    ULONG phases = OutRate / gcd;
+    ULONG step   = InRate / gcd;
+    if (phases > LEYLINE_RESAMPLE_MAX_PHASES) return STATUS_INVALID_PARAMETER;
+
+    // Decimating lowers the cutoff, so the filter widens to keep the same transition
+    // band measured at the output rate.
+    ULONGLONG taps = c_BaseTaps[Quality];
+    if (step > phases) taps = (taps * step + phases - 1) / phases;
+    taps = (taps + 7) & ~7ULL;
+    if (taps > LEYLINE_RESAMPLE_MAX_TAPS) taps = LEYLINE_RESAMPLE_MAX_TAPS;
+
+    SIZE_T bytes = sizeof(LeylineResampleTable) + 32 + (SIZE_T)phases * (SIZE_T)taps * sizeof(float);
+    LeylineResampleTable* table = static_cast<LeylineResampleTable*>(
+        ExAllocatePool2(POOL_FLAG_NON_PAGED, bytes, LEYLINE_RESAMPLE_TAG));
+    if (!table) return STATUS_INSUFFICIENT_RESOURCES;
+
+    table->InRate  = InRate;
+    table->OutRate = OutRate;
+    table->Quality = Quality;
+    table->Phases  = phases;
+    table->Step    = step;
+    table->Taps    = (ULONG)taps;
+    table->Coefs   = reinterpret_cast<float*>(((ULONG_PTR)(table + 1) + 31) & ~(ULONG_PTR)31);
+
+    // Cutoff as a fraction of the input Nyquist; the lower of the two rates governs.
+    double cutoff = c_Cutoff[Quality] * ((phases < step) ? (double)phases / step : 1.0);
+    double half   = (double)(taps / 2);
+
+    for (ULONG p = 0; p < phases; p++)
+    {
+        // Tap m reads input frame (i - taps/2 + 1 + m) for an output at i + p/phases.
+        float* coefs = table->Coefs + (SIZE_T)p * taps;
+        double frac  = (double)p / phases;
+        double sum   = 0.0;
+        double h[LEYLINE_RESAMPLE_MAX_TAPS];
+
+        for (ULONG m = 0; m < taps; m++)
+        {
+            double t = frac + half - 1.0 - m;
+            h[m] = cutoff * Sinc(cutoff * t) * Window(t / half);
+            sum += h[m];
+        }
+
+        // Unity DC gain on every phase, so a constant input stays ripple-free.
+        for (ULONG m = 0; m < taps; m++) coefs[m] = (float)(h[m] / sum);
+    }
+
+    *Table = table;
+    return STATUS_SUCCESS;
+}
+
+void LeylineResampleTableFree(LeylineResampleTable* Table)
+{
+    if (Table) ExFreePoolWithTag(Table, LEYLINE_RESAMPLE_TAG);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAMING
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LeylineDotFn SelectDot(LeylineSimdLevel Level)
+{
+#if LEYLINE_MIXER_X86
+    if (Level >= LeylineSimdAvx2) return Avx2Dot;
+    if (Level >= LeylineSimdSse2) return Sse2Dot;
+#else
+    UNREFERENCED_PARAMETER(Level);
+#endif
+    return ScalarDot;
+}
+
+static inline float* HistoryPlane(const LeylineResampler* Resampler, ULONG Channel)
+{
+    return Resampler->History + (SIZE_T)Channel * LEYLINE_RESAMPLE_HISTORY;
+}
+
+NTSTATUS LeylineResamplerAllocate(LeylineResampler* Resampler, ULONG MaxChannels)
+{
+    RtlZeroMemory(Resampler, sizeof(*Resampler));
+    if (MaxChannels == 0 || MaxChannels > LEYLINE_MAX_CHANNELS) return STATUS_INVALID_PARAMETER;
+
+    SIZE_T bytes = (SIZE_T)MaxChannels * LEYLINE_RESAMPLE_HISTORY * sizeof(float);
+    Resampler->History = static_cast<float*>(ExAllocatePool2(POOL_FLAG_NON_PAGED, bytes, LEYLINE_RESAMPLE_TAG));
+    if (!Resampler->History) return STATUS_INSUFFICIENT_RESOURCES;
+
+    Resampler->MaxChannels = MaxChannels;
+    return STATUS_SUCCESS;
+}
+
+void LeylineResamplerFree(LeylineResampler* Resampler)
+{
+    if (Resampler->History) ExFreePoolWithTag(Resampler->History, LEYLINE_RESAMPLE_TAG);
+    RtlZeroMemory(Resampler, sizeof(*Resampler));
+}
+
+void LeylineResamplerReset(LeylineResampler* Resampler, const LeylineResampleTable* Table, ULONG Channels)
+{
+    Resampler->Table    = Resampler->History ? Table : nullptr;
+    Resampler->Channels = min(Channels, Resampler->MaxChannels);
+    Resampler->Phase    = 0;
+    Resampler->Offset   = 0;
+    Resampler->Fill     = 0;
+    if (!Resampler->Table) return;
+
+    // Pre-roll with silence so the first output is centred on the first input frame.
+    Resampler->Fill = Table->Taps / 2 - 1;
+    for (ULONG c = 0; c < Resampler->Channels; c++)
+        RtlZeroMemory(HistoryPlane(Resampler, c), Resampler->Fill * sizeof(float));
+}
+
+ULONG LeylineResamplerInputNeeded(const LeylineResampler* Resampler, ULONG OutFrames)
+{
+    const LeylineResampleTable* table = Resampler->Table;
+    if (!table || OutFrames == 0) return 0;
+
+    ULONGLONG last = Resampler->Offset + table->Taps +
+                     (Resampler->Phase + (ULONGLONG)(OutFrames - 1) * table->Step) / table->Phases;
+    return (last > Resampler->Fill) ? (ULONG)(last - Resampler->Fill) : 0;
+}
+
+ULONG LeylineResamplerPush(LeylineResampler* Resampler, const float* In, ULONG InChannels, ULONG Frames)
+{
+    if (!Resampler->Table) return 0;
+
+    // Slide the live window to the front once the tail is out of room.
+    if (Resampler->Fill + Frames > LEYLINE_RESAMPLE_HISTORY && Resampler->Offset > 0)
+    {
+        ULONG shift = min(Resampler->Offset, Resampler->Fill);
+        for (ULONG c = 0; c < Resampler->Channels; c++)
+        {
+            float* plane = HistoryPlane(Resampler, c);
+            RtlMoveMemory(plane, plane + shift, (SIZE_T)(Resampler->Fill - shift) * sizeof(float));
+        }
+        Resampler->Fill   -= shift;
+        Resampler->Offset -= shift;
+    }
+
+    ULONG accepted = min(Frames, (ULONG)LEYLINE_RESAMPLE_HISTORY - Resampler->Fill);
+    for (ULONG c = 0; c < Resampler->Channels; c++)
+    {
+        float* plane = HistoryPlane(Resampler, c) + Resampler->Fill;
+        if (In && c < InChannels)
+        {
+            for (ULONG f = 0; f < accepted; f++) plane[f] = In[(SIZE_T)f * InChannels + c];
+        }
+        else
+        {
+            RtlZeroMemory(plane, (SIZE_T)accepted * sizeof(float));
+        }
+    }
+
+    Resampler->Fill += accepted;
+    return accepted;
+}
+
+ULONG LeylineResamplerPull(LeylineResampler* Resampler, float* Out, ULONG OutChannels,
+                           ULONG MaxFrames, BOOLEAN Accumulate, LeylineSimdLevel Level)
+{
+    const LeylineResampleTable* table = Resampler->Table;
+    if (!table) return 0;
+
+    LeylineDotFn dot   = SelectDot(Level);
+    ULONG taps         = table->Taps;
+    ULONG channels     = min(Resampler->Channels, OutChannels);
+    ULONG produced     = 0;
+
+    while (produced < MaxFrames && Resampler->Offset + taps <= Resampler->Fill)
+    {
+        const float* coefs = table->Coefs + (SIZE_T)Resampler->Phase * taps;
+        float*       out   = Out + (SIZE_T)produced * OutChannels;
+
+        for (ULONG c = 0; c < channels; c++)
+        {
+            float v = dot(coefs, HistoryPlane(Resampler, c) + Resampler->Offset, taps);
+            out[c]  = Accumulate ? out[c] + v : v;
+        }
+        if (!Accumulate)
+        {
+            for (ULONG c = channels; c < OutChannels; c++) out[c] = 0.0f;
+        }
+
+        // Advance by M/L input frames: whole frames move the window, the rest the phase.
+        Resampler->Phase  += table->Step;
+        Resampler->Offset += Resampler->Phase / table->Phases;
+        Resampler->Phase  %= table->Phases;
+        produced++;
+    }
+    return produced;
+}
@@ -0,0 +1,184 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALAR MIX KERNELS
+// Reference conversions and the fallback on CPUs without SSE2 (host builds only; the
+// driver is x64). Plain linear loops, so the compiler may still vectorize them.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ACCUMULATE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void ScalarAccumulateNone(float* /*Bus*/, const UCHAR* /*Src*/, ULONG /*Samples*/)
+{
+}
+
+void ScalarAccumulateInt16(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const SHORT* s = reinterpret_cast<const SHORT*>(Src);
+    for (ULONG i = 0; i < Samples; i++) Bus[i] += s[i] * (1.0f / LEYLINE_INT16_SCALE);
+}
+
+void ScalarAccumulateInt24(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    for (ULONG i = 0; i < Samples; i++) Bus[i] += MixReadInt24(Src + i * 3) * (1.0f / LEYLINE_INT24_SCALE);
+}
+
+// Also decodes int24-in-32: the valid bits are left-justified, so the scale is the same.
+void ScalarAccumulateInt32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const LONG* s = reinterpret_cast<const LONG*>(Src);
+    for (ULONG i = 0; i < Samples; i++) Bus[i] += s[i] * (1.0f / LEYLINE_INT32_SCALE);
+}
+
+void ScalarAccumulateFloat32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const float* s = reinterpret_cast<const float*>(Src);
+    for (ULONG i = 0; i < Samples; i++) Bus[i] += s[i];
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// WRITE OUT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void ScalarWriteOutNone(UCHAR* /*Dst*/, const float* /*Bus*/, ULONG /*Samples*/, float /*Gain*/)
+{
+}
+
+void ScalarWriteOutInt16(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT16_SCALE * Gain;
+    SHORT* d = reinterpret_cast<SHORT*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+        d[i] = (SHORT)MixRound(MixClamp(Bus[i] * scale, -32768.0f, 32767.0f));
+}
+
+void ScalarWriteOutInt24(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT24_SCALE * Gain;
+    for (ULONG i = 0; i < Samples; i++)
+        MixWriteInt24(Dst + i * 3, MixRound(MixClamp(Bus[i] * scale, -8388608.0f, 8388607.0f)));
+}
+
+void ScalarWriteOutInt24In32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT24_SCALE * Gain;
+    LONG* d = reinterpret_cast<LONG*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+        d[i] = (LONG)((ULONG)MixRound(MixClamp(Bus[i] * scale, -8388608.0f, 8388607.0f)) << 8);
+}
+
+void ScalarWriteOutInt32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT32_SCALE * Gain;
+    LONG* d = reinterpret_cast<LONG*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+        d[i] = MixRound(MixClamp(Bus[i] * scale, -LEYLINE_INT32_SCALE, LEYLINE_INT32_MAX_FLOAT));
+}
+
+void ScalarWriteOutFloat32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    float* d = reinterpret_cast<float*>(Dst);
+    for (ULONG i = 0; i < Samples; i++) d[i] = MixClamp(Bus[i] * Gain, -1.0f, 1.0f);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALE COPY
+// Decode and re-encode in one step, with the same operations as a trip through the bus.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void ScalarScaleCopyNone(UCHAR* /*Dst*/, const UCHAR* /*Src*/, ULONG /*Samples*/, float /*Gain*/)
+{
+}
+
+void ScalarScaleCopyInt16(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT16_SCALE * Gain;
+    const SHORT* s = reinterpret_cast<const SHORT*>(Src);
+    SHORT* d = reinterpret_cast<SHORT*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+        d[i] = (SHORT)MixRound(MixClamp(s[i] * (1.0f / LEYLINE_INT16_SCALE) * scale, -32768.0f, 32767.0f));
+}
+
+void ScalarScaleCopyInt24(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT24_SCALE * Gain;
+    for (ULONG i = 0; i < Samples; i++)
+    {
+        float v = MixReadInt24(Src + i * 3) * (1.0f / LEYLINE_INT24_SCALE);
+        MixWriteInt24(Dst + i * 3, MixRound(MixClamp(v * scale, -8388608.0f, 8388607.0f)));
+    }
+}
+
+void ScalarScaleCopyInt24In32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT24_SCALE * Gain;
+    const LONG* s = reinterpret_cast<const LONG*>(Src);
+    LONG* d = reinterpret_cast<LONG*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+    {
+        float v = s[i] * (1.0f / LEYLINE_INT32_SCALE);
+        d[i] = (LONG)((ULONG)MixRound(MixClamp(v * scale, -8388608.0f, 8388607.0f)) << 8);
+    }
+}
+
+void ScalarScaleCopyInt32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const float scale = LEYLINE_INT32_SCALE * Gain;
+    const LONG* s = reinterpret_cast<const LONG*>(Src);
+    LONG* d = reinterpret_cast<LONG*>(Dst);
+    for (ULONG i = 0; i < Samples; i++)
+        d[i] = MixRound(MixClamp(s[i] * (1.0f / LEYLINE_INT32_SCALE) * scale, -LEYLINE_INT32_SCALE, LEYLINE_INT32_MAX_FLOAT));
+}
+
+void ScalarScaleCopyFloat32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const float* s = reinterpret_cast<const float*>(Src);
+    float* d = reinterpret_cast<float*>(Dst);
+    for (ULONG i = 0; i < Samples; i++) d[i] = MixClamp(s[i] * Gain, -1.0f, 1.0f);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FILTER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+float ScalarDot(const float* A, const float* B, ULONG Count)
+{
+    float sum = 0.0f;
+    for (ULONG i = 0; i < Count; i++) sum += A[i] * B[i];
+    return sum;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void ScalarMeasure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares)
+{
+    for (ULONG i = 0; i < Samples; i++)
+    {
+        ULONG lane = i & (LEYLINE_METER_LANES - 1);
+        float v    = Bus[i];
+        float a    = (v < 0.0f) ? -v : v;
+        if (a > Peak[lane]) Peak[lane] = a;
+        SumSquares[lane] += v * v;
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TABLE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+const LeylineMixKernels g_ScalarMixKernels[LeylineSampleFormatCount] =
+{
+    { ScalarAccumulateNone,    ScalarWriteOutNone,      ScalarScaleCopyNone,      LeylineSimdScalar }, // Unsupported
+    { ScalarAccumulateInt16,   ScalarWriteOutInt16,     ScalarScaleCopyInt16,     LeylineSimdScalar },
+    { ScalarAccumulateInt24,   ScalarWriteOutInt24,     ScalarScaleCopyInt24,     LeylineSimdScalar },
+    { ScalarAccumulateInt32,   ScalarWriteOutInt24In32, ScalarScaleCopyInt24In32, LeylineSimdScalar },
+    { ScalarAccumulateInt32,   ScalarWriteOutInt32,     ScalarScaleCopyInt32,     LeylineSimdScalar },
+    { ScalarAccumulateFloat32, ScalarWriteOutFloat32,   ScalarScaleCopyFloat32,   LeylineSimdScalar },
+};
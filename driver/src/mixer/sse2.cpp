@@ -0,0 +1,248 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SSE2 MIX KERNELS
+// Baseline on x64 and usable at DISPATCH_LEVEL without saving any state. Packed int24
+// needs a byte shuffle SSE2 doesn't have, so it stays on the scalar kernels here.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "mixer_internal.h"
+
+#if LEYLINE_MIXER_X86
+
+#include <emmintrin.h>
+
+// Scale, clamp and round half away from zero, exactly as MixRound(MixClamp(...)).
+static inline __m128i Quantize(__m128 bus, __m128 scale, __m128 lo, __m128 hi)
+{
+    __m128 v    = _mm_min_ps(_mm_max_ps(_mm_mul_ps(bus, scale), lo), hi);
+    __m128 half = _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(v, half));
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ACCUMULATE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Sse2AccumulateInt16(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / LEYLINE_INT16_SCALE);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 2));
+        __m128  lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        __m128  hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        _mm_storeu_ps(Bus + i,     _mm_add_ps(_mm_loadu_ps(Bus + i),     _mm_mul_ps(lo, scale)));
+        _mm_storeu_ps(Bus + i + 4, _mm_add_ps(_mm_loadu_ps(Bus + i + 4), _mm_mul_ps(hi, scale)));
+    }
+    ScalarAccumulateInt16(Bus + i, Src + i * 2, Samples - i);
+}
+
+static void Sse2AccumulateInt32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+    {
+        __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 4)));
+        _mm_storeu_ps(Bus + i, _mm_add_ps(_mm_loadu_ps(Bus + i), _mm_mul_ps(v, scale)));
+    }
+    ScalarAccumulateInt32(Bus + i, Src + i * 4, Samples - i);
+}
+
+static void Sse2AccumulateFloat32(float* Bus, const UCHAR* Src, ULONG Samples)
+{
+    const float* s = reinterpret_cast<const float*>(Src);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+        _mm_storeu_ps(Bus + i, _mm_add_ps(_mm_loadu_ps(Bus + i), _mm_loadu_ps(s + i)));
+    ScalarAccumulateFloat32(Bus + i, Src + i * 4, Samples - i);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// WRITE OUT
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Sse2WriteOutInt16(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT16_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-32768.0f);
+    const __m128 hi    = _mm_set1_ps(32767.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128i a = Quantize(_mm_loadu_ps(Bus + i),     scale, lo, hi);
+        __m128i b = Quantize(_mm_loadu_ps(Bus + i + 4), scale, lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 2), _mm_packs_epi32(a, b));
+    }
+    ScalarWriteOutInt16(Dst + i * 2, Bus + i, Samples - i, Gain);
+}
+
+static void Sse2WriteOutInt24In32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-8388608.0f);
+    const __m128 hi    = _mm_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+    {
+        __m128i v = _mm_slli_epi32(Quantize(_mm_loadu_ps(Bus + i), scale, lo, hi), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 4), v);
+    }
+    ScalarWriteOutInt24In32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+static void Sse2WriteOutInt32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT32_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-LEYLINE_INT32_SCALE);
+    const __m128 hi    = _mm_set1_ps(LEYLINE_INT32_MAX_FLOAT);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 4), Quantize(_mm_loadu_ps(Bus + i), scale, lo, hi));
+    ScalarWriteOutInt32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+static void Sse2WriteOutFloat32(UCHAR* Dst, const float* Bus, ULONG Samples, float Gain)
+{
+    const __m128 gain = _mm_set1_ps(Gain);
+    const __m128 lo   = _mm_set1_ps(-1.0f);
+    const __m128 hi   = _mm_set1_ps(1.0f);
+    float* d = reinterpret_cast<float*>(Dst);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+        _mm_storeu_ps(d + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(Bus + i), gain), lo), hi));
+    ScalarWriteOutFloat32(Dst + i * 4, Bus + i, Samples - i, Gain);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SCALE COPY
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void Sse2ScaleCopyInt16(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m128 unit  = _mm_set1_ps(1.0f / LEYLINE_INT16_SCALE);
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT16_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-32768.0f);
+    const __m128 hi    = _mm_set1_ps(32767.0f);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 2));
+        __m128  a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), unit);
+        __m128  b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), unit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 2),
+                         _mm_packs_epi32(Quantize(a, scale, lo, hi), Quantize(b, scale, lo, hi)));
+    }
+    ScalarScaleCopyInt16(Dst + i * 2, Src + i * 2, Samples - i, Gain);
+}
+
+static void Sse2ScaleCopyInt24In32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m128 unit  = _mm_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT24_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-8388608.0f);
+    const __m128 hi    = _mm_set1_ps(8388607.0f);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+    {
+        __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 4))), unit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 4), _mm_slli_epi32(Quantize(v, scale, lo, hi), 8));
+    }
+    ScalarScaleCopyInt24In32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+static void Sse2ScaleCopyInt32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m128 unit  = _mm_set1_ps(1.0f / LEYLINE_INT32_SCALE);
+    const __m128 scale = _mm_set1_ps(LEYLINE_INT32_SCALE * Gain);
+    const __m128 lo    = _mm_set1_ps(-LEYLINE_INT32_SCALE);
+    const __m128 hi    = _mm_set1_ps(LEYLINE_INT32_MAX_FLOAT);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+    {
+        __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i * 4))), unit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i * 4), Quantize(v, scale, lo, hi));
+    }
+    ScalarScaleCopyInt32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+static void Sse2ScaleCopyFloat32(UCHAR* Dst, const UCHAR* Src, ULONG Samples, float Gain)
+{
+    const __m128 gain = _mm_set1_ps(Gain);
+    const __m128 lo   = _mm_set1_ps(-1.0f);
+    const __m128 hi   = _mm_set1_ps(1.0f);
+    const float* s = reinterpret_cast<const float*>(Src);
+    float* d = reinterpret_cast<float*>(Dst);
+    ULONG i = 0;
+    for (; i + 4 <= Samples; i += 4)
+        _mm_storeu_ps(d + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(s + i), gain), lo), hi));
+    ScalarScaleCopyFloat32(Dst + i * 4, Src + i * 4, Samples - i, Gain);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FILTER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+float Sse2Dot(const float* A, const float* B, ULONG Count)
+{
+    // Two accumulators hide the add latency.
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    for (ULONG i = 0; i < Count; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(A + i),     _mm_loadu_ps(B + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(A + i + 4), _mm_loadu_ps(B + i + 4)));
+    }
+    __m128 s = _mm_add_ps(s0, s1);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void Sse2Measure(const float* Bus, ULONG Samples, float* Peak, float* SumSquares)
+{
+    // Lanes 0-3 and 4-7 in two registers each, matching the scalar lane order.
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 p0 = _mm_loadu_ps(Peak);
+    __m128 p1 = _mm_loadu_ps(Peak + 4);
+    __m128 s0 = _mm_loadu_ps(SumSquares);
+    __m128 s1 = _mm_loadu_ps(SumSquares + 4);
+    ULONG i = 0;
+    for (; i + 8 <= Samples; i += 8)
+    {
+        __m128 v0 = _mm_loadu_ps(Bus + i);
+        __m128 v1 = _mm_loadu_ps(Bus + i + 4);
+        p0 = _mm_max_ps(p0, _mm_and_ps(v0, absMask));
+        p1 = _mm_max_ps(p1, _mm_and_ps(v1, absMask));
+        s0 = _mm_add_ps(s0, _mm_mul_ps(v0, v0));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(v1, v1));
+    }
+    _mm_storeu_ps(Peak,           p0);
+    _mm_storeu_ps(Peak + 4,       p1);
+    _mm_storeu_ps(SumSquares,     s0);
+    _mm_storeu_ps(SumSquares + 4, s1);
+    ScalarMeasure(Bus + i, Samples - i, Peak, SumSquares);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TABLE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+const LeylineMixKernels g_Sse2MixKernels[LeylineSampleFormatCount] =
+{
+    { ScalarAccumulateNone,  ScalarWriteOutNone,    ScalarScaleCopyNone,    LeylineSimdScalar }, // Unsupported
+    { Sse2AccumulateInt16,   Sse2WriteOutInt16,     Sse2ScaleCopyInt16,     LeylineSimdSse2 },
+    { ScalarAccumulateInt24, ScalarWriteOutInt24,   ScalarScaleCopyInt24,   LeylineSimdScalar },
+    { Sse2AccumulateInt32,   Sse2WriteOutInt24In32, Sse2ScaleCopyInt24In32, LeylineSimdSse2 },
+    { Sse2AccumulateInt32,   Sse2WriteOutInt32,     Sse2ScaleCopyInt32,     LeylineSimdSse2 },
+    { Sse2AccumulateFloat32, Sse2WriteOutFloat32,   Sse2ScaleCopyFloat32,   LeylineSimdSse2 },
+};
+
+#endif // LEYLINE_MIXER_X86
@@ -0,0 +1,128 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DPC PLACEMENT
+// Greedy longest-cost-first assignment of cables to processors, with overrides and
+// hysteresis. Called when streams start or stop, so a quadratic sort over a few dozen
+// cables is fine.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_placement.h"
+
+static inline BOOLEAN IsPinned(const LeylinePlacementEntry* Entry, ULONG Processors)
+{
+    return Entry->Override < Processors;
+}
+
+// Overrides first, then by cost descending, then by cable Id so equal costs always
+// land in the same order.
+static inline BOOLEAN PlacesBefore(const LeylinePlacementEntry* A, const LeylinePlacementEntry* B,
+                                   ULONG Processors)
+{
+    BOOLEAN pinnedA = IsPinned(A, Processors), pinnedB = IsPinned(B, Processors);
+    if (pinnedA != pinnedB) return pinnedA;
+    if (A->Cost != B->Cost) return A->Cost > B->Cost;
+    return A->CableId < B->CableId;
+}
+
+static void SortForPlacement(LeylinePlacementEntry* Entries, ULONG Count, ULONG Processors)
+{
+    for (ULONG i = 1; i < Count; i++)
+    {
+        LeylinePlacementEntry entry = Entries[i];
+        ULONG j = i;
+        while (j > 0 && PlacesBefore(&entry, &Entries[j - 1], Processors))
+        {
+            Entries[j] = Entries[j - 1];
+            j--;
+        }
+        Entries[j] = entry;
+    }
+}
+
+// Greedy pass over sorted entries. Sticky keeps an automatic entry where it is unless
+// moving saves more than a fraction of its cost; otherwise Processor is ignored.
+static ULONG Assign(LeylinePlacementEntry* Entries, ULONG Count, ULONG Processors,
+                    ULONGLONG* Load, BOOLEAN Sticky, BOOLEAN Commit)
+{
+    ULONG moved = 0;
+    for (ULONG i = 0; i < Count; i++)
+    {
+        LeylinePlacementEntry* entry = &Entries[i];
+        ULONG target;
+
+        if (IsPinned(entry, Processors))
+        {
+            target = entry->Override;
+        }
+        else
+        {
+            target = 0;
+            for (ULONG p = 1; p < Processors; p++)
+                if (Load[p] < Load[target]) target = p;
+
+            // Idle cables cost nothing wherever they are, so they never move.
+            ULONG current = entry->Processor;
+            ULONGLONG slack = entry->Cost >> LEYLINE_PLACEMENT_HYSTERESIS_SHIFT;
+            if (Sticky && current < Processors && (entry->Cost == 0 || Load[current] <= Load[target] + slack))
+                target = current;
+        }
+
+        if (target != entry->Processor) moved++;
+        if (Commit) entry->Processor = target;
+        Load[target] += entry->Cost;
+    }
+    return moved;
+}
+
+static ULONGLONG MaxLoad(const ULONGLONG* Load, ULONG Processors)
+{
+    ULONGLONG worst = 0;
+    for (ULONG p = 0; p < Processors; p++)
+        if (Load[p] > worst) worst = Load[p];
+    return worst;
+}
+
+ULONG LeylinePlacementBalance(LeylinePlacementEntry* Entries, ULONG Count, ULONG Processors,
+                              ULONGLONG* Load)
+{
+    if (Processors == 0) Processors = 1;
+    if (Processors > LEYLINE_PLACEMENT_MAX_PROCESSORS) Processors = LEYLINE_PLACEMENT_MAX_PROCESSORS;
+
+    ULONGLONG load[LEYLINE_PLACEMENT_MAX_PROCESSORS] = {};
+    SortForPlacement(Entries, Count, Processors);
+
+    // Per-entry slack alone cascades: one cable moving shifts the loads every later
+    // one compares. So first check the placement as a whole; if every entry is on a
+    // valid processor that honors its override, and the busiest processor is within
+    // the same fraction of a fresh LPT result, nothing moves at all.
+    BOOLEAN placed = TRUE;
+    for (ULONG i = 0; i < Count && placed; i++)
+    {
+        const LeylinePlacementEntry* entry = &Entries[i];
+        if (entry->Processor >= Processors) placed = FALSE;
+        else if (IsPinned(entry, Processors) && entry->Processor != entry->Override) placed = FALSE;
+        else load[entry->Processor] += entry->Cost;
+    }
+
+    if (placed)
+    {
+        ULONGLONG fresh[LEYLINE_PLACEMENT_MAX_PROCESSORS] = {};
+        Assign(Entries, Count, Processors, fresh, FALSE, FALSE);
+        ULONGLONG best = MaxLoad(fresh, Processors);
+        if (MaxLoad(load, Processors) <= best + (best >> LEYLINE_PLACEMENT_HYSTERESIS_SHIFT))
+        {
+            if (Load)
+                for (ULONG p = 0; p < Processors; p++) Load[p] = load[p];
+            return 0;
+        }
+    }
+
+    for (ULONG p = 0; p < Processors; p++) load[p] = 0;
+    ULONG moved = Assign(Entries, Count, Processors, load, TRUE, TRUE);
+
+    if (Load)
+        for (ULONG p = 0; p < Processors; p++) Load[p] = load[p];
+    return moved;
+}
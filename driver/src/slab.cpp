@@ -0,0 +1,105 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// OBJECT SLABS
+// A chunk is one pool allocation: its list entry, then the slots from the first cache
+// line boundary after it. The free list and counters are under the slab's lock; a new
+// chunk is allocated and carved outside it and then spliced in whole.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_slab.h"
+
+#define SLAB_LINE   ((SIZE_T)SYSTEM_CACHE_ALIGNMENT_SIZE)
+
+struct SlabChunk
+{
+    LIST_ENTRY  ListEntry;
+};
+
+static inline SIZE_T AlignUp(SIZE_T Value, SIZE_T Alignment)
+{
+    return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+void LeylineSlabInit(LeylineSlab* Slab, SIZE_T ObjectSize, ULONG Tag)
+{
+    KeInitializeSpinLock(&Slab->Lock);
+    InitializeListHead(&Slab->Chunks);
+    Slab->Free         = nullptr;
+    Slab->ObjectSize   = (ULONG)AlignUp(max(ObjectSize, sizeof(PVOID)), SLAB_LINE);
+    Slab->ChunkObjects = max((ULONG)(LEYLINE_SLAB_CHUNK_BYTES / Slab->ObjectSize), (ULONG)1);
+    Slab->Tag          = Tag;
+    Slab->InUse        = 0;
+    Slab->Peak         = 0;
+    Slab->ChunkCount   = 0;
+}
+
+void LeylineSlabCleanup(LeylineSlab* Slab)
+{
+    while (Slab->Chunks.Flink && !IsListEmpty(&Slab->Chunks))
+        ExFreePoolWithTag(CONTAINING_RECORD(RemoveHeadList(&Slab->Chunks), SlabChunk, ListEntry), Slab->Tag);
+    Slab->Free       = nullptr;
+    Slab->ChunkCount = 0;
+}
+
+// A chunk's slots, linked into a free list of their own; null if it can't be had.
+static SlabChunk* NewChunk(LeylineSlab* Slab, PVOID* First, PVOID** Last)
+{
+    SIZE_T bytes = sizeof(SlabChunk) + SLAB_LINE - 1 + (SIZE_T)Slab->ChunkObjects * Slab->ObjectSize;
+    auto*  chunk = static_cast<SlabChunk*>(ExAllocatePool2(POOL_FLAG_NON_PAGED, bytes, Slab->Tag));
+    if (!chunk) return nullptr;
+
+    PUCHAR slot = reinterpret_cast<PUCHAR>(AlignUp(reinterpret_cast<SIZE_T>(chunk + 1), SLAB_LINE));
+    *First = slot;
+    for (ULONG i = 1; i < Slab->ChunkObjects; i++, slot += Slab->ObjectSize)
+        *reinterpret_cast<PVOID*>(slot) = slot + Slab->ObjectSize;
+    *Last = reinterpret_cast<PVOID*>(slot);
+    return chunk;
+}
+
+PVOID LeylineSlabAllocate(LeylineSlab* Slab, SIZE_T Size)
+{
+    if (Size > Slab->ObjectSize) return nullptr;
+
+    KIRQL irql;
+    KeAcquireSpinLock(&Slab->Lock, &irql);
+    PVOID object = Slab->Free;
+    if (!object)
+    {
+        KeReleaseSpinLock(&Slab->Lock, irql);
+
+        PVOID  first;
+        PVOID* last;
+        SlabChunk* chunk = NewChunk(Slab, &first, &last);
+        if (!chunk) return nullptr;
+
+        KeAcquireSpinLock(&Slab->Lock, &irql);
+        InsertTailList(&Slab->Chunks, &chunk->ListEntry);
+        Slab->ChunkCount++;
+        *last      = Slab->Free;
+        Slab->Free = first;
+        object     = first;
+    }
+
+    Slab->Free = *static_cast<PVOID*>(object);
+    Slab->InUse++;
+    Slab->Peak = max(Slab->Peak, Slab->InUse);
+    KeReleaseSpinLock(&Slab->Lock, irql);
+
+    // Zeroed like a pool allocation; a reused slot still holds its last object.
+    RtlZeroMemory(object, Slab->ObjectSize);
+    return object;
+}
+
+void LeylineSlabFree(LeylineSlab* Slab, PVOID Object)
+{
+    if (!Object) return;
+
+    KIRQL irql;
+    KeAcquireSpinLock(&Slab->Lock, &irql);
+    *static_cast<PVOID*>(Object) = Slab->Free;
+    Slab->Free = Object;
+    Slab->InUse--;
+    KeReleaseSpinLock(&Slab->Lock, irql);
+}
@@ -12,12 +12,12 @@
 // CMiniportTopology
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-CMiniportTopology::CMiniportTopology(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, DeviceExtension* DevExt)
+CMiniportTopology::CMiniportTopology(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, LeylineCable* Cable)
     : CUnknown(OuterUnknown)
     , m_IsCapture(IsCapture)
     , m_IsInitialized(FALSE)
     , m_Port(nullptr)
-    , m_DevExt(DevExt)
+    , m_Cable(Cable)
 {}
 
 CMiniportTopology::~CMiniportTopology() {}
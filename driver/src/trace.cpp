@@ -0,0 +1,224 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENT TRACING
+// Descriptors and payloads by hand, field for field as the manifest's templates lay
+// them out: ETW concatenates the data descriptors without padding, so each field is
+// one descriptor over a value of exactly its template type's size.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_trace.h"
+
+volatile ULONGLONG g_LeylineTraceKeywords = 0;
+
+static REGHANDLE s_TraceHandle = 0;
+
+// Tasks group the events as the manifest does; every event uses the win:Info opcode.
+#define TRACE_TASK_STREAM   1
+#define TRACE_TASK_CABLE    2
+#define TRACE_TASK_GLITCH   3
+
+#define TRACE_EVENT(Id, Level, Task, Keyword) { (Id), 0, 0, (Level), 0, (Task), (Keyword) }
+
+static const EVENT_DESCRIPTOR c_StreamState  = TRACE_EVENT(LEYLINE_EVENT_STREAM_STATE,  LEYLINE_LEVEL_INFORMATION,
+                                                           TRACE_TASK_STREAM, LEYLINE_KEYWORD_STREAM);
+static const EVENT_DESCRIPTOR c_StreamFormat = TRACE_EVENT(LEYLINE_EVENT_STREAM_FORMAT, LEYLINE_LEVEL_INFORMATION,
+                                                           TRACE_TASK_STREAM, LEYLINE_KEYWORD_STREAM);
+static const EVENT_DESCRIPTOR c_StreamBuffer = TRACE_EVENT(LEYLINE_EVENT_STREAM_BUFFER, LEYLINE_LEVEL_INFORMATION,
+                                                           TRACE_TASK_STREAM, LEYLINE_KEYWORD_STREAM);
+static const EVENT_DESCRIPTOR c_CableCreated = TRACE_EVENT(LEYLINE_EVENT_CABLE_CREATED, LEYLINE_LEVEL_INFORMATION,
+                                                           TRACE_TASK_CABLE, LEYLINE_KEYWORD_CABLE);
+static const EVENT_DESCRIPTOR c_Overrun      = TRACE_EVENT(LEYLINE_EVENT_OVERRUN,       LEYLINE_LEVEL_WARNING,
+                                                           TRACE_TASK_GLITCH, LEYLINE_KEYWORD_GLITCH);
+static const EVENT_DESCRIPTOR c_Underrun     = TRACE_EVENT(LEYLINE_EVENT_UNDERRUN,      LEYLINE_LEVEL_WARNING,
+                                                           TRACE_TASK_GLITCH, LEYLINE_KEYWORD_GLITCH);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ENABLE CALLBACK
+// A session enables a level and keywords: an event passes if its level is at or below
+// the session's (0 is any) and it carries one of MatchAny (0 is any) and all of
+// MatchAll. Every event here carries one keyword at one level, so the result is which
+// keywords pass. ETW hands the callback what all sessions together ask for.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static const struct
+{
+    ULONGLONG Keyword;
+    UCHAR     Level;
+} c_TraceKeywords[] =
+{
+    { LEYLINE_KEYWORD_STREAM, LEYLINE_LEVEL_INFORMATION },
+    { LEYLINE_KEYWORD_CABLE,  LEYLINE_LEVEL_INFORMATION },
+    { LEYLINE_KEYWORD_GLITCH, LEYLINE_LEVEL_WARNING     },
+};
+
+static void NTAPI TraceEnableCallback(LPCGUID /*SourceId*/, ULONG ControlCode, UCHAR Level,
+                                      ULONGLONG MatchAnyKeyword, ULONGLONG MatchAllKeyword,
+                                      PEVENT_FILTER_DESCRIPTOR /*FilterData*/, PVOID /*CallbackContext*/)
+{
+    if (ControlCode == EVENT_CONTROL_CODE_DISABLE_PROVIDER)
+    {
+        g_LeylineTraceKeywords = 0;
+        return;
+    }
+    if (ControlCode != EVENT_CONTROL_CODE_ENABLE_PROVIDER) return;
+
+    ULONGLONG keywords = 0;
+    for (ULONG i = 0; i < SIZEOF_ARRAY(c_TraceKeywords); i++)
+    {
+        ULONGLONG keyword = c_TraceKeywords[i].Keyword;
+        if (Level != 0 && c_TraceKeywords[i].Level > Level) continue;
+        if (MatchAnyKeyword != 0 && !(MatchAnyKeyword & keyword)) continue;
+        if ((MatchAllKeyword & keyword) != MatchAllKeyword) continue;
+        keywords |= keyword;
+    }
+    g_LeylineTraceKeywords = keywords;
+}
+
+NTSTATUS LeylineTraceRegister(LPCGUID ProviderId)
+{
+    if (s_TraceHandle) return STATUS_SUCCESS;
+
+    NTSTATUS status = EtwRegister(ProviderId, TraceEnableCallback, nullptr, &s_TraceHandle);
+    if (!NT_SUCCESS(status))
+    {
+        DbgPrint("Leyline: ETW registration failed 0x%08X; tracing is off\n", status);
+        s_TraceHandle = 0;
+    }
+    return status;
+}
+
+// By unload every stream and cable is gone, so nothing writes any more.
+void LeylineTraceUnregister()
+{
+    if (!s_TraceHandle) return;
+    EtwUnregister(s_TraceHandle);
+    s_TraceHandle          = 0;
+    g_LeylineTraceKeywords = 0;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENT ENCODING
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define TRACE_MAX_FIELDS 8
+
+// Each field refers to the writer's own argument or local, so the event is written
+// before the writer returns.
+struct TraceEvent
+{
+    EVENT_DATA_DESCRIPTOR Data[TRACE_MAX_FIELDS];
+    ULONG                 Count;
+};
+
+template <typename T>
+static inline void TraceField(TraceEvent* Event, const T& Value)
+{
+    EventDataDescCreate(&Event->Data[Event->Count++], &Value, sizeof(T));
+}
+
+static inline void TraceWrite(const EVENT_DESCRIPTOR* Descriptor, TraceEvent* Event)
+{
+    if (s_TraceHandle) EtwWrite(s_TraceHandle, Descriptor, nullptr, Event->Count, Event->Data);
+}
+
+// Manifest types: BOOLEAN is win:UInt8, KSSTATE and NTSTATUS are win:UInt32, a stream
+// is a win:UInt64 shown in hex.
+static inline ULONGLONG StreamId(const void* Stream)
+{
+    return (ULONGLONG)(ULONG_PTR)Stream;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENTS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void LeylineTraceStreamState(ULONG CableId, const void* Stream, BOOLEAN Capture, KSSTATE OldState,
+                             KSSTATE NewState, ULONGLONG PositionBytes, LONGLONG Qpc)
+{
+    ULONGLONG stream   = StreamId(Stream);
+    UCHAR     capture  = Capture ? 1 : 0;
+    ULONG     oldState = (ULONG)OldState;
+    ULONG     newState = (ULONG)NewState;
+
+    TraceEvent event = {};
+    TraceField(&event, CableId);
+    TraceField(&event, stream);
+    TraceField(&event, capture);
+    TraceField(&event, oldState);
+    TraceField(&event, newState);
+    TraceField(&event, PositionBytes);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_StreamState, &event);
+}
+
+void LeylineTraceStreamFormat(const void* Stream, BOOLEAN Capture, ULONG FrameRate, ULONG BitsPerSample,
+                              ULONG ValidBitsPerSample, ULONG Channels, BOOLEAN IsFloat, LONGLONG Qpc)
+{
+    ULONGLONG stream  = StreamId(Stream);
+    UCHAR     capture = Capture ? 1 : 0;
+    UCHAR     isFloat = IsFloat ? 1 : 0;
+
+    TraceEvent event = {};
+    TraceField(&event, stream);
+    TraceField(&event, capture);
+    TraceField(&event, FrameRate);
+    TraceField(&event, BitsPerSample);
+    TraceField(&event, ValidBitsPerSample);
+    TraceField(&event, Channels);
+    TraceField(&event, isFloat);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_StreamFormat, &event);
+}
+
+void LeylineTraceStreamBuffer(const void* Stream, ULONG RequestedBytes, ULONG Bytes, BOOLEAN Pooled,
+                              BOOLEAN Mirrored, NTSTATUS Status, LONGLONG Qpc)
+{
+    ULONGLONG stream   = StreamId(Stream);
+    UCHAR     pooled   = Pooled ? 1 : 0;
+    UCHAR     mirrored = Mirrored ? 1 : 0;
+    ULONG     status   = (ULONG)Status;
+
+    TraceEvent event = {};
+    TraceField(&event, stream);
+    TraceField(&event, RequestedBytes);
+    TraceField(&event, Bytes);
+    TraceField(&event, pooled);
+    TraceField(&event, mirrored);
+    TraceField(&event, status);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_StreamBuffer, &event);
+}
+
+void LeylineTraceCableCreated(ULONG CableId, LONGLONG Qpc)
+{
+    TraceEvent event = {};
+    TraceField(&event, CableId);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_CableCreated, &event);
+}
+
+void LeylineTraceOverrun(ULONG CableId, ULONGLONG LostFrames, ULONGLONG LostBytes, LONGLONG Qpc)
+{
+    TraceEvent event = {};
+    TraceField(&event, CableId);
+    TraceField(&event, LostFrames);
+    TraceField(&event, LostBytes);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_Overrun, &event);
+}
+
+void LeylineTraceUnderrun(ULONG CableId, const void* Stream, ULONGLONG PositionBytes, ULONGLONG MissingBytes,
+                          LONGLONG Qpc)
+{
+    ULONGLONG stream = StreamId(Stream);
+
+    TraceEvent event = {};
+    TraceField(&event, CableId);
+    TraceField(&event, stream);
+    TraceField(&event, PositionBytes);
+    TraceField(&event, MissingBytes);
+    TraceField(&event, Qpc);
+    TraceWrite(&c_Underrun, &event);
+}
@@ -8,256 +8,51 @@
 
 #include "leyline_miniport.h"
 
-// Loopback timer period: 1ms relative interval in 100ns units (negative = relative).
-static const LONGLONG LOOPBACK_PERIOD_100NS = -10000LL;
-static const LONG     LOOPBACK_PERIOD_MS    = 1;
-
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// LOOPBACK DPC ROUTINE
-// Copies audio from the active render buffer to the active capture buffer.
-// Applies volume and mute during the copy using integer math.
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-extern "C" void LoopbackDpcRoutine(PKDPC /*Dpc*/, PVOID DeferredContext,
-                                   PVOID /*SystemArgument1*/, PVOID /*SystemArgument2*/)
-{
-    DeviceExtension* devExt = reinterpret_cast<DeviceExtension*>(DeferredContext);
-    if (!devExt) return;
-
-    KIRQL oldIrql;
-    KeAcquireSpinLock(&devExt->StreamLock, &oldIrql);
-
-    if (IsListEmpty(&devExt->RenderStreams) || IsListEmpty(&devExt->CaptureStreams))
-    {
-        KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-        return;
-    }
-
-    // For now, kernel-mixing relies on the first render stream as the master clock/source
-    CMiniportWaveRTStream* renderStream = CONTAINING_RECORD(devExt->RenderStreams.Flink, CMiniportWaveRTStream, m_ListEntry);
-
-    if (renderStream->GetStreamState() != KSSTATE_RUN)
-    {
-        KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-        return;
-    }
-
-    PUCHAR renderBase  = renderStream->GetBufferBase();
-    SIZE_T renderSize  = renderStream->GetBufferSize();
-
-    if (!renderBase || renderSize == 0)
-    {
-        KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-        return;
-    }
-
-    LONGLONG now = KeQueryPerformanceCounter(nullptr).QuadPart;
-    LONGLONG renderElapsed = now - renderStream->GetStartTime();
-    ULONGLONG currentByte = WaveRTMath::TicksToBytes(
-        renderElapsed, renderStream->GetStreamByteRate(), renderStream->GetFrequency());
-
-    ULONGLONG lastByte = devExt->LastCopiedByte;
-    if (currentByte <= lastByte)
-    {
-        KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-        return;
-    }
-
-    renderStream->UpdateHwRegisters(currentByte, (ULONGLONG)now);
-    renderStream->CheckAndSignalEvents(lastByte, currentByte);
-
-    ULONGLONG bytesToCopy = currentByte - lastByte;
-
-    // Distribute to all capture streams
-    for (PLIST_ENTRY entry = devExt->CaptureStreams.Flink; entry != &devExt->CaptureStreams; entry = entry->Flink)
-    {
-        CMiniportWaveRTStream* captureStream = CONTAINING_RECORD(entry, CMiniportWaveRTStream, m_ListEntry);
-        
-        if (captureStream->GetStreamState() != KSSTATE_RUN) continue;
-
-        PUCHAR captureBase = captureStream->GetBufferBase();
-        SIZE_T captureSize = captureStream->GetBufferSize();
-
-        if (!captureBase || captureSize == 0) continue;
-
-        LONGLONG captureElapsed = now - captureStream->GetStartTime();
-        ULONGLONG currentCapByte = WaveRTMath::TicksToBytes(
-            captureElapsed, captureStream->GetStreamByteRate(), captureStream->GetFrequency());
-        ULONGLONG lastCapByte = currentCapByte - bytesToCopy; // Tightly bound to render length
-
-        captureStream->UpdateHwRegisters(currentCapByte, (ULONGLONG)now);
-        captureStream->CheckAndSignalEvents(lastCapByte, currentCapByte);
-
-        SIZE_T maxCopy = min(renderSize, captureSize);
-        ULONGLONG toCopy = (bytesToCopy > (ULONGLONG)maxCopy) ? maxCopy : bytesToCopy;
-
-        if (bytesToCopy > (ULONGLONG)maxCopy)
-        {
-            devExt->GlitchCount++;
-            DbgPrint("Leyline: Overrun detected! Lost %llu bytes. GlitchCount: %u\n", bytesToCopy - (ULONGLONG)maxCopy, devExt->GlitchCount);
-        }
-
-        SIZE_T srcOff = (SIZE_T)(lastByte % renderSize);
-        SIZE_T dstOff = (SIZE_T)(lastCapByte % captureSize);
-        SIZE_T remaining = (SIZE_T)toCopy;
-
-    while (remaining > 0)
-    {
-        SIZE_T srcAvail = renderSize  - srcOff;
-        SIZE_T dstAvail = captureSize - dstOff;
-        SIZE_T chunk    = min(remaining, min(srcAvail, dstAvail));
-
-        // Bit-perfect absolute pass-through
-        RtlCopyMemory(captureBase + dstOff, renderBase + srcOff, chunk);
-
-        srcOff    = (srcOff + chunk) % renderSize;
-        dstOff    = (dstOff + chunk) % captureSize;
-        remaining -= chunk;
-    }
-
-    } // End loop over capture streams
-
-    devExt->LastCopiedByte = currentByte;
-    KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-}
-
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// HELPER: Register or unregister a stream with the loopback engine.
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-static void RegisterStreamForLoopback(DeviceExtension* devExt, CMiniportWaveRTStream* stream, BOOLEAN capture)
-{
-    if (!devExt) return;
-
-    KIRQL oldIrql;
-    KeAcquireSpinLock(&devExt->StreamLock, &oldIrql);
-
-    if (capture)
-        InsertTailList(&devExt->CaptureStreams, &stream->m_ListEntry);
-    else
-        InsertTailList(&devExt->RenderStreams, &stream->m_ListEntry);
-
-    // Start timer when both lists become populated
-    if (!IsListEmpty(&devExt->RenderStreams) && !IsListEmpty(&devExt->CaptureStreams) && !devExt->TimerRunning)
-    {
-        CMiniportWaveRTStream* masterRender = CONTAINING_RECORD(devExt->RenderStreams.Flink, CMiniportWaveRTStream, m_ListEntry);
-
-        LONGLONG now          = KeQueryPerformanceCounter(nullptr).QuadPart;
-        LONGLONG renderStart  = masterRender->GetStartTime();
-        LONGLONG renderElapsed = now - renderStart;
-        devExt->LastCopiedByte = WaveRTMath::TicksToBytes(
-            renderElapsed,
-            masterRender->GetStreamByteRate(),
-            masterRender->GetFrequency());
-
-        LARGE_INTEGER dueTime;
-        dueTime.QuadPart = LOOPBACK_PERIOD_100NS;
-        KeSetTimerEx(&devExt->LoopbackTimer, dueTime, LOOPBACK_PERIOD_MS, &devExt->LoopbackDpc);
-        devExt->TimerRunning = TRUE;
-    }
-
-    KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-}
-
-static void UnregisterStreamFromLoopback(DeviceExtension* devExt, CMiniportWaveRTStream* stream, BOOLEAN capture)
-{
-    if (!devExt) return;
-
-    KIRQL oldIrql;
-    KeAcquireSpinLock(&devExt->StreamLock, &oldIrql);
-
-    RemoveEntryList(&stream->m_ListEntry);
-    InitializeListHead(&stream->m_ListEntry);
-
-    if ((IsListEmpty(&devExt->RenderStreams) || IsListEmpty(&devExt->CaptureStreams)) && devExt->TimerRunning)
-    {
-        KeCancelTimer(&devExt->LoopbackTimer);
-        devExt->TimerRunning = FALSE;
-        devExt->LastCopiedByte = 0;
-    }
-
-    KeReleaseSpinLock(&devExt->StreamLock, oldIrql);
-}
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // CMiniportWaveRTStream
+// Thin COM wrapper: stream state, positions and the copy engine live in loopback.cpp.
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-CMiniportWaveRTStream::CMiniportWaveRTStream(PUNKNOWN OuterUnknown, DeviceExtension* DevExt)
+CMiniportWaveRTStream::CMiniportWaveRTStream(PUNKNOWN OuterUnknown, LeylineCable* Cable)
     : CUnknown(OuterUnknown)
-    , m_State(KSSTATE_STOP)
-    , m_Mdl(nullptr)
-    , m_Mapping(nullptr)
-    , m_IsCapture(FALSE)
-    , m_OwnsMdl(FALSE)
-    , m_StartTime(0)
-    , m_ByteRate(48000 * 4)
-    , m_Frequency(0)
-    , m_DevExt(DevExt)
-    , m_BitsPerSample(16)
-    , m_Channels(2)
-    , m_IsFloat(FALSE)
-    , m_NotificationBytes(0)
-    , m_HwPositionRegister(0)
-    , m_HwClockRegister(0)
+    , m_Cable(Cable)
 {
-    InitializeListHead(&m_ListEntry);
-    RtlZeroMemory(m_NotificationEvents, sizeof(m_NotificationEvents));
-    LARGE_INTEGER freq = {};
-    KeQueryPerformanceCounter(&freq);
-    m_Frequency = freq.QuadPart;
+    LoopbackStreamInit(&m_Stream, FALSE);
 }
 
 CMiniportWaveRTStream::~CMiniportWaveRTStream()
 {
     // Unregister from loopback engine before resource cleanup.
-    UnregisterStreamFromLoopback(m_DevExt, this, m_IsCapture);
-
-    for (int i = 0; i < 8; i++)
-    {
-        if (m_NotificationEvents[i])
-        {
-            ObDereferenceObject(m_NotificationEvents[i]);
-            m_NotificationEvents[i] = nullptr;
-        }
-    }
-
-    if (m_OwnsMdl && m_Mdl)
-    {
-        if (m_Mapping)
-            MmUnmapLockedPages(m_Mapping, m_Mdl);
-        MmFreePagesFromMdl(m_Mdl);
-        IoFreeMdl(m_Mdl);
-        m_Mdl     = nullptr;
-        m_Mapping = nullptr;
-    }
+    LoopbackStreamUnregister(m_Cable ? &m_Cable->Loopback : nullptr, &m_Stream);
+    LoopbackStreamReleaseEvents(m_Cable ? &m_Cable->Loopback : nullptr, &m_Stream);
+    LoopbackStreamFreeBuffer(&m_Stream);
 }
 
 NTSTATUS CMiniportWaveRTStream::Init(ULONG /*PinId*/, BOOLEAN Capture, PKSDATAFORMAT Format)
 {
-    m_IsCapture     = Capture;
-    m_BitsPerSample = 16;
-    m_Channels      = 2;
-    m_IsFloat       = FALSE;
+    m_Stream.IsCapture = Capture;
 
     if (Format)
     {
         auto *wfx  = reinterpret_cast<KSDATAFORMAT*>(Format);
         auto *wave = reinterpret_cast<WAVEFORMATEX*>(wfx + 1);
-        m_ByteRate      = wave->nAvgBytesPerSec;
-        m_BitsPerSample = wave->wBitsPerSample;
-        m_Channels      = wave->nChannels;
-        m_IsFloat       = (wave->wFormatTag == WAVE_FORMAT_IEEE_FLOAT);
+        BOOLEAN isFloat = (wave->wFormatTag == WAVE_FORMAT_IEEE_FLOAT);
+        ULONG validBits = 0;
 
         if (wave->wFormatTag == WAVE_FORMAT_EXTENSIBLE)
         {
             auto *wfext = reinterpret_cast<WAVEFORMATEXTENSIBLE*>(wave);
-            m_IsFloat   = !!IsEqualGUID(wfext->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT);
+            isFloat     = !!IsEqualGUID(wfext->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT);
+            validBits   = wfext->Samples.wValidBitsPerSample;
         }
+
+        LoopbackStreamSetFormat(&m_Stream, wave->nAvgBytesPerSec, wave->wBitsPerSample,
+                                validBits, wave->nChannels, isFloat);
     }
 
     DbgPrint("LeylineWaveRT: Stream Init (capture=%d, byteRate=%u, bits=%u, ch=%u, float=%d)\n",
-             (int)m_IsCapture, m_ByteRate, m_BitsPerSample, m_Channels, (int)m_IsFloat);
+             (int)m_Stream.IsCapture, m_Stream.ByteRate, m_Stream.BitsPerSample,
+             m_Stream.Channels, (int)m_Stream.IsFloat);
     return STATUS_SUCCESS;
 }
 
@@ -285,20 +80,15 @@ STDMETHODIMP CMiniportWaveRTStream::SetFormat(PKSDATAFORMAT /*DataFormat*/)
 
 STDMETHODIMP CMiniportWaveRTStream::SetState(KSSTATE State)
 {
-    KSSTATE prevState = m_State;
-    m_State = State;
-
-    if (State == KSSTATE_STOP)
-    {
-        m_StartTime = 0;
-        UnregisterStreamFromLoopback(m_DevExt, this, m_IsCapture);
-    }
-    else if (State == KSSTATE_RUN && prevState != KSSTATE_RUN)
-    {
-        m_StartTime = KeQueryPerformanceCounter(nullptr).QuadPart;
-        RegisterStreamForLoopback(m_DevExt, this, m_IsCapture);
-    }
-
+    LoopbackEngine* engine  = m_Cable ? &m_Cable->Loopback : nullptr;
+    BOOLEAN         running = engine && LoopbackEngineRunning(engine);
+    LoopbackStreamSetState(engine, &m_Stream, State);
+
+    // A cable only costs anything while its timer runs, so spread the DPCs again only
+    // when that starts or stops. A pass on every transition would also move, and so
+    // re-phase, the timers of other cables mid-stream over noise in their costs.
+    if (engine && m_Cable->Device && LoopbackEngineRunning(engine) != running)
+        LeylineCablesBalance(m_Cable->Device);
     return STATUS_SUCCESS;
 }
 
@@ -306,27 +96,23 @@ STDMETHODIMP CMiniportWaveRTStream::GetPosition(PKSAUDIO_POSITION Position)
 {
     if (!Position) return STATUS_INVALID_PARAMETER;
 
-    if (m_State != KSSTATE_RUN || m_StartTime == 0)
+    if (m_Stream.State != KSSTATE_RUN || m_Stream.StartTime == 0)
     {
         Position->PlayOffset = 0;
         Position->WriteOffset = 0;
         return STATUS_SUCCESS;
     }
 
-    LONGLONG now     = KeQueryPerformanceCounter(nullptr).QuadPart;
-    LONGLONG elapsed = now - m_StartTime;
-    ULONGLONG bytes  = WaveRTMath::TicksToBytes(elapsed, m_ByteRate, m_Frequency);
+    LONGLONG now  = KeQueryPerformanceCounter(nullptr).QuadPart;
+    ULONGLONG pos = LoopbackStreamPosition(&m_Stream, now);
 
-    SIZE_T size = m_Buffer.GetSize();
-    ULONGLONG pos = (size > 0) ? (bytes % (ULONGLONG)size) : 0;
-    
     Position->PlayOffset = pos;
     Position->WriteOffset = pos;
 
-    if (m_DevExt && m_DevExt->SharedParams)
+    if (m_Cable && m_Cable->SharedParams)
     {
-        if (!m_IsCapture) m_DevExt->SharedParams->WritePos = (ULONG)pos;
-        else m_DevExt->SharedParams->ReadPos = (ULONG)pos;
+        if (!m_Stream.IsCapture) m_Cable->SharedParams->WritePos = (ULONG)pos;
+        else m_Cable->SharedParams->ReadPos = (ULONG)pos;
     }
 
     return STATUS_SUCCESS;
@@ -337,56 +123,34 @@ STDMETHODIMP CMiniportWaveRTStream::AllocateAudioBuffer(
     ULONG* ActualSize, ULONG* OffsetFromFirstPage,
     MEMORY_CACHING_TYPE* CacheType)
 {
-    if (m_Mdl) return STATUS_ALREADY_COMMITTED;
-
-    ULONG frameSize = (m_BitsPerSample / 8) * m_Channels;
-    if (frameSize == 0) frameSize = 4;
-
-    ULONG minBytes = (m_ByteRate / 1000); // 1ms
-    if (minBytes == 0) minBytes = 128 * frameSize;
-
-    ULONG maxBytes = m_ByteRate * 5; // 5 seconds
-    
-    ULONG safeSize = RequestedSize;
-    if (safeSize < minBytes) safeSize = minBytes;
-    if (safeSize > maxBytes) safeSize = maxBytes;
-
-    safeSize = (safeSize + (frameSize - 1)) & ~(frameSize - 1);
-
-    PHYSICAL_ADDRESS low  = { 0 }, high = { 0 }, skip = { 0 };
-    high.LowPart = 0xFFFFFFFF;
-
-    PMDL mdl = MmAllocatePagesForMdlEx(low, high, skip, safeSize, MmCached, MM_ALLOCATE_FULLY_REQUIRED);
-    if (!mdl)
+    if (m_Stream.Mdl) return STATUS_ALREADY_COMMITTED;
+
+    // A capture matching the cable's only render stream reads that stream's pages, and
+    // the loopback has nothing to copy while it stays the only one.
+    ULONG actual = 0;
+    NTSTATUS status = STATUS_NOT_SUPPORTED;
+    if (m_Stream.IsCapture && m_Cable)
+        status = LoopbackEngineAliasBuffer(&m_Cable->Loopback, &m_Stream, RequestedSize, &actual);
+
+    // Mirrored where the size allows, so the loopback mix never splits a copy where the
+    // ring wraps. PortCls and the client only ever see the single MDL. Pooled pages skip the allocation and
+    // usually the mapping too, which is most of what opening a stream costs.
+    if (!NT_SUCCESS(status))
     {
-        if (m_DevExt && m_DevExt->LoopbackMdl)
-        {
-            m_Mdl     = m_DevExt->LoopbackMdl;
-            m_Mapping = m_DevExt->LoopbackBuffer;
-            m_Buffer.Init(m_DevExt->LoopbackBuffer, m_DevExt->LoopbackSize);
-            m_OwnsMdl = FALSE;
-            if (AudioBufferMdl)     *AudioBufferMdl     = m_Mdl;
-            if (ActualSize)         *ActualSize         = (ULONG)m_DevExt->LoopbackSize;
-            if (OffsetFromFirstPage) *OffsetFromFirstPage = 0;
-            if (CacheType)          *CacheType          = MmCached;
-            return STATUS_SUCCESS;
-        }
-        return STATUS_INSUFFICIENT_RESOURCES;
+        LeylineBufferPool* pool = (m_Cable && m_Cable->Device) ? &m_Cable->Device->BufferPool : nullptr;
+        status = LoopbackStreamAllocatePooledBuffer(&m_Stream, pool, RequestedSize, LOOPBACK_BUFFER_MIRRORED, &actual);
     }
-
-    m_Mapping = MmMapLockedPagesSpecifyCache(mdl, KernelMode, MmCached, nullptr, FALSE, NormalPagePriority);
-    if (!m_Mapping)
+    if (!NT_SUCCESS(status))
     {
-        IoFreeMdl(mdl);
-        return STATUS_INSUFFICIENT_RESOURCES;
-    }
+        if (!m_Cable || !m_Cable->LoopbackMdl) return status;
 
-    m_Mdl     = mdl;
-    m_OwnsMdl = TRUE;
-    m_Buffer.Init(reinterpret_cast<PUCHAR>(m_Mapping), RequestedSize);
+        // Fall back to the cable's loopback buffer.
+        actual = (ULONG)m_Cable->LoopbackSize;
+        LoopbackStreamAttachBuffer(&m_Stream, m_Cable->LoopbackMdl, m_Cable->LoopbackBuffer, actual);
+    }
 
-    if (AudioBufferMdl)      *AudioBufferMdl      = m_Mdl;
-    if (ActualSize)          *ActualSize          = RequestedSize;
+    if (AudioBufferMdl)      *AudioBufferMdl      = m_Stream.Mdl;
+    if (ActualSize)          *ActualSize          = actual;
     if (OffsetFromFirstPage) *OffsetFromFirstPage = 0;
     if (CacheType)           *CacheType           = MmCached;
     return STATUS_SUCCESS;
@@ -394,26 +158,16 @@ STDMETHODIMP CMiniportWaveRTStream::AllocateAudioBuffer(
 
 STDMETHODIMP_(void) CMiniportWaveRTStream::FreeAudioBuffer(PMDL /*AudioBufferMdl*/, ULONG /*BufferSize*/)
 {
-    if (m_OwnsMdl && m_Mdl)
-    {
-        if (m_Mapping)
-        {
-            MmUnmapLockedPages(m_Mapping, m_Mdl);
-            m_Mapping = nullptr;
-        }
-        MmFreePagesFromMdl(m_Mdl);
-        IoFreeMdl(m_Mdl);
-        m_Mdl     = nullptr;
-        m_OwnsMdl = FALSE;
-    }
-    m_Buffer.Reset();
+    LoopbackStreamFreeBuffer(&m_Stream);
 }
 
 STDMETHODIMP_(void) CMiniportWaveRTStream::GetHWLatency(KSRTAUDIO_HWLATENCY* Latency)
 {
+    // A capture's read-behind is the only data held back from the client: the frames
+    // the tick has written but its position has yet to reach.
     if (Latency)
     {
-        Latency->FifoSize     = 0;
+        Latency->FifoSize     = LoopbackStreamSafetyBytes(m_Cable ? &m_Cable->Loopback : nullptr, &m_Stream);
         Latency->ChipsetDelay = 0;
         Latency->CodecDelay   = 0;
     }
@@ -423,7 +177,7 @@ STDMETHODIMP CMiniportWaveRTStream::GetPositionRegister(KSRTAUDIO_HWREGISTER* Re
 {
     if (!Register) return STATUS_INVALID_PARAMETER;
 
-    Register->Register    = &m_HwPositionRegister;
+    Register->Register    = &m_Stream.HwPositionRegister;
     Register->Width       = 64;
     Register->Numerator   = 1;
     Register->Denominator = 1;
@@ -439,7 +193,7 @@ STDMETHODIMP CMiniportWaveRTStream::GetClockRegister(KSRTAUDIO_HWREGISTER* Regis
     LARGE_INTEGER freq;
     KeQueryPerformanceCounter(&freq); // Get the frequency of QPC
 
-    Register->Register    = &m_HwClockRegister;
+    Register->Register    = &m_Stream.HwClockRegister;
     Register->Width       = 64;
     Register->Numerator   = (ULONG)freq.QuadPart;
     Register->Denominator = 1;
@@ -463,11 +217,13 @@ STDMETHODIMP CMiniportWaveRTStream::AllocateBufferWithNotification(
     {
         if (NotificationCount > 0 && ActualSize && *ActualSize > 0)
         {
-            m_NotificationBytes = *ActualSize / NotificationCount;
+            // Whole frames, so every notification lands on a frame boundary.
+            ULONG frames = (*ActualSize / m_Stream.FrameBytes) / NotificationCount;
+            m_Stream.NotificationBytes = frames * m_Stream.FrameBytes;
         }
         else
         {
-            m_NotificationBytes = 0;
+            m_Stream.NotificationBytes = 0;
         }
     }
     return status;
@@ -476,69 +232,28 @@ STDMETHODIMP CMiniportWaveRTStream::AllocateBufferWithNotification(
 STDMETHODIMP_(void) CMiniportWaveRTStream::FreeBufferWithNotification(PMDL AudioBufferMdl, ULONG BufferSize)
 {
     FreeAudioBuffer(AudioBufferMdl, BufferSize);
-    m_NotificationBytes = 0;
+    m_Stream.NotificationBytes = 0;
 }
 
 STDMETHODIMP CMiniportWaveRTStream::RegisterNotificationEvent(PKEVENT NotificationEvent)
 {
-    if (!NotificationEvent) return STATUS_INVALID_PARAMETER;
-
-    for (int i = 0; i < 8; i++)
-    {
-        if (m_NotificationEvents[i] == nullptr)
-        {
-            ObReferenceObject(NotificationEvent);
-            m_NotificationEvents[i] = NotificationEvent;
-            return STATUS_SUCCESS;
-        }
-    }
-    return STATUS_INSUFFICIENT_RESOURCES;
+    return LoopbackStreamAddEvent(m_Cable ? &m_Cable->Loopback : nullptr, &m_Stream, NotificationEvent);
 }
 
 STDMETHODIMP CMiniportWaveRTStream::UnregisterNotificationEvent(PKEVENT NotificationEvent)
 {
-    if (!NotificationEvent) return STATUS_INVALID_PARAMETER;
-
-    for (int i = 0; i < 8; i++)
-    {
-        if (m_NotificationEvents[i] == NotificationEvent)
-        {
-            m_NotificationEvents[i] = nullptr;
-            ObDereferenceObject(NotificationEvent);
-            return STATUS_SUCCESS;
-        }
-    }
-    return STATUS_NOT_FOUND;
-}
-
-void CMiniportWaveRTStream::CheckAndSignalEvents(ULONGLONG lastPosBytes, ULONGLONG currentPosBytes)
-{
-    if (m_NotificationBytes == 0) return;
-
-    ULONGLONG lastBoundary = lastPosBytes / m_NotificationBytes;
-    ULONGLONG currentBoundary = currentPosBytes / m_NotificationBytes;
-
-    if (currentBoundary > lastBoundary)
-    {
-        for (int i = 0; i < 8; i++)
-        {
-            if (m_NotificationEvents[i])
-            {
-                KeSetEvent(m_NotificationEvents[i], 0, FALSE);
-            }
-        }
-    }
+    return LoopbackStreamRemoveEvent(m_Cable ? &m_Cable->Loopback : nullptr, &m_Stream, NotificationEvent);
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // CMiniportWaveRT
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-CMiniportWaveRT::CMiniportWaveRT(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, DeviceExtension* DevExt)
+CMiniportWaveRT::CMiniportWaveRT(PUNKNOWN OuterUnknown, BOOLEAN IsCapture, LeylineCable* Cable)
     : CUnknown(OuterUnknown)
     , m_IsCapture(IsCapture)
     , m_IsInitialized(FALSE)
-    , m_DevExt(DevExt)
+    , m_Cable(Cable)
 {}
 
 CMiniportWaveRT::~CMiniportWaveRT() {}
@@ -665,7 +380,7 @@ STDMETHODIMP CMiniportWaveRT::NewStream(
     if (!Stream) return STATUS_INVALID_PARAMETER;
     if (!m_IsInitialized) return STATUS_DEVICE_NOT_READY;
 
-    CMiniportWaveRTStream *stream = new (NonPagedPool, 'LLWS') CMiniportWaveRTStream(nullptr, m_DevExt);
+    CMiniportWaveRTStream *stream = new CMiniportWaveRTStream(nullptr, m_Cable);
     if (!stream) return STATUS_INSUFFICIENT_RESOURCES;
 
     NTSTATUS status = stream->Init(PinId, Capture, DataFormat);
@@ -0,0 +1,850 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE HOST KERNEL SHIM IMPLEMENTATION
+// Virtual QPC, spinlocks, events, timers, pool and page allocation for the host build.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DEBUG OUTPUT
+// Silent unless LEYLINE_HOST_VERBOSE is set, so benchmarks don't measure stdio.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ULONG DbgPrint(const char* Format, ...)
+{
+    static const int s_Verbose = getenv("LEYLINE_HOST_VERBOSE") ? 1 : 0;
+    if (!s_Verbose) return 0;
+
+    va_list args;
+    va_start(args, Format);
+    vfprintf(stderr, Format, args);
+    va_end(args);
+    return 0;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// IRQL & SPINLOCKS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static thread_local KIRQL t_CurrentIrql = PASSIVE_LEVEL;
+
+KIRQL KeGetCurrentIrql()
+{
+    return t_CurrentIrql;
+}
+
+void KeRaiseIrql(KIRQL NewIrql, PKIRQL OldIrql)
+{
+    *OldIrql      = t_CurrentIrql;
+    t_CurrentIrql = NewIrql;
+}
+
+void KeLowerIrql(KIRQL NewIrql)
+{
+    t_CurrentIrql = NewIrql;
+}
+
+void YieldProcessor()
+{
+    sched_yield();
+}
+
+void KeAcquireSpinLockAtDpcLevel(PKSPIN_LOCK SpinLock)
+{
+    while (__atomic_exchange_n(SpinLock, 1, __ATOMIC_ACQUIRE) != 0)
+    {
+        while (__atomic_load_n(SpinLock, __ATOMIC_RELAXED) != 0) YieldProcessor();
+    }
+}
+
+void KeReleaseSpinLockFromDpcLevel(PKSPIN_LOCK SpinLock)
+{
+    __atomic_store_n(SpinLock, 0, __ATOMIC_RELEASE);
+}
+
+void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIRQL OldIrql)
+{
+    *OldIrql      = t_CurrentIrql;
+    t_CurrentIrql = DISPATCH_LEVEL;
+    KeAcquireSpinLockAtDpcLevel(SpinLock);
+}
+
+void KeReleaseSpinLock(PKSPIN_LOCK SpinLock, KIRQL NewIrql)
+{
+    KeReleaseSpinLockFromDpcLevel(SpinLock);
+    t_CurrentIrql = NewIrql;
+}
+
+void ExAcquireFastMutex(PFAST_MUTEX FastMutex)
+{
+    KIRQL oldIrql = t_CurrentIrql;
+    t_CurrentIrql = APC_LEVEL;
+    KeAcquireSpinLockAtDpcLevel(&FastMutex->Owned);
+    FastMutex->OldIrql = oldIrql;
+}
+
+void ExReleaseFastMutex(PFAST_MUTEX FastMutex)
+{
+    KIRQL oldIrql = FastMutex->OldIrql;
+    KeReleaseSpinLockFromDpcLevel(&FastMutex->Owned);
+    t_CurrentIrql = oldIrql;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// VIRTUAL PERFORMANCE COUNTER
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LONGLONG s_ClockNow       = 0;
+static LONGLONG s_ClockFrequency = 10000000; // 10 MHz, as on current Windows builds
+
+void HostClockReset(LONGLONG Frequency)
+{
+    __atomic_store_n(&s_ClockNow, 0, __ATOMIC_SEQ_CST);
+    s_ClockFrequency = (Frequency > 0) ? Frequency : 10000000;
+}
+
+LONGLONG HostClockNow()
+{
+    return __atomic_load_n(&s_ClockNow, __ATOMIC_ACQUIRE);
+}
+
+LONGLONG HostClockFrequency()
+{
+    return s_ClockFrequency;
+}
+
+void HostClockSet(LONGLONG Ticks)
+{
+    __atomic_store_n(&s_ClockNow, Ticks, __ATOMIC_RELEASE);
+}
+
+void HostClockAdvance(LONGLONG Ticks)
+{
+    __atomic_add_fetch(&s_ClockNow, Ticks, __ATOMIC_ACQ_REL);
+}
+
+LARGE_INTEGER KeQueryPerformanceCounter(PLARGE_INTEGER PerformanceFrequency)
+{
+    if (PerformanceFrequency) PerformanceFrequency->QuadPart = s_ClockFrequency;
+    LARGE_INTEGER now;
+    now.QuadPart = HostClockNow();
+    return now;
+}
+
+ULONGLONG ReadTimeStampCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ULONGLONG)now.tv_sec * 1000000000ULL + (ULONGLONG)now.tv_nsec;
+#endif
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENTS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void KeInitializeEvent(PKEVENT Event, EVENT_TYPE /*Type*/, BOOLEAN State)
+{
+    Event->SignalState   = State ? 1 : 0;
+    Event->SignalCount   = 0;
+    Event->LastSignalQpc = 0;
+    Event->RefCount      = 1;
+}
+
+LONG KeSetEvent(PKEVENT Event, KPRIORITY /*Increment*/, BOOLEAN /*Wait*/)
+{
+    LONG previous = InterlockedExchange(&Event->SignalState, 1);
+    __atomic_add_fetch(&Event->SignalCount, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&Event->LastSignalQpc, HostClockNow(), __ATOMIC_RELAXED);
+    return previous;
+}
+
+LONG KeResetEvent(PKEVENT Event)
+{
+    return InterlockedExchange(&Event->SignalState, 0);
+}
+
+NTSTATUS KeWaitForSingleObject(PVOID Object, KWAIT_REASON /*WaitReason*/, KPROCESSOR_MODE /*WaitMode*/,
+                               BOOLEAN /*Alertable*/, PLARGE_INTEGER /*Timeout*/)
+{
+    HostWorkItemsRun();
+    return ReadAcquire(&static_cast<PKEVENT>(Object)->SignalState) ? STATUS_SUCCESS : STATUS_TIMEOUT;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TIMERS & DPCS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void KeInitializeDpc(PKDPC Dpc, PKDEFERRED_ROUTINE DeferredRoutine, PVOID DeferredContext)
+{
+    Dpc->DeferredRoutine = DeferredRoutine;
+    Dpc->DeferredContext = DeferredContext;
+    Dpc->TargetProcessor = HOST_DPC_ANY_PROCESSOR;
+}
+
+BOOLEAN KeRemoveQueueDpc(PKDPC /*Dpc*/)
+{
+    // Host DPCs run synchronously inside HostTimerFire; nothing is ever queued.
+    return FALSE;
+}
+
+void KeInitializeTimer(PKTIMER Timer)
+{
+    Timer->Armed          = FALSE;
+    Timer->DueQpc         = 0;
+    Timer->PeriodQpc      = 0;
+    Timer->TolerableDelay = 0;
+    Timer->Dpc            = nullptr;
+}
+
+// Convert a KeSetTimerEx due time (negative = relative, 100ns units) to virtual QPC.
+static LONGLONG HundredNsToQpc(LONGLONG Interval100ns)
+{
+    return (Interval100ns * s_ClockFrequency) / 10000000LL;
+}
+
+BOOLEAN KeSetTimerEx(PKTIMER Timer, LARGE_INTEGER DueTime, LONG Period, PKDPC Dpc)
+{
+    BOOLEAN wasArmed = Timer->Armed;
+    LONGLONG now     = HostClockNow();
+
+    Timer->DueQpc         = (DueTime.QuadPart < 0) ? now + HundredNsToQpc(-DueTime.QuadPart)
+                                                   : HundredNsToQpc(DueTime.QuadPart);
+    Timer->PeriodQpc      = HundredNsToQpc((LONGLONG)Period * 10000LL);
+    Timer->TolerableDelay = 0;
+    Timer->Dpc            = Dpc;
+    Timer->Armed          = TRUE;
+    return wasArmed;
+}
+
+BOOLEAN KeSetCoalescableTimer(PKTIMER Timer, LARGE_INTEGER DueTime, ULONG Period, ULONG TolerableDelay, PKDPC Dpc)
+{
+    BOOLEAN wasArmed = KeSetTimerEx(Timer, DueTime, (LONG)Period, Dpc);
+    Timer->TolerableDelay = TolerableDelay;
+    return wasArmed;
+}
+
+BOOLEAN KeCancelTimer(PKTIMER Timer)
+{
+    BOOLEAN wasArmed = Timer->Armed;
+    Timer->Armed = FALSE;
+    return wasArmed;
+}
+
+ULONG HostTimerFire(PKTIMER Timer)
+{
+    ULONG fired = 0;
+    LONGLONG now = HostClockNow();
+
+    while (Timer->Armed && Timer->DueQpc <= now)
+    {
+        PKDPC dpc = Timer->Dpc;
+        if (Timer->PeriodQpc > 0)
+            Timer->DueQpc += Timer->PeriodQpc;
+        else
+            Timer->Armed = FALSE;
+
+        if (dpc && dpc->DeferredRoutine)
+        {
+            KIRQL oldIrql = t_CurrentIrql;
+            t_CurrentIrql = DISPATCH_LEVEL;
+            dpc->DeferredRoutine(dpc, dpc->DeferredContext, nullptr, nullptr);
+            t_CurrentIrql = oldIrql;
+        }
+        fired++;
+    }
+    return fired;
+}
+
+struct _EX_TIMER
+{
+    PEXT_CALLBACK Callback;
+    PVOID         Context;
+    BOOLEAN       Armed;
+    LONGLONG      DueQpc;
+    LONGLONG      PeriodQpc;
+};
+
+PEX_TIMER ExAllocateTimer(PEXT_CALLBACK Callback, PVOID CallbackContext, ULONG /*Attributes*/)
+{
+    PEX_TIMER timer = static_cast<PEX_TIMER>(calloc(1, sizeof(struct _EX_TIMER)));
+    if (!timer) return nullptr;
+    timer->Callback = Callback;
+    timer->Context  = CallbackContext;
+    return timer;
+}
+
+BOOLEAN ExSetTimer(PEX_TIMER Timer, LONGLONG DueTime, LONGLONG Period, PEXT_SET_PARAMETERS /*Parameters*/)
+{
+    BOOLEAN wasArmed = Timer->Armed;
+
+    // Round a relative due time up, so the timer never fires before it was asked to.
+    LONGLONG now = HostClockNow();
+    Timer->DueQpc = (DueTime < 0) ? now + (-DueTime * s_ClockFrequency + 9999999LL) / 10000000LL
+                                  : HundredNsToQpc(DueTime);
+    Timer->PeriodQpc = (Period > 0) ? max(HundredNsToQpc(Period), (LONGLONG)1) : 0;
+    Timer->Armed     = TRUE;
+    return wasArmed;
+}
+
+BOOLEAN ExCancelTimer(PEX_TIMER Timer, PEXT_CANCEL_PARAMETERS /*Parameters*/)
+{
+    BOOLEAN wasArmed = Timer->Armed;
+    Timer->Armed = FALSE;
+    return wasArmed;
+}
+
+BOOLEAN ExDeleteTimer(PEX_TIMER Timer, BOOLEAN /*Cancel*/, BOOLEAN /*Wait*/, PEXT_DELETE_PARAMETERS /*Parameters*/)
+{
+    BOOLEAN wasArmed = Timer->Armed;
+    free(Timer);
+    return wasArmed;
+}
+
+BOOLEAN HostExTimerDue(PEX_TIMER Timer, LONGLONG* DueQpc)
+{
+    if (!Timer || !Timer->Armed) return FALSE;
+    *DueQpc = Timer->DueQpc;
+    return TRUE;
+}
+
+ULONG HostExTimerFire(PEX_TIMER Timer)
+{
+    ULONG fired = 0;
+    LONGLONG now = HostClockNow();
+
+    while (Timer && Timer->Armed && Timer->DueQpc <= now)
+    {
+        if (Timer->PeriodQpc > 0)
+            Timer->DueQpc += Timer->PeriodQpc;
+        else
+            Timer->Armed = FALSE;
+
+        KIRQL oldIrql = t_CurrentIrql;
+        t_CurrentIrql = DISPATCH_LEVEL;
+        Timer->Callback(Timer, Timer->Context);
+        t_CurrentIrql = oldIrql;
+        fired++;
+    }
+    return fired;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SYSTEM THREADS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct _KTHREAD
+{
+    PKSTART_ROUTINE Routine;
+    PVOID           Context;
+    KPRIORITY       Priority;
+};
+
+static volatile LONG s_ThreadCount = 0;
+
+NTSTATUS PsCreateSystemThread(PHANDLE ThreadHandle, ACCESS_MASK /*DesiredAccess*/,
+                              POBJECT_ATTRIBUTES /*ObjectAttributes*/, HANDLE /*ProcessHandle*/,
+                              PCLIENT_ID /*ClientId*/, PKSTART_ROUTINE StartRoutine, PVOID StartContext)
+{
+    PKTHREAD thread = static_cast<PKTHREAD>(calloc(1, sizeof(struct _KTHREAD)));
+    if (!thread) return STATUS_INSUFFICIENT_RESOURCES;
+    thread->Routine  = StartRoutine;
+    thread->Context  = StartContext;
+    thread->Priority = 8;
+    InterlockedIncrement(&s_ThreadCount);
+    *ThreadHandle = thread;
+    return STATUS_SUCCESS;
+}
+
+// Only a thread's own routine calls this, and host threads never run theirs.
+NTSTATUS PsTerminateSystemThread(NTSTATUS /*ExitStatus*/)
+{
+    abort();
+}
+
+PKTHREAD KeGetCurrentThread()
+{
+    return nullptr;
+}
+
+KPRIORITY KeSetPriorityThread(PKTHREAD Thread, KPRIORITY Priority)
+{
+    if (!Thread) return 0;
+    KPRIORITY previous = Thread->Priority;
+    Thread->Priority = Priority;
+    return previous;
+}
+
+NTSTATUS ZwWaitForSingleObject(HANDLE /*Handle*/, BOOLEAN /*Alertable*/, PLARGE_INTEGER /*Timeout*/)
+{
+    return STATUS_SUCCESS;
+}
+
+static thread_local ULONG t_IdealProcessor = HOST_DPC_ANY_PROCESSOR;
+
+// Only the current thread's ideal processor; host threads have nothing else to set.
+NTSTATUS ZwSetInformationThread(HANDLE ThreadHandle, THREADINFOCLASS ThreadInformationClass,
+                                PVOID ThreadInformation, ULONG ThreadInformationLength)
+{
+    if (ThreadHandle != ZwCurrentThread() || ThreadInformationClass != ThreadIdealProcessorEx)
+        return STATUS_NOT_SUPPORTED;
+    if (ThreadInformationLength != sizeof(PROCESSOR_NUMBER)) return STATUS_INVALID_PARAMETER;
+
+    const PROCESSOR_NUMBER* number = static_cast<const PROCESSOR_NUMBER*>(ThreadInformation);
+    if (number->Group != 0 || number->Number >= KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS))
+        return STATUS_INVALID_PARAMETER;
+    t_IdealProcessor = number->Number;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS ZwClose(HANDLE Handle)
+{
+    if (!Handle) return STATUS_INVALID_PARAMETER;
+    free(Handle);
+    InterlockedDecrement(&s_ThreadCount);
+    return STATUS_SUCCESS;
+}
+
+ULONG HostThreadCount()
+{
+    return (ULONG)ReadAcquire(&s_ThreadCount);
+}
+
+ULONG HostIdealProcessor()
+{
+    return t_IdealProcessor;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// WORK ITEMS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct _IO_WORKITEM
+{
+    PDEVICE_OBJECT       Device;
+    PIO_WORKITEM_ROUTINE Routine;
+    PVOID                Context;
+    PIO_WORKITEM         Next;
+    BOOLEAN              Queued;
+};
+
+static KSPIN_LOCK   s_WorkLock = 0;
+static PIO_WORKITEM s_WorkHead = nullptr;
+static PIO_WORKITEM s_WorkTail = nullptr;
+
+PIO_WORKITEM IoAllocateWorkItem(PDEVICE_OBJECT DeviceObject)
+{
+    PIO_WORKITEM item = static_cast<PIO_WORKITEM>(calloc(1, sizeof(struct _IO_WORKITEM)));
+    if (item) item->Device = DeviceObject;
+    return item;
+}
+
+// Queuing an item that is already queued is a bug in the kernel too.
+void IoQueueWorkItem(PIO_WORKITEM IoWorkItem, PIO_WORKITEM_ROUTINE WorkerRoutine,
+                     WORK_QUEUE_TYPE /*QueueType*/, PVOID Context)
+{
+    KIRQL irql;
+    KeAcquireSpinLock(&s_WorkLock, &irql);
+    if (IoWorkItem->Queued) abort();
+    IoWorkItem->Routine = WorkerRoutine;
+    IoWorkItem->Context = Context;
+    IoWorkItem->Next    = nullptr;
+    IoWorkItem->Queued  = TRUE;
+    if (s_WorkTail) s_WorkTail->Next = IoWorkItem;
+    else            s_WorkHead       = IoWorkItem;
+    s_WorkTail = IoWorkItem;
+    KeReleaseSpinLock(&s_WorkLock, irql);
+}
+
+void IoFreeWorkItem(PIO_WORKITEM IoWorkItem)
+{
+    if (IoWorkItem && IoWorkItem->Queued) abort();
+    free(IoWorkItem);
+}
+
+ULONG HostWorkItemsRun()
+{
+    ULONG ran = 0;
+    for (;;)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&s_WorkLock, &irql);
+        PIO_WORKITEM item = s_WorkHead;
+        if (item)
+        {
+            s_WorkHead = item->Next;
+            if (!s_WorkHead) s_WorkTail = nullptr;
+            item->Queued = FALSE;
+        }
+        KeReleaseSpinLock(&s_WorkLock, irql);
+        if (!item) return ran;
+
+        // Unqueued before it runs, as in the kernel, so the routine may queue it again.
+        KIRQL oldIrql = t_CurrentIrql;
+        t_CurrentIrql = PASSIVE_LEVEL;
+        item->Routine(item->Device, item->Context);
+        t_CurrentIrql = oldIrql;
+        ran++;
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PROCESSORS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static ULONG s_ProcessorCount = 0;
+
+ULONG KeQueryActiveProcessorCountEx(USHORT /*GroupNumber*/)
+{
+    ULONG count = __atomic_load_n(&s_ProcessorCount, __ATOMIC_RELAXED);
+    if (count) return count;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return (online > 0) ? (ULONG)online : 1;
+}
+
+NTSTATUS KeGetProcessorNumberFromIndex(ULONG ProcIndex, PPROCESSOR_NUMBER ProcNumber)
+{
+    if (ProcIndex >= KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS) || ProcIndex > 0xFF)
+        return STATUS_INVALID_PARAMETER;
+    ProcNumber->Group    = 0;
+    ProcNumber->Number   = (UCHAR)ProcIndex;
+    ProcNumber->Reserved = 0;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS KeSetTargetProcessorDpcEx(PKDPC Dpc, PPROCESSOR_NUMBER ProcNumber)
+{
+    if (ProcNumber->Group != 0) return STATUS_INVALID_PARAMETER;
+    Dpc->TargetProcessor = ProcNumber->Number;
+    return STATUS_SUCCESS;
+}
+
+void HostSetProcessorCount(ULONG Count)
+{
+    __atomic_store_n(&s_ProcessorCount, Count, __ATOMIC_RELAXED);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PROCESSOR FEATURES & EXTENDED STATE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static LONG s_ExtendedStateSaves = 0;
+
+BOOLEAN ExIsProcessorFeaturePresent(ULONG ProcessorFeature)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    switch (ProcessorFeature)
+    {
+    case PF_XMMI64_INSTRUCTIONS_AVAILABLE: return __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+    case PF_AVX2_INSTRUCTIONS_AVAILABLE:   return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+    default: break;
+    }
+#endif
+    return FALSE;
+}
+
+ULONG64 RtlGetEnabledExtendedFeatures(ULONG64 FeatureMask)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // The "avx" probe includes the OSXSAVE/XGETBV check, i.e. the OS manages YMM.
+    if (__builtin_cpu_supports("avx")) return FeatureMask & XSTATE_MASK_AVX;
+#endif
+    return 0;
+}
+
+NTSTATUS KeSaveExtendedProcessorState(ULONG64 Mask, PXSTATE_SAVE XStateSave)
+{
+    XStateSave->Mask = Mask;
+    InterlockedIncrement(&s_ExtendedStateSaves);
+    return STATUS_SUCCESS;
+}
+
+void KeRestoreExtendedProcessorState(PXSTATE_SAVE XStateSave)
+{
+    XStateSave->Mask = 0;
+}
+
+ULONG HostExtendedStateSaves()
+{
+    return (ULONG)__atomic_load_n(&s_ExtendedStateSaves, __ATOMIC_RELAXED);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENT TRACING
+// The provider's handle is 1 while registered. Kept events live in a fixed array, so
+// a write never allocates; once it is full further events are dropped, as a session
+// with no free buffers drops them.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define HOST_ETW_HANDLE 1
+
+struct HostEtwRecord
+{
+    EVENT_DESCRIPTOR Descriptor;
+    ULONG            Size;
+    UCHAR            Payload[HOST_ETW_MAX_PAYLOAD];
+};
+
+static KSPIN_LOCK         s_EtwLock     = 0;
+static PETWENABLECALLBACK s_EtwCallback = nullptr;
+static PVOID              s_EtwContext  = nullptr;
+static GUID               s_EtwProvider = {};
+static BOOLEAN            s_EtwEnabled  = FALSE;
+static UCHAR              s_EtwLevel    = 0;
+static ULONGLONG          s_EtwKeywords = 0;
+static ULONG              s_EtwCount    = 0;
+static volatile LONG      s_EtwWrites   = 0;
+static HostEtwRecord      s_EtwEvents[HOST_ETW_MAX_EVENTS];
+
+static void EtwNotify(ULONG ControlCode)
+{
+    if (!s_EtwCallback) return;
+    s_EtwCallback(&s_EtwProvider, ControlCode, s_EtwLevel, s_EtwKeywords, 0, nullptr, s_EtwContext);
+}
+
+NTSTATUS EtwRegister(LPCGUID ProviderId, PETWENABLECALLBACK EnableCallback, PVOID CallbackContext,
+                     PREGHANDLE RegHandle)
+{
+    if (s_EtwCallback || !ProviderId || !RegHandle) return STATUS_INVALID_PARAMETER;
+    s_EtwProvider = *ProviderId;
+    s_EtwCallback = EnableCallback;
+    s_EtwContext  = CallbackContext;
+    *RegHandle    = HOST_ETW_HANDLE;
+    if (s_EtwEnabled) EtwNotify(EVENT_CONTROL_CODE_ENABLE_PROVIDER);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS EtwUnregister(REGHANDLE RegHandle)
+{
+    if (RegHandle != HOST_ETW_HANDLE) return STATUS_INVALID_PARAMETER;
+    s_EtwCallback = nullptr;
+    s_EtwContext  = nullptr;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS EtwWrite(REGHANDLE RegHandle, PCEVENT_DESCRIPTOR EventDescriptor, LPCGUID /*ActivityId*/,
+                  ULONG UserDataCount, PEVENT_DATA_DESCRIPTOR UserData)
+{
+    if (RegHandle != HOST_ETW_HANDLE) return STATUS_INVALID_PARAMETER;
+    InterlockedIncrement(&s_EtwWrites);
+
+    KIRQL irql;
+    KeAcquireSpinLock(&s_EtwLock, &irql);
+    BOOLEAN admitted = s_EtwEnabled &&
+                       (s_EtwLevel == 0 || EventDescriptor->Level <= s_EtwLevel) &&
+                       (s_EtwKeywords == 0 || (EventDescriptor->Keyword & s_EtwKeywords) != 0);
+    NTSTATUS status = STATUS_SUCCESS;
+    if (admitted && s_EtwCount < HOST_ETW_MAX_EVENTS)
+    {
+        HostEtwRecord* record = &s_EtwEvents[s_EtwCount];
+        record->Descriptor = *EventDescriptor;
+        record->Size       = 0;
+        for (ULONG i = 0; i < UserDataCount; i++)
+        {
+            if (record->Size + UserData[i].Size > HOST_ETW_MAX_PAYLOAD)
+            {
+                status = STATUS_BUFFER_OVERFLOW;
+                break;
+            }
+            RtlCopyMemory(record->Payload + record->Size, (const void*)(ULONG_PTR)UserData[i].Ptr, UserData[i].Size);
+            record->Size += UserData[i].Size;
+        }
+        if (NT_SUCCESS(status)) s_EtwCount++;
+    }
+    KeReleaseSpinLock(&s_EtwLock, irql);
+    return status;
+}
+
+void HostEtwEnable(UCHAR Level, ULONGLONG MatchAnyKeyword)
+{
+    s_EtwEnabled  = TRUE;
+    s_EtwLevel    = Level;
+    s_EtwKeywords = MatchAnyKeyword;
+    EtwNotify(EVENT_CONTROL_CODE_ENABLE_PROVIDER);
+}
+
+void HostEtwDisable()
+{
+    s_EtwEnabled  = FALSE;
+    s_EtwLevel    = 0;
+    s_EtwKeywords = 0;
+    EtwNotify(EVENT_CONTROL_CODE_DISABLE_PROVIDER);
+}
+
+ULONG HostEtwEventCount()
+{
+    return s_EtwCount;
+}
+
+BOOLEAN HostEtwEvent(ULONG Index, EVENT_DESCRIPTOR* Descriptor, const UCHAR** Payload, ULONG* Size)
+{
+    if (Index >= s_EtwCount) return FALSE;
+    if (Descriptor) *Descriptor = s_EtwEvents[Index].Descriptor;
+    if (Payload)    *Payload    = s_EtwEvents[Index].Payload;
+    if (Size)       *Size       = s_EtwEvents[Index].Size;
+    return TRUE;
+}
+
+void HostEtwClear()
+{
+    s_EtwCount = 0;
+}
+
+ULONG HostEtwWrites()
+{
+    return (ULONG)ReadAcquire(&s_EtwWrites);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MEMORY DESCRIPTOR LISTS
+// Allocated pages are a zeroed memfd, mapped once for the MDL's own use; that mapping
+// is what mapping such an MDL returns. An MDL built by IoAllocateMdl, whose frames the
+// caller fills in, gets a fresh mapping of its frames each time, so frames listed
+// twice alias just as they do in the kernel.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static volatile LONG s_PageAllocations = 0;
+
+static PMDL AllocateMdl(SIZE_T ByteCount)
+{
+    SIZE_T pages = BYTES_TO_PAGES(ByteCount);
+    PMDL mdl = static_cast<PMDL>(calloc(1, sizeof(MDL) + pages * sizeof(PFN_NUMBER)));
+    if (!mdl) return nullptr;
+    mdl->ByteCount = ByteCount;
+    mdl->Fd        = -1;
+    return mdl;
+}
+
+PMDL MmAllocatePagesForMdlEx(PHYSICAL_ADDRESS /*LowAddress*/, PHYSICAL_ADDRESS /*HighAddress*/,
+                             PHYSICAL_ADDRESS /*SkipBytes*/, SIZE_T TotalBytes,
+                             MEMORY_CACHING_TYPE /*CacheType*/, ULONG /*Flags*/)
+{
+    if (TotalBytes == 0) return nullptr;
+
+    PMDL mdl = AllocateMdl(TotalBytes);
+    if (!mdl) return nullptr;
+
+    SIZE_T pages = BYTES_TO_PAGES(TotalBytes);
+    mdl->Fd = memfd_create("leyline-mdl", MFD_CLOEXEC);
+    if (mdl->Fd < 0 || ftruncate(mdl->Fd, (off_t)(pages * PAGE_SIZE)) != 0)
+    {
+        IoFreeMdl(mdl);
+        return nullptr;
+    }
+
+    PVOID pagesVa = mmap(nullptr, pages * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mdl->Fd, 0);
+    if (pagesVa == MAP_FAILED)
+    {
+        IoFreeMdl(mdl);
+        return nullptr;
+    }
+
+    mdl->Pages    = pagesVa;
+    mdl->MdlFlags = MDL_PAGES_LOCKED;
+    for (SIZE_T i = 0; i < pages; i++)
+        MmGetMdlPfnArray(mdl)[i] = ((PFN_NUMBER)mdl->Fd << 32) | i;
+    InterlockedIncrement(&s_PageAllocations);
+    return mdl;
+}
+
+PMDL IoAllocateMdl(PVOID /*VirtualAddress*/, ULONG Length, BOOLEAN /*SecondaryBuffer*/,
+                   BOOLEAN /*ChargeQuota*/, PIRP /*Irp*/)
+{
+    return Length ? AllocateMdl(Length) : nullptr;
+}
+
+PVOID MmMapLockedPagesSpecifyCache(PMDL Mdl, KPROCESSOR_MODE /*AccessMode*/,
+                                   MEMORY_CACHING_TYPE /*CacheType*/, PVOID /*RequestedAddress*/,
+                                   ULONG /*BugCheckOnFailure*/, ULONG /*Priority*/)
+{
+    if (!Mdl) return nullptr;
+    if (Mdl->Pages) return Mdl->Pages;
+    if (!(Mdl->MdlFlags & MDL_PAGES_LOCKED)) return nullptr;
+
+    // Reserve the whole range, then lay each run of consecutive frames over it.
+    SIZE_T pages = BYTES_TO_PAGES(Mdl->ByteCount);
+    PUCHAR base = static_cast<PUCHAR>(mmap(nullptr, pages * PAGE_SIZE, PROT_NONE,
+                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) return nullptr;
+
+    PPFN_NUMBER frames = MmGetMdlPfnArray(Mdl);
+    for (SIZE_T i = 0; i < pages; )
+    {
+        SIZE_T run = 1;
+        while (i + run < pages && frames[i + run] == frames[i] + run) run++;
+
+        int   fd     = (int)(frames[i] >> 32);
+        off_t offset = (off_t)(frames[i] & 0xFFFFFFFF) * PAGE_SIZE;
+        if (mmap(base + i * PAGE_SIZE, run * PAGE_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED)
+        {
+            munmap(base, pages * PAGE_SIZE);
+            return nullptr;
+        }
+        i += run;
+    }
+    return base;
+}
+
+void MmUnmapLockedPages(PVOID BaseAddress, PMDL Mdl)
+{
+    if (Mdl && !Mdl->Pages && BaseAddress)
+        munmap(BaseAddress, BYTES_TO_PAGES(Mdl->ByteCount) * PAGE_SIZE);
+}
+
+void MmFreePagesFromMdl(PMDL Mdl)
+{
+    if (!Mdl || !Mdl->Pages) return;
+    munmap(Mdl->Pages, BYTES_TO_PAGES(Mdl->ByteCount) * PAGE_SIZE);
+    close(Mdl->Fd);
+    Mdl->Pages     = nullptr;
+    Mdl->ByteCount = 0;
+    Mdl->Fd        = -1;
+}
+
+void IoFreeMdl(PMDL Mdl)
+{
+    if (Mdl && Mdl->Fd >= 0) close(Mdl->Fd);
+    free(Mdl);
+}
+
+ULONG HostPageAllocations()
+{
+    return (ULONG)ReadAcquire(&s_PageAllocations);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POOL
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+PVOID ExAllocatePool2(POOL_FLAGS Flags, SIZE_T NumberOfBytes, ULONG /*Tag*/)
+{
+    if (NumberOfBytes == 0) return nullptr;
+    if (!(Flags & POOL_FLAG_CACHE_ALIGNED)) return calloc(1, NumberOfBytes);
+
+    SIZE_T bytes = (NumberOfBytes + SYSTEM_CACHE_ALIGNMENT_SIZE - 1) & ~(SIZE_T)(SYSTEM_CACHE_ALIGNMENT_SIZE - 1);
+    PVOID  p     = aligned_alloc(SYSTEM_CACHE_ALIGNMENT_SIZE, bytes);
+    if (p) memset(p, 0, bytes);
+    return p;
+}
+
+void ExFreePoolWithTag(PVOID P, ULONG /*Tag*/)
+{
+    free(P);
+}
@@ -0,0 +1,632 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LEYLINE HOST KERNEL SHIM
+// The minimal slice of the WDM surface the portable loopback core depends on:
+// spinlocks, QPC, KEVENT, KTIMER/KDPC, pool and MDL-backed pages. QPC is a virtual
+// counter the simulation advances explicitly, so every run is deterministic.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BASIC TYPES
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define __int64 long long
+
+typedef void                VOID, *PVOID;
+typedef uint8_t             UCHAR, *PUCHAR, BYTE;
+typedef uint8_t             BOOLEAN, *PBOOLEAN;
+typedef int16_t             SHORT;
+typedef uint16_t            USHORT, WORD;
+typedef int32_t             LONG, *PLONG;
+typedef uint32_t            ULONG, *PULONG, DWORD;
+typedef int64_t             LONGLONG;
+typedef uint64_t            ULONGLONG, ULONG64;
+typedef intptr_t            LONG_PTR;
+typedef uintptr_t           ULONG_PTR;
+typedef size_t              SIZE_T;
+typedef LONG                NTSTATUS;
+typedef UCHAR               KIRQL, *PKIRQL;
+
+#define TRUE  1
+#define FALSE 0
+#define MAXULONG 0xFFFFFFFFUL
+#define MAXLONGLONG 0x7FFFFFFFFFFFFFFFLL
+
+#define STATUS_SUCCESS                  ((NTSTATUS)0x00000000L)
+#define STATUS_TIMEOUT                  ((NTSTATUS)0x00000102L)
+#define STATUS_BUFFER_OVERFLOW          ((NTSTATUS)0x80000005L)
+#define STATUS_UNSUCCESSFUL             ((NTSTATUS)0xC0000001L)
+#define STATUS_NOT_IMPLEMENTED          ((NTSTATUS)0xC0000002L)
+#define STATUS_INVALID_PARAMETER        ((NTSTATUS)0xC000000DL)
+#define STATUS_INVALID_DEVICE_REQUEST   ((NTSTATUS)0xC0000010L)
+#define STATUS_ALREADY_COMMITTED        ((NTSTATUS)0xC0000021L)
+#define STATUS_BUFFER_TOO_SMALL         ((NTSTATUS)0xC0000023L)
+#define STATUS_INSUFFICIENT_RESOURCES   ((NTSTATUS)0xC000009AL)
+#define STATUS_DEVICE_NOT_READY         ((NTSTATUS)0xC00000A3L)
+#define STATUS_NOT_SUPPORTED            ((NTSTATUS)0xC00000BBL)
+#define STATUS_NOT_FOUND                ((NTSTATUS)0xC0000225L)
+#define NT_SUCCESS(Status)              (((NTSTATUS)(Status)) >= 0)
+
+typedef union _LARGE_INTEGER
+{
+    struct { ULONG LowPart; LONG HighPart; };
+    LONGLONG QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER, PHYSICAL_ADDRESS;
+
+typedef enum _MODE { KernelMode, UserMode } KPROCESSOR_MODE;
+
+#define UNREFERENCED_PARAMETER(P) ((void)(P))
+#define CONTAINING_RECORD(address, type, field) \
+    ((type*)((PUCHAR)(address) - offsetof(type, field)))
+#define FIELD_OFFSET(type, field) ((LONG)offsetof(type, field))
+#define SIZEOF_ARRAY(a) (sizeof(a) / sizeof((a)[0]))
+#define SYSTEM_CACHE_ALIGNMENT_SIZE 64
+#define DECLSPEC_CACHEALIGN __attribute__((aligned(SYSTEM_CACHE_ALIGNMENT_SIZE)))
+
+template <typename T> inline T min(T a, T b) { return (a < b) ? a : b; }
+template <typename T> inline T max(T a, T b) { return (a > b) ? a : b; }
+
+// The x64 intrinsics wdm.h maps these to (_umul128, __umulh).
+inline ULONGLONG UnsignedMultiply128(ULONGLONG Multiplier, ULONGLONG Multiplicand, ULONGLONG* HighProduct)
+{
+    unsigned __int128 product = (unsigned __int128)Multiplier * Multiplicand;
+    *HighProduct = (ULONGLONG)(product >> 64);
+    return (ULONGLONG)product;
+}
+
+inline ULONGLONG UnsignedMultiplyHigh(ULONGLONG Multiplier, ULONGLONG Multiplicand)
+{
+    return (ULONGLONG)(((unsigned __int128)Multiplier * Multiplicand) >> 64);
+}
+
+inline BOOLEAN _BitScanReverse64(ULONG* Index, ULONGLONG Mask)
+{
+    if (Mask == 0) return FALSE;
+    *Index = 63 - (ULONG)__builtin_clzll(Mask);
+    return TRUE;
+}
+
+#define RtlCopyMemory(dst, src, len)  memcpy((dst), (src), (len))
+#define RtlMoveMemory(dst, src, len)  memmove((dst), (src), (len))
+#define RtlZeroMemory(dst, len)       memset((dst), 0, (len))
+#define RtlFillMemory(dst, len, fill) memset((dst), (fill), (len))
+
+ULONG DbgPrint(const char* Format, ...);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// IOCTL ENCODING
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define FILE_DEVICE_UNKNOWN 0x00000022
+#define METHOD_BUFFERED     0
+#define FILE_ANY_ACCESS     0
+#define CTL_CODE(DeviceType, Function, Method, Access) \
+    (((DeviceType) << 16) | ((Access) << 14) | ((Function) << 2) | (Method))
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// INTERLOCKED
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+inline LONG InterlockedIncrement(LONG volatile* Target)
+{
+    return __atomic_add_fetch(Target, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedDecrement(LONG volatile* Target)
+{
+    return __atomic_sub_fetch(Target, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedExchange(LONG volatile* Target, LONG Value)
+{
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedCompareExchange(LONG volatile* Target, LONG Exchange, LONG Comparand)
+{
+    __atomic_compare_exchange_n(Target, &Comparand, Exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return Comparand;
+}
+
+inline PVOID InterlockedExchangePointer(PVOID volatile* Target, PVOID Value)
+{
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+}
+
+inline void KeMemoryBarrier()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+inline LONG ReadAcquire(LONG const volatile* Source)
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline PVOID ReadPointerAcquire(PVOID const volatile* Source)
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline ULONG ReadULongAcquire(ULONG const volatile* Source)
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline ULONG ReadULongNoFence(ULONG const volatile* Source)
+{
+    return __atomic_load_n(Source, __ATOMIC_RELAXED);
+}
+
+inline void WriteULongRelease(ULONG volatile* Destination, ULONG Value)
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELEASE);
+}
+
+inline void WriteULongNoFence(ULONG volatile* Destination, ULONG Value)
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELAXED);
+}
+
+// A pause on real hardware. Host threads may share one core, so this yields the thread
+// instead; otherwise a spinning writer could hold off the tick it is waiting for.
+void YieldProcessor();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// IRQL & SPINLOCKS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define PASSIVE_LEVEL  0
+#define DISPATCH_LEVEL 2
+
+typedef volatile LONG KSPIN_LOCK, *PKSPIN_LOCK;
+
+KIRQL KeGetCurrentIrql();
+void  KeRaiseIrql(KIRQL NewIrql, PKIRQL OldIrql);
+void  KeLowerIrql(KIRQL NewIrql);
+
+inline void KeInitializeSpinLock(PKSPIN_LOCK SpinLock) { *SpinLock = 0; }
+void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIRQL OldIrql);
+void KeReleaseSpinLock(PKSPIN_LOCK SpinLock, KIRQL NewIrql);
+void KeAcquireSpinLockAtDpcLevel(PKSPIN_LOCK SpinLock);
+void KeReleaseSpinLockFromDpcLevel(PKSPIN_LOCK SpinLock);
+
+// A passive-level lock held at APC_LEVEL. Waiters yield as at a spinlock; the kernel's
+// block instead.
+#define APC_LEVEL 1
+
+typedef struct _FAST_MUTEX
+{
+    volatile LONG Owned;
+    KIRQL         OldIrql;
+} FAST_MUTEX, *PFAST_MUTEX;
+
+inline void ExInitializeFastMutex(PFAST_MUTEX FastMutex) { FastMutex->Owned = 0; }
+void ExAcquireFastMutex(PFAST_MUTEX FastMutex);
+void ExReleaseFastMutex(PFAST_MUTEX FastMutex);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// DOUBLY-LINKED LISTS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef struct _LIST_ENTRY
+{
+    struct _LIST_ENTRY* Flink;
+    struct _LIST_ENTRY* Blink;
+} LIST_ENTRY, *PLIST_ENTRY;
+
+inline void InitializeListHead(PLIST_ENTRY Head) { Head->Flink = Head->Blink = Head; }
+inline BOOLEAN IsListEmpty(const LIST_ENTRY* Head) { return Head->Flink == Head; }
+
+inline void InsertTailList(PLIST_ENTRY Head, PLIST_ENTRY Entry)
+{
+    PLIST_ENTRY blink = Head->Blink;
+    Entry->Flink = Head;
+    Entry->Blink = blink;
+    blink->Flink = Entry;
+    Head->Blink  = Entry;
+}
+
+inline BOOLEAN RemoveEntryList(PLIST_ENTRY Entry)
+{
+    PLIST_ENTRY flink = Entry->Flink;
+    PLIST_ENTRY blink = Entry->Blink;
+    blink->Flink = flink;
+    flink->Blink = blink;
+    return flink == blink;
+}
+
+inline PLIST_ENTRY RemoveHeadList(PLIST_ENTRY Head)
+{
+    PLIST_ENTRY entry = Head->Flink;
+    RemoveEntryList(entry);
+    return entry;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PERFORMANCE COUNTER (VIRTUAL)
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+LARGE_INTEGER KeQueryPerformanceCounter(PLARGE_INTEGER PerformanceFrequency);
+
+// Reset the virtual counter to zero at the given frequency (ticks per second).
+void     HostClockReset(LONGLONG Frequency);
+LONGLONG HostClockNow();
+LONGLONG HostClockFrequency();
+void     HostClockSet(LONGLONG Ticks);
+void     HostClockAdvance(LONGLONG Ticks);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TIME STAMP COUNTER (REAL)
+// Unlike the QPC this is the host's own counter, so probes time real work. Off x86 it
+// counts nanoseconds.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ULONGLONG ReadTimeStampCounter();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENTS & OBJECT REFERENCES
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef enum _EVENT_TYPE { NotificationEvent, SynchronizationEvent } EVENT_TYPE;
+
+// Host events record how often and when they were signaled instead of waking anyone.
+typedef struct _KEVENT
+{
+    LONG      SignalState;
+    ULONG     SignalCount;
+    LONGLONG  LastSignalQpc;
+    LONG      RefCount;
+} KEVENT, *PKEVENT;
+
+typedef LONG KPRIORITY;
+#define IO_NO_INCREMENT 0
+
+void KeInitializeEvent(PKEVENT Event, EVENT_TYPE Type, BOOLEAN State);
+LONG KeSetEvent(PKEVENT Event, KPRIORITY Increment, BOOLEAN Wait);
+LONG KeResetEvent(PKEVENT Event);
+
+typedef enum _KWAIT_REASON { Executive } KWAIT_REASON;
+
+// A host wait can't block. It runs the queued work items first, as the system workers
+// would while the caller waited, then reports whether the event is signaled.
+NTSTATUS KeWaitForSingleObject(PVOID Object, KWAIT_REASON WaitReason, KPROCESSOR_MODE WaitMode,
+                               BOOLEAN Alertable, PLARGE_INTEGER Timeout);
+
+#define ObReferenceObject(Object)   InterlockedIncrement(&(Object)->RefCount)
+#define ObDereferenceObject(Object) InterlockedDecrement(&(Object)->RefCount)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TIMERS & DPCS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct _KDPC;
+typedef void KDEFERRED_ROUTINE(struct _KDPC* Dpc, PVOID DeferredContext,
+                               PVOID SystemArgument1, PVOID SystemArgument2);
+typedef KDEFERRED_ROUTINE* PKDEFERRED_ROUTINE;
+
+typedef struct _KDPC
+{
+    PKDEFERRED_ROUTINE DeferredRoutine;
+    PVOID              DeferredContext;
+    ULONG              TargetProcessor;     // Index, or HOST_DPC_ANY_PROCESSOR
+} KDPC, *PKDPC;
+
+#define HOST_DPC_ANY_PROCESSOR 0xFFFFFFFF
+
+// A host timer never fires on its own; the simulation calls HostTimerFire(). A
+// coalescable timer records its tolerance and still fires exactly on time.
+typedef struct _KTIMER
+{
+    BOOLEAN   Armed;
+    LONGLONG  DueQpc;
+    LONGLONG  PeriodQpc;
+    ULONG     TolerableDelay;       // Milliseconds, as given to KeSetCoalescableTimer
+    PKDPC     Dpc;
+} KTIMER, *PKTIMER;
+
+void    KeInitializeDpc(PKDPC Dpc, PKDEFERRED_ROUTINE DeferredRoutine, PVOID DeferredContext);
+BOOLEAN KeRemoveQueueDpc(PKDPC Dpc);
+void    KeInitializeTimer(PKTIMER Timer);
+BOOLEAN KeSetTimerEx(PKTIMER Timer, LARGE_INTEGER DueTime, LONG Period, PKDPC Dpc);
+BOOLEAN KeSetCoalescableTimer(PKTIMER Timer, LARGE_INTEGER DueTime, ULONG Period, ULONG TolerableDelay, PKDPC Dpc);
+BOOLEAN KeCancelTimer(PKTIMER Timer);
+
+// Run the timer's DPC once for every period that has elapsed on the virtual clock.
+// Returns the number of DPC invocations.
+ULONG HostTimerFire(PKTIMER Timer);
+
+// High-resolution timers (ExAllocateTimer). Like KTIMERs they only fire when the
+// simulation calls HostExTimerFire, which runs a one-shot's callback at most once per
+// call and a periodic timer's once per period elapsed.
+typedef struct _EX_TIMER* PEX_TIMER;
+typedef void EXT_CALLBACK(PEX_TIMER Timer, PVOID Context);
+typedef EXT_CALLBACK* PEXT_CALLBACK;
+typedef struct _EXT_SET_PARAMETERS* PEXT_SET_PARAMETERS;
+typedef struct _EXT_CANCEL_PARAMETERS* PEXT_CANCEL_PARAMETERS;
+typedef struct _EXT_DELETE_PARAMETERS* PEXT_DELETE_PARAMETERS;
+
+#define EX_TIMER_HIGH_RESOLUTION 0x4
+
+PEX_TIMER ExAllocateTimer(PEXT_CALLBACK Callback, PVOID CallbackContext, ULONG Attributes);
+BOOLEAN   ExSetTimer(PEX_TIMER Timer, LONGLONG DueTime, LONGLONG Period, PEXT_SET_PARAMETERS Parameters);
+BOOLEAN   ExCancelTimer(PEX_TIMER Timer, PEXT_CANCEL_PARAMETERS Parameters);
+BOOLEAN   ExDeleteTimer(PEX_TIMER Timer, BOOLEAN Cancel, BOOLEAN Wait, PEXT_DELETE_PARAMETERS Parameters);
+
+// Virtual QPC the timer is armed for; FALSE if it isn't.
+BOOLEAN HostExTimerDue(PEX_TIMER Timer, LONGLONG* DueQpc);
+// Run the callback if the timer is due. Returns how many times it ran.
+ULONG   HostExTimerFire(PEX_TIMER Timer);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SYSTEM THREADS
+// Created, never run: a host thread is a record of its start routine, and the
+// simulation calls whatever the thread would have run where it would have woken. A
+// wait for one returns at once, as for a thread that has already exited. The ideal
+// processor a thread asks for is kept per calling host thread.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef PVOID HANDLE, *PHANDLE;
+typedef ULONG ACCESS_MASK;
+typedef struct _KTHREAD* PKTHREAD;
+typedef struct _CLIENT_ID* PCLIENT_ID;
+typedef void KSTART_ROUTINE(PVOID StartContext);
+typedef KSTART_ROUTINE* PKSTART_ROUTINE;
+
+typedef struct _OBJECT_ATTRIBUTES { ULONG Attributes; } OBJECT_ATTRIBUTES, *POBJECT_ATTRIBUTES;
+#define OBJ_KERNEL_HANDLE       0x00000200L
+#define THREAD_ALL_ACCESS       0x001FFFFFUL
+#define InitializeObjectAttributes(p, n, a, r, s) ((p)->Attributes = (a))
+
+#define LOW_REALTIME_PRIORITY   16
+#define HIGH_PRIORITY           31
+
+typedef enum _THREADINFOCLASS { ThreadIdealProcessorEx = 33 } THREADINFOCLASS;
+#define ZwCurrentThread()       ((HANDLE)(LONG_PTR)-2)
+
+NTSTATUS  PsCreateSystemThread(PHANDLE ThreadHandle, ACCESS_MASK DesiredAccess, POBJECT_ATTRIBUTES ObjectAttributes,
+                               HANDLE ProcessHandle, PCLIENT_ID ClientId, PKSTART_ROUTINE StartRoutine,
+                               PVOID StartContext);
+NTSTATUS  PsTerminateSystemThread(NTSTATUS ExitStatus);
+PKTHREAD  KeGetCurrentThread();
+KPRIORITY KeSetPriorityThread(PKTHREAD Thread, KPRIORITY Priority);
+NTSTATUS  ZwWaitForSingleObject(HANDLE Handle, BOOLEAN Alertable, PLARGE_INTEGER Timeout);
+NTSTATUS  ZwClose(HANDLE Handle);
+NTSTATUS  ZwSetInformationThread(HANDLE ThreadHandle, THREADINFOCLASS ThreadInformationClass,
+                                 PVOID ThreadInformation, ULONG ThreadInformationLength);
+
+// System threads created and not yet closed.
+ULONG HostThreadCount();
+
+// The ideal processor the calling thread last set, or HOST_DPC_ANY_PROCESSOR.
+ULONG HostIdealProcessor();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// WORK ITEMS
+// Queued, never run on their own: the simulation calls HostWorkItemsRun() where a
+// system worker thread would have picked them up. The device object is only a handle.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef struct _DEVICE_OBJECT { ULONG Flags; } DEVICE_OBJECT, *PDEVICE_OBJECT;
+typedef struct _IO_WORKITEM* PIO_WORKITEM;
+typedef void IO_WORKITEM_ROUTINE(PDEVICE_OBJECT DeviceObject, PVOID Context);
+typedef IO_WORKITEM_ROUTINE* PIO_WORKITEM_ROUTINE;
+typedef enum _WORK_QUEUE_TYPE { CriticalWorkQueue, DelayedWorkQueue } WORK_QUEUE_TYPE;
+
+PIO_WORKITEM IoAllocateWorkItem(PDEVICE_OBJECT DeviceObject);
+void         IoQueueWorkItem(PIO_WORKITEM IoWorkItem, PIO_WORKITEM_ROUTINE WorkerRoutine,
+                             WORK_QUEUE_TYPE QueueType, PVOID Context);
+void         IoFreeWorkItem(PIO_WORKITEM IoWorkItem);
+
+// Run every queued work item at PASSIVE_LEVEL on the calling thread, including any
+// queued meanwhile. Returns how many ran.
+ULONG HostWorkItemsRun();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PROCESSORS
+// One group. The count defaults to the host's and can be overridden so placement can
+// be tested for machines other than the one running the tests.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define ALL_PROCESSOR_GROUPS 0xFFFF
+
+typedef struct _PROCESSOR_NUMBER
+{
+    USHORT Group;
+    UCHAR  Number;
+    UCHAR  Reserved;
+} PROCESSOR_NUMBER, *PPROCESSOR_NUMBER;
+
+ULONG    KeQueryActiveProcessorCountEx(USHORT GroupNumber);
+NTSTATUS KeGetProcessorNumberFromIndex(ULONG ProcIndex, PPROCESSOR_NUMBER ProcNumber);
+NTSTATUS KeSetTargetProcessorDpcEx(PKDPC Dpc, PPROCESSOR_NUMBER ProcNumber);
+
+// 0 restores the host's own count.
+void HostSetProcessorCount(ULONG Count);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PROCESSOR FEATURES & EXTENDED STATE
+// Feature queries reflect the host CPU. User mode needs no YMM save, so the extended
+// state calls only count how often the core brackets AVX work.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define PF_XMMI64_INSTRUCTIONS_AVAILABLE 10
+#define PF_AVX2_INSTRUCTIONS_AVAILABLE   40
+#define XSTATE_MASK_AVX                  (1ULL << 2)
+
+typedef struct _XSTATE_SAVE
+{
+    ULONG64 Mask;
+} XSTATE_SAVE, *PXSTATE_SAVE;
+
+BOOLEAN  ExIsProcessorFeaturePresent(ULONG ProcessorFeature);
+ULONG64  RtlGetEnabledExtendedFeatures(ULONG64 FeatureMask);
+NTSTATUS KeSaveExtendedProcessorState(ULONG64 Mask, PXSTATE_SAVE XStateSave);
+void     KeRestoreExtendedProcessorState(PXSTATE_SAVE XStateSave);
+
+// Number of KeSaveExtendedProcessorState calls since start-up.
+ULONG HostExtendedStateSaves();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENT TRACING
+// One provider and one in-memory session. The simulation enables and disables the
+// session as a trace controller would, which calls the provider's enable callback;
+// events the session's level and keywords admit are kept, payload fields concatenated
+// as a consumer receives them, until the session fills or is cleared.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define NTAPI
+
+typedef struct _GUID
+{
+    ULONG  Data1;
+    USHORT Data2;
+    USHORT Data3;
+    UCHAR  Data4[8];
+} GUID;
+typedef const GUID* LPCGUID;
+
+typedef ULONGLONG REGHANDLE, *PREGHANDLE;
+
+typedef struct _EVENT_DESCRIPTOR
+{
+    USHORT    Id;
+    UCHAR     Version;
+    UCHAR     Channel;
+    UCHAR     Level;
+    UCHAR     Opcode;
+    USHORT    Task;
+    ULONGLONG Keyword;
+} EVENT_DESCRIPTOR, *PEVENT_DESCRIPTOR;
+typedef const EVENT_DESCRIPTOR* PCEVENT_DESCRIPTOR;
+
+typedef struct _EVENT_DATA_DESCRIPTOR
+{
+    ULONGLONG Ptr;
+    ULONG     Size;
+    ULONG     Reserved;
+} EVENT_DATA_DESCRIPTOR, *PEVENT_DATA_DESCRIPTOR;
+
+typedef struct _EVENT_FILTER_DESCRIPTOR
+{
+    ULONGLONG Ptr;
+    ULONG     Size;
+    ULONG     Type;
+} EVENT_FILTER_DESCRIPTOR, *PEVENT_FILTER_DESCRIPTOR;
+
+#define EVENT_CONTROL_CODE_DISABLE_PROVIDER 0
+#define EVENT_CONTROL_CODE_ENABLE_PROVIDER  1
+#define EVENT_CONTROL_CODE_CAPTURE_STATE    2
+
+typedef void ETWENABLECALLBACK(LPCGUID SourceId, ULONG ControlCode, UCHAR Level, ULONGLONG MatchAnyKeyword,
+                               ULONGLONG MatchAllKeyword, PEVENT_FILTER_DESCRIPTOR FilterData, PVOID CallbackContext);
+typedef ETWENABLECALLBACK* PETWENABLECALLBACK;
+
+inline void EventDataDescCreate(PEVENT_DATA_DESCRIPTOR EventDataDescriptor, const VOID* DataPtr, ULONG DataSize)
+{
+    EventDataDescriptor->Ptr      = (ULONGLONG)(ULONG_PTR)DataPtr;
+    EventDataDescriptor->Size     = DataSize;
+    EventDataDescriptor->Reserved = 0;
+}
+
+// Registering while the session is enabled calls the callback at once, as in the kernel.
+NTSTATUS EtwRegister(LPCGUID ProviderId, PETWENABLECALLBACK EnableCallback, PVOID CallbackContext,
+                     PREGHANDLE RegHandle);
+NTSTATUS EtwUnregister(REGHANDLE RegHandle);
+NTSTATUS EtwWrite(REGHANDLE RegHandle, PCEVENT_DESCRIPTOR EventDescriptor, LPCGUID ActivityId,
+                  ULONG UserDataCount, PEVENT_DATA_DESCRIPTOR UserData);
+
+#define HOST_ETW_MAX_EVENTS     1024
+#define HOST_ETW_MAX_PAYLOAD    256
+
+// Enable the session for events at or below Level (0: any) carrying any of
+// MatchAnyKeyword (0: any), or disable it. Events already kept stay.
+void    HostEtwEnable(UCHAR Level, ULONGLONG MatchAnyKeyword);
+void    HostEtwDisable();
+// Events kept since the last clear, and the Index'th of them; Payload stays valid
+// until the next clear.
+ULONG   HostEtwEventCount();
+BOOLEAN HostEtwEvent(ULONG Index, EVENT_DESCRIPTOR* Descriptor, const UCHAR** Payload, ULONG* Size);
+void    HostEtwClear();
+// EtwWrite calls since start-up, kept or not.
+ULONG   HostEtwWrites();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MEMORY DESCRIPTOR LISTS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define PAGE_SIZE 0x1000
+#define MM_ALLOCATE_FULLY_REQUIRED 0x00000004
+
+typedef enum _MEMORY_CACHING_TYPE { MmNonCached, MmCached, MmWriteCombined } MEMORY_CACHING_TYPE;
+typedef enum _MM_PAGE_PRIORITY { LowPagePriority, NormalPagePriority = 16, HighPagePriority = 32 } MM_PAGE_PRIORITY;
+
+#define MDL_PAGES_LOCKED 0x0002
+
+#define BYTES_TO_PAGES(Size) (((SIZE_T)(Size) + PAGE_SIZE - 1) / PAGE_SIZE)
+
+// A host page frame is a page of a memfd: the descriptor in the high half, the page
+// index in the low half. Mapping an MDL maps its frames in order, so an MDL that lists
+// a page twice sees it twice, as a kernel mapping would.
+typedef ULONG_PTR PFN_NUMBER, *PPFN_NUMBER;
+
+// Followed in memory by its page frame array, as in the kernel.
+typedef struct _MDL
+{
+    PVOID  Pages;               // The pages' own mapping; null if built by IoAllocateMdl
+    SIZE_T ByteCount;
+    USHORT MdlFlags;
+    int    Fd;                  // Backing memfd of allocated pages, or -1
+} MDL, *PMDL;
+
+typedef struct _IRP* PIRP;
+
+#define MmGetMdlPfnArray(Mdl) ((PPFN_NUMBER)((Mdl) + 1))
+
+PMDL  MmAllocatePagesForMdlEx(PHYSICAL_ADDRESS LowAddress, PHYSICAL_ADDRESS HighAddress,
+                              PHYSICAL_ADDRESS SkipBytes, SIZE_T TotalBytes,
+                              MEMORY_CACHING_TYPE CacheType, ULONG Flags);
+PMDL  IoAllocateMdl(PVOID VirtualAddress, ULONG Length, BOOLEAN SecondaryBuffer,
+                    BOOLEAN ChargeQuota, PIRP Irp);
+PVOID MmMapLockedPagesSpecifyCache(PMDL Mdl, KPROCESSOR_MODE AccessMode,
+                                   MEMORY_CACHING_TYPE CacheType, PVOID RequestedAddress,
+                                   ULONG BugCheckOnFailure, ULONG Priority);
+void  MmUnmapLockedPages(PVOID BaseAddress, PMDL Mdl);
+void  MmFreePagesFromMdl(PMDL Mdl);
+void  IoFreeMdl(PMDL Mdl);
+
+// Number of MmAllocatePagesForMdlEx calls that succeeded since start-up.
+ULONG HostPageAllocations();
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// POOL
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef ULONG64 POOL_FLAGS;
+#define POOL_FLAG_CACHE_ALIGNED 0x0000000000000008ULL
+#define POOL_FLAG_NON_PAGED 0x0000000000000040ULL
+
+// Zeroed, like ExAllocatePool2, and line-aligned when asked. Tags are accepted and ignored.
+PVOID ExAllocatePool2(POOL_FLAGS Flags, SIZE_T NumberOfBytes, ULONG Tag);
+void  ExFreePoolWithTag(PVOID P, ULONG Tag);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// KERNEL STREAMING
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef enum
+{
+    KSSTATE_STOP,
+    KSSTATE_ACQUIRE,
+    KSSTATE_PAUSE,
+    KSSTATE_RUN
+} KSSTATE;
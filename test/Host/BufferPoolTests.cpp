@@ -0,0 +1,240 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BUFFER POOL TESTS
+// Stream buffers through the pool: reuse without allocating, zeroing ahead and on the
+// open path, size classes, the high-water mark, aliased captures holding pooled pages,
+// and cleanup with zeroing still queued. Work items only run when a test runs them.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+
+using namespace HostSim;
+
+// 48 kHz 16-bit stereo; 5 pages (about 107 ms) is mirrored, in the 8-page class.
+static const ULONG c_BufferBytes = 5 * PAGE_SIZE;
+static const ULONG c_PooledBytes = 5 * PAGE_SIZE;
+static const ULONG c_ClassBytes  = 8 * PAGE_SIZE;
+
+static NTSTATUS OpenPooled(LeylineBufferPool* pool, LoopbackStream* stream, BOOLEAN capture,
+                           ULONG bytes = c_BufferBytes)
+{
+    LoopbackStreamInit(stream, capture);
+    LoopbackStreamSetFormat(stream, 48000 * 4, 16, 0, 2, FALSE);
+    return LoopbackStreamAllocatePooledBuffer(stream, pool, bytes, LOOPBACK_BUFFER_MIRRORED, nullptr);
+}
+
+static BOOLEAN IsSilent(LoopbackStream* stream)
+{
+    const UCHAR* p = stream->Buffer.GetBaseAddress();
+    for (ULONG i = 0; i < stream->Buffer.GetSize(); i++)
+        if (p[i]) return FALSE;
+    return TRUE;
+}
+
+static LeylinePoolStats Stats(LeylineBufferPool* pool)
+{
+    LeylinePoolStats stats;
+    LeylineBufferPoolQueryStats(pool, &stats);
+    return stats;
+}
+
+TEST(ReturnedBuffersAreReusedZeroed)
+{
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, LEYLINE_POOL_DEFAULT_LIMIT);
+    ULONG allocations = HostPageAllocations();
+
+    // A miss allocates the whole class; PortCls sees only the stream's size.
+    LoopbackStream stream;
+    CHECK_EQ(OpenPooled(&pool, &stream, FALSE), STATUS_SUCCESS);
+    CHECK_EQ(HostPageAllocations(), allocations + 1);
+    CHECK_EQ(stream.Buffer.GetSize(), c_PooledBytes);
+    CHECK_EQ((ULONG)stream.Mdl->ByteCount, c_PooledBytes);
+    CHECK(stream.Pages->MirrorMdl != nullptr);
+    CHECK_EQ(Stats(&pool).Misses, 1u);
+    PMDL view = stream.Mdl;
+
+    memset(stream.Buffer.GetBaseAddress(), 0x5A, c_PooledBytes);
+    LoopbackStreamFreeBuffer(&stream);
+    CHECK_EQ(Stats(&pool).Returned, 1u);
+    CHECK_EQ(Stats(&pool).PooledBytes, (ULONGLONG)c_ClassBytes);
+
+    // Zeroed in the background, then handed out again with nothing allocated or mapped.
+    CHECK_EQ(HostWorkItemsRun(), 1u);
+    CHECK_EQ(Stats(&pool).ZeroedAhead, 1u);
+    CHECK_EQ(OpenPooled(&pool, &stream, FALSE), STATUS_SUCCESS);
+    CHECK_EQ(HostPageAllocations(), allocations + 1);
+    CHECK_EQ(Stats(&pool).Hits, 1u);
+    CHECK_EQ(Stats(&pool).PooledBytes, 0ull);
+    CHECK(stream.Mdl == view);
+    CHECK(IsSilent(&stream));
+
+    // Still mirrored. Volatile, since the compiler can't know the two bytes are one.
+    volatile UCHAR* base = stream.Buffer.GetBaseAddress();
+    base[7] = 0x11;
+    CHECK_EQ(base[c_PooledBytes + 7], 0x11);
+
+    LoopbackStreamFreeBuffer(&stream);
+    LeylineBufferPoolCleanup(&pool);
+    CHECK_EQ(Stats(&pool).PooledBytes, 0ull);
+}
+
+TEST(ReuseBeforeZeroingZeroesOnOpen)
+{
+    // With the work item queued but not yet run, and with no work item at all.
+    DEVICE_OBJECT  device   = {};
+    PDEVICE_OBJECT owners[] = { &device, nullptr };
+    for (PDEVICE_OBJECT owner : owners)
+    {
+        LeylineBufferPool pool;
+        LeylineBufferPoolInit(&pool, owner, LEYLINE_POOL_DEFAULT_LIMIT);
+
+        LoopbackStream stream;
+        CHECK_EQ(OpenPooled(&pool, &stream, FALSE), STATUS_SUCCESS);
+        memset(stream.Buffer.GetBaseAddress(), 0x5A, c_PooledBytes);
+        LoopbackStreamFreeBuffer(&stream);
+
+        CHECK_EQ(OpenPooled(&pool, &stream, FALSE), STATUS_SUCCESS);
+        CHECK_EQ(Stats(&pool).Hits, 1u);
+        CHECK_EQ(Stats(&pool).ZeroedOnOpen, 1u);
+        CHECK(IsSilent(&stream));
+
+        // The work item finds nothing left to do.
+        CHECK_EQ(HostWorkItemsRun(), owner ? 1u : 0u);
+        CHECK_EQ(Stats(&pool).ZeroedAhead, 0u);
+
+        LoopbackStreamFreeBuffer(&stream);
+        LeylineBufferPoolCleanup(&pool);
+    }
+}
+
+TEST(BuffersShareSizeClasses)
+{
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, LEYLINE_POOL_DEFAULT_LIMIT);
+
+    LoopbackStream stream;
+    CHECK_EQ(OpenPooled(&pool, &stream, FALSE), STATUS_SUCCESS);
+    memset(stream.Buffer.GetBaseAddress(), 0x5A, c_PooledBytes);
+    LoopbackStreamFreeBuffer(&stream);
+    HostWorkItemsRun();
+
+    // Six pages fit the same class, through a new view of exactly six.
+    CHECK_EQ(OpenPooled(&pool, &stream, FALSE, 6 * PAGE_SIZE), STATUS_SUCCESS);
+    CHECK_EQ(Stats(&pool).Hits, 1u);
+    CHECK_EQ((ULONG)stream.Mdl->ByteCount, 6u * PAGE_SIZE);
+    CHECK_EQ(stream.Buffer.GetSize(), 6u * PAGE_SIZE);
+    CHECK(IsSilent(&stream));
+    volatile UCHAR* base = stream.Buffer.GetBaseAddress();
+    base[1] = 0x22;
+    CHECK_EQ(base[6 * PAGE_SIZE + 1], 0x22);
+
+    // Ten pages need the next class up.
+    LoopbackStream larger;
+    CHECK_EQ(OpenPooled(&pool, &larger, FALSE, 10 * PAGE_SIZE), STATUS_SUCCESS);
+    CHECK_EQ(Stats(&pool).Misses, 2u);
+    LoopbackStreamFreeBuffer(&larger);
+    LoopbackStreamFreeBuffer(&stream);
+    CHECK_EQ(Stats(&pool).PooledBytes, (ULONGLONG)(c_ClassBytes + 16 * PAGE_SIZE));
+
+    // Past the largest class the stream allocates its own pages.
+    LoopbackStreamInit(&larger, FALSE);
+    LoopbackStreamSetFormat(&larger, 192000 * 32, 32, 0, 8, TRUE);
+    CHECK_EQ(LoopbackStreamAllocatePooledBuffer(&larger, &pool, 192000 * 32, 0, nullptr), STATUS_SUCCESS);
+    CHECK(larger.Pages->Block == nullptr);
+    CHECK_EQ(Stats(&pool).Oversized, 1u);
+    LoopbackStreamFreeBuffer(&larger);
+    CHECK_EQ(Stats(&pool).Returned, 3u);
+
+    LeylineBufferPoolCleanup(&pool);
+}
+
+TEST(HighWaterMarkBoundsThePool)
+{
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, c_ClassBytes);
+
+    // Room for one block: the second is freed as it comes back.
+    LoopbackStream a, b;
+    CHECK_EQ(OpenPooled(&pool, &a, FALSE), STATUS_SUCCESS);
+    CHECK_EQ(OpenPooled(&pool, &b, FALSE), STATUS_SUCCESS);
+    LoopbackStreamFreeBuffer(&a);
+    LoopbackStreamFreeBuffer(&b);
+    CHECK_EQ(Stats(&pool).Returned, 1u);
+    CHECK_EQ(Stats(&pool).Trimmed, 1u);
+    CHECK_EQ(Stats(&pool).PooledBytes, (ULONGLONG)c_ClassBytes);
+
+    // A limit of zero empties the pool and stops pooling.
+    LeylineBufferPoolSetLimit(&pool, 0);
+    CHECK_EQ(Stats(&pool).Trimmed, 2u);
+    CHECK_EQ(Stats(&pool).PooledBytes, 0ull);
+    CHECK_EQ(HostWorkItemsRun(), 1u);
+    CHECK_EQ(Stats(&pool).ZeroedAhead, 0u);
+
+    CHECK_EQ(OpenPooled(&pool, &a, FALSE), STATUS_SUCCESS);
+    CHECK(a.Pages->Block == nullptr);
+    CHECK_EQ(Stats(&pool).Misses, 2u);
+    LoopbackStreamFreeBuffer(&a);
+    CHECK_EQ(Stats(&pool).Returned, 1u);
+
+    LeylineBufferPoolCleanup(&pool);
+}
+
+TEST(AliasedCaptureHoldsPooledPages)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, LEYLINE_POOL_DEFAULT_LIMIT);
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    CHECK_EQ(OpenPooled(&pool, &render, FALSE), STATUS_SUCCESS);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    LoopbackStreamInit(&capture, TRUE);
+    LoopbackStreamSetFormat(&capture, 48000 * 4, 16, 0, 2, FALSE);
+    CHECK_EQ(LoopbackEngineAliasBuffer(&engine, &capture, c_BufferBytes, nullptr), STATUS_SUCCESS);
+    CHECK(capture.Pages == render.Pages);
+
+    // The block goes back only when the capture lets go too.
+    CloseStream(&engine, &render);
+    CHECK_EQ(Stats(&pool).Returned, 0u);
+    CloseStream(&engine, &capture);
+    CHECK_EQ(Stats(&pool).Returned, 1u);
+
+    LoopbackEngineCleanup(&engine);
+    LeylineBufferPoolCleanup(&pool);
+}
+
+TEST(CleanupWaitsForZeroing)
+{
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, LEYLINE_POOL_DEFAULT_LIMIT);
+
+    LoopbackStream returned, late;
+    CHECK_EQ(OpenPooled(&pool, &returned, FALSE), STATUS_SUCCESS);
+    CHECK_EQ(OpenPooled(&pool, &late, FALSE), STATUS_SUCCESS);
+    LoopbackStreamFreeBuffer(&returned);
+
+    // The queued zeroing runs before cleanup frees anything; a buffer returned after
+    // cleanup is freed, not pooled.
+    LeylineBufferPoolCleanup(&pool);
+    CHECK_EQ(HostWorkItemsRun(), 0u);
+    CHECK_EQ(Stats(&pool).PooledBytes, 0ull);
+    CHECK_EQ(Stats(&pool).Trimmed, 1u);
+    LoopbackStreamFreeBuffer(&late);
+    CHECK_EQ(Stats(&pool).Returned, 1u);
+    CHECK_EQ(Stats(&pool).Trimmed, 2u);
+    CHECK_EQ(Stats(&pool).PooledBytes, 0ull);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,143 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CABLE SCALING BENCHMARK
+// Each cable is one render and one capture stream. "cables" gives every cable its own
+// engine and timer, as the driver does; "parallel" fires those timers from a worker
+// per spare core, as DPCs spread over processors would; "shared" puts every stream on one
+// engine, as the driver did before, where each capture records every cable's render
+// and all of them wait on one lock. Rows report the wall-clock cost of one simulated
+// millisecond (every timer fired once) and that cost divided by the cable count.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace HostSim;
+
+static const ULONG c_Rate       = 48000;
+static const ULONG c_BufferSize = c_Rate * 4 / 10;     // 100 ms of 16-bit stereo
+
+enum CableMode { ModeCables, ModeParallel, ModeShared };
+
+static const char* const s_ModeNames[] = { "cables", "parallel", "shared" };
+
+// Spin barrier: the main thread bumps Generation to start a tick, workers count
+// themselves back in through Done.
+struct TickGate
+{
+    std::atomic<ULONG> Generation{ 0 };
+    std::atomic<ULONG> Done{ 0 };
+    std::atomic<bool>  Quit{ false };
+};
+
+static void Worker(TickGate* gate, LoopbackEngine* engines, ULONG first, ULONG count)
+{
+    ULONG seen = 0;
+    for (;;)
+    {
+        ULONG generation;
+        while ((generation = gate->Generation.load(std::memory_order_acquire)) == seen)
+        {
+            if (gate->Quit.load(std::memory_order_acquire)) return;
+        }
+        seen = generation;
+        for (ULONG e = first; e < first + count; e++) HostTimerFire(&engines[e].LoopbackTimer);
+        gate->Done.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+static void RunCables(ULONG cableCount, CableMode mode, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    BOOLEAN shared = mode == ModeShared;
+    ULONG engineCount = shared ? 1 : cableCount;
+    std::unique_ptr<LoopbackEngine[]> engines(new LoopbackEngine[engineCount]);
+    for (ULONG e = 0; e < engineCount; e++) LoopbackEngineInit(&engines[e]);
+
+    std::vector<LoopbackStream> renders(cableCount), captures(cableCount);
+    for (ULONG c = 0; c < cableCount; c++)
+    {
+        LoopbackEngine* engine = &engines[shared ? 0 : c];
+        OpenStream(&renders[c],  FALSE, c_Rate, 16, 2, FALSE, c_BufferSize);
+        OpenStream(&captures[c], TRUE,  c_Rate, 16, 2, FALSE, c_BufferSize);
+        LoopbackStreamSetState(engine, &renders[c],  KSSTATE_RUN);
+        LoopbackStreamSetState(engine, &captures[c], KSSTATE_RUN);
+    }
+
+    TickGate gate;
+    std::vector<std::thread> workers;
+    if (mode == ModeParallel)
+    {
+        // The main thread spins too, so leave it a core.
+        ULONG threads = std::max(1u, std::min(cableCount, std::thread::hardware_concurrency() - 1));
+        for (ULONG t = 0, first = 0; t < threads; t++)
+        {
+            ULONG count = cableCount / threads + (t < cableCount % threads ? 1 : 0);
+            workers.emplace_back(Worker, &gate, engines.get(), first, count);
+            first += count;
+        }
+    }
+
+    HostBench::Samples perTick, perCable;
+    perTick.Reserve(ticks);
+    perCable.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        if (mode == ModeParallel)
+        {
+            gate.Done.store(0, std::memory_order_relaxed);
+            gate.Generation.fetch_add(1, std::memory_order_acq_rel);
+            while (gate.Done.load(std::memory_order_acquire) < workers.size()) {}
+        }
+        else
+        {
+            for (ULONG e = 0; e < engineCount; e++) HostTimerFire(&engines[e].LoopbackTimer);
+        }
+        long long ns = HostBench::WallNs() - t0;
+        perTick.Add(ns);
+        perCable.Add(ns / cableCount);
+    }
+
+    gate.Quit.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) worker.join();
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s x%u", s_ModeNames[mode], cableCount);
+    HostBench::PrintRow(label, perTick);
+    snprintf(label, sizeof(label), "%s x%u per cable", s_ModeNames[mode], cableCount);
+    HostBench::PrintRow(label, perCable);
+
+    for (ULONG c = 0; c < cableCount; c++)
+    {
+        LoopbackEngine* engine = &engines[shared ? 0 : c];
+        CloseStream(engine, &captures[c]);
+        CloseStream(engine, &renders[c]);
+    }
+    for (ULONG e = 0; e < engineCount; e++) LoopbackEngineCleanup(&engines[e]);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 5000);
+
+    static const ULONG counts[] = { 1, 8, 32, 64 };
+
+    HostBench::PrintHeader("Loopback time per 1 ms, 48k/16/2 pcm cables");
+    printf("%u simulated ticks per row, %u hardware threads\n", ticks, std::thread::hardware_concurrency());
+    for (ULONG count : counts)
+    {
+        RunCables(count, ModeCables, ticks);
+        if (std::thread::hardware_concurrency() > 1) RunCables(count, ModeParallel, ticks);
+        RunCables(count, ModeShared, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// REGISTRATION CHURN BENCHMARK
+// One engine with a few steady render/capture pairs, ticked as fast as the timer can
+// be fired, while writer threads open, restart and close their own pairs on it. The
+// tick walks a published snapshot and never takes StreamLock, so its percentiles
+// should not move with the writer count beyond what sharing the cores costs; each
+// row also reports the writer cycles (RUN, PAUSE, RUN, STOP on a pair) completed.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace HostSim;
+
+static const ULONG c_Rate         = 48000;
+static const ULONG c_BufferSize   = c_Rate * 4 / 10;   // 100 ms of 16-bit stereo
+static const ULONG c_SteadyPairs  = 4;
+
+static void Writer(LoopbackEngine* engine, std::atomic<bool>* stop, std::atomic<ULONG>* cycles)
+{
+    LoopbackStream render, capture;
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        OpenStream(&render,  FALSE, c_Rate, 16, 2, FALSE, c_BufferSize);
+        OpenStream(&capture, TRUE,  c_Rate, 16, 2, FALSE, c_BufferSize);
+        LoopbackStreamSetState(engine, &render,  KSSTATE_RUN);
+        LoopbackStreamSetState(engine, &capture, KSSTATE_RUN);
+        LoopbackStreamSetState(engine, &render,  KSSTATE_PAUSE);
+        LoopbackStreamSetState(engine, &render,  KSSTATE_RUN);
+        CloseStream(engine, &capture);
+        CloseStream(engine, &render);
+        cycles->fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void RunChurn(ULONG writerCount, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    std::vector<LoopbackStream> renders(c_SteadyPairs), captures(c_SteadyPairs);
+    for (ULONG p = 0; p < c_SteadyPairs; p++)
+    {
+        OpenStream(&renders[p],  FALSE, c_Rate, 16, 2, FALSE, c_BufferSize);
+        OpenStream(&captures[p], TRUE,  c_Rate, 16, 2, FALSE, c_BufferSize);
+        LoopbackStreamSetState(&engine, &renders[p],  KSSTATE_RUN);
+        LoopbackStreamSetState(&engine, &captures[p], KSSTATE_RUN);
+    }
+
+    std::atomic<bool>  stop{ false };
+    std::atomic<ULONG> cycles{ 0 };
+    std::vector<std::thread> writers;
+    for (ULONG w = 0; w < writerCount; w++) writers.emplace_back(Writer, &engine, &stop, &cycles);
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+
+    stop.store(true);
+    for (std::thread& writer : writers) writer.join();
+
+    char label[64];
+    snprintf(label, sizeof(label), "tick, %u writers", writerCount);
+    HostBench::PrintRow(label, samples);
+    printf("  %u writer cycles during %u ticks\n", cycles.load(), ticks);
+
+    for (ULONG p = 0; p < c_SteadyPairs; p++)
+    {
+        CloseStream(&engine, &captures[p]);
+        CloseStream(&engine, &renders[p]);
+    }
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 20000);
+
+    static const ULONG writerCounts[] = { 0, 1, 3, 8 };
+
+    HostBench::PrintHeader("Loopback tick under registration churn, 4 steady 48k/16/2 pairs");
+    printf("%u ticks per row, %u hardware threads\n", ticks, std::thread::hardware_concurrency());
+    for (ULONG writers : writerCounts) RunChurn(writers, ticks);
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM CLOCK BENCHMARK
+// The per-stream clock against the multiply-and-divide it replaced, for the two
+// questions the tick and GetPosition ask: the current frame, and the position in the
+// buffer. Each row times batches of readings at advancing, uneven QPC values, for a
+// few formats and counter rates.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+#include "leyline_clock.h"
+
+// The previous position math, verbatim.
+namespace WaveRTMath
+{
+    // Convert elapsed QPC ticks to an absolute byte offset.
+    inline ULONGLONG TicksToBytes(LONGLONG elapsedTicks, ULONG byteRate, LONGLONG frequency)
+    {
+        if (frequency <= 0) return 0;
+        // Standard 64-bit math is safe for >100 days of continuous playback at 192kHz/24bit.
+        return (ULONGLONG)((elapsedTicks * (unsigned __int64)byteRate) / (unsigned __int64)frequency);
+    }
+
+    // Clamp a byte offset into a ring buffer.
+    inline ULONGLONG CalculatePosition(LONGLONG elapsedTicks, ULONG byteRate, LONGLONG frequency, SIZE_T bufferSize)
+    {
+        ULONGLONG bytes = TicksToBytes(elapsedTicks, byteRate, frequency);
+        if (bufferSize > 0) bytes %= (ULONGLONG)bufferSize;
+        return bytes;
+    }
+}
+
+struct BenchFormat
+{
+    const char* Label;
+    ULONG       Rate;
+    ULONG       FrameBytes;
+    LONGLONG    Frequency;
+};
+
+static const ULONG c_Batch = 1000;
+
+// Volatile inputs so the compiler can't hoist the divisor or fold the loop.
+static void RunFormat(const BenchFormat& fmt, ULONG iterations)
+{
+    volatile ULONG    byteRateIn   = fmt.Rate * fmt.FrameBytes;
+    volatile ULONG    frameBytesIn = fmt.FrameBytes;
+    volatile LONGLONG frequencyIn  = fmt.Frequency;
+    ULONG    byteRate   = byteRateIn;
+    ULONG    frameBytes = frameBytesIn;
+    LONGLONG frequency  = frequencyIn;
+    ULONG    bufferBytes  = fmt.Rate / 10 * frameBytes;
+    ULONG    bufferFrames = bufferBytes / frameBytes;
+
+    LeylineStreamClock clock;
+    LeylineClockInit(&clock, fmt.Rate, frequency, 0);
+    LeylineDivisor divisor;
+    LeylineDivisorInit(&divisor, bufferFrames);
+
+    // Readings about a millisecond apart, jittered, starting an hour in.
+    LONGLONG step  = frequency / 1000;
+    LONGLONG start = frequency * 3600;
+
+    HostBench::Samples legacyFrame, clockFrame, legacyPosition, clockPosition;
+    ULONGLONG sink = 0;
+    for (ULONG i = 0; i < iterations / c_Batch; i++)
+    {
+        LONGLONG base = start + (LONGLONG)i * c_Batch * step;
+
+        long long t0 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+            sink += WaveRTMath::TicksToBytes(base + b * step + (b & 7), byteRate, frequency) / frameBytes;
+        long long t1 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+            sink += LeylineClockFrames(&clock, base + b * step + (b & 7));
+        long long t2 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+            sink += WaveRTMath::CalculatePosition(base + b * step + (b & 7), byteRate, frequency, bufferBytes);
+        long long t3 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+            sink += LeylineModulo(&divisor, LeylineClockFrames(&clock, base + b * step + (b & 7))) * frameBytes;
+        long long t4 = HostBench::WallNs();
+
+        legacyFrame.Add(t1 - t0);
+        clockFrame.Add(t2 - t1);
+        legacyPosition.Add(t3 - t2);
+        clockPosition.Add(t4 - t3);
+    }
+    HostBench::Consume(&sink);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s frame div", fmt.Label);
+    HostBench::PrintRow(label, legacyFrame);
+    snprintf(label, sizeof(label), "%s frame clock", fmt.Label);
+    HostBench::PrintRow(label, clockFrame);
+    snprintf(label, sizeof(label), "%s pos div", fmt.Label);
+    HostBench::PrintRow(label, legacyPosition);
+    snprintf(label, sizeof(label), "%s pos clock", fmt.Label);
+    HostBench::PrintRow(label, clockPosition);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG iterations = HostBench::IterationsFromArgs(argc, argv, 2000000);
+
+    static const BenchFormat formats[] =
+    {
+        { "48k/16/2",       48000,  4,  10000000 },
+        { "44.1k/24/2",     44100,  6,  10000000 },
+        { "192k/32/8",      192000, 32, 10000000 },
+        { "44.1k/24/2 acpi", 44100, 6,  3579545 },
+    };
+
+    HostBench::PrintHeader("Stream clock readings, 10 MHz QPC (acpi: 3.58 MHz)");
+    printf("%u readings per row, ns per batch of %u\n", iterations, c_Batch);
+    for (const BenchFormat& fmt : formats) RunFormat(fmt, iterations);
+    return 0;
+}
@@ -0,0 +1,287 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CLOCK TESTS
+// The stream clock and the fixed divisor against 128-bit reference arithmetic: every
+// tick of whole rate periods at several points of a counter's life, frame edges,
+// random times up to the counter's limit and awkward divisors. Then the stream
+// position built on them.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+#include "leyline_clock.h"
+
+#include <random>
+#include <vector>
+
+using namespace HostSim;
+
+typedef unsigned __int128 Wide;
+
+static const LONGLONG c_MaxQpc = 0x7FFFFFFFFFFFFFFFLL;
+
+static const LONGLONG c_Frequencies[] =
+{
+    1000000, 3579545, 10000000, 14318180, 24000000, 1LL << 20, 1LL << 24, 2999999929LL,
+};
+
+static const ULONG c_Rates[] =
+{
+    8000, 11025, 22050, 44100, 48000, 88200, 96000, 176400, 192000, 352800, 384000, 705600, 768000,
+};
+
+static ULONGLONG ReferenceFrames(LONGLONG elapsed, ULONG rate, LONGLONG frequency)
+{
+    return (ULONGLONG)((Wide)(ULONGLONG)elapsed * rate / (ULONGLONG)frequency);
+}
+
+static ULONGLONG Gcd(ULONGLONG a, ULONGLONG b)
+{
+    while (b)
+    {
+        ULONGLONG t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Mismatches over [First, First + Count) ticks after Start.
+static ULONG SweepMismatches(ULONG rate, LONGLONG frequency, LONGLONG start, LONGLONG first, LONGLONG count)
+{
+    LeylineStreamClock clock;
+    LeylineClockInit(&clock, rate, frequency, start);
+    ULONG mismatches = 0;
+    for (LONGLONG t = first; t < first + count; t++)
+        if (LeylineClockFrames(&clock, start + t) != ReferenceFrames(t, rate, frequency)) mismatches++;
+    return mismatches;
+}
+
+TEST(ClockMatchesReferenceOverWholePeriods)
+{
+    // frames(t + F/g) = frames(t) + R/g, so one period holds every rounding case the
+    // pair can produce. Sweep it at the start, after a few days and near the limit.
+    static const struct { ULONG Rate; LONGLONG Frequency; } pairs[] =
+    {
+        { 44100, 10000000 }, { 48000, 10000000 }, { 11025, 3579545 }, { 192000, 24000000 },
+        { 96000, 1LL << 20 }, { 22050, 14318180 },
+    };
+    for (const auto& pair : pairs)
+    {
+        LONGLONG period = pair.Frequency / (LONGLONG)Gcd(pair.Rate, (ULONGLONG)pair.Frequency);
+        period = min(period, (LONGLONG)4000000);
+        CHECK_EQ(SweepMismatches(pair.Rate, pair.Frequency, 0, 0, period), 0u);
+        CHECK_EQ(SweepMismatches(pair.Rate, pair.Frequency, 12345, 1LL << 42, period), 0u);
+        CHECK_EQ(SweepMismatches(pair.Rate, pair.Frequency, 0, c_MaxQpc - period, period), 0u);
+    }
+}
+
+TEST(ClockMatchesReferenceAtFrameEdges)
+{
+    // The first tick of each frame and the tick before it, the two readings an estimate
+    // that is one off would get wrong.
+    std::mt19937_64 rng(7);
+    ULONG mismatches = 0;
+    for (LONGLONG frequency : c_Frequencies)
+    {
+        for (ULONG rate : c_Rates)
+        {
+            LeylineStreamClock clock;
+            LeylineClockInit(&clock, rate, frequency, 0);
+            for (int i = 0; i < 2000; i++)
+            {
+                // Frame k starts at ceil(k * F / R).
+                ULONGLONG k     = (i < 1000) ? (ULONGLONG)i : rng() % ((ULONGLONG)c_MaxQpc / frequency * rate / 2);
+                Wide      edge  = ((Wide)k * (ULONGLONG)frequency + rate - 1) / rate;
+                LONGLONG  first = (LONGLONG)edge;
+                if (LeylineClockFrames(&clock, first) != k) mismatches++;
+                if (first > 0 && LeylineClockFrames(&clock, first - 1) != k - 1) mismatches++;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+TEST(ClockMatchesReferenceAtRandomTimes)
+{
+    std::mt19937_64 rng(11);
+    ULONG mismatches = 0;
+    for (LONGLONG frequency : c_Frequencies)
+    {
+        for (ULONG rate : c_Rates)
+        {
+            LeylineStreamClock clock;
+            LeylineClockInit(&clock, rate, frequency, 1000);
+            for (int i = 0; i < 20000; i++)
+            {
+                // Spread over every magnitude, not just the top few bits.
+                LONGLONG t = (LONGLONG)(rng() >> (1 + rng() % 63));
+                if (t > c_MaxQpc - 1000) continue;
+                if (LeylineClockFrames(&clock, 1000 + t) != ReferenceFrames(t, rate, frequency)) mismatches++;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+TEST(ClockHoldsOverWeeksOfUptime)
+{
+    // Eight weeks at 192 kHz: far past where elapsed * ByteRate overflowed 64 bits for
+    // 32-bit 8-channel streams (about a day at 10 MHz).
+    LONGLONG weeks = 8LL * 7 * 24 * 3600 * QPC_FREQUENCY;
+    LeylineStreamClock clock;
+    LeylineClockInit(&clock, 192000, QPC_FREQUENCY, 5);
+    CHECK_EQ(LeylineClockFrames(&clock, 5 + weeks), 8ull * 7 * 24 * 3600 * 192000);
+    CHECK_EQ(LeylineClockFrames(&clock, 5 + weeks - 1), 8ull * 7 * 24 * 3600 * 192000 - 1);
+    CHECK_EQ(SweepMismatches(192000, QPC_FREQUENCY, 5, weeks - 100000, 200000), 0u);
+
+    // And at the end of the counter.
+    LeylineClockInit(&clock, 768000, QPC_FREQUENCY, 0);
+    CHECK_EQ(LeylineClockFrames(&clock, c_MaxQpc), ReferenceFrames(c_MaxQpc, 768000, QPC_FREQUENCY));
+}
+
+TEST(ClockEdgeCases)
+{
+    LeylineStreamClock clock;
+    LeylineClockInit(&clock, 48000, QPC_FREQUENCY, 1000);
+    CHECK_EQ(LeylineClockFrames(&clock, 0), 0ull);
+    CHECK_EQ(LeylineClockFrames(&clock, 1000), 0ull);
+    CHECK_EQ(LeylineClockFrames(&clock, 1000 + QPC_FREQUENCY), 48000ull);
+
+    // A counter slower than the sample rate still gives whole frames.
+    LeylineClockInit(&clock, 192000, 32768, 0);
+    CHECK_EQ(clock.Whole, 5ull);
+    CHECK_EQ(SweepMismatches(192000, 32768, 0, 0, 32768 * 3), 0u);
+    CHECK_EQ(LeylineClockFrames(&clock, c_MaxQpc / 8), ReferenceFrames(c_MaxQpc / 8, 192000, 32768));
+
+    // Rate equal to the frequency: one frame per tick.
+    LeylineClockInit(&clock, 48000, 48000, 0);
+    CHECK_EQ(LeylineClockFrames(&clock, 123456789), 123456789ull);
+
+    // Nothing to count with.
+    LeylineClockInit(&clock, 0, QPC_FREQUENCY, 0);
+    CHECK_EQ(LeylineClockFrames(&clock, 1LL << 40), 0ull);
+    LeylineClockInit(&clock, 48000, 0, 0);
+    CHECK_EQ(LeylineClockFrames(&clock, 1LL << 40), 0ull);
+}
+
+TEST(ClockTimeOfIsTheFirstTickOfAFrame)
+{
+    std::mt19937_64 rng(19);
+    ULONG mismatches = 0;
+    for (LONGLONG frequency : c_Frequencies)
+    {
+        for (ULONG rate : c_Rates)
+        {
+            LeylineStreamClock clock;
+            LeylineClockInit(&clock, rate, frequency, 77);
+            ULONGLONG limit = (ULONGLONG)(c_MaxQpc / 2) / (ULONGLONG)frequency * rate;
+            for (int i = 0; i < 4000; i++)
+            {
+                ULONGLONG frame = (i < 1000) ? (ULONGLONG)i : rng() % limit;
+                LONGLONG  time  = LeylineClockTimeOf(&clock, frame);
+                Wide      exact = ((Wide)frame * (ULONGLONG)frequency + rate - 1) / rate;
+                if (time != 77 + (LONGLONG)exact) mismatches++;
+                if (LeylineClockFrames(&clock, time) < frame) mismatches++;
+                if (frame > 0 && LeylineClockFrames(&clock, time - 1) >= frame) mismatches++;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+
+    // Past the end of the counter, and a clock that never moves.
+    LeylineStreamClock clock;
+    LeylineClockInit(&clock, 48000, QPC_FREQUENCY, 0);
+    CHECK_EQ(LeylineClockTimeOf(&clock, ~0ull / 4), MAXLONGLONG);
+    LeylineClockInit(&clock, 0, QPC_FREQUENCY, 0);
+    CHECK_EQ(LeylineClockTimeOf(&clock, 1), MAXLONGLONG);
+}
+
+TEST(DivisorMatchesHardwareDivide)
+{
+    std::vector<ULONGLONG> divisors = { 1, 2, 3, 5, 7, 10, 441, 480, 1920, 4410, 48000, 65535, 65536, 65537,
+                                        0xFFFFFFFFull, 0x100000000ull, 0x100000001ull, 1ull << 63,
+                                        (1ull << 63) + 1, ~0ull - 1, ~0ull };
+    std::mt19937_64 rng(13);
+    for (int i = 0; i < 200; i++) divisors.push_back(rng() >> (rng() % 64) | 1);
+
+    ULONG mismatches = 0;
+    for (ULONGLONG d : divisors)
+    {
+        LeylineDivisor divisor;
+        LeylineDivisorInit(&divisor, d);
+
+        std::vector<ULONGLONG> values = { 0, 1, d - 1, d, d + 1, ~0ull, ~0ull - 1, ~0ull - d, ~0ull / d * d,
+                                          ~0ull / d * d - 1 };
+        for (int i = 0; i < 2000; i++) values.push_back(rng() >> (rng() % 64));
+        for (int i = 0; i < 200; i++)
+        {
+            ULONGLONG q = rng() % (~0ull / d);
+            values.push_back(q * d);
+            if (q) values.push_back(q * d - 1);
+        }
+
+        for (ULONGLONG v : values)
+        {
+            ULONGLONG remainder;
+            ULONGLONG quotient = LeylineDivide(&divisor, v, &remainder);
+            if (quotient != v / d || remainder != v % d) mismatches++;
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+TEST(StreamPositionIsWholeFrames)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    // 44.1k 24-bit stereo: 6-byte frames that never line up with 1 ms of ticks.
+    LoopbackStream stream;
+    CHECK(NT_SUCCESS(OpenStream(&stream, FALSE, 44100, 24, 2, FALSE, 44100 * 6 / 10)));
+    LoopbackStreamSetState(nullptr, &stream, KSSTATE_RUN);
+    LONGLONG  start  = stream.StartTime;
+    ULONGLONG frames = stream.Buffer.GetSize() / 6;
+
+    std::mt19937_64 rng(17);
+    ULONG misaligned = 0, mismatches = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        LONGLONG  now      = start + (LONGLONG)(rng() >> (24 + rng() % 40));
+        ULONGLONG position = LoopbackStreamPosition(&stream, now);
+        if (position % 6 != 0) misaligned++;
+        if (position != ReferenceFrames(now - start, 44100, QPC_FREQUENCY) % frames * 6) mismatches++;
+    }
+    CHECK_EQ(misaligned, 0u);
+    CHECK_EQ(mismatches, 0u);
+
+    LoopbackStreamSetState(nullptr, &stream, KSSTATE_STOP);
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+TEST(StreamPositionSurvivesDaysAtHighRates)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    // 192k 32-bit 8-channel is 6.1 MB/s; at 10 MHz the old tick * byte-rate product
+    // overflowed 64 bits after about 1.7 days.
+    LoopbackStream stream;
+    CHECK(NT_SUCCESS(OpenStream(&stream, FALSE, 192000, 32, 8, TRUE, 192000 * 32 / 10)));
+    LoopbackStreamSetState(nullptr, &stream, KSSTATE_RUN);
+    LONGLONG  start  = stream.StartTime;
+    ULONGLONG frames = stream.Buffer.GetSize() / 32;
+
+    for (LONGLONG days = 1; days <= 60; days++)
+    {
+        LONGLONG elapsed = days * 24 * 3600 * QPC_FREQUENCY + days * 7919;
+        CHECK_EQ(LoopbackStreamPosition(&stream, start + elapsed),
+                 ReferenceFrames(elapsed, 192000, QPC_FREQUENCY) % frames * 32);
+    }
+
+    LoopbackStreamSetState(nullptr, &stream, KSSTATE_STOP);
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FORMAT CONVERSION BENCHMARK
+// Frames per second for every source -> destination format pair at each SIMD level
+// this CPU supports. A conversion is one block through the float bus: zero, decode and
+// accumulate, then saturate and encode, exactly as the loopback tick does it.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+static const ULONG CHANNELS     = 2;
+static const ULONG TOTAL_FRAMES = 48000; // One second of stereo audio per pass
+
+static const char* const s_FormatNames[LeylineSampleFormatCount] =
+    { "none", "int16", "int24", "int24in32", "int32", "float32" };
+static const ULONG s_SampleBytes[LeylineSampleFormatCount] = { 0, 2, 3, 4, 4, 4 };
+static const char* const s_LevelNames[] = { "scalar", "sse2", "avx2" };
+
+static double MeasureFramesPerSecond(const LeylineMixKernels* src, ULONG srcFrameBytes,
+                                     const LeylineMixKernels* dst, ULONG dstFrameBytes,
+                                     const UCHAR* srcBuf, UCHAR* dstBuf, ULONG passes)
+{
+    static float bus[LEYLINE_MIX_BLOCK_FRAMES * CHANNELS];
+
+    long long t0 = HostBench::WallNs();
+    for (ULONG pass = 0; pass < passes; pass++)
+    {
+        for (ULONG frame = 0; frame < TOTAL_FRAMES; frame += LEYLINE_MIX_BLOCK_FRAMES)
+        {
+            ULONG frames  = min((ULONG)LEYLINE_MIX_BLOCK_FRAMES, TOTAL_FRAMES - frame);
+            ULONG samples = frames * CHANNELS;
+            memset(bus, 0, samples * sizeof(float));
+            src->Accumulate(bus, srcBuf + (SIZE_T)frame * srcFrameBytes, samples);
+            dst->WriteOut(dstBuf + (SIZE_T)frame * dstFrameBytes, bus, samples, 1.0f);
+        }
+        HostBench::Consume(dstBuf);
+    }
+    long long elapsed = HostBench::WallNs() - t0;
+    return (double)TOTAL_FRAMES * passes * 1e9 / (double)(elapsed > 0 ? elapsed : 1);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG passes = HostBench::IterationsFromArgs(argc, argv, 200);
+
+    // Sized for the widest format; every format reads a prefix of the same pattern.
+    std::vector<UCHAR> srcBuf(TOTAL_FRAMES * CHANNELS * 4), dstBuf(TOTAL_FRAMES * CHANNELS * 4);
+    for (size_t i = 0; i < srcBuf.size(); i++) srcBuf[i] = (UCHAR)(i * 29 + (i >> 7));
+    // Keep float samples finite and in range.
+    float* asFloat = reinterpret_cast<float*>(srcBuf.data());
+    for (size_t i = 0; i < srcBuf.size() / 4; i++) asFloat[i] = (float)((LONG)(i * 2654435761u)) / 2147483648.0f;
+
+    LeylineSimdLevel detected = LeylineDetectSimdLevel();
+
+    HostBench::PrintHeader("Format conversion throughput (stereo, Mframes/s)");
+    printf("%u passes of %u frames per pair; detected level: %s\n",
+           passes, TOTAL_FRAMES, s_LevelNames[detected]);
+
+    printf("%-22s", "src -> dst");
+    for (int level = LeylineSimdScalar; level <= (int)detected; level++) printf("%12s", s_LevelNames[level]);
+    printf("\n");
+
+    for (int from = LeylineSampleInt16; from < LeylineSampleFormatCount; from++)
+    {
+        for (int to = LeylineSampleInt16; to < LeylineSampleFormatCount; to++)
+        {
+            char label[48];
+            snprintf(label, sizeof(label), "%s -> %s", s_FormatNames[from], s_FormatNames[to]);
+            printf("%-22s", label);
+
+            for (int level = LeylineSimdScalar; level <= (int)detected; level++)
+            {
+                const LeylineMixKernels* src = LeylineSelectMixKernels((LeylineSampleFormat)from, (LeylineSimdLevel)level);
+                const LeylineMixKernels* dst = LeylineSelectMixKernels((LeylineSampleFormat)to, (LeylineSimdLevel)level);
+                double fps = MeasureFramesPerSecond(src, s_SampleBytes[from] * CHANNELS,
+                                                    dst, s_SampleBytes[to] * CHANNELS,
+                                                    srcBuf.data(), dstBuf.data(), passes);
+                printf("%12.1f", fps / 1e6);
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MASTER GAIN BENCHMARK
+// Frames per second for the raw capture copy with master gain applied, per format and
+// SIMD level. "memcpy" is the unity-gain path; "fused" is the ScaleCopy kernel the
+// DPC uses below unity; "two-pass" copies first and then scales the destination in a
+// second walk, the shape the fused kernel replaces.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+static const ULONG CHANNELS     = 2;
+static const ULONG TOTAL_FRAMES = 48000; // One second of stereo audio per pass
+static const ULONG CHUNK_FRAMES = 480;   // One 10 ms DPC's worth per call
+static const float GAIN         = 0.5011872f;
+
+static const char* const s_FormatNames[LeylineSampleFormatCount] =
+    { "none", "int16", "int24", "int24in32", "int32", "float32" };
+static const ULONG s_SampleBytes[LeylineSampleFormatCount] = { 0, 2, 3, 4, 4, 4 };
+static const char* const s_LevelNames[] = { "scalar", "sse2", "avx2" };
+
+enum Method { MethodMemcpy, MethodFused, MethodTwoPass };
+
+static double MeasureFramesPerSecond(Method method, const LeylineMixKernels* kernels, ULONG frameBytes,
+                                     const UCHAR* srcBuf, UCHAR* dstBuf, ULONG passes)
+{
+    long long t0 = HostBench::WallNs();
+    for (ULONG pass = 0; pass < passes; pass++)
+    {
+        for (ULONG frame = 0; frame < TOTAL_FRAMES; frame += CHUNK_FRAMES)
+        {
+            SIZE_T offset  = (SIZE_T)frame * frameBytes;
+            ULONG  samples = CHUNK_FRAMES * CHANNELS;
+            switch (method)
+            {
+            case MethodMemcpy:
+                memcpy(dstBuf + offset, srcBuf + offset, (SIZE_T)CHUNK_FRAMES * frameBytes);
+                break;
+            case MethodFused:
+                kernels->ScaleCopy(dstBuf + offset, srcBuf + offset, samples, GAIN);
+                break;
+            case MethodTwoPass:
+                memcpy(dstBuf + offset, srcBuf + offset, (SIZE_T)CHUNK_FRAMES * frameBytes);
+                kernels->ScaleCopy(dstBuf + offset, dstBuf + offset, samples, GAIN);
+                break;
+            }
+        }
+        HostBench::Consume(dstBuf);
+    }
+    long long elapsed = HostBench::WallNs() - t0;
+    return (double)TOTAL_FRAMES * passes * 1e9 / (double)(elapsed > 0 ? elapsed : 1);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG passes = HostBench::IterationsFromArgs(argc, argv, 200);
+
+    std::vector<UCHAR> srcBuf(TOTAL_FRAMES * CHANNELS * 4), dstBuf(TOTAL_FRAMES * CHANNELS * 4);
+    for (size_t i = 0; i < srcBuf.size(); i++) srcBuf[i] = (UCHAR)(i * 29 + (i >> 7));
+    float* asFloat = reinterpret_cast<float*>(srcBuf.data());
+    for (size_t i = 0; i < srcBuf.size() / 4; i++) asFloat[i] = (float)((LONG)(i * 2654435761u)) / 2147483648.0f;
+
+    LeylineSimdLevel detected = LeylineDetectSimdLevel();
+
+    HostBench::PrintHeader("Master gain on the raw copy (stereo, Mframes/s)");
+    printf("%u passes of %u frames, gain %.4f; detected level: %s\n",
+           passes, TOTAL_FRAMES, GAIN, s_LevelNames[detected]);
+
+    printf("%-22s%12s", "format / method", "memcpy");
+    for (int level = LeylineSimdScalar; level <= (int)detected; level++) printf("%12s", s_LevelNames[level]);
+    printf("\n");
+
+    for (int format = LeylineSampleInt16; format < LeylineSampleFormatCount; format++)
+    {
+        ULONG frameBytes = s_SampleBytes[format] * CHANNELS;
+        for (Method method : { MethodFused, MethodTwoPass })
+        {
+            char label[48];
+            snprintf(label, sizeof(label), "%s %s", s_FormatNames[format],
+                     (method == MethodFused) ? "fused" : "two-pass");
+            printf("%-22s", label);
+
+            const LeylineMixKernels* base = LeylineSelectMixKernels((LeylineSampleFormat)format, LeylineSimdScalar);
+            printf("%12.1f", MeasureFramesPerSecond(MethodMemcpy, base, frameBytes,
+                                                    srcBuf.data(), dstBuf.data(), passes) / 1e6);
+
+            for (int level = LeylineSimdScalar; level <= (int)detected; level++)
+            {
+                const LeylineMixKernels* kernels = LeylineSelectMixKernels((LeylineSampleFormat)format, (LeylineSimdLevel)level);
+                double fps = MeasureFramesPerSecond(method, kernels, frameBytes,
+                                                    srcBuf.data(), dstBuf.data(), passes);
+                printf("%12.1f", fps / 1e6);
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
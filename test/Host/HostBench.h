@@ -0,0 +1,79 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HOST BENCHMARK HELPERS
+// Wall-clock sampling and percentile reporting for the host benchmarks.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "HostTest.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace HostBench
+{
+    // Wall-clock nanoseconds; the virtual QPC only drives the simulation.
+    inline long long WallNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct Samples
+    {
+        std::vector<long long> Ns;
+
+        void Reserve(size_t n) { Ns.reserve(n); }
+        void Add(long long ns) { Ns.push_back(ns); }
+
+        double Mean() const
+        {
+            if (Ns.empty()) return 0.0;
+            long double sum = 0;
+            for (long long v : Ns) sum += v;
+            return (double)(sum / Ns.size());
+        }
+
+        // Sorts in place; call after sampling is finished.
+        long long Percentile(double p)
+        {
+            if (Ns.empty()) return 0;
+            std::sort(Ns.begin(), Ns.end());
+            size_t idx = (size_t)(p / 100.0 * (Ns.size() - 1) + 0.5);
+            return Ns[idx];
+        }
+    };
+
+    inline void PrintHeader(const char* title)
+    {
+        printf("\n== %s ==\n", title);
+    }
+
+    inline void PrintRow(const char* label, Samples& s)
+    {
+        printf("%-28s mean %9.1f ns  p50 %8lld ns  p99 %8lld ns  max %8lld ns\n",
+               label, s.Mean(), s.Percentile(50), s.Percentile(99), s.Percentile(100));
+    }
+
+    // Optional first argument scales the iteration count (e.g. "bench 100000").
+    inline ULONG IterationsFromArgs(int argc, char** argv, ULONG fallback)
+    {
+        if (argc > 1)
+        {
+            long v = strtol(argv[1], nullptr, 10);
+            if (v > 0) return (ULONG)v;
+        }
+        return fallback;
+    }
+
+    // Defeat dead-store elimination of benchmark outputs.
+    inline void Consume(const void* p)
+    {
+        __asm__ __volatile__("" : : "r"(p) : "memory");
+    }
+}
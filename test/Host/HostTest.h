@@ -0,0 +1,143 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HOST TEST HARNESS
+// Minimal CHECK/TEST macros plus loopback simulation helpers shared by the host
+// tests and benchmarks. No third-party framework: each test file is its own binary.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#pragma once
+
+#include "leyline_loopback.h"
+
+#include <stdio.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TEST REGISTRY
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace HostTest
+{
+    typedef void (*TestFn)();
+
+    struct TestCase
+    {
+        const char* Name;
+        TestFn      Fn;
+        TestCase*   Next;
+    };
+
+    inline TestCase*& Head()     { static TestCase* s_Head = nullptr; return s_Head; }
+    inline int&       Failures() { static int s_Failures = 0; return s_Failures; }
+
+    struct Registrar
+    {
+        TestCase Case;
+        Registrar(const char* name, TestFn fn) : Case{ name, fn, nullptr }
+        {
+            TestCase** tail = &Head();
+            while (*tail) tail = &(*tail)->Next;
+            *tail = &Case;
+        }
+    };
+
+    inline int RunAll()
+    {
+        int run = 0;
+        for (TestCase* t = Head(); t; t = t->Next)
+        {
+            int before = Failures();
+            t->Fn();
+            printf("[%s] %s\n", (Failures() == before) ? "PASS" : "FAIL", t->Name);
+            run++;
+        }
+        printf("%d test(s), %d failure(s)\n", run, Failures());
+        return Failures() ? 1 : 0;
+    }
+}
+
+#define TEST(name)                                                         \
+    static void name();                                                    \
+    static HostTest::Registrar s_Registrar_##name(#name, name);            \
+    static void name()
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            HostTest::Failures()++;                                        \
+        }                                                                  \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                     \
+    do {                                                                   \
+        auto _va = (a); auto _vb = (b);                                    \
+        if (!(_va == _vb)) {                                               \
+            printf("  %s:%d: CHECK_EQ(%s, %s) failed: %lld vs %lld\n",     \
+                   __FILE__, __LINE__, #a, #b, (long long)_va, (long long)_vb); \
+            HostTest::Failures()++;                                        \
+        }                                                                  \
+    } while (0)
+
+#define HOST_TEST_MAIN() int main() { return HostTest::RunAll(); }
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SIMULATION HELPERS
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace HostSim
+{
+    // Virtual QPC runs at 10 MHz, so one 1 ms loopback period is 10000 ticks.
+    static const LONGLONG QPC_FREQUENCY = 10000000;
+    static const LONGLONG TICK_QPC      = QPC_FREQUENCY / 1000;
+
+    // Open a stream with a private buffer, as AllocateAudioBuffer would.
+    inline NTSTATUS OpenStream(LoopbackStream* stream, BOOLEAN capture, ULONG sampleRate,
+                               ULONG bitsPerSample, ULONG channels, BOOLEAN isFloat,
+                               ULONG bufferBytes, ULONG bufferFlags = 0)
+    {
+        LoopbackStreamInit(stream, capture);
+        ULONG blockAlign = (bitsPerSample / 8) * channels;
+        LoopbackStreamSetFormat(stream, sampleRate * blockAlign, bitsPerSample, 0, channels, isFloat);
+        return LoopbackStreamAllocateBuffer(stream, bufferBytes, bufferFlags, nullptr);
+    }
+
+    inline void CloseStream(LoopbackEngine* engine, LoopbackStream* stream)
+    {
+        LoopbackStreamSetState(engine, stream, KSSTATE_STOP);
+        LoopbackStreamReleaseEvents(engine, stream);
+        LoopbackStreamFreeBuffer(stream);
+    }
+
+    // Move the virtual clock to Until, stopping at each time the notification timer is
+    // armed for on the way to fire it. Returns the number of callbacks.
+    inline ULONG RunNotifications(LoopbackEngine* engine, LONGLONG until)
+    {
+        ULONG    fired = 0;
+        LONGLONG due;
+        while (HostExTimerDue(engine->NotifyTimer, &due) && due <= until)
+        {
+            if (due > HostClockNow()) HostClockSet(due);
+            fired += HostExTimerFire(engine->NotifyTimer);
+        }
+        HostClockSet(until);
+        return fired;
+    }
+
+    // Advance the virtual clock one period at a time, firing the engine timer, whichever
+    // of the two is ticking, and the notification timer whenever it comes due in between.
+    // An engine with a worker thread has it run at once after each period's timer.
+    inline ULONG RunTicks(LoopbackEngine* engine, ULONG ticks, LONGLONG tickQpc = TICK_QPC)
+    {
+        ULONG fired = 0;
+        for (ULONG i = 0; i < ticks; i++)
+        {
+            RunNotifications(engine, HostClockNow() + tickQpc);
+            fired += HostTimerFire(&engine->LoopbackTimer);
+            fired += HostExTimerFire(engine->FastTimer);
+            if (engine->WorkerThread) LoopbackEngineWork(engine);
+        }
+        return fired;
+    }
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STRUCTURE LAYOUT REPORT
+// Offsets and sizes of the structures the loopback tick walks, with the cache line each
+// field starts on. The build runs it and writes layout.txt next to the binaries; the
+// static_asserts below fail the build if a field the tick updates drifts off the
+// stream's first line, what the snapshot copies spills past line 2, or a stream table
+// entry grows past two. The miniport classes
+// need PortCls, so only the portable structures they embed are reported; the slabs
+// give those objects whole, aligned lines.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+#include "leyline_slab.h"
+
+#include <stddef.h>
+
+// LoopbackStream holds a RingBuffer, whose private members make it non-standard-layout;
+// GCC and Clang still give the offsets this report needs.
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+
+#define LINE        SYSTEM_CACHE_ALIGNMENT_SIZE
+#define TICK_FIELD(Field)                                                               \
+    static_assert(offsetof(LoopbackStream, Field) + sizeof(LoopbackStream::Field) <= LINE, \
+                  #Field " is touched every tick")
+
+TICK_FIELD(BufferBase);
+TICK_FIELD(BufferFrames);
+TICK_FIELD(State);
+TICK_FIELD(FrameBytes);
+TICK_FIELD(HwPositionRegister);
+TICK_FIELD(HwClockRegister);
+TICK_FIELD(Cursor);
+TICK_FIELD(PositionSlot);
+TICK_FIELD(Mixing);
+TICK_FIELD(Resampling);
+
+// A position query needs only line 0 and the clock on line 1.
+TICK_FIELD(ByteRate);
+TICK_FIELD(StartTime);
+static_assert(offsetof(LoopbackStream, Clock) == LINE, "the clock starts line 1");
+static_assert(alignof(LoopbackStream) == LINE, "a stream starts on a line");
+
+// What the snapshot copies from the stream shares line 2 after the clock.
+static_assert(offsetof(LoopbackStream, FrameShift) == 2 * LINE, "the copy sources start line 2");
+static_assert(offsetof(LoopbackStream, IsCapture) < 3 * LINE, "the copy sources fit line 2");
+
+// The rest of what the tick reads, one table entry per stream.
+static_assert(sizeof(LoopbackTickStream) == 2 * LINE, "a stream table entry is two lines");
+static_assert(FIELD_OFFSET(LoopbackSnapshot, Streams) % LINE == 0, "the stream table starts on a line");
+
+static void Field(const char* name, size_t offset, size_t size)
+{
+    printf("  %-24s %6zu %6zu   line %zu\n", name, offset, size, offset / LINE);
+}
+
+#define STRUCT(Type)    printf("\n%s: %zu bytes, %zu lines, align %zu\n", #Type, sizeof(Type), \
+                               (sizeof(Type) + LINE - 1) / LINE, alignof(Type))
+#define FIELD(Type, F)  Field(#F, offsetof(Type, F), sizeof(((Type*)nullptr)->F))
+
+int main()
+{
+    printf("Leyline structure layout (%d-byte cache lines)\n", LINE);
+    printf("  %-24s %6s %6s\n", "field", "offset", "size");
+
+    STRUCT(LoopbackStream);
+    FIELD(LoopbackStream, BufferBase);
+    FIELD(LoopbackStream, BufferFrames);
+    FIELD(LoopbackStream, State);
+    FIELD(LoopbackStream, ByteRate);
+    FIELD(LoopbackStream, FrameBytes);
+    FIELD(LoopbackStream, StartTime);
+    FIELD(LoopbackStream, HwPositionRegister);
+    FIELD(LoopbackStream, HwClockRegister);
+    FIELD(LoopbackStream, Cursor);
+    FIELD(LoopbackStream, PositionSlot);
+    FIELD(LoopbackStream, Mixing);
+    FIELD(LoopbackStream, Resampling);
+    FIELD(LoopbackStream, Clock);
+    FIELD(LoopbackStream, FrameRate);
+    FIELD(LoopbackStream, Channels);
+    FIELD(LoopbackStream, FrameShift);
+    FIELD(LoopbackStream, BufferDivisor);
+    FIELD(LoopbackStream, Kernels);
+    FIELD(LoopbackStream, Pages);
+    FIELD(LoopbackStream, SampleFormat);
+    FIELD(LoopbackStream, SafetyFrames);
+    FIELD(LoopbackStream, PositionId);
+    FIELD(LoopbackStream, BufferMirrored);
+    FIELD(LoopbackStream, IsCapture);
+    FIELD(LoopbackStream, NotifyNext);
+    FIELD(LoopbackStream, NotifyFrames);
+    FIELD(LoopbackStream, PeriodUs);
+    FIELD(LoopbackStream, ListEntry);
+    FIELD(LoopbackStream, Mdl);
+    FIELD(LoopbackStream, Mapping);
+    FIELD(LoopbackStream, Frequency);
+    FIELD(LoopbackStream, BitsPerSample);
+    FIELD(LoopbackStream, IsFloat);
+    FIELD(LoopbackStream, Buffer);
+    FIELD(LoopbackStream, Resampler);
+    FIELD(LoopbackStream, NotificationEvents);
+    FIELD(LoopbackStream, NotificationBytes);
+
+    STRUCT(LoopbackTickStream);
+    FIELD(LoopbackTickStream, Stream);
+    FIELD(LoopbackTickStream, Clock);
+    FIELD(LoopbackTickStream, FrameShift);
+    FIELD(LoopbackTickStream, BufferDivisor);
+    FIELD(LoopbackTickStream, Kernels);
+    FIELD(LoopbackTickStream, Pages);
+    FIELD(LoopbackTickStream, FrameRate);
+    FIELD(LoopbackTickStream, Channels);
+    FIELD(LoopbackTickStream, SampleFormat);
+    FIELD(LoopbackTickStream, BufferMirrored);
+    FIELD(LoopbackTickStream, Running);
+    FIELD(LoopbackTickStream, OwnerRunning);
+    FIELD(LoopbackTickStream, SafetyFrames);
+
+    STRUCT(LeylineStreamClock);
+    STRUCT(RingBuffer);
+    STRUCT(LoopbackPages);
+    STRUCT(LoopbackSnapshot);
+    FIELD(LoopbackSnapshot, Streams);
+
+    STRUCT(LoopbackEngine);
+    FIELD(LoopbackEngine, StreamLock);
+    FIELD(LoopbackEngine, RenderStreams);
+    FIELD(LoopbackEngine, CaptureStreams);
+    FIELD(LoopbackEngine, LoopbackTimer);
+
+    STRUCT(LeylinePoolBlock);
+    STRUCT(LeylineBufferPool);
+    STRUCT(LeylineSlab);
+
+    // What each type occupies in a slab.
+    printf("\nslab slots\n");
+    const struct { const char* Name; size_t Size; } slots[] =
+    {
+        { "LoopbackStream", sizeof(LoopbackStream) },
+        { "LoopbackEngine", sizeof(LoopbackEngine) },
+    };
+    for (const auto& s : slots)
+    {
+        LeylineSlab slab;
+        LeylineSlabInit(&slab, s.Size, 0);
+        printf("  %-24s %6u bytes, %3u per chunk\n", s.Name, slab.ObjectSize, slab.ChunkObjects);
+        LeylineSlabCleanup(&slab);
+    }
+    return 0;
+}
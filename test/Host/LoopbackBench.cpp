@@ -0,0 +1,106 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK DPC BENCHMARK
+// Runs thousands of simulated 1 ms loopback ticks on the virtual clock and reports
+// the wall-clock cost of each DPC invocation for common stream formats. The single
+// capture rows are a raw copy, shown with the meter off, on, and with loudness; the
+// aliased rows are the same capture on the render stream's pages, with nothing to copy.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+struct BenchFormat
+{
+    const char* Label;
+    ULONG       SampleRate;
+    ULONG       Bits;
+    ULONG       Channels;
+    BOOLEAN     IsFloat;
+};
+
+enum BenchMeter { MeterOff, MeterLevels, MeterLoudness };
+
+static const char* const s_MeterNames[] = { "meter off", "levels", "loudness" };
+
+static void RunFormat(const BenchFormat& fmt, ULONG captureCount, BenchMeter meter, ULONG ticks,
+                      BOOLEAN aliased = FALSE)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetMetering(&engine, meter != MeterOff, meter == MeterLoudness);
+
+    ULONG blockAlign = (fmt.Bits / 8) * fmt.Channels;
+    ULONG bufferBytes = fmt.SampleRate * blockAlign / 10; // 100 ms
+
+    LoopbackStream render;
+    OpenStream(&render, FALSE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+
+    std::vector<LoopbackStream> captures(captureCount);
+    for (LoopbackStream& capture : captures)
+    {
+        if (aliased)
+        {
+            LoopbackStreamInit(&capture, TRUE);
+            LoopbackStreamSetFormat(&capture, fmt.SampleRate * blockAlign, fmt.Bits, 0, fmt.Channels, fmt.IsFloat);
+            if (!NT_SUCCESS(LoopbackEngineAliasBuffer(&engine, &capture, bufferBytes, nullptr)))
+                OpenStream(&capture, TRUE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes);
+        }
+        else
+        {
+            OpenStream(&capture, TRUE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes);
+        }
+        LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    }
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+
+    char label[64];
+    if (aliased) snprintf(label, sizeof(label), "%s alias %s", fmt.Label, s_MeterNames[meter]);
+    else         snprintf(label, sizeof(label), "%s x%u %s", fmt.Label, captureCount, s_MeterNames[meter]);
+    HostBench::PrintRow(label, samples);
+
+    for (LoopbackStream& capture : captures) CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 10000);
+
+    static const BenchFormat formats[] =
+    {
+        { "48k/16/2 pcm",    48000, 16, 2, FALSE },
+        { "48k/32/2 float",  48000, 32, 2, TRUE  },
+        { "192k/32/8 float", 192000, 32, 8, TRUE },
+    };
+
+    HostBench::PrintHeader("Loopback DPC time per 1 ms tick");
+    printf("%u simulated ticks per row\n", ticks);
+    for (const BenchFormat& fmt : formats)
+    {
+        RunFormat(fmt, 1, MeterOff, ticks);
+        RunFormat(fmt, 1, MeterOff, ticks, TRUE);
+        RunFormat(fmt, 1, MeterLevels, ticks);
+        RunFormat(fmt, 1, MeterLevels, ticks, TRUE);
+        RunFormat(fmt, 1, MeterLoudness, ticks);
+        RunFormat(fmt, 4, MeterLoudness, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,1625 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LOOPBACK ENGINE TESTS
+// Drives the portable core on the virtual clock: timer lifecycle, copy, positions,
+// notification events, capture read-behind, tick probes, aliased captures, isolation
+// between cables, and registration racing the tick; then the SPSC ring buffer.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace HostSim;
+
+static void FillPattern(LoopbackStream* stream)
+{
+    PUCHAR base = stream->Buffer.GetBaseAddress();
+    for (ULONG i = 0; i < stream->Buffer.GetSize(); i++)
+        base[i] = (UCHAR)((i * 7) + (i >> 8));
+}
+
+TEST(TimerArmsOnlyWithRenderAndCapture)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    CHECK(NT_SUCCESS(OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10)));
+    CHECK(NT_SUCCESS(OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10)));
+
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(!engine.TimerRunning);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(engine.TimerRunning);
+
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+
+    CloseStream(&engine, &capture);
+    CHECK(!engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 10), 0u);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(TimerRunsOnlyWhileBothSidesPlay)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(engine.TimerRunning);
+    CHECK_EQ(engine.TimerArms, 1ull);
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+
+    // Either side paused leaves nothing to mix: no timer, though both stay registered.
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_PAUSE);
+    CHECK(!engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 10), 0u);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(!engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 10), 0u);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_ACQUIRE);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(!engine.TimerRunning);
+
+    // Back in RUN, the render cursor picks up from its clock, not where it paused.
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(engine.TimerRunning);
+    CHECK_EQ(engine.TimerArms, 2ull);
+    CHECK_EQ(render.Cursor, 0ull);
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+    CHECK_EQ(render.Cursor, 480ull);
+    CHECK_EQ(capture.HwPositionRegister, 480ull * 4);
+
+    // A pair of idle streams costs no wakeups at all; none of these found nothing to do.
+    CHECK_EQ(engine.TimerWakeups, 20ull);
+    CHECK_EQ(engine.IdleWakeups, 0ull);
+
+    // With no read-behind to absorb a late tick the timer may not be coalesced.
+    CHECK_EQ(engine.LoopbackTimer.TolerableDelay, 0u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(TickPeriodFollowsTheStreams)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetTickRange(&engine, LOOPBACK_MIN_PERIOD_US, LOOPBACK_MAX_PERIOD_US);
+
+    // 100 ms buffers without notifications ask for 12.5 ms, held to the 10 ms ceiling.
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(engine.TickPeriodUs, 10000u);
+    CHECK(!engine.TickFast);
+    CHECK_EQ(engine.LoopbackTimer.PeriodQpc, 10 * TICK_QPC);
+    CHECK_EQ(RunTicks(&engine, 20), 2u);
+
+    // The capture waits 9 ms longer between writes than at 1 ms, and reads that behind.
+    CHECK_EQ(capture.PeriodUs, 10000u);
+    CHECK_EQ(capture.SafetyFrames, 432u);
+
+    // A 10 ms render buffer notifying every 5 ms asks for 1.25 ms: retuned to whole
+    // milliseconds without rearming, and the capture keeps its place behind its clock.
+    LoopbackStream low;
+    OpenStream(&low, FALSE, 48000, 16, 2, FALSE, 1920);
+    low.NotificationBytes = 960;
+    LoopbackStreamSetState(&engine, &low, KSSTATE_RUN);
+    CHECK_EQ(low.PeriodUs, 1000u);
+    CHECK_EQ(engine.TickPeriodUs, 1000u);
+    CHECK_EQ(engine.TimerArms, 1ull);
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+    CHECK_EQ(capture.HwPositionRegister, (480ull * 3 - 432) * 4);
+
+    // A 2 ms capture buffer asks for 250 us and gets the 500 us floor, on the
+    // high-resolution timer.
+    LoopbackStream fast;
+    OpenStream(&fast, TRUE, 48000, 16, 2, FALSE, 384);
+    LoopbackStreamSetState(&engine, &fast, KSSTATE_RUN);
+    CHECK_EQ(engine.TickPeriodUs, 500u);
+    CHECK(engine.TickFast);
+    CHECK(!engine.LoopbackTimer.Armed);
+    CHECK_EQ(RunTicks(&engine, 10), 20u);
+    CHECK_EQ(capture.HwPositionRegister, (480ull * 4 - 432) * 4);
+
+    // Leaving or pausing gives the period back.
+    LoopbackStreamSetState(&engine, &fast, KSSTATE_PAUSE);
+    CHECK_EQ(engine.TickPeriodUs, 1000u);
+    CHECK(!engine.TickFast);
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+    CloseStream(&engine, &low);
+    CHECK_EQ(engine.TickPeriodUs, 10000u);
+    CHECK_EQ(RunTicks(&engine, 20), 2u);
+    CHECK_EQ(capture.HwPositionRegister, (480ull * 7 - 432) * 4);
+    CHECK_EQ(engine.TimerArms, 1ull);
+
+    CloseStream(&engine, &fast);
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(WorkerMixesWhatTheTimerPosts)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    CHECK_EQ(LoopbackEngineStartWorker(&engine), STATUS_SUCCESS);
+    CHECK_EQ(HostThreadCount(), 1u);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    FillPattern(&render);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // The timer only stamps the tick and wakes the worker; nothing has moved yet.
+    HostClockAdvance(TICK_QPC);
+    CHECK_EQ(HostTimerFire(&engine.LoopbackTimer), 1u);
+    CHECK_EQ(engine.WorkerWake.SignalCount, 1u);
+    CHECK_EQ(render.Cursor, 0ull);
+
+    // The worker mixes up to the clock as it stood when the tick was posted, however
+    // late it runs, and counts that delay.
+    HostClockAdvance(TICK_QPC / 4);
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(render.Cursor, 48ull);
+    CHECK_EQ(capture.HwPositionRegister, 48ull * 4);
+    CHECK_EQ(engine.WorkerLatency, TICK_QPC / 4);     // A sixteenth of the way up from 0, scaled by 16
+
+    // Three ticks behind, it takes the newest and covers the rest in one mix.
+    for (int i = 0; i < 3; i++)
+    {
+        HostClockAdvance(i ? TICK_QPC : TICK_QPC - TICK_QPC / 4);
+        HostTimerFire(&engine.LoopbackTimer);
+    }
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(render.Cursor, 48ull * 4);
+    CHECK_EQ(engine.CoalescedTicks, 2ull);
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(render.Cursor, 48ull * 4);
+
+    // Ticks posted while it ran stay for the next batch, and the audio arrives intact.
+    RunTicks(&engine, 46);
+    CHECK_EQ(render.Cursor, 2400ull);
+    CHECK_EQ(capture.HwPositionRegister, 9600ull);
+    CHECK(memcmp(render.Buffer.GetBaseAddress(), capture.Buffer.GetBaseAddress(), 9600) == 0);
+    CHECK_EQ(engine.GlitchCount, 0u);
+
+    // A tick posted before the timer stopped mixes nothing once it has.
+    HostClockAdvance(TICK_QPC);
+    HostTimerFire(&engine.LoopbackTimer);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_PAUSE);
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(render.Cursor, 2400ull);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    CHECK_EQ(HostThreadCount(), 0u);
+}
+
+TEST(WritersWaitForTheWorkerWithoutTheLock)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    CHECK_EQ(LoopbackEngineStartWorker(&engine), STATUS_SUCCESS);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // The worker is part way through a tick, and a pause stops the timer: the writer
+    // waits the tick out.
+    InterlockedIncrement(&engine.TickSequence);
+    std::atomic<bool> paused{ false };
+    std::thread writer([&]() {
+        LoopbackStreamSetState(&engine, &capture, KSSTATE_PAUSE);
+        paused = true;
+    });
+
+    BOOLEAN changing = FALSE;
+    while (!changing)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&engine.StreamLock, &irql);
+        changing = engine.TimerChanging;
+        KeReleaseSpinLock(&engine.StreamLock, irql);
+        std::this_thread::yield();
+    }
+
+    // A notification callback interrupting the worker meanwhile still gets the lock.
+    LoopbackNotifyRoutine(nullptr, &engine);
+    CHECK(!paused);
+
+    InterlockedIncrement(&engine.TickSequence);
+    writer.join();
+    CHECK(paused);
+    CHECK(!engine.TimerRunning);
+    CHECK(!engine.TimerChanging);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(CopiesRenderIntoCapture)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    FillPattern(&render);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    RunTicks(&engine, 50);
+
+    // 50 ms at 192000 B/s, both streams started on the same QPC tick.
+    CHECK_EQ(render.Cursor, 2400ull);
+    CHECK_EQ(capture.HwPositionRegister, 9600ull);
+    CHECK_EQ(engine.GlitchCount, 0u);
+
+    PUCHAR src = render.Buffer.GetBaseAddress();
+    PUCHAR dst = capture.Buffer.GetBaseAddress();
+    CHECK(memcmp(src, dst, 9600) == 0);
+    CHECK_EQ(dst[9600], 0);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(CopyWrapsAroundBufferEnd)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // 10 ms buffers, run for 25 ms so both cursors wrap twice.
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    FillPattern(&render);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 25);
+
+    CHECK(memcmp(render.Buffer.GetBaseAddress(), capture.Buffer.GetBaseAddress(), 1920) == 0);
+    CHECK_EQ(LoopbackStreamPosition(&capture, HostClockNow()), (25ull * 192) % 1920);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(NotificationEventsFireOnBoundaries)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2; // Two notifications per 10 ms buffer
+
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+    CHECK_EQ(event.RefCount, 2);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 100);
+
+    CHECK_EQ(event.SignalCount, 20u);
+
+    CHECK(NT_SUCCESS(LoopbackStreamRemoveEvent(&engine, &render, &event)));
+    CHECK_EQ(event.RefCount, 1);
+    CHECK(LoopbackStreamRemoveEvent(&engine, &render, &event) == STATUS_NOT_FOUND);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(RemovedEventOutlivesTheTick)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2;
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+
+    // A tick that may have read the slot is in progress: the slot empties at once, but
+    // the event keeps its reference until the tick is done.
+    InterlockedIncrement(&engine.TickSequence);
+    std::atomic<bool> removed{ false };
+    std::thread writer([&]() {
+        CHECK(NT_SUCCESS(LoopbackStreamRemoveEvent(&engine, &render, &event)));
+        removed = true;
+    });
+
+    PKEVENT slot = &event;
+    while (slot)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&engine.StreamLock, &irql);
+        slot = render.NotificationEvents[0];
+        KeReleaseSpinLock(&engine.StreamLock, irql);
+        std::this_thread::yield();
+    }
+    CHECK(!removed);
+    CHECK_EQ(ReadAcquire(&event.RefCount), 2);
+
+    InterlockedIncrement(&engine.TickSequence);
+    writer.join();
+    CHECK(removed);
+    CHECK_EQ(event.RefCount, 1);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(RemovedEventWaitsForTheNotificationCallback)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2;
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+
+    // The callback signals under StreamLock; while it holds the lock the event stays.
+    KIRQL irql;
+    KeAcquireSpinLock(&engine.StreamLock, &irql);
+    std::atomic<bool> removed{ false };
+    std::thread writer([&]() {
+        CHECK(NT_SUCCESS(LoopbackStreamRemoveEvent(&engine, &render, &event)));
+        removed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(render.NotificationEvents[0] == &event);
+    CHECK_EQ(ReadAcquire(&event.RefCount), 2);
+    KeReleaseSpinLock(&engine.StreamLock, irql);
+
+    writer.join();
+    CHECK(removed);
+    CHECK_EQ(event.RefCount, 1);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(NotificationsNeedNoCapturePartner)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2;
+
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(!engine.TimerRunning);
+    RunTicks(&engine, 100);
+    CHECK_EQ(event.SignalCount, 20u);
+
+    // Paused, the stream is skipped and the timer left idle.
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    RunTicks(&engine, 20);
+    CHECK_EQ(event.SignalCount, 20u);
+    LONGLONG due;
+    CHECK(!HostExTimerDue(engine.NotifyTimer, &due));
+
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+    CHECK_EQ(event.SignalCount, 22u);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(NotificationsFireOnTheBoundaryTick)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // 147 frames at 44.1 kHz is 3.33 ms, and 100 frames at 48 kHz 2.08 ms: neither is
+    // a whole number of ticks or of loopback periods.
+    LoopbackStream a, b;
+    OpenStream(&a, FALSE, 44100, 16, 2, FALSE, 147 * 4 * 3);
+    OpenStream(&b, TRUE,  48000, 24, 2, FALSE, 100 * 6 * 4);
+    a.NotificationBytes = 147 * 4;
+    b.NotificationBytes = 100 * 6;
+
+    KEVENT eventA, eventB;
+    KeInitializeEvent(&eventA, NotificationEvent, FALSE);
+    KeInitializeEvent(&eventB, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &a, &eventA)));
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &b, &eventB)));
+    LoopbackStreamSetState(&engine, &a, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &b, KSSTATE_RUN);
+
+    // Each signal lands on the first tick of the boundary frame: ceil(k * N * F / R).
+    ULONG wrongA = 0, wrongB = 0, seenA = 0, seenB = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        LONGLONG due;
+        if (!HostExTimerDue(engine.NotifyTimer, &due)) break;
+        RunNotifications(&engine, due);
+        if (eventA.SignalCount != seenA)
+        {
+            seenA = eventA.SignalCount;
+            ULONGLONG exact = ((ULONGLONG)seenA * 147 * QPC_FREQUENCY + 44099) / 44100;
+            if (eventA.LastSignalQpc != a.StartTime + (LONGLONG)exact) wrongA++;
+        }
+        if (eventB.SignalCount != seenB)
+        {
+            seenB = eventB.SignalCount;
+            ULONGLONG exact = ((ULONGLONG)seenB * 100 * QPC_FREQUENCY + 47999) / 48000;
+            if (eventB.LastSignalQpc != b.StartTime + (LONGLONG)exact) wrongB++;
+        }
+    }
+    CHECK(seenA > 500);
+    CHECK(seenB > 800);
+    CHECK_EQ(wrongA, 0u);
+    CHECK_EQ(wrongB, 0u);
+
+    CloseStream(&engine, &b);
+    CloseStream(&engine, &a);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(LateNotificationSignalsOnce)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2;
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+
+    // The callback runs 12 ms late, past two boundaries: one signal, and the next one
+    // is the boundary after now, not the ones it slept through.
+    LONGLONG due;
+    CHECK(HostExTimerDue(engine.NotifyTimer, &due));
+    CHECK_EQ(due, render.StartTime + 5 * TICK_QPC);
+    HostClockSet(render.StartTime + 12 * TICK_QPC);
+    CHECK_EQ(HostExTimerFire(engine.NotifyTimer), 1u);
+    CHECK_EQ(event.SignalCount, 1u);
+    CHECK(HostExTimerDue(engine.NotifyTimer, &due));
+    CHECK_EQ(due, render.StartTime + 15 * TICK_QPC);
+
+    // Stopped devices get no callbacks; resuming picks the schedule up again.
+    LoopbackEngineStop(&engine);
+    CHECK(!HostExTimerDue(engine.NotifyTimer, &due));
+    HostClockSet(render.StartTime + 16 * TICK_QPC);
+    LoopbackEngineResume(&engine);
+    CHECK_EQ(event.SignalCount, 2u);
+    CHECK(HostExTimerDue(engine.NotifyTimer, &due));
+    CHECK_EQ(due, render.StartTime + 20 * TICK_QPC);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+// A user-mode reader's copy of a record: false if a write was in progress or landed
+// while copying. Stall stands in for a reader preempted between Position and Qpc.
+static BOOLEAN ReadPositionRecord(const LeylinePositionRecord* record, LeylinePositionRecord* copy,
+                                  BOOLEAN stall = FALSE)
+{
+    ULONG before = ReadULongAcquire(&record->Sequence);
+    if (before & 1) return FALSE;
+    memcpy(copy, record, sizeof(*copy));
+    if (stall)
+    {
+        YieldProcessor();
+        copy->Qpc = *reinterpret_cast<const volatile LONGLONG*>(&record->Qpc);
+    }
+    KeMemoryBarrier();
+    return ReadULongNoFence(&record->Sequence) == before;
+}
+
+TEST(PositionRecordsFollowStreams)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylinePositionPage page = {};
+    LoopbackEngineSetPositionPage(&engine, &page);
+    CHECK_EQ(page.Version, (ULONG)LEYLINE_POSITION_VERSION);
+    CHECK_EQ(page.HeaderSize, 64u);
+    CHECK_EQ(page.RecordSize, 64u);
+    CHECK_EQ(page.RecordCount, (ULONG)LEYLINE_MAX_POSITION_RECORDS);
+    CHECK_EQ(page.QpcFrequency, (LONGLONG)QPC_FREQUENCY);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  44100, 24, 2, FALSE, 26460);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    HostClockAdvance(TICK_QPC / 2);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // Joining writes the whole record, at position 0.
+    const LeylinePositionRecord& r = page.Records[0];
+    const LeylinePositionRecord& c = page.Records[1];
+    CHECK_EQ(r.StreamId, 1u);
+    CHECK_EQ(r.Flags, 0u);
+    CHECK_EQ(r.State, (ULONG)KSSTATE_RUN);
+    CHECK_EQ(r.Position, 0ull);
+    CHECK_EQ(r.Qpc, render.StartTime);
+    CHECK_EQ(r.StartQpc, render.StartTime);
+    CHECK_EQ(r.ByteRate, 192000u);
+    CHECK_EQ(r.FrameBytes, 4u);
+    CHECK_EQ(r.BufferSize, 19200u);
+    CHECK_EQ(c.StreamId, 2u);
+    CHECK_EQ(c.Flags, (ULONG)LEYLINE_POSITION_CAPTURE);
+    CHECK_EQ(c.BufferSize, 26460u);
+
+    // Every tick moves both, each by its own clock.
+    RunTicks(&engine, 10);
+    CHECK_EQ(r.Qpc, HostClockNow());
+    CHECK_EQ(c.Qpc, HostClockNow());
+    CHECK_EQ(r.Position, 504ull * 4);                       // 10.5 ms at 48 kHz
+    CHECK_EQ(c.Position, 441ull * 6);                       // 10 ms at 44.1 kHz
+    CHECK_EQ(r.Sequence % 2, 0u);
+
+    // Paused, the record keeps where it stopped. With nothing left to mix the timer
+    // stops too, so the other record holds its last tick and moves on at its ByteRate.
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    CHECK(!engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 5), 0u);
+    CHECK_EQ(r.State, (ULONG)KSSTATE_PAUSE);
+    CHECK_EQ(r.Position, 504ull * 4);
+    CHECK_EQ(c.Position, 441ull * 6);
+    CHECK_EQ(c.Qpc + 5 * TICK_QPC, HostClockNow());
+    CHECK_EQ(LoopbackStreamPosition(&capture, HostClockNow()), 661ull * 6);
+
+    // Leaving empties the record; the next stream to take it gets a new Id.
+    CloseStream(&engine, &render);
+    CHECK_EQ(r.StreamId, 0u);
+    CHECK_EQ(r.State, (ULONG)KSSTATE_STOP);
+    CHECK_EQ(r.Position, 0ull);
+    CHECK_EQ(engine.PositionSlots, 2u);
+
+    LoopbackStream next;
+    OpenStream(&next, FALSE, 48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &next, KSSTATE_RUN);
+    CHECK_EQ(next.PositionSlot, 0u);
+    CHECK_EQ(r.StreamId, 3u);
+
+    CloseStream(&engine, &next);
+    CloseStream(&engine, &capture);
+    CHECK_EQ(engine.PositionSlots, 0u);
+    LoopbackEngineSetPositionPage(&engine, nullptr);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(PositionPageAttachedWhileRunning)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // More streams than records: the last ones go without.
+    const ULONG count = LEYLINE_MAX_POSITION_RECORDS + 2;
+    std::vector<LoopbackStream> renders(count);
+    for (LoopbackStream& stream : renders)
+    {
+        OpenStream(&stream, FALSE, 48000, 16, 2, FALSE, 19200);
+        LoopbackStreamSetState(&engine, &stream, KSSTATE_RUN);
+    }
+    CHECK_EQ(renders[LEYLINE_MAX_POSITION_RECORDS - 1].PositionSlot, (ULONG)LEYLINE_MAX_POSITION_RECORDS - 1);
+    CHECK_EQ(renders[LEYLINE_MAX_POSITION_RECORDS].PositionSlot, (ULONG)LOOPBACK_NO_POSITION_SLOT);
+
+    // Render only, so there is no tick; attaching fills in where each stream is now.
+    HostClockAdvance(QPC_FREQUENCY / 100);
+    LeylinePositionPage page = {};
+    LoopbackEngineSetPositionPage(&engine, &page);
+    CHECK(!engine.TimerRunning);
+    ULONG wrong = 0;
+    for (ULONG i = 0; i < LEYLINE_MAX_POSITION_RECORDS; i++)
+    {
+        const LeylinePositionRecord& record = page.Records[i];
+        wrong += record.StreamId != renders[i].PositionId || record.State != (ULONG)KSSTATE_RUN ||
+                 record.Qpc != HostClockNow() || record.Position != 480ull * 4;
+    }
+    CHECK_EQ(wrong, 0u);
+
+    // Detached, nothing more is written to it.
+    ULONG id = renders[0].PositionId;
+    LoopbackEngineSetPositionPage(&engine, nullptr);
+    CloseStream(&engine, &renders[0]);
+    CHECK_EQ(page.Records[0].StreamId, id);
+
+    for (ULONG i = 1; i < count; i++) CloseStream(&engine, &renders[i]);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(PositionRecordsAreNeverTorn)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylinePositionPage page = {};
+    LoopbackEngineSetPositionPage(&engine, &page);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  44100, 16, 2, FALSE, 17640);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // Every consistent copy has the position its own clock gives at its own QPC.
+    std::atomic<bool>  stop(false);
+    std::atomic<ULONG> reads(0), retries(0), torn(0);
+    std::thread reader([&]() {
+        while (!stop.load())
+        {
+            for (ULONG i = 0; i < 2; i++)
+            {
+                LeylinePositionRecord copy;
+                if (!ReadPositionRecord(&page.Records[i], &copy, (reads.load() & 1) != 0))
+                {
+                    retries++;
+                    continue;
+                }
+                reads++;
+                if (copy.StreamId == 0 || copy.FrameBytes == 0) continue;
+
+                LeylineStreamClock clock;
+                LeylineClockInit(&clock, copy.ByteRate / copy.FrameBytes, page.QpcFrequency, copy.StartQpc);
+                if (copy.Position != LeylineClockFrames(&clock, copy.Qpc) * copy.FrameBytes) torn++;
+            }
+        }
+    });
+
+    // Ticks refresh the records while pauses and restarts rewrite them.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (ULONG i = 0; (i < 20000 || reads.load() < 10000) && std::chrono::steady_clock::now() < deadline; i++)
+    {
+        RunTicks(&engine, 1, TICK_QPC + (LONGLONG)(i % 7));
+        if (i % 64 == 0)
+        {
+            LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+            LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+        }
+    }
+    stop = true;
+    reader.join();
+
+    printf("  %u reads, %u retries\n", reads.load(), retries.load());
+    CHECK(reads.load() > 0u);
+    CHECK_EQ(torn.load(), 0u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineSetPositionPage(&engine, nullptr);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(BufferSizeIsClampedAndReported)
+{
+    LoopbackStream stream;
+    LoopbackStreamInit(&stream, FALSE);
+    LoopbackStreamSetFormat(&stream, 48000 * 4, 16, 0, 2, FALSE);
+
+    ULONG actual = 0;
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 16, 0, &actual)));
+    CHECK_EQ(actual, 192u); // 1 ms minimum
+    CHECK_EQ(stream.Buffer.GetSize(), actual);
+    CHECK(LoopbackStreamAllocateBuffer(&stream, 16, 0, &actual) == STATUS_ALREADY_COMMITTED);
+    LoopbackStreamFreeBuffer(&stream);
+
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 0x7FFFFFFF, 0, &actual)));
+    CHECK_EQ(actual, 48000u * 4 * 5); // 5 s maximum
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+TEST(BufferSizeIsWholeFramesForOddFrameSizes)
+{
+    // 24-bit stereo: 6-byte frames, where a power-of-two mask would split a frame.
+    LoopbackStream stream;
+    LoopbackStreamInit(&stream, FALSE);
+    LoopbackStreamSetFormat(&stream, 44100 * 6, 24, 0, 2, FALSE);
+
+    ULONG actual = 0;
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 1000, 0, &actual)));
+    CHECK_EQ(actual, 1002u);
+    LoopbackStreamFreeBuffer(&stream);
+
+    // 1 ms minimum (264.6 bytes) rounds up to whole frames too.
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 1, 0, &actual)));
+    CHECK_EQ(actual % 6, 0u);
+    CHECK(actual >= 44100u * 6 / 1000);
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+TEST(MirroredBufferAliasesItself)
+{
+    LoopbackStream stream;
+    LoopbackStreamInit(&stream, FALSE);
+    LoopbackStreamSetFormat(&stream, 48000 * 4, 16, 0, 2, FALSE);
+
+    // Whole pages, so the second view starts where the first ends.
+    ULONG actual = 0;
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 4096, LOOPBACK_BUFFER_MIRRORED, &actual)));
+    CHECK_EQ(actual, 4096u);
+    CHECK(stream.Buffer.IsMirrored());
+    PUCHAR base = stream.Buffer.GetBaseAddress();
+    base[10] = 0x5A;
+    CHECK_EQ(base[actual + 10], 0x5A);
+    base[actual + actual - 1] = 0xA5;
+    CHECK_EQ(base[actual - 1], 0xA5);
+
+    // A span across the end is one piece.
+    RingBuffer& ring = stream.Buffer;
+    RingBufferSpan span;
+    ring.CommitWrite(ring.AcquireWrite(&span, 4000));
+    ring.CommitRead(ring.AcquireRead(&span, 4000));
+    CHECK_EQ(ring.AcquireWrite(&span, 200), 200u);
+    CHECK(span.Data[0] == base + 4000 && span.Length[0] == 200u && span.Length[1] == 0u);
+    RtlFillMemory(span.Data[0], 200, 0x11);
+    CHECK(base[0] == 0x11 && base[103] == 0x11 && base[104] == 0);
+    LoopbackStreamFreeBuffer(&stream);
+
+    // 24-bit stereo needs whole frames as well: lcm(6, 4096).
+    LoopbackStreamSetFormat(&stream, 48000 * 6, 24, 0, 2, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 12288, LOOPBACK_BUFFER_MIRRORED, &actual)));
+    CHECK_EQ(actual, 12288u);
+    CHECK(stream.Buffer.IsMirrored());
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+TEST(MirroringNeverGrowsTheBuffer)
+{
+    LoopbackStream stream;
+    LoopbackStreamInit(&stream, FALSE);
+
+    // 10 ms of 48 kHz 16-bit stereo keeps its 1920 bytes, and its notification period,
+    // and is split at the wrap instead.
+    LoopbackStreamSetFormat(&stream, 48000 * 4, 16, 0, 2, FALSE);
+    ULONG actual = 0;
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 1920, LOOPBACK_BUFFER_MIRRORED, &actual)));
+    CHECK_EQ(actual, 1920u);
+    CHECK(!stream.Buffer.IsMirrored());
+    LoopbackStreamFreeBuffer(&stream);
+
+    // Only rounded to whole frames: 1000 bytes of 24-bit stereo is 1002.
+    LoopbackStreamSetFormat(&stream, 48000 * 6, 24, 0, 2, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 1000, LOOPBACK_BUFFER_MIRRORED, &actual)));
+    CHECK_EQ(actual, 1002u);
+    CHECK(!stream.Buffer.IsMirrored());
+    LoopbackStreamFreeBuffer(&stream);
+
+    // 10 ms of 48 kHz 24-bit 5.1 stays at 8640 bytes rather than 36 KB.
+    LoopbackStreamSetFormat(&stream, 48000 * 18, 24, 0, 6, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAllocateBuffer(&stream, 8640, LOOPBACK_BUFFER_MIRRORED, &actual)));
+    CHECK_EQ(actual, 8640u);
+    CHECK(!stream.Buffer.IsMirrored());
+    LoopbackStreamFreeBuffer(&stream);
+}
+
+// Renders into one capture for a number of ticks with buffers that wrap mid-tick, and
+// returns what the capture holds.
+static std::vector<UCHAR> RunWrappingMix(ULONG bufferFlags, ULONG renderRate, ULONG bits, ULONG renderCount,
+                                         ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // Whole pages and frames, and no whole number of ticks.
+    ULONG bufferBytes = (bits == 24) ? 12288 : 4096;
+    std::vector<LoopbackStream> renders(renderCount);
+    LoopbackStream capture;
+    for (LoopbackStream& render : renders)
+    {
+        OpenStream(&render, FALSE, renderRate, bits, 2, FALSE, bufferBytes, bufferFlags);
+        FillPattern(&render);
+        LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    }
+    OpenStream(&capture, TRUE, 48000, bits, 2, FALSE, bufferBytes, bufferFlags);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, ticks);
+
+    std::vector<UCHAR> captured(capture.Buffer.GetBaseAddress(), capture.Buffer.GetBaseAddress() + bufferBytes);
+    if (bufferFlags) CHECK(capture.Buffer.IsMirrored() && renders[0].Buffer.IsMirrored());
+
+    CloseStream(&engine, &capture);
+    for (LoopbackStream& render : renders) CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    return captured;
+}
+
+TEST(MirroredMixMatchesSplitMix)
+{
+    // Raw copy, the bus with two sources, and rate conversion.
+    struct { ULONG Rate, Bits, Renders; } cases[] = { { 48000, 16, 1 }, { 48000, 24, 2 }, { 44100, 16, 1 } };
+    for (const auto& c : cases)
+    {
+        std::vector<UCHAR> split = RunWrappingMix(0, c.Rate, c.Bits, c.Renders, 100);
+        CHECK(std::count(split.begin(), split.end(), 0) < (long)split.size() / 4);
+        CHECK(split == RunWrappingMix(LOOPBACK_BUFFER_MIRRORED, c.Rate, c.Bits, c.Renders, 100));
+    }
+}
+
+// Open a capture stream backed by the engine's only render stream, as AllocateAudioBuffer
+// does when it qualifies.
+static NTSTATUS OpenAliasedCapture(LoopbackEngine* engine, LoopbackStream* stream, ULONG sampleRate,
+                                   ULONG bitsPerSample, ULONG channels, ULONG bufferBytes)
+{
+    LoopbackStreamInit(stream, TRUE);
+    ULONG blockAlign = (bitsPerSample / 8) * channels;
+    LoopbackStreamSetFormat(stream, sampleRate * blockAlign, bitsPerSample, 0, channels, FALSE);
+    return LoopbackEngineAliasBuffer(engine, stream, bufferBytes, nullptr);
+}
+
+// Frames from the capture's offset forward to the render stream's, at Now.
+static ULONG AliasGap(const LoopbackStream* render, const LoopbackStream* capture)
+{
+    ULONGLONG size = render->Buffer.GetSize();
+    ULONGLONG gap  = (LoopbackStreamPosition(render, HostClockNow()) + size -
+                      LoopbackStreamPosition(capture, HostClockNow())) % size;
+    return (ULONG)(gap / render->FrameBytes);
+}
+
+static const ULONG c_AliasLagFrames = 48000 / 1000 * LOOPBACK_ALIAS_LAG_MS;
+
+TEST(AliasedCaptureNeedsNoCopy)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 19200);
+    FillPattern(&render);
+    std::vector<UCHAR> played(render.Buffer.GetBaseAddress(), render.Buffer.GetBaseAddress() + 19200);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    HostClockAdvance(TICK_QPC * 5);
+
+    ULONG actual = 0;
+    LoopbackStreamInit(&capture, TRUE);
+    LoopbackStreamSetFormat(&capture, 48000 * 4, 16, 0, 2, FALSE);
+    CHECK(NT_SUCCESS(LoopbackEngineAliasBuffer(&engine, &capture, 9600, &actual)));
+    CHECK_EQ(actual, 19200u);
+    CHECK(capture.Buffer.GetBaseAddress() == render.Buffer.GetBaseAddress());
+    CHECK(capture.Mdl == render.Mdl);
+    CHECK_EQ(render.Pages->RefCount, 2);
+
+    // The capture starts the lag behind the render stream's offset, mid-buffer.
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(LoopbackStreamPosition(&capture, HostClockNow()), (240ull - c_AliasLagFrames) * 4);
+
+    // Around the buffer twice and a bit: the pages are never written, and the lag holds.
+    for (ULONG i = 0; i < 23; i++)
+    {
+        RunTicks(&engine, 10);
+        ULONG gap = AliasGap(&render, &capture);
+        CHECK(gap + 1 >= c_AliasLagFrames && gap <= c_AliasLagFrames + 1);
+    }
+    CHECK(memcmp(played.data(), capture.Buffer.GetBaseAddress(), 19200) == 0);
+    CHECK_EQ(engine.GlitchCount, 0u);
+
+    CloseStream(&engine, &capture);
+    CHECK_EQ(render.Pages->RefCount, 1);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(AliasingNeedsOneMatchingRender)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // Nothing registered, or a render stream that isn't.
+    LoopbackStream render, other, capture, second;
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200), STATUS_NOT_SUPPORTED);
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 19200);
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200), STATUS_NOT_SUPPORTED);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+
+    // Another format, rate or width, or a larger buffer than the render stream's.
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 24, 2, 19200), STATUS_NOT_SUPPORTED);
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 44100, 16, 2, 19200), STATUS_NOT_SUPPORTED);
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 16, 1, 19200), STATUS_NOT_SUPPORTED);
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19204), STATUS_NOT_SUPPORTED);
+    CHECK(capture.Mdl == nullptr);
+
+    // One capture per render stream.
+    CHECK(NT_SUCCESS(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200)));
+    CHECK_EQ(LoopbackEngineAliasBuffer(&engine, &capture, 19200, nullptr), STATUS_ALREADY_COMMITTED);
+    CHECK_EQ(OpenAliasedCapture(&engine, &second, 48000, 16, 2, 19200), STATUS_NOT_SUPPORTED);
+    LoopbackStreamFreeBuffer(&capture);
+
+    // Not with two render streams to mix.
+    OpenStream(&other, FALSE, 48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &other, KSSTATE_RUN);
+    CHECK_EQ(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200), STATUS_NOT_SUPPORTED);
+
+    CloseStream(&engine, &other);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(AliasedCaptureTakesTheMixInPlace)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // An aliased capture and a copied one, started with the render stream.
+    LoopbackStream render, capture, copied, joining;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 19200);
+    FillPattern(&render);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(NT_SUCCESS(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200)));
+    OpenStream(&copied, TRUE, 48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &copied,  KSSTATE_RUN);
+    RunTicks(&engine, 30);
+
+    // A second render stream joins and the gain drops: the mix replaces what was played.
+    OpenStream(&joining, FALSE, 48000, 16, 2, FALSE, 19200);
+    SHORT* samples = reinterpret_cast<SHORT*>(joining.Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < 19200 / 2; i++) samples[i] = (SHORT)(i * 13);
+    LoopbackStreamSetState(&engine, &joining, KSSTATE_RUN);
+    LoopbackEngineSetMasterGain(&engine, -6 * 0x10000, FALSE);
+    RunTicks(&engine, 170);
+
+    // The last 50 ms before the render position read the same through either capture.
+    ULONG end = (ULONG)(LoopbackStreamPosition(&render, HostClockNow()) / 4);
+    for (ULONG f = end + 4800 - 2400; f < end + 4800; f++)
+    {
+        ULONG off = (f % 4800) * 4;
+        if (memcmp(capture.Buffer.GetBaseAddress() + off, copied.Buffer.GetBaseAddress() + off, 4) != 0)
+        {
+            CHECK(!"aliased frame differs from the copied one");
+            break;
+        }
+    }
+
+    CloseStream(&engine, &joining);
+    CloseStream(&engine, &copied);
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(AliasedCaptureRealignsAndOutlivesItsRender)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture, next;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(NT_SUCCESS(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200)));
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 30);
+
+    // The render stream restarts part way through a tick: the capture moves forward to
+    // trail it again.
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    RunTicks(&engine, 7);
+    ULONGLONG before = capture.HwPositionRegister;
+    HostClockAdvance(TICK_QPC / 3);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK_EQ(AliasGap(&render, &capture), c_AliasLagFrames);
+    RunTicks(&engine, 10);
+    CHECK(capture.HwPositionRegister > before);
+    ULONG gap = AliasGap(&render, &capture);
+    CHECK(gap + 1 >= c_AliasLagFrames && gap <= c_AliasLagFrames + 1);
+
+    // Once the render stream frees its buffer the pages are the capture's alone, and a
+    // new render stream is copied into them like any other.
+    CloseStream(&engine, &render);
+    CHECK_EQ(capture.Pages->RefCount, 1);
+    OpenStream(&next, FALSE, 48000, 16, 2, FALSE, 19200);
+    SHORT* samples = reinterpret_cast<SHORT*>(next.Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < 19200 / 2; i++) samples[i] = 0x1111;
+    LoopbackStreamSetState(&engine, &next, KSSTATE_RUN);
+    RunTicks(&engine, 120);
+
+    const SHORT* captured = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    CHECK(std::count(captured, captured + 19200 / 2, (SHORT)0x1111) == 19200 / 2);
+
+    CloseStream(&engine, &next);
+    CloseStream(&engine, &capture);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(AliasedCaptureTakesTheMixWhileItsRenderPauses)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture, other;
+    OpenStream(&render, FALSE, 48000, 16, 2, FALSE, 19200);
+    FillPattern(&render);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    CHECK(NT_SUCCESS(OpenAliasedCapture(&engine, &capture, 48000, 16, 2, 19200)));
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 30);
+
+    // Another render stream plays while the capture's own one is paused: it is the mix,
+    // and the capture records it rather than replaying the paused stream's buffer.
+    OpenStream(&other, FALSE, 48000, 16, 2, FALSE, 19200);
+    SHORT* samples = reinterpret_cast<SHORT*>(other.Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < 19200 / 2; i++) samples[i] = 0x2222;
+    LoopbackStreamSetState(&engine, &other, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    RunTicks(&engine, 120);
+
+    const SHORT* captured = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    CHECK(std::count(captured, captured + 19200 / 2, (SHORT)0x2222) == 19200 / 2);
+    CHECK_EQ(engine.GlitchCount, 0u);
+
+    CloseStream(&engine, &other);
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(CaptureReportsBehindItsClock)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetSafetyOffset(&engine, 2000, FALSE);
+    LeylinePositionPage page = {};
+    LoopbackEngineSetPositionPage(&engine, &page);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    FillPattern(&render);
+
+    // 2 ms at 48 kHz; what a capture would be told before it starts, and once it has.
+    CHECK_EQ(LoopbackStreamSafetyBytes(&engine, &capture), 96u * 4);
+    CHECK_EQ(LoopbackStreamSafetyBytes(&engine, &render), 0u);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(capture.SafetyFrames, 96u);
+    CHECK_EQ(capture.HwPositionRegister, 0ull);
+
+    // The samples land as before; only the capture's reported position trails.
+    RunTicks(&engine, 50);
+    CHECK_EQ(render.Cursor, 2400ull);
+    CHECK_EQ(capture.HwPositionRegister, (2400ull - 96) * 4);
+    CHECK_EQ(LoopbackStreamPosition(&capture, HostClockNow()), (2400ull - 96) * 4);
+    CHECK_EQ(page.Records[1].Position, (2400ull - 96) * 4);
+    CHECK_EQ(page.Records[1].SafetyBytes, 96u * 4);
+    CHECK_EQ(page.Records[0].SafetyBytes, 0u);
+    CHECK(memcmp(render.Buffer.GetBaseAddress(), capture.Buffer.GetBaseAddress(), 9600) == 0);
+
+    // A running capture keeps its offset; the next start takes the new one.
+    LoopbackEngineSetSafetyOffset(&engine, 1000, FALSE);
+    CHECK_EQ(LoopbackStreamSafetyBytes(&engine, &capture), 96u * 4);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_STOP);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(capture.SafetyFrames, 48u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineSetPositionPage(&engine, nullptr);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(ReadBehindAdaptsToLateTicks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetSafetyOffset(&engine, 1000, TRUE);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(capture.SafetyFrames, 48u);
+
+    // One tick in twenty comes 3 ms late, more than a window's 1%.
+    for (ULONG i = 0; i < 12; i++)
+    {
+        RunTicks(&engine, 95);
+        RunTicks(&engine, 5, 4 * TICK_QPC);
+    }
+
+    LeylineCableSafety info = {};
+    LoopbackEngineQuerySafety(&engine, &info);
+    CHECK_EQ(info.FloorUs, 1000u);
+    CHECK_EQ(info.Adaptive, (BOOLEAN)TRUE);
+    CHECK_EQ(info.LatenessP50Us, 250u);
+    CHECK_EQ(info.LatenessP99Us, 3250u);
+    CHECK_EQ(info.LatenessMaxUs, 3000u);
+    CHECK_EQ(info.EstimateUs, 1000u + 3250);
+    CHECK_EQ(info.OffsetUs, info.EstimateUs);
+
+    // The running capture keeps the offset it started with; a restart takes the estimate.
+    CHECK_EQ(capture.SafetyFrames, 48u);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_STOP);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(capture.SafetyFrames, 204u);                   // 4.25 ms at 48 kHz
+
+    // A quiet window halves the way back down. The window in progress still holds some
+    // of the late ticks, so it takes the next one.
+    RunTicks(&engine, 2 * LOOPBACK_LATENESS_WINDOW);
+    LoopbackEngineQuerySafety(&engine, &info);
+    CHECK_EQ(info.LatenessP99Us, 250u);
+    CHECK_EQ(info.EstimateUs, 4250u - (4250 - 1250) / 2);
+
+    // Fixed, the estimate is still kept but no longer used.
+    LoopbackEngineSetSafetyOffset(&engine, 1000, FALSE);
+    LoopbackEngineQuerySafety(&engine, &info);
+    CHECK_EQ(info.OffsetUs, 1000u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+#if LEYLINE_PROBES
+static ULONG ProbeTotal(const LeylineCableStats& stats, ULONG probe)
+{
+    ULONG total = 0;
+    for (ULONG b = 0; b < LEYLINE_STATS_BUCKETS; b++) total += stats.Histograms[probe][b];
+    return total;
+}
+
+TEST(ProbesBinEveryStage)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    render.NotificationBytes = 1920 / 2;
+    KEVENT event;
+    KeInitializeEvent(&event, NotificationEvent, FALSE);
+    CHECK(NT_SUCCESS(LoopbackStreamAddEvent(&engine, &render, &event)));
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // Ten ticks on time, then one 3 ms late: the timer catches up with three more
+    // at the same instant, which find nothing new to mix.
+    RunTicks(&engine, 10);
+    RunTicks(&engine, 1, 4 * TICK_QPC);
+
+    LeylineCableStats stats = {};
+    CHECK_EQ(LoopbackEngineQueryStats(&engine, &stats), STATUS_SUCCESS);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_TICK), 14u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_POSITIONS), 11u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_MIX), 11u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_PUBLISH), 14u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_WAKE), 0u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_LATENESS), 13u);
+    CHECK_EQ(stats.Histograms[LEYLINE_PROBE_LATENESS][0], 12u);
+    CHECK_EQ(stats.Histograms[LEYLINE_PROBE_LATENESS][21], 1u);      // 3 ms: 2^21 ns and up
+    CHECK(event.SignalCount >= 2u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_SIGNAL), event.SignalCount);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_LOCK_WAIT), event.SignalCount);
+    CHECK_EQ(stats.ElapsedQpc, 14ull * TICK_QPC);
+    CHECK_EQ(stats.QpcFrequency, (ULONGLONG)QPC_FREQUENCY);
+
+    // 20 ms in one tick overruns the 10 ms buffers: the older half is dropped.
+    RunTicks(&engine, 1, 20 * TICK_QPC);
+    CHECK_EQ(LoopbackEngineQueryStats(&engine, &stats), STATUS_SUCCESS);
+    CHECK_EQ(stats.GlitchCount, 1u);
+    CHECK_EQ(stats.LostFrames, 480ull);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+
+    // With a worker the callback only posts; the worker bins how long it took to wake.
+    LoopbackEngineInit(&engine);
+    LoopbackEngineStartWorker(&engine);
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    HostClockAdvance(TICK_QPC);
+    HostTimerFire(&engine.LoopbackTimer);
+    HostClockAdvance(TICK_QPC / 4);
+    LoopbackEngineWork(&engine);
+
+    CHECK_EQ(LoopbackEngineQueryStats(&engine, &stats), STATUS_SUCCESS);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_TICK), 1u);
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_WAKE), 1u);
+    CHECK_EQ(stats.Histograms[LEYLINE_PROBE_WAKE][17], 1u);          // 250 us
+    CHECK_EQ(ProbeTotal(stats, LEYLINE_PROBE_MIX), 1u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+#endif
+
+TEST(EngineStopAndResume)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    LoopbackEngineStop(&engine);
+    CHECK(!engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 5), 0u);
+
+    LoopbackEngineResume(&engine);
+    CHECK(engine.TimerRunning);
+    CHECK_EQ(RunTicks(&engine, 5), 5u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(CablesDoNotShareStreams)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    // Two cables, as the driver builds them: one engine each, ticked by its own timer.
+    LoopbackEngine cable1, cable2;
+    LoopbackEngineInit(&cable1);
+    LoopbackEngineInit(&cable2);
+
+    LoopbackStream render1, capture1, render2, capture2;
+    OpenStream(&render1,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture1, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&render2,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(&capture2, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    FillPattern(&render2);
+
+    LoopbackStreamSetState(&cable1, &render1,  KSSTATE_RUN);
+    LoopbackStreamSetState(&cable1, &capture1, KSSTATE_RUN);
+    LoopbackStreamSetState(&cable2, &render2,  KSSTATE_RUN);
+    LoopbackStreamSetState(&cable2, &capture2, KSSTATE_RUN);
+
+    for (int i = 0; i < 50; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        CHECK_EQ(HostTimerFire(&cable1.LoopbackTimer), 1u);
+        CHECK_EQ(HostTimerFire(&cable2.LoopbackTimer), 1u);
+    }
+
+    // Cable 2's render reaches only cable 2's capture; cable 1 records its own silence.
+    CHECK(memcmp(render2.Buffer.GetBaseAddress(), capture2.Buffer.GetBaseAddress(), 9600) == 0);
+    PUCHAR dst1 = capture1.Buffer.GetBaseAddress();
+    ULONG nonzero = 0;
+    for (ULONG i = 0; i < capture1.Buffer.GetSize(); i++) nonzero += dst1[i] != 0;
+    CHECK_EQ(nonzero, 0u);
+    CHECK_EQ(capture1.HwPositionRegister, 9600ull);
+
+    // Stopping one cable leaves the other's timer running.
+    CloseStream(&cable2, &capture2);
+    CHECK(!cable2.TimerRunning);
+    CHECK(cable1.TimerRunning);
+
+    CloseStream(&cable2, &render2);
+    CloseStream(&cable1, &capture1);
+    CloseStream(&cable1, &render1);
+    LoopbackEngineCleanup(&cable1);
+    LoopbackEngineCleanup(&cable2);
+}
+
+TEST(RegistrationChurnDuringTicks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    SHORT* src = reinterpret_cast<SHORT*>(render.Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < render.Buffer.GetSize() / 2; i++) src[i] = 16384;
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    // Writers open, pause, restart and close silent pairs while the timer fires, so
+    // the capture must still hold exactly the one render stream's samples.
+    std::atomic<bool>  stop{ false };
+    std::atomic<ULONG> cycles{ 0 };
+    std::vector<std::thread> writers;
+    for (ULONG w = 0; w < 3; w++)
+    {
+        writers.emplace_back([&engine, &stop, &cycles]() {
+            LoopbackStream churnRender, churnCapture;
+            OpenStream(&churnRender,  FALSE, 48000, 16, 2, FALSE, 19200);
+            OpenStream(&churnCapture, TRUE,  48000, 16, 2, FALSE, 19200);
+            while (!stop.load())
+            {
+                LoopbackStreamSetState(&engine, &churnRender,  KSSTATE_RUN);
+                LoopbackStreamSetState(&engine, &churnCapture, KSSTATE_RUN);
+                LoopbackStreamSetState(&engine, &churnRender,  KSSTATE_PAUSE);
+                LoopbackStreamSetState(&engine, &churnRender,  KSSTATE_RUN);
+                CloseStream(&engine, &churnCapture);
+                CloseStream(&engine, &churnRender);
+                OpenStream(&churnRender,  FALSE, 48000, 16, 2, FALSE, 19200);
+                OpenStream(&churnCapture, TRUE,  48000, 16, 2, FALSE, 19200);
+                cycles++;
+            }
+            LoopbackStreamFreeBuffer(&churnCapture);
+            LoopbackStreamFreeBuffer(&churnRender);
+        });
+    }
+
+    ULONG ticks = 0, fired = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((ticks < 2000 || cycles.load() < 100) && std::chrono::steady_clock::now() < deadline)
+    {
+        fired += RunTicks(&engine, 1);
+        ticks++;
+    }
+    stop.store(true);
+    for (std::thread& writer : writers) writer.join();
+
+    printf("  %u ticks, %u writer cycles\n", ticks, cycles.load());
+    CHECK(cycles.load() > 0u);
+    CHECK_EQ(fired, ticks);
+    CHECK(engine.TimerRunning);
+    CHECK_EQ(engine.Snapshot->RenderCount, 1u);
+    CHECK_EQ(engine.Snapshot->CaptureCount, 1u);
+
+    const SHORT* dst = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    ULONG wrong = 0;
+    for (ULONG i = 0; i < capture.Buffer.GetSize() / 2; i++) wrong += dst[i] != 16384;
+    CHECK_EQ(wrong, 0u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(RingBufferReadWrite)
+{
+    UCHAR storage[16] = {};
+    RingBuffer ring;
+    ring.Init(storage, sizeof(storage));
+
+    UCHAR in[12], out[12];
+    for (int i = 0; i < 12; i++) in[i] = (UCHAR)(i + 1);
+
+    CHECK_EQ(ring.Write(in, 12), 12u);
+    CHECK_EQ(ring.Read(out, 8), 8u);
+    CHECK_EQ(ring.Write(in, 12), 12u);  // Every byte is usable
+    CHECK_EQ(ring.AvailableRead(), 16u);
+    CHECK_EQ(ring.AvailableWrite(), 0u);
+    CHECK_EQ(ring.Write(in, 1), 0u);
+    CHECK_EQ(ring.Read(out, 4), 4u);
+    CHECK(out[0] == 9 && out[3] == 12);
+    CHECK_EQ(ring.Read(out, 12), 12u);
+    CHECK(out[0] == 1 && out[11] == 12);
+    CHECK_EQ(ring.AvailableRead(), 0u);
+}
+
+TEST(RingBufferSpansSplitAtTheEnd)
+{
+    UCHAR storage[10] = {};
+    RingBuffer ring;
+    ring.Init(storage, sizeof(storage));
+
+    RingBufferSpan span;
+    CHECK_EQ(ring.AcquireWrite(&span, 7), 7u);
+    CHECK(span.Data[0] == storage && span.Length[0] == 7u && span.Length[1] == 0u);
+    ring.CommitWrite(7);
+    CHECK_EQ(ring.AcquireRead(&span), 7u);
+    ring.CommitRead(5);
+
+    // Eight free bytes: three at the end, five at the start.
+    CHECK_EQ(ring.AcquireWrite(&span), 8u);
+    CHECK(span.Data[0] == storage + 7 && span.Length[0] == 3u);
+    CHECK(span.Data[1] == storage && span.Length[1] == 5u);
+    RtlFillMemory(span.Data[0], span.Length[0], 0xAA);
+    RtlFillMemory(span.Data[1], span.Length[1], 0xBB);
+    ring.CommitWrite(8);
+
+    CHECK_EQ(ring.AcquireRead(&span), 10u);
+    CHECK(span.Data[0] == storage + 5 && span.Length[0] == 5u && span.Length[1] == 5u);
+    CHECK(storage[7] == 0xAA && storage[4] == 0xBB);
+
+    // Nothing at all leaves an empty span rather than a bad pointer.
+    ring.Init(nullptr, 0);
+    CHECK_EQ(ring.AcquireWrite(&span), 0u);
+    CHECK_EQ(ring.Write(storage, 4), 0u);
+}
+
+TEST(RingBufferIndicesWrap)
+{
+    // Power of two: the indices wrap at 2^32 and the offset is a mask.
+    static UCHAR storage[1 << 16];
+    RingBuffer ring;
+    ring.Init(storage, sizeof(storage));
+    RingBufferSpan span;
+    ULONG step = sizeof(storage) - 3;
+    for (ULONGLONG moved = 0; moved < (1ull << 32) + 5 * step; moved += step)
+    {
+        CHECK_EQ(ring.AcquireWrite(&span, step), step);
+        ring.CommitWrite(step);
+        CHECK_EQ(ring.AcquireRead(&span), step);
+        ring.CommitRead(step);
+    }
+    UCHAR in[8] = { 1, 2, 3, 4, 5, 6, 7, 8 }, out[8] = {};
+    CHECK_EQ(ring.Write(in, 8), 8u);
+    CHECK_EQ(ring.AvailableRead(), 8u);
+    CHECK_EQ(ring.Read(out, 8), 8u);
+    CHECK(memcmp(in, out, 8) == 0);
+
+    // Any other size: they wrap at twice the size.
+    UCHAR small[12];
+    ring.Init(small, sizeof(small));
+    for (ULONG round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < 8; i++) in[i] = (UCHAR)(round + i);
+        CHECK_EQ(ring.Write(in, 7), 7u);
+        CHECK_EQ(ring.AvailableWrite(), 5u);
+        CHECK_EQ(ring.Read(out, 8), 7u);
+        CHECK(memcmp(in, out, 7) == 0);
+    }
+}
+
+TEST(RingBufferAcrossThreads)
+{
+    // One producer thread, one consumer thread, odd chunk sizes on an odd ring; every
+    // byte must arrive once and in order.
+    static const ULONG total = 4 << 20;
+    std::vector<UCHAR> storage(4093);
+    RingBuffer ring;
+    ring.Init(storage.data(), (ULONG)storage.size());
+
+    std::thread producer([&ring]()
+    {
+        ULONG sent = 0, chunk = 1;
+        while (sent < total)
+        {
+            RingBufferSpan span;
+            ULONG n = ring.AcquireWrite(&span, min(chunk, total - sent));
+            if (n == 0) { YieldProcessor(); continue; }
+            for (ULONG i = 0; i < span.Length[0]; i++) span.Data[0][i] = (UCHAR)(sent + i);
+            for (ULONG i = 0; i < span.Length[1]; i++) span.Data[1][i] = (UCHAR)(sent + span.Length[0] + i);
+            ring.CommitWrite(n);
+            sent += n;
+            chunk = chunk % 1500 + 7;
+        }
+    });
+
+    ULONG received = 0, wrong = 0;
+    UCHAR out[1024];
+    while (received < total)
+    {
+        ULONG n = ring.Read(out, sizeof(out));
+        if (n == 0) { YieldProcessor(); continue; }
+        for (ULONG i = 0; i < n; i++) wrong += out[i] != (UCHAR)(received + i);
+        received += n;
+    }
+    producer.join();
+
+    CHECK_EQ(received, total);
+    CHECK_EQ(wrong, 0u);
+    CHECK_EQ(ring.AvailableRead(), 0u);
+}
+
+HOST_TEST_MAIN()
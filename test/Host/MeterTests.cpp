@@ -0,0 +1,235 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// METER TESTS
+// Levels and loudness against reference signals, SIMD parity, then the engine
+// publishing to a shared parameter block.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+
+#include <math.h>
+#include <vector>
+
+using namespace HostSim;
+
+static const double c_TwoPi = 6.283185307179586;
+
+static BOOLEAN Near(double value, double expected, double tolerance)
+{
+    BOOLEAN ok = fabs(value - expected) <= tolerance;
+    if (!ok) printf("  %.6f, expected %.6f +/- %g\n", value, expected, tolerance);
+    return ok;
+}
+
+// Interleaved sine at Amplitude on every channel.
+static std::vector<float> Sine(ULONG rate, ULONG channels, ULONG frames, double hz, double amplitude)
+{
+    std::vector<float> bus((size_t)frames * channels);
+    for (ULONG f = 0; f < frames; f++)
+    {
+        float v = (float)(amplitude * sin(c_TwoPi * hz * f / rate));
+        for (ULONG c = 0; c < channels; c++) bus[(size_t)f * channels + c] = v;
+    }
+    return bus;
+}
+
+// Feed in tick-sized pieces, as the engine does.
+static void Feed(LeylineMeter* meter, const std::vector<float>& bus, float gain, LeylineSimdLevel level)
+{
+    ULONG frames = (ULONG)(bus.size() / meter->Channels);
+    for (ULONG done = 0; done < frames; )
+    {
+        ULONG n = min(frames - done, 48u);
+        LeylineMeterProcess(meter, bus.data() + (size_t)done * meter->Channels, n, gain, level);
+        done += n;
+    }
+}
+
+static float FromBits(ULONG bits)
+{
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+TEST(PeakAndRmsOfASine)
+{
+    LeylineMeter meter;
+    LeylineMeterReset(&meter, 48000, 2, FALSE);
+    CHECK_EQ(meter.BlockFrames, 4800u);
+
+    // 1 kHz fits the 100 ms block exactly, so the RMS is the textbook 1/sqrt(2).
+    Feed(&meter, Sine(48000, 2, 4800, 1000.0, 1.0), 1.0f, LeylineDetectSimdLevel());
+    CHECK_EQ(meter.Blocks, 1u);
+    CHECK(Near(meter.Levels.Peak[0], 1.0, 1e-6));
+    CHECK(Near(meter.Levels.Rms[0], 0.70710678, 1e-5));
+    CHECK(Near(meter.Levels.Rms[1], 0.70710678, 1e-5));
+    CHECK(meter.Levels.Peak[2] == 0.0f);
+
+    // Gain scales both, as if applied to the samples.
+    Feed(&meter, Sine(48000, 2, 4800, 1000.0, 1.0), 0.5f, LeylineDetectSimdLevel());
+    CHECK(Near(meter.Levels.Peak[1], 0.5, 1e-6));
+    CHECK(Near(meter.Levels.Rms[1], 0.35355339, 1e-5));
+
+    // The held peak spans both blocks until it is taken.
+    CHECK(LeylineMeterTakePeak(&meter, 0) == meter.Levels.Peak[0] * 2.0f);
+    CHECK(LeylineMeterTakePeak(&meter, 0) == 0.0f);
+}
+
+TEST(SimdLevelsMeasureIdentically)
+{
+    LeylineSimdLevel detected = LeylineDetectSimdLevel();
+    printf("  detected SIMD level %d\n", (int)detected);
+
+    // Includes widths that don't divide the 8 lanes, and a feed that splits blocks.
+    static const ULONG widths[] = { 1, 2, 3, 4, 6, 8 };
+    for (ULONG channels : widths)
+    {
+        std::vector<float> bus((size_t)9973 * channels);
+        for (size_t i = 0; i < bus.size(); i++) bus[i] = (float)((LONG)(i * 2654435761u)) / 2147483648.0f;
+
+        LeylineMeter scalar;
+        LeylineMeterReset(&scalar, 44100, channels, TRUE);
+        Feed(&scalar, bus, 0.75f, LeylineSimdScalar);
+
+        for (int level = LeylineSimdSse2; level <= (int)detected; level++)
+        {
+            LeylineMeter simd;
+            LeylineMeterReset(&simd, 44100, channels, TRUE);
+            Feed(&simd, bus, 0.75f, (LeylineSimdLevel)level);
+            if (memcmp(&scalar.Levels, &simd.Levels, sizeof(scalar.Levels)) != 0)
+                printf("  mismatch: %u channels, level %d\n", channels, level);
+            CHECK(memcmp(&scalar.Levels, &simd.Levels, sizeof(scalar.Levels)) == 0);
+            CHECK(memcmp(scalar.PeakHold, simd.PeakHold, sizeof(scalar.PeakHold)) == 0);
+        }
+    }
+}
+
+TEST(KWeightingMatchesTheStandardAt48k)
+{
+    // ITU-R BS.1770-4, tables 1 and 2.
+    LeylineMeter meter;
+    LeylineMeterReset(&meter, 48000, 2, TRUE);
+    CHECK(Near(meter.Shelf.B0,  1.53512485958697, 1e-9));
+    CHECK(Near(meter.Shelf.B1, -2.69169618940638, 1e-9));
+    CHECK(Near(meter.Shelf.B2,  1.19839281085285, 1e-9));
+    CHECK(Near(meter.Shelf.A1, -1.69065929318241, 1e-9));
+    CHECK(Near(meter.Shelf.A2,  0.73248077421585, 1e-9));
+    CHECK(Near(meter.HighPass.A1, -1.99004745483398, 1e-9));
+    CHECK(Near(meter.HighPass.A2,  0.99007225036621, 1e-9));
+}
+
+TEST(LoudnessOfReferenceTones)
+{
+    static const ULONG rates[] = { 44100, 48000, 96000 };
+    for (ULONG rate : rates)
+    {
+        // Full-scale 997 Hz on both channels is 0 LUFS by definition; on one it is -3.01.
+        LeylineMeter meter;
+        LeylineMeterReset(&meter, rate, 2, TRUE);
+        Feed(&meter, Sine(rate, 2, rate * 3, 997.0, 1.0), 1.0f, LeylineDetectSimdLevel());
+        CHECK(Near(meter.Levels.Loudness, 0.0, 0.05));
+
+        LeylineMeterReset(&meter, rate, 2, TRUE);
+        Feed(&meter, Sine(rate, 2, rate * 3, 997.0, 0.1), 1.0f, LeylineDetectSimdLevel());
+        CHECK(Near(meter.Levels.Loudness, -20.0, 0.05));
+
+        LeylineMeterReset(&meter, rate, 1, TRUE);
+        Feed(&meter, Sine(rate, 1, rate * 3, 997.0, 1.0), 1.0f, LeylineDetectSimdLevel());
+        CHECK(Near(meter.Levels.Loudness, -3.01, 0.05));
+    }
+
+    // The high-pass rejects a 10 Hz rumble almost entirely; silence is the floor.
+    LeylineMeter meter;
+    LeylineMeterReset(&meter, 48000, 2, TRUE);
+    Feed(&meter, Sine(48000, 2, 48000, 10.0, 1.0), 1.0f, LeylineDetectSimdLevel());
+    CHECK(meter.Levels.Loudness < -20.0f);
+    LeylineMeterReset(&meter, 48000, 2, TRUE);
+    Feed(&meter, std::vector<float>(48000 * 2, 0.0f), 1.0f, LeylineDetectSimdLevel());
+    CHECK(meter.Levels.Loudness == LEYLINE_METER_SILENCE_LUFS);
+}
+
+TEST(EnginePublishesLevelsAfterGain)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylineSharedParameters params = {};
+    LoopbackEngineSetSharedParameters(&engine, &params);
+
+    // Matching formats take the raw copy; the meter still sees the mix.
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    SHORT* src = reinterpret_cast<SHORT*>(render.Buffer.GetBaseAddress());
+    for (ULONG f = 0; f < render.Buffer.GetSize() / 4; f++)
+    {
+        src[f * 2]     = 16384;     // 0.5
+        src[f * 2 + 1] = -8192;     // -0.25
+    }
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(params.MeterSequence, 2u);     // Attaching publishes the idle levels
+    RunTicks(&engine, 99);
+    CHECK_EQ(params.MeterSequence, 2u);
+    RunTicks(&engine, 1);
+
+    CHECK_EQ(params.MeterSequence, 4u);
+    CHECK(FromBits(params.PeakLBits) == 0.5f);
+    CHECK(FromBits(params.PeakRBits) == 0.25f);
+    CHECK(Near(FromBits(params.RmsLBits), 0.5, 1e-6));
+    CHECK(Near(FromBits(params.RmsRBits), 0.25, 1e-6));
+    CHECK(reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress())[0] == 16384);
+
+    CHECK(LoopbackEngineTakePeak(&engine, 1) == 0.25f);
+    CHECK(LoopbackEngineTakePeak(&engine, 1) == 0.0f);
+
+    // -6 dB reaches the meter once the ramp has passed.
+    LoopbackEngineSetMasterGain(&engine, -6 * 0x10000, FALSE);
+    RunTicks(&engine, 200);
+    CHECK_EQ(params.MeterSequence, 8u);
+    CHECK(Near(FromBits(params.PeakLBits), 0.5 * 0.5011872, 1e-6));
+
+    // Stopping the loopback drops the published levels to silence.
+    CloseStream(&engine, &capture);
+    CHECK(params.MeterSequence % 2 == 0);
+    CHECK(FromBits(params.PeakLBits) == 0.0f);
+    CHECK(FromBits(params.RmsRBits) == 0.0f);
+    CHECK(FromBits(params.LoudnessBits) == LEYLINE_METER_SILENCE_LUFS);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(MeteringOffLeavesTheRawCopyAlone)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetMetering(&engine, FALSE, FALSE);
+    LeylineSharedParameters params = {};
+    LoopbackEngineSetSharedParameters(&engine, &params);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 200);
+
+    CHECK_EQ(engine.Meter.SampleRate, 0u);
+    CHECK_EQ(params.MeterSequence, 2u);     // Only the initial publish
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+HOST_TEST_MAIN()
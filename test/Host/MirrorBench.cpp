@@ -0,0 +1,170 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MIRRORED BUFFER BENCHMARK
+// What the wrap costs. First the mix kernels on one tick's frames that cross the end
+// of a ring a few frames in, called twice around the wrap as a plain buffer needs, or
+// once over a mirrored mapping. Then whole ticks on buffers sized so the wrap lands
+// mid-tick every few dozen ticks, plain against mirrored.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+struct BenchFormat
+{
+    const char* Label;
+    ULONG       SampleRate;
+    ULONG       Bits;
+    ULONG       Channels;
+    BOOLEAN     IsFloat;
+};
+
+static const ULONG c_Batch = 100;
+
+// The tick's frames start Lead frames before the end of the ring, so the split pair
+// of calls does Lead frames and then the rest.
+static void RunKernels(const BenchFormat& fmt, ULONG lead, ULONG iterations)
+{
+    // About 100 ms, rounded up to whole pages of whole frames so it can be mirrored.
+    ULONG frameSize = (fmt.Bits / 8) * fmt.Channels;
+    ULONG unit      = frameSize * (PAGE_SIZE / min(frameSize & (0 - frameSize), (ULONG)PAGE_SIZE));
+    ULONG bytes     = (fmt.SampleRate * frameSize / 10 + unit - 1) / unit * unit;
+
+    LoopbackStream ring;
+    OpenStream(&ring, FALSE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bytes, LOOPBACK_BUFFER_MIRRORED);
+    if (!ring.Buffer.IsMirrored())
+    {
+        printf("%s: no mirrored mapping\n", fmt.Label);
+        LoopbackStreamFreeBuffer(&ring);
+        return;
+    }
+
+    ULONG  frameBytes = ring.FrameBytes;
+    ULONG  frames     = fmt.SampleRate / 1000;
+    ULONG  samples    = frames * fmt.Channels;
+    PUCHAR base       = ring.Buffer.GetBaseAddress();
+    PUCHAR start      = base + ring.Buffer.GetSize() - (SIZE_T)lead * frameBytes;
+    for (ULONG i = 0; i < ring.Buffer.GetSize(); i++) base[i] = (UCHAR)(i * 13);
+
+    std::vector<UCHAR> out((SIZE_T)frames * frameBytes);
+    std::vector<float> bus(samples, 0.0f);
+    const LeylineMixKernels* kernels = LeylineSelectMixKernels(ring.SampleFormat, LeylineDetectSimdLevel());
+    ULONG leadSamples = lead * fmt.Channels;
+
+    HostBench::Samples copySplit, copyLinear, accSplit, accLinear;
+    for (ULONG i = 0; i < iterations / c_Batch; i++)
+    {
+        long long t0 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+        {
+            kernels->ScaleCopy(out.data(), start, leadSamples, 0.5f);
+            kernels->ScaleCopy(out.data() + (SIZE_T)lead * frameBytes, base, samples - leadSamples, 0.5f);
+        }
+        long long t1 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++) kernels->ScaleCopy(out.data(), start, samples, 0.5f);
+        long long t2 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++)
+        {
+            kernels->Accumulate(bus.data(), start, leadSamples);
+            kernels->Accumulate(bus.data() + leadSamples, base, samples - leadSamples);
+        }
+        long long t3 = HostBench::WallNs();
+        for (ULONG b = 0; b < c_Batch; b++) kernels->Accumulate(bus.data(), start, samples);
+        long long t4 = HostBench::WallNs();
+
+        copySplit.Add((t1 - t0) / c_Batch);
+        copyLinear.Add((t2 - t1) / c_Batch);
+        accSplit.Add((t3 - t2) / c_Batch);
+        accLinear.Add((t4 - t3) / c_Batch);
+        HostBench::Consume(out.data());
+        HostBench::Consume(bus.data());
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s copy split", fmt.Label);
+    HostBench::PrintRow(label, copySplit);
+    snprintf(label, sizeof(label), "%s copy mirror", fmt.Label);
+    HostBench::PrintRow(label, copyLinear);
+    snprintf(label, sizeof(label), "%s accum split", fmt.Label);
+    HostBench::PrintRow(label, accSplit);
+    snprintf(label, sizeof(label), "%s accum mirror", fmt.Label);
+    HostBench::PrintRow(label, accLinear);
+
+    LoopbackStreamFreeBuffer(&ring);
+}
+
+static void RunTicks(const BenchFormat& fmt, ULONG renderCount, ULONG bufferFlags, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // Three pages of 24-bit frames or one page of anything else: never a whole number
+    // of ticks, so the wrap moves around within the tick.
+    ULONG bufferBytes = (fmt.Bits == 24) ? 3 * PAGE_SIZE : PAGE_SIZE;
+    bufferBytes *= fmt.Channels / 2;
+
+    std::vector<LoopbackStream> renders(renderCount);
+    for (LoopbackStream& render : renders)
+    {
+        OpenStream(&render, FALSE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes, bufferFlags);
+        PUCHAR base = render.Buffer.GetBaseAddress();
+        for (ULONG i = 0; i < render.Buffer.GetSize(); i++) base[i] = (UCHAR)(i * 13);
+        LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    }
+    LoopbackStream capture;
+    OpenStream(&capture, TRUE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes, bufferFlags);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+    HostBench::Consume(capture.Buffer.GetBaseAddress());
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s x%u %s", fmt.Label, renderCount,
+             capture.Buffer.IsMirrored() ? "mirrored" : "split");
+    HostBench::PrintRow(label, samples);
+
+    CloseStream(&engine, &capture);
+    for (LoopbackStream& render : renders) CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG iterations = HostBench::IterationsFromArgs(argc, argv, 20000);
+
+    static const BenchFormat formats[] =
+    {
+        { "48k/16/2 pcm",    48000, 16, 2, FALSE },
+        { "48k/24/2 pcm",    48000, 24, 2, FALSE },
+        { "192k/32/8 float", 192000, 32, 8, TRUE },
+    };
+
+    HostBench::PrintHeader("Mix kernels on 1 ms crossing the wrap 3 frames in");
+    printf("%u batches of %u calls per row\n", iterations / c_Batch, c_Batch);
+    for (const BenchFormat& fmt : formats) RunKernels(fmt, 3, iterations);
+
+    HostBench::PrintHeader("Loopback DPC time per 1 ms tick, buffers wrapping mid-tick");
+    printf("%u simulated ticks per row\n", iterations);
+    for (const BenchFormat& fmt : formats)
+    {
+        RunTicks(fmt, 1, 0, iterations);
+        RunTicks(fmt, 1, LOOPBACK_BUFFER_MIRRORED, iterations);
+        RunTicks(fmt, 2, 0, iterations);
+        RunTicks(fmt, 2, LOOPBACK_BUFFER_MIRRORED, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MIXER DPC BENCHMARK
+// DPC time per 1 ms tick as the number of running render streams grows, feeding one
+// capture stream. A single matching stream takes the bit-perfect copy; every other
+// row goes through the float bus.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+struct BenchFormat
+{
+    const char* Label;
+    ULONG       SampleRate;
+    ULONG       Bits;
+    ULONG       Channels;
+    BOOLEAN     IsFloat;
+};
+
+static void RunMix(const BenchFormat& fmt, ULONG renderCount, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    ULONG blockAlign  = (fmt.Bits / 8) * fmt.Channels;
+    ULONG bufferBytes = fmt.SampleRate * blockAlign / 10; // 100 ms
+
+    std::vector<LoopbackStream> renders(renderCount);
+    for (LoopbackStream& render : renders)
+    {
+        OpenStream(&render, FALSE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes);
+        PUCHAR base = render.Buffer.GetBaseAddress();
+        for (ULONG i = 0; i < render.Buffer.GetSize(); i++) base[i] = (UCHAR)(i * 13);
+        LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    }
+
+    LoopbackStream capture;
+    OpenStream(&capture, TRUE, fmt.SampleRate, fmt.Bits, fmt.Channels, fmt.IsFloat, bufferBytes);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+    HostBench::Consume(capture.Buffer.GetBaseAddress());
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s x%u render", fmt.Label, renderCount);
+    HostBench::PrintRow(label, samples);
+
+    CloseStream(&engine, &capture);
+    for (LoopbackStream& render : renders) CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 10000);
+
+    static const BenchFormat formats[] =
+    {
+        { "48k/16/2 pcm",   48000, 16, 2, FALSE },
+        { "48k/32/2 float", 48000, 32, 2, TRUE  },
+        { "48k/24/8 pcm",   48000, 24, 8, FALSE },
+    };
+    static const ULONG renderCounts[] = { 1, 2, 4, 8, 16 };
+
+    HostBench::PrintHeader("Mixer DPC time per 1 ms tick vs. render streams");
+    printf("%u simulated ticks per row, one capture stream\n", ticks);
+    for (const BenchFormat& fmt : formats)
+    {
+        for (ULONG count : renderCounts) RunMix(fmt, count, ticks);
+    }
+    return 0;
+}
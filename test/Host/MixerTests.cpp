@@ -0,0 +1,494 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MIXER TESTS
+// Sample kernels in isolation, then multi-stream mixing and master gain through the
+// loopback engine.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+
+using namespace HostSim;
+
+// Full-scale positive is one step short of 1.0 for integer formats.
+static float MixClampForTest(float v)
+{
+    const float top = 8388607.0f / 8388608.0f;
+    return (v > top) ? top : (v < -1.0f) ? -1.0f : v;
+}
+
+static void FillConstant16(LoopbackStream* stream, SHORT value)
+{
+    SHORT* samples = reinterpret_cast<SHORT*>(stream->Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < stream->Buffer.GetSize() / sizeof(SHORT); i++) samples[i] = value;
+}
+
+static void FillConstantFloat(LoopbackStream* stream, float value)
+{
+    float* samples = reinterpret_cast<float*>(stream->Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < stream->Buffer.GetSize() / sizeof(float); i++) samples[i] = value;
+}
+
+TEST(SampleFormatSelection)
+{
+    CHECK(LeylineSampleFormatOf(16, 0,  FALSE) == LeylineSampleInt16);
+    CHECK(LeylineSampleFormatOf(24, 0,  FALSE) == LeylineSampleInt24);
+    CHECK(LeylineSampleFormatOf(32, 24, FALSE) == LeylineSampleInt24In32);
+    CHECK(LeylineSampleFormatOf(32, 0,  FALSE) == LeylineSampleInt32);
+    CHECK(LeylineSampleFormatOf(32, 32, FALSE) == LeylineSampleInt32);
+    CHECK(LeylineSampleFormatOf(32, 0,  TRUE)  == LeylineSampleFloat32);
+    CHECK(LeylineSampleFormatOf(8,  0,  FALSE) == LeylineSampleUnsupported);
+    CHECK(LeylineSampleFormatOf(64, 0,  TRUE)  == LeylineSampleUnsupported);
+}
+
+TEST(AccumulateAndSaturate)
+{
+    float bus[4] = {};
+    SHORT a[4] = { 30000, -30000, 100, -1 };
+    SHORT b[4] = { 30000, -30000, 200, 0 };
+
+    MixAccumulate(bus, 2, reinterpret_cast<const UCHAR*>(a), LeylineSampleInt16, 2, 2);
+    MixAccumulate(bus, 2, reinterpret_cast<const UCHAR*>(b), LeylineSampleInt16, 2, 2);
+
+    SHORT out16[4] = {};
+    MixWriteOut(reinterpret_cast<UCHAR*>(out16), LeylineSampleInt16, 2, bus, 2, 2, 1.0f);
+    CHECK_EQ(out16[0], 32767);
+    CHECK_EQ(out16[1], -32768);
+    CHECK_EQ(out16[2], 300);
+    CHECK_EQ(out16[3], -1);
+
+    LONG out32[4] = {};
+    MixWriteOut(reinterpret_cast<UCHAR*>(out32), LeylineSampleInt32, 2, bus, 2, 2, 1.0f);
+    CHECK_EQ(out32[0], 2147483520);
+    CHECK_EQ(out32[1], (LONG)-2147483647 - 1);
+    CHECK_EQ(out32[2], 300 << 16);
+
+    float outF[4] = {};
+    MixWriteOut(reinterpret_cast<UCHAR*>(outF), LeylineSampleFloat32, 2, bus, 2, 2, 1.0f);
+    CHECK(outF[0] == 1.0f && outF[1] == -1.0f);
+}
+
+TEST(PackedInt24RoundTrip)
+{
+    UCHAR src[6] = { 0x56, 0x34, 0x12, 0xFF, 0xFF, 0x80 }; // 0x123456, -0x7F0001
+    float bus[2] = {};
+    MixAccumulate(bus, 1, src, LeylineSampleInt24, 1, 2);
+
+    UCHAR dst[6] = {};
+    MixWriteOut(dst, LeylineSampleInt24, 1, bus, 1, 2, 1.0f);
+    CHECK(memcmp(src, dst, sizeof(src)) == 0);
+}
+
+TEST(Int24In32IsLeftJustified)
+{
+    LONG src[2] = { 0x12345600, (LONG)0x80000000 };
+    float bus[2] = {};
+    MixAccumulate(bus, 2, reinterpret_cast<const UCHAR*>(src), LeylineSampleInt24In32, 2, 1);
+    CHECK(bus[1] == -1.0f);
+
+    // Re-encoding keeps 24 valid bits and zeroes the padding byte.
+    bus[0] += 0x40 / 2147483648.0f;
+    LONG dst[2] = {};
+    MixWriteOut(reinterpret_cast<UCHAR*>(dst), LeylineSampleInt24In32, 2, bus, 2, 1, 1.0f);
+    CHECK_EQ(dst[0], 0x12345600);
+    CHECK_EQ(dst[1], (LONG)0x80000000);
+}
+
+// Deterministic samples spanning the full range, with a few values past full scale.
+static void FillBusPattern(float* bus, ULONG count)
+{
+    ULONG seed = 0x1234567u;
+    for (ULONG i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        bus[i] = ((LONG)seed / 2147483648.0f) * 1.25f;
+    }
+    bus[0] = 0.5f / 32768.0f;   // Rounding tie for int16
+    bus[1] = -0.5f / 32768.0f;
+    bus[2] = -1.0f;
+    bus[3] = 1.0f;
+}
+
+TEST(SimdKernelsMatchScalar)
+{
+    // Odd sample count so every SIMD level also exercises its scalar tail.
+    const ULONG samples = 1003;
+    static float bus[samples], scalarBus[samples], simdBus[samples];
+    static UCHAR encoded[samples * 4], scalarOut[samples * 4 + 16], simdOut[samples * 4 + 16];
+    FillBusPattern(bus, samples);
+
+    LeylineSimdLevel detected = LeylineDetectSimdLevel();
+    printf("  detected SIMD level %d\n", (int)detected);
+
+    static const float gains[] = { 1.0f, 0.5011872f, 0.0f };
+    for (int level = LeylineSimdSse2; level <= (int)detected; level++)
+    {
+        for (int format = LeylineSampleInt16; format < LeylineSampleFormatCount; format++)
+        {
+            const LeylineMixKernels* scalar = LeylineSelectMixKernels((LeylineSampleFormat)format, LeylineSimdScalar);
+            const LeylineMixKernels* simd   = LeylineSelectMixKernels((LeylineSampleFormat)format, (LeylineSimdLevel)level);
+
+            for (float gain : gains)
+            {
+                memset(scalarOut, 0xA5, sizeof(scalarOut));
+                memset(simdOut,   0xA5, sizeof(simdOut));
+                scalar->WriteOut(scalarOut, bus, samples, gain);
+                simd->WriteOut(simdOut, bus, samples, gain);
+                if (memcmp(scalarOut, simdOut, sizeof(scalarOut)) != 0)
+                    printf("  write-out mismatch: format %d level %d gain %g\n", format, level, gain);
+                CHECK(memcmp(scalarOut, simdOut, sizeof(scalarOut)) == 0);
+            }
+
+            scalar->WriteOut(encoded, bus, samples, 1.0f);
+            for (ULONG i = 0; i < samples; i++) scalarBus[i] = simdBus[i] = 0.25f;
+            scalar->Accumulate(scalarBus, encoded, samples);
+            simd->Accumulate(simdBus, encoded, samples);
+            if (memcmp(scalarBus, simdBus, sizeof(scalarBus)) != 0)
+                printf("  accumulate mismatch: format %d level %d\n", format, level);
+            CHECK(memcmp(scalarBus, simdBus, sizeof(scalarBus)) == 0);
+
+            for (float gain : gains)
+            {
+                memset(scalarOut, 0xA5, sizeof(scalarOut));
+                memset(simdOut,   0xA5, sizeof(simdOut));
+                scalar->ScaleCopy(scalarOut, encoded, samples, gain);
+                simd->ScaleCopy(simdOut, encoded, samples, gain);
+                if (memcmp(scalarOut, simdOut, sizeof(scalarOut)) != 0)
+                    printf("  scale-copy mismatch: format %d level %d gain %g\n", format, level, gain);
+                CHECK(memcmp(scalarOut, simdOut, sizeof(scalarOut)) == 0);
+            }
+        }
+    }
+}
+
+TEST(ScaleCopyMatchesBusPath)
+{
+    // The raw path and the bus path must agree, so switching between them mid-stream
+    // (a second render stream joining, a ramp finishing) is seamless.
+    const ULONG samples = 515;
+    static float bus[samples], pivot[samples];
+    static UCHAR encoded[samples * 4], viaBus[samples * 4], direct[samples * 4];
+    FillBusPattern(bus, samples);
+
+    LeylineSimdLevel level = LeylineDetectSimdLevel();
+    for (int format = LeylineSampleInt16; format < LeylineSampleFormatCount; format++)
+    {
+        const LeylineMixKernels* kernels = LeylineSelectMixKernels((LeylineSampleFormat)format, level);
+        kernels->WriteOut(encoded, bus, samples, 1.0f);
+
+        memset(pivot, 0, sizeof(pivot));
+        kernels->Accumulate(pivot, encoded, samples);
+        kernels->WriteOut(viaBus, pivot, samples, 0.3548134f);
+        kernels->ScaleCopy(direct, encoded, samples, 0.3548134f);
+        if (memcmp(viaBus, direct, sizeof(direct)) != 0) printf("  format %d differs\n", format);
+        CHECK(memcmp(viaBus, direct, sizeof(direct)) == 0);
+    }
+}
+
+TEST(VolumeTableTracksDecibels)
+{
+    CHECK(LeylineGainFromVolume(0) == 1.0f);
+    CHECK(LeylineGainFromVolume(0x10000) == 1.0f);
+    CHECK(LeylineGainFromVolume(LEYLINE_VOLUME_MIN - 1) == LeylineGainFromVolume(LEYLINE_VOLUME_MIN));
+
+    // Reference values of 10^(dB/20).
+    static const struct { LONG Level; float Gain; } cases[] =
+    {
+        { -6 * 0x10000,            0.5011872f },
+        { -20 * 0x10000,           0.1f },
+        { -(20 * 0x10000 + 0x8000), 0.0944061f },   // -20.5 dB
+        { -(3 * 0x10000 + 0x1000),  0.7028700f },   // -3.0625 dB
+        { LEYLINE_VOLUME_MIN,      1.5848932e-5f },
+    };
+    for (const auto& c : cases)
+    {
+        float err = LeylineGainFromVolume(c.Level) / c.Gain - 1.0f;
+        if (err < 0) err = -err;
+        CHECK(err < 1e-5f);
+    }
+
+    // Monotonic across the whole range at the table's 1/16 dB resolution.
+    BOOLEAN monotonic = TRUE;
+    for (LONG level = LEYLINE_VOLUME_MAX; level > LEYLINE_VOLUME_MIN; level -= 0x1000)
+        monotonic = monotonic && LeylineGainFromVolume(level - 0x1000) < LeylineGainFromVolume(level);
+    CHECK(monotonic);
+}
+
+TEST(ConversionMatrixRoundTrips)
+{
+    // Every format pair, through the float pivot: the destination must hold the source
+    // value to within the narrower format's resolution.
+    const ULONG samples = 64;
+    static float bus[samples];
+    FillBusPattern(bus, samples);
+    for (ULONG i = 0; i < samples; i++) bus[i] = MixClampForTest(bus[i]);
+
+    static const float resolution[LeylineSampleFormatCount] =
+        { 0.0f, 1.0f / 32768, 1.0f / 8388608, 1.0f / 8388608, 1.0f / 2147483648.0f, 1.0f / 16777216 };
+
+    LeylineSimdLevel level = LeylineDetectSimdLevel();
+    for (int from = LeylineSampleInt16; from < LeylineSampleFormatCount; from++)
+    {
+        for (int to = LeylineSampleInt16; to < LeylineSampleFormatCount; to++)
+        {
+            const LeylineMixKernels* src = LeylineSelectMixKernels((LeylineSampleFormat)from, level);
+            const LeylineMixKernels* dst = LeylineSelectMixKernels((LeylineSampleFormat)to, level);
+
+            UCHAR srcBuf[samples * 4], dstBuf[samples * 4];
+            float pivot[samples] = {}, result[samples] = {};
+            src->WriteOut(srcBuf, bus, samples, 1.0f);
+            src->Accumulate(pivot, srcBuf, samples);
+            dst->WriteOut(dstBuf, pivot, samples, 1.0f);
+            dst->Accumulate(result, dstBuf, samples);
+
+            float tolerance = max(resolution[from], resolution[to]);
+            float worst = 0.0f;
+            for (ULONG i = 0; i < samples; i++)
+            {
+                float err = result[i] - bus[i];
+                if (err < 0) err = -err;
+                if (err > worst) worst = err;
+            }
+            if (worst > tolerance)
+                printf("  %d -> %d: error %g exceeds %g\n", from, to, worst, tolerance);
+            CHECK(worst <= tolerance);
+        }
+    }
+}
+
+TEST(ChannelCountMismatch)
+{
+    // Mono source onto a stereo bus fills only the first channel; the stereo bus onto a
+    // quad destination writes silence to the extra channels.
+    SHORT mono[2] = { 16384, -16384 };
+    float bus[4] = {};
+    MixAccumulate(bus, 2, reinterpret_cast<const UCHAR*>(mono), LeylineSampleInt16, 1, 2);
+    CHECK(bus[0] == 0.5f && bus[1] == 0.0f && bus[2] == -0.5f && bus[3] == 0.0f);
+
+    SHORT quad[8];
+    for (SHORT& s : quad) s = 123;
+    MixWriteOut(reinterpret_cast<UCHAR*>(quad), LeylineSampleInt16, 4, bus, 2, 2, 1.0f);
+    CHECK(quad[0] == 16384 && quad[1] == 0 && quad[2] == 0 && quad[3] == 0);
+    CHECK(quad[4] == -16384 && quad[7] == 0);
+}
+
+TEST(EngineSumsAllRenderStreams)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream renderA, renderB, capture;
+    OpenStream(&renderA, FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&renderB, FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    FillConstant16(&renderA, 1000);
+    FillConstant16(&renderB, 234);
+
+    LoopbackStreamSetState(&engine, &renderA, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &renderB, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 20);
+
+    CHECK_EQ(capture.HwPositionRegister, 20ull * 192);
+    CHECK_EQ(renderA.Cursor, renderB.Cursor);
+    CHECK_EQ(engine.GlitchCount, 0u);
+
+    const SHORT* dst = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    BOOLEAN allSummed = TRUE;
+    for (ULONG i = 0; i < 20 * 96; i++) allSummed = allSummed && (dst[i] == 1234);
+    CHECK(allSummed);
+    CHECK_EQ(dst[20 * 96], 0);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &renderB);
+    CloseStream(&engine, &renderA);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(EngineMixesFloatAndPcmIntoEachCaptureFormat)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream renderPcm, renderFloat, capturePcm, captureFloat;
+    OpenStream(&renderPcm,    FALSE, 48000, 16, 2, FALSE, 9600);
+    OpenStream(&renderFloat,  FALSE, 48000, 32, 2, TRUE,  19200);
+    OpenStream(&capturePcm,   TRUE,  48000, 16, 2, FALSE, 9600);
+    OpenStream(&captureFloat, TRUE,  48000, 32, 2, TRUE,  19200);
+    FillConstant16(&renderPcm, 16384);       // 0.5
+    FillConstantFloat(&renderFloat, 0.75f);  // Sum clips to full scale
+
+    LoopbackStreamSetState(&engine, &renderPcm,    KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &renderFloat,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capturePcm,   KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &captureFloat, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+
+    const SHORT* pcm = reinterpret_cast<const SHORT*>(capturePcm.Buffer.GetBaseAddress());
+    const float* flt = reinterpret_cast<const float*>(captureFloat.Buffer.GetBaseAddress());
+    CHECK_EQ(pcm[0], 32767);
+    CHECK_EQ(pcm[10 * 96 - 1], 32767);
+    CHECK(flt[0] == 1.0f && flt[10 * 96 - 1] == 1.0f);
+
+    CloseStream(&engine, &captureFloat);
+    CloseStream(&engine, &capturePcm);
+    CloseStream(&engine, &renderFloat);
+    CloseStream(&engine, &renderPcm);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(LateRenderStreamJoinsOnItsOwnCursor)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream renderA, renderB, capture;
+    OpenStream(&renderA, FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&renderB, FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    FillConstant16(&renderA, 100);
+    FillConstant16(&renderB, 20);
+
+    LoopbackStreamSetState(&engine, &renderA, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 5);
+
+    LoopbackStreamSetState(&engine, &renderB, KSSTATE_RUN);
+    RunTicks(&engine, 5);
+
+    // renderB started 240 frames after renderA and is read from its own frame zero.
+    CHECK_EQ(renderA.Cursor, 480ull);
+    CHECK_EQ(renderB.Cursor, 240ull);
+
+    const SHORT* dst = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    CHECK_EQ(dst[0], 100);
+    CHECK_EQ(dst[2 * 240 - 1], 100);
+    CHECK_EQ(dst[2 * 240], 120);
+    CHECK_EQ(dst[2 * 480 - 1], 120);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &renderB);
+    CloseStream(&engine, &renderA);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(PauseAndResumeKeepsMixing)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    FillConstant16(&render, 7);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 5);
+
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    RunTicks(&engine, 5);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    RunTicks(&engine, 5);
+
+    // The render clock restarted at RUN; the cursor follows it instead of stalling.
+    CHECK_EQ(render.Cursor, 240ull);
+    CHECK_EQ(render.HwPositionRegister, 960ull);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    CHECK(IsListEmpty(&engine.RenderStreams));
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(MasterGainScalesTheRawCopy)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // Set before anything runs, so there is no ramp and the raw path applies it.
+    LoopbackEngineSetMasterGain(&engine, -6 * 0x10000, FALSE);
+    CHECK(engine.GainCurrent == engine.GainTarget);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    FillConstant16(&render, 16384);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+
+    const SHORT* dst = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    CHECK_EQ(dst[0], 8211);                 // 16384 * 10^(-6/20), rounded
+    CHECK_EQ(dst[10 * 96 - 1], 8211);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(MuteRampsWithoutAJump)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 32, 2, TRUE, 38400);
+    OpenStream(&capture, TRUE,  48000, 32, 2, TRUE, 38400);
+    FillConstantFloat(&render, 0.5f);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+
+    LoopbackEngineSetMasterGain(&engine, 0, TRUE);
+    RunTicks(&engine, 10);
+    CHECK(engine.GainCurrent == 0.0f);
+
+    // Left channel of 20 ms: flat, then a 5 ms ramp down in even steps, then silence.
+    const float* dst = reinterpret_cast<const float*>(capture.Buffer.GetBaseAddress());
+    const float  maxStep = 0.5f / (48 * LOOPBACK_GAIN_RAMP_MS) * 1.01f;
+    BOOLEAN smooth = TRUE;
+    for (ULONG f = 1; f < 960; f++)
+    {
+        float step = dst[(f - 1) * 2] - dst[f * 2];
+        smooth = smooth && step >= 0.0f && step <= maxStep;
+    }
+    CHECK(smooth);
+    CHECK(dst[479 * 2] == 0.5f);
+    CHECK(dst[480 * 2] < 0.5f && dst[480 * 2] > 0.49f);
+    CHECK(dst[(480 + 48 * LOOPBACK_GAIN_RAMP_MS) * 2] == 0.0f);
+    CHECK(dst[959 * 2] == 0.0f && dst[959 * 2 + 1] == 0.0f);
+
+    // Unmuting ramps back up to the raw path's exact samples.
+    LoopbackEngineSetMasterGain(&engine, 0, FALSE);
+    RunTicks(&engine, 10);
+    CHECK(engine.GainCurrent == 1.0f);
+    CHECK(dst[1439 * 2] == 0.5f);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,172 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// NOTIFICATION LATENESS BENCHMARK
+// How late each notification event is signaled after the boundary frame begins, for
+// the one-shot scheduler and for the tick-driven signaling it replaced (run by deleting
+// the engine's notification timer, the driver's fallback). Timers fire exactly when due
+// on the virtual clock, so this is the scheduling error alone; OS wake latency comes on
+// top in both modes. Missed counts boundaries that passed without a signal of their own.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+struct BenchCase
+{
+    const char* Label;
+    ULONG       SampleRate;
+    ULONG       PeriodFrames;
+    BOOLEAN     WithCapture;
+    LONGLONG    Frequency;
+};
+
+// Bucket upper bounds in microseconds; the last bucket is everything beyond.
+static const LONGLONG c_Buckets[] = { 1, 10, 100, 250, 500, 1000 };
+static const ULONG    c_BucketCount = sizeof(c_Buckets) / sizeof(c_Buckets[0]) + 1;
+
+struct Lateness
+{
+    HostBench::Samples Ns;
+    ULONG              Histogram[c_BucketCount] = {};
+    ULONGLONG          Boundaries = 0;
+    ULONG              Signals = 0;
+};
+
+// Latest notification boundary at or before Now, as a QPC time.
+static LONGLONG LastBoundary(const LoopbackStream* stream, LONGLONG now)
+{
+    ULONGLONG frame = LeylineClockFrames(&stream->Clock, now);
+    return LeylineClockTimeOf(&stream->Clock, frame - frame % stream->NotifyFrames);
+}
+
+static void Observe(const LoopbackStream* stream, const KEVENT* event, ULONG* seen,
+                    LONGLONG frequency, Lateness* out)
+{
+    if (event->SignalCount == *seen) return;
+    *seen = event->SignalCount;
+
+    LONGLONG late = event->LastSignalQpc - LastBoundary(stream, event->LastSignalQpc);
+    long long ns  = (long long)((double)late * 1e9 / (double)frequency);
+    out->Ns.Add(ns);
+    out->Signals++;
+
+    ULONG bucket = 0;
+    while (bucket < c_BucketCount - 1 && ns >= c_Buckets[bucket] * 1000) bucket++;
+    out->Histogram[bucket]++;
+}
+
+static void PrintLateness(const char* label, Lateness& l)
+{
+    ULONG missed = (ULONG)(l.Boundaries > l.Signals ? l.Boundaries - l.Signals : 0);
+    printf("%-34s signals %6u  missed %6u", label, l.Signals, missed);
+    if (l.Signals == 0)
+    {
+        printf("\n");
+        return;
+    }
+    printf("  p50 %7lld ns  p99 %7lld ns  max %7lld ns\n",
+           l.Ns.Percentile(50), l.Ns.Percentile(99), l.Ns.Percentile(100));
+    printf("%-34s", "");
+    for (ULONG b = 0; b < c_BucketCount; b++)
+    {
+        if (b < c_BucketCount - 1) printf(" <%lldus %5.1f%%", (long long)c_Buckets[b], 100.0 * l.Histogram[b] / l.Signals);
+        else                       printf(" more %5.1f%%", 100.0 * l.Histogram[b] / l.Signals);
+    }
+    printf("\n");
+}
+
+static void RunCase(const BenchCase& bc, BOOLEAN scheduler, ULONG seconds)
+{
+    HostClockReset(bc.Frequency);
+    HostClockSet(bc.Frequency);
+    LONGLONG tickQpc = bc.Frequency / 1000;
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    if (!scheduler)
+    {
+        ExDeleteTimer(engine.NotifyTimer, TRUE, TRUE, nullptr);
+        engine.NotifyTimer = nullptr;
+    }
+
+    ULONG bufferBytes = bc.SampleRate / 10 * 4;
+
+    LoopbackStream render, capture;
+    KEVENT renderEvent, captureEvent;
+    OpenStream(&render, FALSE, bc.SampleRate, 16, 2, FALSE, bufferBytes);
+    render.NotificationBytes = bc.PeriodFrames * 4;
+    KeInitializeEvent(&renderEvent, NotificationEvent, FALSE);
+    LoopbackStreamAddEvent(&engine, &render, &renderEvent);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    if (bc.WithCapture)
+    {
+        OpenStream(&capture, TRUE, bc.SampleRate, 16, 2, FALSE, bufferBytes);
+        capture.NotificationBytes = bc.PeriodFrames * 4;
+        KeInitializeEvent(&captureEvent, NotificationEvent, FALSE);
+        LoopbackStreamAddEvent(&engine, &capture, &captureEvent);
+        LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    }
+
+    // Whichever timer is due next fires next; the engine tick keeps its 1 ms cadence.
+    Lateness  renderLate, captureLate;
+    ULONG     renderSeen = 0, captureSeen = 0;
+    LONGLONG  end        = HostClockNow() + (LONGLONG)seconds * bc.Frequency;
+    LONGLONG  nextTick   = HostClockNow() + tickQpc;
+    while (HostClockNow() < end)
+    {
+        LONGLONG due;
+        if (HostExTimerDue(engine.NotifyTimer, &due) && due <= nextTick)
+        {
+            HostClockSet(max(due, HostClockNow()));
+            HostExTimerFire(engine.NotifyTimer);
+        }
+        else
+        {
+            HostClockSet(nextTick);
+            HostTimerFire(&engine.LoopbackTimer);
+            nextTick += tickQpc;
+        }
+        Observe(&render, &renderEvent, &renderSeen, bc.Frequency, &renderLate);
+        if (bc.WithCapture) Observe(&capture, &captureEvent, &captureSeen, bc.Frequency, &captureLate);
+    }
+    renderLate.Boundaries  = LeylineClockFrames(&render.Clock, end) / render.NotifyFrames;
+    captureLate.Boundaries = bc.WithCapture ? LeylineClockFrames(&capture.Clock, end) / capture.NotifyFrames : 0;
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s %s render", bc.Label, scheduler ? "timer" : "tick");
+    PrintLateness(label, renderLate);
+    if (bc.WithCapture)
+    {
+        snprintf(label, sizeof(label), "%s %s capture", bc.Label, scheduler ? "timer" : "tick");
+        PrintLateness(label, captureLate);
+        CloseStream(&engine, &capture);
+    }
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG seconds = HostBench::IterationsFromArgs(argc, argv, 60);
+
+    // Periods that are not whole milliseconds, as shared-mode engines commonly pick.
+    static const BenchCase cases[] =
+    {
+        { "48k/480 solo",       48000, 480, FALSE, 10000000 },
+        { "48k/100 pair",       48000, 100, TRUE,  10000000 },
+        { "44.1k/147 pair",     44100, 147, TRUE,  10000000 },
+        { "44.1k/147 pair acpi", 44100, 147, TRUE, 3579545 },
+    };
+
+    HostBench::PrintHeader("Notification lateness, 10 MHz QPC (acpi: 3.58 MHz)");
+    printf("%u simulated seconds per row; timers fire exactly when due\n", seconds);
+    for (const BenchCase& bc : cases)
+    {
+        RunCase(bc, TRUE, seconds);
+        RunCase(bc, FALSE, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TICK PIPELINE BENCHMARK
+// DPC time per 1 ms tick with the mix in the DPC and with it on the worker thread, for
+// a raw copy and for eight 44.1 kHz render streams resampled into eight 48 kHz
+// captures. With the worker the DPC only stamps the tick; the worker's batch is timed
+// separately. The host has no scheduler, so the worker runs after a modelled wake-up
+// delay on the virtual clock; the added latency is that delay plus the batch's wall
+// time, and it is what the capture read-behind has to cover in place of the mix cost.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+struct BenchLoad
+{
+    const char* Label;
+    ULONG       Pairs;
+    ULONG       RenderRate;
+};
+
+static void RunLoad(const BenchLoad& load, BOOLEAN worker, ULONG wakeUs, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    if (worker) LoopbackEngineStartWorker(&engine);
+
+    std::vector<LoopbackStream> streams(load.Pairs * 2);
+    for (ULONG i = 0; i < streams.size(); i++)
+    {
+        BOOLEAN capture = i >= load.Pairs;
+        ULONG   rate    = capture ? 48000 : load.RenderRate;
+        OpenStream(&streams[i], capture, rate, 16, 2, FALSE, rate * 4 / 10);
+        LoopbackStreamSetState(&engine, &streams[i], KSSTATE_RUN);
+    }
+
+    LONGLONG wakeQpc = QPC_FREQUENCY * wakeUs / 1000000;
+    HostBench::Samples dpc, work, added;
+    dpc.Reserve(ticks);
+    work.Reserve(ticks);
+    added.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC - wakeQpc);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        long long t1 = HostBench::WallNs();
+        dpc.Add(t1 - t0);
+        if (!worker) continue;
+
+        HostClockAdvance(wakeQpc);
+        LoopbackEngineWork(&engine);
+        long long t2 = HostBench::WallNs();
+        work.Add(t2 - t1);
+        added.Add(wakeUs * 1000LL + (t2 - t1));
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s %s", load.Label, worker ? "worker" : "in DPC");
+    HostBench::PrintRow(label, dpc);
+    if (worker)
+    {
+        snprintf(label, sizeof(label), "  batch (wake %u us)", wakeUs);
+        HostBench::PrintRow(label, work);
+        HostBench::PrintRow("  added latency", added);
+    }
+
+    for (LoopbackStream& stream : streams) CloseStream(&engine, &stream);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 5000);
+
+    static const BenchLoad loads[] =
+    {
+        { "1r+1c copy",       1, 48000 },
+        { "8r+8c resample",   8, 44100 },
+    };
+    static const ULONG wakes[] = { 20, 100 };
+
+    HostBench::PrintHeader("Loopback tick: mix in the DPC vs on the worker thread");
+    printf("%u simulated 1 ms ticks per row\n", ticks);
+    for (const BenchLoad& load : loads)
+    {
+        RunLoad(load, FALSE, 0, ticks);
+        for (ULONG wake : wakes) RunLoad(load, TRUE, wake, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PLACEMENT BENCHMARK
+// Synthetic per-cable tick costs, skewed the way real cables are (a few multichannel
+// or resampling cables among many cheap stereo ones). For each shape it compares the
+// busiest processor under round-robin by Id, which is what unbalanced DPCs amount to,
+// against the balancer; counts the moves when every cost jitters by up to 10%; and
+// times one balance call.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+#include "leyline_placement.h"
+
+#include <random>
+
+static std::vector<LeylinePlacementEntry> SyntheticCables(ULONG count, std::mt19937& rng)
+{
+    // Mostly 200-400 ns stereo cables, one in eight an expensive 1-4 us one.
+    std::uniform_int_distribution<ULONG> cheap(200, 400), heavy(1000, 4000), pick(0, 7);
+    std::vector<LeylinePlacementEntry> entries(count);
+    for (ULONG i = 0; i < count; i++)
+    {
+        entries[i].CableId   = i + 1;
+        entries[i].Override  = LEYLINE_PROCESSOR_AUTO;
+        entries[i].Processor = LEYLINE_PROCESSOR_AUTO;
+        entries[i].Cost      = pick(rng) == 0 ? heavy(rng) : cheap(rng);
+        entries[i].Context   = nullptr;
+    }
+    return entries;
+}
+
+static ULONGLONG MaxLoad(const ULONGLONG* load, ULONG processors)
+{
+    ULONGLONG worst = 0;
+    for (ULONG p = 0; p < processors; p++) worst = max(worst, load[p]);
+    return worst;
+}
+
+static void RunShape(ULONG cables, ULONG processors, ULONG iterations)
+{
+    std::mt19937 rng(cables * 131 + processors);
+    std::vector<LeylinePlacementEntry> entries = SyntheticCables(cables, rng);
+
+    ULONGLONG total = 0, largest = 0;
+    ULONGLONG robin[LEYLINE_PLACEMENT_MAX_PROCESSORS] = {};
+    for (const LeylinePlacementEntry& entry : entries)
+    {
+        robin[(entry.CableId - 1) % processors] += entry.Cost;
+        total += entry.Cost;
+        largest = max(largest, entry.Cost);
+    }
+    // No placement beats the mean load or the single most expensive cable.
+    ULONGLONG bound = max(largest, (total + processors - 1) / processors);
+
+    ULONGLONG load[LEYLINE_PLACEMENT_MAX_PROCESSORS];
+    LeylinePlacementBalance(entries.data(), cables, processors, load);
+
+    // Jitter every cost and rebalance from the current placement.
+    std::vector<ULONGLONG> base(cables + 1);
+    for (const LeylinePlacementEntry& entry : entries) base[entry.CableId] = entry.Cost;
+    std::uniform_int_distribution<ULONG> jitter(90, 110);
+    ULONG moves = 0;
+    for (ULONG round = 0; round < 100; round++)
+    {
+        for (LeylinePlacementEntry& entry : entries) entry.Cost = base[entry.CableId] * jitter(rng) / 100;
+        moves += LeylinePlacementBalance(entries.data(), cables, processors, nullptr);
+    }
+
+    HostBench::Samples timing;
+    timing.Reserve(iterations);
+    for (ULONG i = 0; i < iterations; i++)
+    {
+        long long t0 = HostBench::WallNs();
+        LeylinePlacementBalance(entries.data(), cables, processors, nullptr);
+        timing.Add(HostBench::WallNs() - t0);
+        HostBench::Consume(entries.data());
+    }
+
+    char label[64];
+    printf("%2u cables / %2u cpus: bound %6llu ns, round-robin max %6llu ns, balanced max %6llu ns, "
+           "%u moves in 100 noisy rounds\n",
+           cables, processors, (unsigned long long)bound,
+           (unsigned long long)MaxLoad(robin, processors), (unsigned long long)MaxLoad(load, processors), moves);
+    snprintf(label, sizeof(label), "balance %ux%u", cables, processors);
+    HostBench::PrintRow(label, timing);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG iterations = HostBench::IterationsFromArgs(argc, argv, 20000);
+
+    static const ULONG cableCounts[]    = { 8, 32, 64 };
+    static const ULONG processorCounts[] = { 4, 8, 16 };
+
+    HostBench::PrintHeader("DPC placement against synthetic cable costs");
+    for (ULONG cables : cableCounts)
+        for (ULONG processors : processorCounts) RunShape(cables, processors, iterations);
+    return 0;
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PLACEMENT TESTS
+// The balancer against synthetic cable costs, then an engine being retargeted while
+// its timer runs, with its worker following and a high-resolution tick left in phase.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+#include "leyline_placement.h"
+
+#include <vector>
+
+using namespace HostSim;
+
+static std::vector<LeylinePlacementEntry> Cables(const std::vector<ULONGLONG>& costs)
+{
+    std::vector<LeylinePlacementEntry> entries(costs.size());
+    for (size_t i = 0; i < costs.size(); i++)
+    {
+        entries[i].CableId   = (ULONG)i + 1;
+        entries[i].Override  = LEYLINE_PROCESSOR_AUTO;
+        entries[i].Processor = LEYLINE_PROCESSOR_AUTO;
+        entries[i].Cost      = costs[i];
+        entries[i].Context   = nullptr;
+    }
+    return entries;
+}
+
+static const LeylinePlacementEntry* ById(const std::vector<LeylinePlacementEntry>& entries, ULONG id)
+{
+    for (const LeylinePlacementEntry& entry : entries)
+        if (entry.CableId == id) return &entry;
+    return nullptr;
+}
+
+static ULONGLONG MaxLoad(const ULONGLONG* load, ULONG processors)
+{
+    ULONGLONG worst = 0;
+    for (ULONG p = 0; p < processors; p++) worst = max(worst, load[p]);
+    return worst;
+}
+
+TEST(EqualCostsSpreadEvenly)
+{
+    auto entries = Cables(std::vector<ULONGLONG>(8, 100));
+    ULONGLONG load[4];
+    CHECK_EQ(LeylinePlacementBalance(entries.data(), 8, 4, load), 8u);
+    for (ULONG p = 0; p < 4; p++) CHECK_EQ(load[p], 200ull);
+
+    // Ties go by cable Id, so the first placement is the same every time.
+    CHECK_EQ(ById(entries, 1)->Processor, 0u);
+    CHECK_EQ(ById(entries, 2)->Processor, 1u);
+    CHECK_EQ(ById(entries, 5)->Processor, 0u);
+}
+
+TEST(LongestFirstBeatsRoundRobin)
+{
+    // Round-robin by Id would put 900 and 800 together on processor 0.
+    auto entries = Cables({ 900, 100, 100, 800, 100, 100 });
+    ULONGLONG load[3];
+    LeylinePlacementBalance(entries.data(), (ULONG)entries.size(), 3, load);
+    CHECK_EQ(MaxLoad(load, 3), 900ull);
+    CHECK(ById(entries, 1)->Processor != ById(entries, 4)->Processor);
+
+    // LPT stays within 4/3 of the optimum; here the optimum is the mean.
+    std::vector<ULONGLONG> costs;
+    ULONGLONG total = 0;
+    for (ULONG i = 0; i < 64; i++)
+    {
+        ULONGLONG cost = 50 + (i * 2654435761u) % 400;
+        costs.push_back(cost);
+        total += cost;
+    }
+    entries = Cables(costs);
+    ULONGLONG spread[8];
+    LeylinePlacementBalance(entries.data(), 64, 8, spread);
+    CHECK(MaxLoad(spread, 8) * 3 <= (total / 8) * 4);
+}
+
+TEST(OverridesArePlacedFirstAndHonored)
+{
+    auto entries = Cables({ 500, 500, 500, 500 });
+    entries[2].Override = 1;
+    entries[3].Override = 1;
+    ULONGLONG load[2];
+    LeylinePlacementBalance(entries.data(), 4, 2, load);
+
+    CHECK_EQ(ById(entries, 3)->Processor, 1u);
+    CHECK_EQ(ById(entries, 4)->Processor, 1u);
+    CHECK_EQ(ById(entries, 1)->Processor, 0u);      // Automatic cables avoid them
+    CHECK_EQ(ById(entries, 2)->Processor, 0u);
+    CHECK_EQ(load[1], 1000ull);
+
+    // An override past the processor count is treated as automatic.
+    entries = Cables({ 10, 10 });
+    entries[0].Override = 7;
+    LeylinePlacementBalance(entries.data(), 2, 2, nullptr);
+    CHECK(ById(entries, 1)->Processor < 2u);
+    CHECK(ById(entries, 1)->Processor != ById(entries, 2)->Processor);
+}
+
+TEST(SmallChangesDoNotMoveCables)
+{
+    std::vector<ULONGLONG> costs = { 400, 300, 300, 200, 200, 100 };
+    auto entries = Cables(costs);
+    LeylinePlacementBalance(entries.data(), 6, 2, nullptr);
+
+    // Re-run with a few percent of noise on every cost: nothing should move.
+    for (ULONG round = 0; round < 16; round++)
+    {
+        for (LeylinePlacementEntry& entry : entries)
+        {
+            ULONGLONG base = costs[entry.CableId - 1];
+            entry.Cost = base + ((entry.CableId * 7 + round * 13) % 9) * base / 100;
+        }
+        CHECK_EQ(LeylinePlacementBalance(entries.data(), 6, 2, nullptr), 0u);
+    }
+
+    // A large shift does rebalance.
+    for (LeylinePlacementEntry& entry : entries)
+        entry.Cost = (entry.CableId == 6) ? 2000 : costs[entry.CableId - 1];
+    ULONGLONG load[2];
+    CHECK(LeylinePlacementBalance(entries.data(), 6, 2, load) > 0u);
+    CHECK_EQ(MaxLoad(load, 2), 2000ull);
+}
+
+TEST(IdleCablesStayPut)
+{
+    auto entries = Cables({ 0, 0, 0, 300 });
+    for (ULONG i = 0; i < 3; i++) entries[i].Processor = 1;
+    entries[3].Processor = 1;
+    LeylinePlacementBalance(entries.data(), 4, 2, nullptr);
+
+    // The busy cable is alone on processor 1 already; the idle ones don't count.
+    CHECK_EQ(ById(entries, 1)->Processor, 1u);
+    CHECK_EQ(ById(entries, 3)->Processor, 1u);
+    CHECK_EQ(ById(entries, 4)->Processor, 1u);
+
+    // A processor that went offline is never kept, idle or not.
+    entries[0].Processor = 5;
+    LeylinePlacementBalance(entries.data(), 4, 2, nullptr);
+    for (const LeylinePlacementEntry& entry : entries) CHECK(entry.Processor < 2u);
+}
+
+TEST(EngineRetargetsWhileRunning)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+    HostSetProcessorCount(4);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    CHECK_EQ(engine.Processor, LEYLINE_PROCESSOR_AUTO);
+    CHECK_EQ(engine.LoopbackDpc.TargetProcessor, HOST_DPC_ANY_PROCESSOR);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    CHECK(!LoopbackEngineRunning(&engine));                 // Nothing to place yet
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(LoopbackEngineRunning(&engine));
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+
+    LoopbackEngineSetProcessor(&engine, 2);
+    CHECK_EQ(engine.Processor, 2u);
+    CHECK_EQ(engine.LoopbackDpc.TargetProcessor, 2u);
+    CHECK_EQ(RunTicks(&engine, 10), 10u);
+
+    // The worker moves itself after the DPC when it next wakes, here on this thread.
+    CHECK_EQ(HostIdealProcessor(), HOST_DPC_ANY_PROCESSOR);
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(HostIdealProcessor(), 2u);
+    CHECK_EQ(engine.WorkerProcessor, 2u);
+
+    // Indexes past the active processors are ignored.
+    LoopbackEngineSetProcessor(&engine, 4);
+    CHECK_EQ(engine.Processor, 2u);
+    CHECK_EQ(engine.LoopbackDpc.TargetProcessor, 2u);
+
+    // The host clock stands still during a tick, so its measured cost is zero.
+    CHECK_EQ(LoopbackEngineTickCostNs(&engine), 0u);
+    engine.TickCost = (TICK_QPC / 10) << LOOPBACK_COST_SHIFT;
+    CHECK_EQ(LoopbackEngineTickCostNs(&engine), 100000u);
+
+    // Retargeting a stopped engine leaves the timer off.
+    CloseStream(&engine, &capture);
+    CHECK(!LoopbackEngineRunning(&engine));
+    LoopbackEngineSetProcessor(&engine, 1);
+    CHECK_EQ(engine.LoopbackDpc.TargetProcessor, 1u);
+    CHECK_EQ(RunTicks(&engine, 10), 0u);
+    LoopbackEngineWork(&engine);
+    CHECK_EQ(HostIdealProcessor(), 1u);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    HostSetProcessorCount(0);
+}
+
+TEST(HighResolutionTickKeepsItsPhase)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+    HostSetProcessorCount(4);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetTickRange(&engine, LOOPBACK_MIN_PERIOD_US, LOOPBACK_MAX_PERIOD_US);
+
+    // A 2 ms capture buffer ticks every 500 us, from the high-resolution timer.
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 384);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(engine.TickFast);
+
+    // The DPC moves; the timer, which never queues it, stays due when it was.
+    LONGLONG due = 0, moved = 0;
+    HostClockAdvance(TICK_QPC / 5);
+    CHECK(HostExTimerDue(engine.FastTimer, &due));
+    LoopbackEngineSetProcessor(&engine, 2);
+    CHECK_EQ(engine.LoopbackDpc.TargetProcessor, 2u);
+    CHECK(HostExTimerDue(engine.FastTimer, &moved));
+    CHECK_EQ(moved, due);
+    CHECK_EQ(engine.TimerArms, 1ull);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    HostSetProcessorCount(0);
+}
+
+HOST_TEST_MAIN()
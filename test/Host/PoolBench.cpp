@@ -0,0 +1,104 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BUFFER POOL BENCHMARK
+// Wall time from opening a stream (format, buffer, RUN) to its first position read,
+// with the stream allocating its own pages and with them taken from the buffer pool.
+// Streams close between opens, the way short notification sounds churn. "pool" runs
+// the zeroing work item between opens, as an idle worker would; "pool hot" reopens at
+// once, so the open path zeroes the block itself. Host pages are memfd-backed and
+// zero-filled on first touch, so the alloc rows leave out the zeroing the kernel's
+// page allocator does up front; the pool rows include all of theirs.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+enum PoolMode { NoPool, PoolIdle, PoolHot };
+
+struct BenchFormat
+{
+    const char* Label;
+    ULONG       SampleRate;
+    ULONG       Bits;
+    ULONG       Channels;
+    BOOLEAN     IsFloat;
+    ULONG       BufferMs;
+};
+
+static void RunFormat(const BenchFormat& f, PoolMode mode, ULONG iterations)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    DEVICE_OBJECT     device = {};
+    LeylineBufferPool pool;
+    LeylineBufferPoolInit(&pool, &device, LEYLINE_POOL_DEFAULT_LIMIT);
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    ULONG frameBytes = f.Bits / 8 * f.Channels;
+    ULONG byteRate   = f.SampleRate * frameBytes;
+    ULONG bytes      = byteRate / 1000 * f.BufferMs;
+
+    HostBench::Samples open;
+    open.Reserve(iterations);
+    ULONG allocations = HostPageAllocations();
+    for (ULONG i = 0; i < iterations; i++)
+    {
+        LoopbackStream stream;
+        long long t0 = HostBench::WallNs();
+        LoopbackStreamInit(&stream, FALSE);
+        LoopbackStreamSetFormat(&stream, byteRate, f.Bits, 0, f.Channels, f.IsFloat);
+        NTSTATUS status = LoopbackStreamAllocatePooledBuffer(&stream, (mode == NoPool) ? nullptr : &pool,
+                                                             bytes, LOOPBACK_BUFFER_MIRRORED, nullptr);
+        LoopbackStreamSetState(&engine, &stream, KSSTATE_RUN);
+        ULONGLONG position = LoopbackStreamPosition(&stream, HostClockNow());
+        open.Add(HostBench::WallNs() - t0);
+        HostBench::Consume(&position);
+        if (!NT_SUCCESS(status)) abort();
+
+        CloseStream(&engine, &stream);
+        if (mode == PoolIdle) HostWorkItemsRun();
+        HostClockAdvance(TICK_QPC);
+    }
+    allocations = HostPageAllocations() - allocations;
+
+    char label[64];
+    static const char* const modes[] = { "alloc", "pool", "pool hot" };
+    snprintf(label, sizeof(label), "%s %s", f.Label, modes[mode]);
+    HostBench::PrintRow(label, open);
+
+    LeylinePoolStats stats;
+    LeylineBufferPoolQueryStats(&pool, &stats);
+    ULONG served = stats.Hits + stats.Misses;
+    printf("%-28s page allocations %5u  hit rate %5.1f%%  zeroed ahead %5u  on open %5u\n", "",
+           allocations, served ? 100.0 * stats.Hits / served : 0.0, stats.ZeroedAhead, stats.ZeroedOnOpen);
+
+    LoopbackEngineCleanup(&engine);
+    LeylineBufferPoolCleanup(&pool);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG iterations = HostBench::IterationsFromArgs(argc, argv, 2000);
+
+    static const BenchFormat formats[] =
+    {
+        { "48k/16/2 10ms",   48000, 16, 2, FALSE, 10 },
+        { "48k/f32/2 100ms", 48000, 32, 2, TRUE,  100 },
+        { "192k/f32/8 100ms", 192000, 32, 8, TRUE, 100 },
+    };
+
+    HostBench::PrintHeader("Stream open to first position, mirrored buffers");
+    printf("%u opens per row\n", iterations);
+    for (const BenchFormat& f : formats)
+    {
+        RunFormat(f, NoPool, iterations);
+        RunFormat(f, PoolIdle, iterations);
+        RunFormat(f, PoolHot, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// RESAMPLER DPC BENCHMARK
+// DPC time per 1 ms tick for one stereo float render stream feeding one capture
+// stream at another rate, per quality tier. The matched-rate row is the baseline
+// without conversion; the table build time is the one-off PASSIVE_LEVEL cost.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+static const char* c_TierNames[LeylineResampleQualityCount] = { "low", "medium", "high" };
+
+static void RunPair(ULONG renderRate, ULONG captureRate, LeylineResampleQuality quality, ULONG ticks)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetResampleQuality(&engine, quality);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, renderRate,  32, 2, TRUE, renderRate * 8 / 10);   // 100 ms
+    OpenStream(&capture, TRUE,  captureRate, 32, 2, TRUE, captureRate * 8 / 10);
+    float* src = reinterpret_cast<float*>(render.Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < render.Buffer.GetSize() / sizeof(float); i++) src[i] = (float)((i * 37) % 200) / 200.0f - 0.5f;
+
+    long long b0 = HostBench::WallNs();
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    long long buildNs = HostBench::WallNs() - b0;
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+    HostBench::Consume(capture.Buffer.GetBaseAddress());
+
+    char label[64];
+    snprintf(label, sizeof(label), "%u->%u %s", renderRate, captureRate,
+             (renderRate == captureRate) ? "(none)" : c_TierNames[quality]);
+    HostBench::PrintRow(label, samples);
+    if (renderRate != captureRate)
+        printf("%-28s taps %u, table build %.1f us\n", "",
+               capture.Resampler.Table ? capture.Resampler.Table->Taps : 0, buildNs / 1000.0);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 10000);
+
+    static const ULONG pairs[][2] =
+    {
+        { 44100, 48000 }, { 48000, 44100 },
+        { 48000, 96000 }, { 96000, 48000 },
+        { 48000, 192000 }, { 192000, 48000 },
+    };
+
+    HostBench::PrintHeader("Resampler DPC time per 1 ms tick, stereo float");
+    printf("%u simulated ticks per row, SIMD level %d\n", ticks, (int)LeylineDetectSimdLevel());
+
+    RunPair(48000, 48000, LeylineResampleMedium, ticks);
+    for (const auto& pair : pairs)
+    {
+        for (ULONG q = 0; q < LeylineResampleQualityCount; q++)
+            RunPair(pair[0], pair[1], (LeylineResampleQuality)q, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// RESAMPLER TESTS
+// Filter design and frame accounting in isolation, then streams at different rates
+// running through the loopback engine.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+
+#include <math.h>
+
+using namespace HostSim;
+
+static const double c_TwoPi = 6.283185307179586;
+
+// Push the whole input through a mono resampler in block-sized pieces.
+static ULONG RunResampler(const LeylineResampleTable* table, const float* in, ULONG inFrames,
+                          float* out, ULONG maxOut, LeylineSimdLevel level)
+{
+    LeylineResampler resampler;
+    LeylineResamplerAllocate(&resampler, 1);
+    LeylineResamplerReset(&resampler, table, 1);
+
+    ULONG produced = 0;
+    for (ULONG pushed = 0; pushed < inFrames; )
+    {
+        ULONG accepted = LeylineResamplerPush(&resampler, in + pushed, 1, min(inFrames - pushed, 256u));
+        if (accepted == 0) break;   // Out is full
+        pushed   += accepted;
+        produced += LeylineResamplerPull(&resampler, out + produced, 1, maxOut - produced, FALSE, level);
+    }
+
+    LeylineResamplerFree(&resampler);
+    return produced;
+}
+
+static void FillSine(float* samples, ULONG frames, ULONG channels, double hz, ULONG rate, float amplitude)
+{
+    for (ULONG f = 0; f < frames; f++)
+    {
+        float v = amplitude * (float)sin(c_TwoPi * hz * f / rate);
+        for (ULONG c = 0; c < channels; c++) samples[f * channels + c] = v;
+    }
+}
+
+TEST(TableReducesRatePair)
+{
+    LeylineResampleTable* up = nullptr;
+    LeylineResampleTable* down = nullptr;
+    LeylineResampleTable* quarter = nullptr;
+    CHECK(NT_SUCCESS(LeylineResampleTableCreate(44100, 48000, LeylineResampleMedium, &up)));
+    CHECK(NT_SUCCESS(LeylineResampleTableCreate(48000, 44100, LeylineResampleMedium, &down)));
+    CHECK(NT_SUCCESS(LeylineResampleTableCreate(192000, 48000, LeylineResampleMedium, &quarter)));
+
+    CHECK_EQ(up->Phases, 160u);
+    CHECK_EQ(up->Step, 147u);
+    CHECK_EQ(up->Taps, 32u);
+    CHECK_EQ(down->Phases, 147u);
+    CHECK_EQ(down->Step, 160u);
+    CHECK_EQ(down->Taps, 40u);      // ceil(32 * 160 / 147) rounded up to 8
+    CHECK_EQ(quarter->Phases, 1u);
+    CHECK_EQ(quarter->Taps, 128u);
+
+    // Every phase passes DC at unity gain.
+    BOOLEAN unity = TRUE;
+    for (ULONG p = 0; p < down->Phases; p++)
+    {
+        double sum = 0.0;
+        for (ULONG m = 0; m < down->Taps; m++) sum += down->Coefs[p * down->Taps + m];
+        unity = unity && fabs(sum - 1.0) < 1e-5;
+    }
+    CHECK(unity);
+
+    LeylineResampleTable* bad = nullptr;
+    CHECK(!NT_SUCCESS(LeylineResampleTableCreate(0, 48000, LeylineResampleMedium, &bad)));
+    CHECK(!NT_SUCCESS(LeylineResampleTableCreate(48000, 44100, LeylineResampleQualityCount, &bad)));
+    CHECK(bad == nullptr);
+
+    LeylineResampleTableFree(quarter);
+    LeylineResampleTableFree(down);
+    LeylineResampleTableFree(up);
+}
+
+TEST(FrameAccountingIsExact)
+{
+    static const ULONG pairs[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 96000 },
+                                      { 96000, 48000 }, { 48000, 192000 }, { 192000, 48000 },
+                                      { 8000, 44100 } };
+    static float in[48000], out[300000];
+    for (ULONG i = 0; i < 48000; i++) in[i] = 0.25f;
+
+    for (const auto& pair : pairs)
+    {
+        LeylineResampleTable* table = nullptr;
+        LeylineResampleTableCreate(pair[0], pair[1], LeylineResampleMedium, &table);
+
+        // An output exists once its whole filter is covered, counting the pre-roll.
+        const ULONG inFrames = 48000;
+        ULONGLONG expected = ((ULONGLONG)(inFrames - table->Taps / 2) * table->Phases + table->Step - 1) / table->Step;
+        ULONG produced = RunResampler(table, in, inFrames, out, SIZEOF_ARRAY(out), LeylineSimdScalar);
+        CHECK_EQ(produced, (ULONG)expected);
+
+        // InputNeeded is exact: one frame short leaves the last output unfinished.
+        LeylineResampler resampler;
+        LeylineResamplerAllocate(&resampler, 1);
+        LeylineResamplerReset(&resampler, table, 1);
+        ULONG need = LeylineResamplerInputNeeded(&resampler, 50);
+        CHECK_EQ(LeylineResamplerPush(&resampler, in, 1, need - 1), need - 1);
+        ULONG early = LeylineResamplerPull(&resampler, out, 1, 50, FALSE, LeylineSimdScalar);
+        CHECK(early < 50);
+        CHECK_EQ(LeylineResamplerInputNeeded(&resampler, 50 - early), 1u);
+        CHECK_EQ(LeylineResamplerPush(&resampler, in, 1, 1), 1u);
+        CHECK_EQ(LeylineResamplerPull(&resampler, out, 1, 50 - early, FALSE, LeylineSimdScalar), 50 - early);
+        LeylineResamplerFree(&resampler);
+
+        LeylineResampleTableFree(table);
+    }
+}
+
+TEST(SineKeepsPitchAndLevel)
+{
+    static const ULONG pairs[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 96000 },
+                                      { 96000, 48000 }, { 48000, 192000 }, { 192000, 48000 } };
+    static float in[192000 / 10], out[192000 / 5];
+
+    for (const auto& pair : pairs)
+    {
+        for (ULONG q = 0; q < LeylineResampleQualityCount; q++)
+        {
+            LeylineResampleTable* table = nullptr;
+            LeylineResampleTableCreate(pair[0], pair[1], (LeylineResampleQuality)q, &table);
+
+            ULONG inFrames = pair[0] / 10;
+            FillSine(in, inFrames, 1, 1000.0, pair[0], 0.5f);
+            ULONG produced = RunResampler(table, in, inFrames, out, SIZEOF_ARRAY(out), LeylineSimdScalar);
+
+            // Output k sits at input time k * M / L, so it should be the same tone
+            // sampled at the output rate. Skip the outputs that still see the pre-roll.
+            double worst = 0.0;
+            for (ULONG k = table->Taps; k < produced; k++)
+            {
+                double ideal = 0.5 * sin(c_TwoPi * 1000.0 * k / pair[1]);
+                worst = fmax(worst, fabs(out[k] - ideal));
+            }
+            if (worst > 1e-3)
+                printf("  %u -> %u Hz, tier %u: error %g\n", pair[0], pair[1], q, worst);
+            CHECK(worst < 1e-3);
+
+            LeylineResampleTableFree(table);
+        }
+    }
+}
+
+TEST(HighTierRejectsAliases)
+{
+    // 23.5 kHz at 48 kHz would fold to 20.6 kHz at 44.1 kHz.
+    static float in[48000 / 10], out[48000 / 10];
+    LeylineResampleTable* table = nullptr;
+    LeylineResampleTableCreate(48000, 44100, LeylineResampleHigh, &table);
+
+    FillSine(in, SIZEOF_ARRAY(in), 1, 23500.0, 48000, 0.5f);
+    ULONG produced = RunResampler(table, in, SIZEOF_ARRAY(in), out, SIZEOF_ARRAY(out), LeylineSimdScalar);
+
+    double energy = 0.0;
+    for (ULONG k = table->Taps; k < produced; k++) energy += (double)out[k] * out[k];
+    double rms = sqrt(energy / (produced - table->Taps));
+    CHECK(rms < 1e-3);
+
+    LeylineResampleTableFree(table);
+}
+
+TEST(SimdFiltersMatchScalar)
+{
+    static float in[4800], scalarOut[8000], simdOut[8000];
+    FillSine(in, SIZEOF_ARRAY(in), 1, 997.0, 48000, 0.9f);
+
+    LeylineResampleTable* table = nullptr;
+    LeylineResampleTableCreate(48000, 44100, LeylineResampleHigh, &table);
+    ULONG scalarCount = RunResampler(table, in, SIZEOF_ARRAY(in), scalarOut, 8000, LeylineSimdScalar);
+
+    for (int level = LeylineSimdSse2; level <= (int)LeylineDetectSimdLevel(); level++)
+    {
+        ULONG simdCount = RunResampler(table, in, SIZEOF_ARRAY(in), simdOut, 8000, (LeylineSimdLevel)level);
+        CHECK_EQ(simdCount, scalarCount);
+
+        float worst = 0.0f;
+        for (ULONG k = 0; k < scalarCount; k++) worst = fmaxf(worst, fabsf(simdOut[k] - scalarOut[k]));
+        CHECK(worst < 1e-5f);
+    }
+
+    LeylineResampleTableFree(table);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ENGINE
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void FillConstant16(LoopbackStream* stream, SHORT value)
+{
+    SHORT* samples = reinterpret_cast<SHORT*>(stream->Buffer.GetBaseAddress());
+    for (ULONG i = 0; i < stream->Buffer.GetSize() / sizeof(SHORT); i++) samples[i] = value;
+}
+
+TEST(TablesArePreparedAtRun)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render48, render44, capture96;
+    OpenStream(&render48,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&render44,  FALSE, 44100, 16, 2, FALSE, 17640);
+    OpenStream(&capture96, TRUE,  96000, 16, 2, FALSE, 38400);
+
+    LoopbackStreamSetState(&engine, &render48, KSSTATE_RUN);
+    CHECK_EQ(engine.ResampleTableCount, 0u);
+
+    // Either render stream may end up as the bus: both directions, plus each into 96k.
+    LoopbackStreamSetState(&engine, &render44, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture96, KSSTATE_RUN);
+    CHECK_EQ(engine.ResampleTableCount, 4u);
+
+    LoopbackEngineSetResampleQuality(&engine, LeylineResampleHigh);
+    CHECK_EQ(engine.ResampleTableCount, 4u);
+    BOOLEAN allHigh = TRUE;
+    for (ULONG i = 0; i < engine.ResampleTableCount; i++)
+        allHigh = allHigh && engine.ResampleTables[i]->Quality == LeylineResampleHigh;
+    CHECK(allHigh);
+
+    CloseStream(&engine, &capture96);
+    CloseStream(&engine, &render44);
+    CloseStream(&engine, &render48);
+    CHECK(render48.Resampler.History == nullptr);
+    LoopbackEngineCleanup(&engine);
+    CHECK_EQ(engine.ResampleTableCount, 0u);
+}
+
+TEST(CaptureAtAnotherRateKeepsPitch)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // 200 ms rings: a whole number of 1 kHz periods at 48 kHz, so the tone loops cleanly.
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 32, 2, TRUE, 9600 * 8);
+    OpenStream(&capture, TRUE,  44100, 32, 2, TRUE, 8820 * 8);
+    FillSine(reinterpret_cast<float*>(render.Buffer.GetBaseAddress()), 9600, 2, 1000.0, 48000, 0.5f);
+
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 150);
+
+    CHECK_EQ(engine.GlitchCount, 0u);
+    CHECK(capture.Resampling);
+
+    // Writes keep pace with the capture clock.
+    ULONGLONG captureFrame = capture.HwPositionRegister / capture.FrameBytes;
+    CHECK(capture.Cursor + 2 >= captureFrame && capture.Cursor <= captureFrame + 2);
+
+    // 100 ms of steady state: 200 zero crossings at 1 kHz, peak unchanged.
+    const float* dst = reinterpret_cast<const float*>(capture.Buffer.GetBaseAddress());
+    ULONG crossings = 0;
+    float peak = 0.0f;
+    for (ULONG f = 2000; f < 2000 + 4410; f++)
+    {
+        float a = dst[f * 2], b = dst[(f + 1) * 2];
+        if ((a < 0.0f) != (b < 0.0f)) crossings++;
+        peak = fmaxf(peak, fabsf(a));
+        CHECK(dst[f * 2] == dst[f * 2 + 1]);
+    }
+    CHECK(crossings >= 199 && crossings <= 201);
+    CHECK(fabsf(peak - 0.5f) < 0.005f);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(RenderAtAnotherRateJoinsTheMix)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    LoopbackStream render48, render44, capture;
+    OpenStream(&render48, FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&render44, FALSE, 44100, 16, 2, FALSE, 17640);
+    OpenStream(&capture,  TRUE,  48000, 16, 2, FALSE, 19200);
+    FillConstant16(&render48, 1000);
+    FillConstant16(&render44, 234);
+
+    LoopbackStreamSetState(&engine, &render48, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &render44, KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture,  KSSTATE_RUN);
+    RunTicks(&engine, 40);
+
+    CHECK_EQ(engine.GlitchCount, 0u);
+    CHECK(render44.Resampling);
+
+    // The converted stream is read up to its own clock, no further.
+    ULONGLONG render44Frame = render44.HwPositionRegister / render44.FrameBytes;
+    CHECK(render44.Cursor <= render44Frame + 1 && render44.Cursor + LOOPBACK_RESYNC_FRAMES >= render44Frame);
+
+    // Once the filter is primed the sum is exact to within a rounding step.
+    const SHORT* dst = reinterpret_cast<const SHORT*>(capture.Buffer.GetBaseAddress());
+    BOOLEAN summed = TRUE;
+    for (ULONG i = 2 * 200; i < 2 * 40 * 48; i++) summed = summed && (dst[i] >= 1233 && dst[i] <= 1235);
+    CHECK(summed);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render44);
+    CloseStream(&engine, &render48);
+    LoopbackEngineCleanup(&engine);
+}
+
+HOST_TEST_MAIN()
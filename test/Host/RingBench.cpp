@@ -0,0 +1,240 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// RING BUFFER BENCHMARK
+// The SPSC RingBuffer against the ring it replaced (plain cursors, a modulo per call,
+// one byte reserved). On one thread: payload rate of write-then-read round trips of
+// 1 ms and 20 ms of 48k stereo 16-bit, and the same through the span API, where the
+// consumer works on the ring in place instead of copying out. Across two threads:
+// throughput and write-to-read latency of timestamped 1 ms chunks, with the old ring
+// behind a spinlock since it has no memory ordering of its own.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+#include <atomic>
+#include <thread>
+
+// The previous RingBuffer, verbatim apart from the name.
+class LegacyRingBuffer
+{
+public:
+    LegacyRingBuffer() : m_Buffer(nullptr), m_Size(0), m_WritePos(0), m_ReadPos(0) {}
+
+    void Init(PUCHAR buffer, ULONG size)
+    {
+        m_Buffer   = buffer;
+        m_Size     = size;
+        m_WritePos = 0;
+        m_ReadPos  = 0;
+    }
+
+    ULONG AvailableWrite() const
+    {
+        if (m_Size == 0) return 0;
+        if (m_WritePos >= m_ReadPos)
+            return m_Size - (m_WritePos - m_ReadPos) - 1;
+        return m_ReadPos - m_WritePos - 1;
+    }
+
+    ULONG AvailableRead() const
+    {
+        if (m_Size == 0) return 0;
+        if (m_WritePos >= m_ReadPos)
+            return m_WritePos - m_ReadPos;
+        return m_Size - (m_ReadPos - m_WritePos);
+    }
+
+    ULONG Write(const PUCHAR data, ULONG len)
+    {
+        ULONG available = AvailableWrite();
+        ULONG toWrite   = min(len, available);
+        if (toWrite == 0) return 0;
+
+        ULONG firstPart = min(toWrite, m_Size - m_WritePos);
+        RtlCopyMemory(m_Buffer + m_WritePos, data, firstPart);
+
+        if (firstPart < toWrite)
+            RtlCopyMemory(m_Buffer, data + firstPart, toWrite - firstPart);
+
+        m_WritePos = (m_WritePos + toWrite) % m_Size;
+        return toWrite;
+    }
+
+    ULONG Read(PUCHAR data, ULONG len)
+    {
+        ULONG available = AvailableRead();
+        ULONG toRead    = min(len, available);
+        if (toRead == 0) return 0;
+
+        ULONG firstPart = min(toRead, m_Size - m_ReadPos);
+        RtlCopyMemory(data, m_Buffer + m_ReadPos, firstPart);
+
+        if (firstPart < toRead)
+            RtlCopyMemory(data + firstPart, m_Buffer, toRead - firstPart);
+
+        m_ReadPos = (m_ReadPos + toRead) % m_Size;
+        return toRead;
+    }
+
+private:
+    PUCHAR  m_Buffer;
+    ULONG   m_Size;
+    ULONG   m_WritePos;
+    ULONG   m_ReadPos;
+};
+
+// The old ring made safe for two threads the only way it can be.
+class LockedLegacyRing
+{
+public:
+    LockedLegacyRing() { KeInitializeSpinLock(&m_Lock); }
+
+    void Init(PUCHAR buffer, ULONG size) { m_Ring.Init(buffer, size); }
+
+    // All or nothing, so chunks stay whole.
+    ULONG Write(const PUCHAR data, ULONG len)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&m_Lock, &irql);
+        ULONG written = m_Ring.AvailableWrite() >= len ? m_Ring.Write(data, len) : 0;
+        KeReleaseSpinLock(&m_Lock, irql);
+        return written;
+    }
+
+    ULONG Read(PUCHAR data, ULONG len)
+    {
+        KIRQL irql;
+        KeAcquireSpinLock(&m_Lock, &irql);
+        ULONG read = m_Ring.AvailableRead() >= len ? m_Ring.Read(data, len) : 0;
+        KeReleaseSpinLock(&m_Lock, irql);
+        return read;
+    }
+
+private:
+    LegacyRingBuffer m_Ring;
+    KSPIN_LOCK       m_Lock;
+};
+
+static const ULONG c_RingSize = 64 * 1024;
+
+static void PrintThroughput(const char* label, ULONGLONG bytes, long long ns)
+{
+    printf("%-36s %8.2f GB/s payload\n", label, ns > 0 ? (double)bytes / (double)ns : 0.0);
+}
+
+template <typename Ring>
+static void CopyRoundTrips(const char* label, Ring& ring, ULONG chunk, ULONG iterations)
+{
+    std::vector<UCHAR> storage(c_RingSize), in(chunk, 0x5A), out(chunk);
+    ring.Init(storage.data(), c_RingSize);
+
+    long long t0 = HostBench::WallNs();
+    for (ULONG i = 0; i < iterations; i++)
+    {
+        ring.Write(in.data(), chunk);
+        ring.Read(out.data(), chunk);
+        HostBench::Consume(out.data());
+    }
+    PrintThroughput(label, (ULONGLONG)chunk * iterations, HostBench::WallNs() - t0);
+}
+
+// The producer copies in through a span and the consumer reads the ring where it is,
+// which the old ring could not offer.
+static void SpanRoundTrips(const char* label, ULONG chunk, ULONG iterations)
+{
+    std::vector<UCHAR> storage(c_RingSize), in(chunk, 0x5A);
+    RingBuffer ring;
+    ring.Init(storage.data(), c_RingSize);
+
+    ULONG sum = 0;
+    long long t0 = HostBench::WallNs();
+    for (ULONG i = 0; i < iterations; i++)
+    {
+        RingBufferSpan span;
+        ULONG n = ring.AcquireWrite(&span, chunk);
+        RtlCopyMemory(span.Data[0], in.data(), span.Length[0]);
+        RtlCopyMemory(span.Data[1], in.data() + span.Length[0], span.Length[1]);
+        ring.CommitWrite(n);
+
+        n = ring.AcquireRead(&span, chunk);
+        sum += span.Data[0][0] + span.Data[0][span.Length[0] - 1];
+        ring.CommitRead(n);
+    }
+    HostBench::Consume(&sum);
+    PrintThroughput(label, (ULONGLONG)chunk * iterations, HostBench::WallNs() - t0);
+}
+
+// Chunks carry the wall time they were written at; the consumer records how long each
+// took to show up.
+template <typename Ring>
+static void CrossThread(const char* label, Ring& ring, ULONG chunk, ULONG chunks)
+{
+    std::vector<UCHAR> storage(c_RingSize);
+    ring.Init(storage.data(), c_RingSize);
+
+    std::thread producer([&ring, chunk, chunks]()
+    {
+        std::vector<UCHAR> in(chunk, 0x5A);
+        for (ULONG sent = 0; sent < chunks; )
+        {
+            long long now = HostBench::WallNs();
+            RtlCopyMemory(in.data(), &now, sizeof(now));
+            if (ring.Write(in.data(), chunk) == chunk) sent++;
+            else YieldProcessor();
+        }
+    });
+
+    HostBench::Samples latency;
+    latency.Reserve(chunks);
+    std::vector<UCHAR> out(chunk);
+    long long t0 = HostBench::WallNs();
+    for (ULONG received = 0; received < chunks; )
+    {
+        if (ring.Read(out.data(), chunk) != chunk) { YieldProcessor(); continue; }
+        long long stamp;
+        RtlCopyMemory(&stamp, out.data(), sizeof(stamp));
+        latency.Add(HostBench::WallNs() - stamp);
+        received++;
+    }
+    long long elapsed = HostBench::WallNs() - t0;
+    producer.join();
+
+    char row[64];
+    snprintf(row, sizeof(row), "%s throughput", label);
+    PrintThroughput(row, (ULONGLONG)chunk * chunks, elapsed);
+    snprintf(row, sizeof(row), "%s latency", label);
+    HostBench::PrintRow(row, latency);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG iterations = HostBench::IterationsFromArgs(argc, argv, 200000);
+
+    static const ULONG chunks[] = { 192, 3840 };    // 1 ms and 20 ms of 48k/16/2
+
+    HostBench::PrintHeader("Ring buffer, one thread, 64 KB ring");
+    for (ULONG chunk : chunks)
+    {
+        char label[64];
+        LegacyRingBuffer legacy;
+        RingBuffer spsc;
+        snprintf(label, sizeof(label), "legacy copy, %u B", chunk);
+        CopyRoundTrips(label, legacy, chunk, iterations);
+        snprintf(label, sizeof(label), "spsc copy, %u B", chunk);
+        CopyRoundTrips(label, spsc, chunk, iterations);
+        snprintf(label, sizeof(label), "spsc spans in place, %u B", chunk);
+        SpanRoundTrips(label, chunk, iterations);
+    }
+
+    HostBench::PrintHeader("Ring buffer, producer and consumer threads, 64 KB ring");
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    {
+        LockedLegacyRing legacy;
+        RingBuffer spsc;
+        CrossThread("legacy + spinlock, 192 B", legacy, 192, iterations);
+        CrossThread("spsc, 192 B", spsc, 192, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// OBJECT SLAB TESTS
+// Slot size and alignment, zeroing on reuse, growth by whole chunks, requests larger
+// than the slab's type, and loopback streams that live in slab slots.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+#include "leyline_slab.h"
+
+#include <new>
+
+using namespace HostSim;
+
+static BOOLEAN IsZero(const void* object, SIZE_T size)
+{
+    const UCHAR* p = static_cast<const UCHAR*>(object);
+    for (SIZE_T i = 0; i < size; i++)
+        if (p[i]) return FALSE;
+    return TRUE;
+}
+
+static BOOLEAN IsLineAligned(const void* object)
+{
+    return (reinterpret_cast<ULONG_PTR>(object) % SYSTEM_CACHE_ALIGNMENT_SIZE) == 0;
+}
+
+TEST(SlotsAreWholeAlignedLines)
+{
+    LeylineSlab slab;
+    LeylineSlabInit(&slab, 100, 'TEST');
+    CHECK_EQ(slab.ObjectSize, 128u);
+    CHECK_EQ(slab.ChunkObjects, (ULONG)(LEYLINE_SLAB_CHUNK_BYTES / 128));
+
+    PVOID a = LeylineSlabAllocate(&slab, 100);
+    PVOID b = LeylineSlabAllocate(&slab, 100);
+    CHECK(a && b);
+    CHECK(IsLineAligned(a));
+    CHECK(IsLineAligned(b));
+    CHECK_EQ((ULONG)((PUCHAR)b - (PUCHAR)a), 128u);
+    CHECK(IsZero(a, slab.ObjectSize));
+
+    LeylineSlabFree(&slab, b);
+    LeylineSlabFree(&slab, a);
+    LeylineSlabCleanup(&slab);
+}
+
+TEST(FreedSlotsAreReusedZeroed)
+{
+    LeylineSlab slab;
+    LeylineSlabInit(&slab, 256, 'TEST');
+
+    PVOID a = LeylineSlabAllocate(&slab, 256);
+    memset(a, 0xA5, 256);
+    LeylineSlabFree(&slab, a);
+    CHECK_EQ(slab.InUse, 0u);
+
+    // The last slot freed is the next one handed out, still warm in the cache.
+    PVOID again = LeylineSlabAllocate(&slab, 256);
+    CHECK(again == a);
+    CHECK(IsZero(again, 256));
+    CHECK_EQ(slab.ChunkCount, 1u);
+
+    LeylineSlabFree(&slab, again);
+    LeylineSlabCleanup(&slab);
+}
+
+TEST(SlabGrowsByWholeChunks)
+{
+    LeylineSlab slab;
+    LeylineSlabInit(&slab, 1000, 'TEST');
+    ULONG  count = slab.ChunkObjects + 1;
+    PVOID* objects = new PVOID[count];
+
+    for (ULONG i = 0; i < count; i++)
+    {
+        objects[i] = LeylineSlabAllocate(&slab, 1000);
+        CHECK(objects[i] && IsLineAligned(objects[i]));
+    }
+    CHECK_EQ(slab.ChunkCount, 2u);
+    CHECK_EQ(slab.InUse, count);
+    CHECK_EQ(slab.Peak, count);
+
+    // Chunks stay once their objects are freed, so the same burst allocates nothing.
+    for (ULONG i = 0; i < count; i++) LeylineSlabFree(&slab, objects[i]);
+    CHECK_EQ(slab.InUse, 0u);
+    for (ULONG i = 0; i < count; i++) objects[i] = LeylineSlabAllocate(&slab, 1000);
+    CHECK_EQ(slab.ChunkCount, 2u);
+    CHECK_EQ(slab.Peak, count);
+
+    for (ULONG i = 0; i < count; i++) LeylineSlabFree(&slab, objects[i]);
+    delete[] objects;
+    LeylineSlabCleanup(&slab);
+    CHECK_EQ(slab.ChunkCount, 0u);
+}
+
+TEST(OversizedRequestsFail)
+{
+    LeylineSlab slab;
+    LeylineSlabInit(&slab, 64, 'TEST');
+    CHECK(LeylineSlabAllocate(&slab, 65) == nullptr);
+    CHECK_EQ(slab.InUse, 0u);
+    CHECK_EQ(slab.ChunkCount, 0u);
+
+    // An object larger than a chunk gets a chunk to itself.
+    LeylineSlab large;
+    LeylineSlabInit(&large, LEYLINE_SLAB_CHUNK_BYTES + 1, 'TEST');
+    CHECK_EQ(large.ChunkObjects, 1u);
+    PVOID a = LeylineSlabAllocate(&large, LEYLINE_SLAB_CHUNK_BYTES + 1);
+    PVOID b = LeylineSlabAllocate(&large, LEYLINE_SLAB_CHUNK_BYTES + 1);
+    CHECK(a && b && IsLineAligned(a) && IsLineAligned(b));
+    CHECK_EQ(large.ChunkCount, 2u);
+
+    LeylineSlabFree(&large, a);
+    LeylineSlabFree(&large, b);
+    LeylineSlabCleanup(&large);
+    LeylineSlabCleanup(&slab);
+}
+
+TEST(SlabStreamsCarryAudio)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylineSlab slab;
+    LeylineSlabInit(&slab, sizeof(LoopbackStream), 'TEST');
+
+    auto* render  = new (LeylineSlabAllocate(&slab, sizeof(LoopbackStream))) LoopbackStream;
+    auto* capture = new (LeylineSlabAllocate(&slab, sizeof(LoopbackStream))) LoopbackStream;
+    CHECK(IsLineAligned(render) && IsLineAligned(capture));
+    OpenStream(render,  FALSE, 48000, 16, 2, FALSE, 48000 * 4 / 10);
+    OpenStream(capture, TRUE,  48000, 16, 2, FALSE, 48000 * 4 / 10);
+    for (ULONG i = 0; i < 9600; i++) render->BufferBase[i] = (UCHAR)(i * 7 + 1);
+
+    LoopbackStreamSetState(&engine, render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, capture, KSSTATE_RUN);
+    RunTicks(&engine, 50);
+    CHECK_EQ(capture->HwPositionRegister, 9600ull);
+    CHECK(memcmp(render->BufferBase, capture->BufferBase, 9600) == 0);
+
+    CloseStream(&engine, capture);
+    CloseStream(&engine, render);
+    LeylineSlabFree(&slab, capture);
+    LeylineSlabFree(&slab, render);
+    LoopbackEngineCleanup(&engine);
+    LeylineSlabCleanup(&slab);
+}
+
+HOST_TEST_MAIN()
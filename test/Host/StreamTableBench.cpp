@@ -0,0 +1,93 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// STREAM TABLE BENCHMARK
+// DPC time per 1 ms tick with many 48 kHz 16-bit stereo streams on one cable. Each
+// stream is its own allocation, a page apart, as miniport objects are in the kernel.
+// "warm" ticks back to back; "cold" evicts the caches between ticks, as a millisecond
+// of other work would, so every line of stream state the tick touches is a miss and
+// the rows show what the tick's per-stream working set costs on top of the samples.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+#include <new>
+
+using namespace HostSim;
+
+static const ULONG c_Rate        = 48000;
+static const ULONG c_BufferBytes = c_Rate * 4 / 10;    // 100 ms of 16-bit stereo
+static const SIZE_T c_EvictBytes = 64 * 1024 * 1024;
+
+static volatile UCHAR s_Sink;
+
+static void EvictCaches(UCHAR* evict)
+{
+    UCHAR sum = 0;
+    for (SIZE_T i = 0; i < c_EvictBytes; i += SYSTEM_CACHE_ALIGNMENT_SIZE)
+    {
+        evict[i]++;
+        sum += evict[i];
+    }
+    s_Sink = sum;
+}
+
+static void RunStreams(ULONG renderCount, ULONG captureCount, BOOLEAN cold, ULONG ticks, UCHAR* evict)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+
+    // A page per stream keeps any two from sharing a line or an adjacent-line prefetch.
+    ULONG  count  = renderCount + captureCount;
+    SIZE_T stride = (sizeof(LoopbackStream) + PAGE_SIZE - 1) & ~(SIZE_T)(PAGE_SIZE - 1);
+    UCHAR* arena  = static_cast<UCHAR*>(operator new(stride * count, std::align_val_t(PAGE_SIZE)));
+    std::vector<LoopbackStream*> streams(count);
+    for (ULONG i = 0; i < count; i++)
+    {
+        streams[i] = new (arena + stride * i) LoopbackStream;
+        OpenStream(streams[i], i >= renderCount, c_Rate, 16, 2, FALSE, c_BufferBytes);
+        LoopbackStreamSetState(&engine, streams[i], KSSTATE_RUN);
+    }
+
+    HostBench::Samples samples;
+    samples.Reserve(ticks);
+    for (ULONG i = 0; i < ticks; i++)
+    {
+        if (cold) EvictCaches(evict);
+        HostClockAdvance(TICK_QPC);
+        long long t0 = HostBench::WallNs();
+        HostTimerFire(&engine.LoopbackTimer);
+        samples.Add(HostBench::WallNs() - t0);
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%ur+%uc %s", renderCount, captureCount, cold ? "cold" : "warm");
+    HostBench::PrintRow(label, samples);
+
+    for (LoopbackStream* stream : streams) CloseStream(&engine, stream);
+    operator delete(arena, std::align_val_t(PAGE_SIZE));
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG ticks = HostBench::IterationsFromArgs(argc, argv, 2000);
+    UCHAR* evict = static_cast<UCHAR*>(calloc(1, c_EvictBytes));
+
+    static const ULONG counts[][2] = { { 1, 1 }, { 8, 8 }, { 32, 32 }, { 63, 1 } };
+
+    HostBench::PrintHeader("Loopback DPC time per 1 ms tick by stream count");
+    printf("%u simulated ticks per row, %zu-byte streams\n", ticks, sizeof(LoopbackStream));
+    for (const auto& c : counts)
+    {
+        RunStreams(c[0], c[1], FALSE, ticks, evict);
+        RunStreams(c[0], c[1], TRUE, ticks / 4, evict);
+    }
+
+    free(evict);
+    return 0;
+}
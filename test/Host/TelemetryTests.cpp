@@ -0,0 +1,286 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TELEMETRY TESTS
+// The shared memory ABI as user mode sees it: the page layouts, the engine publishing
+// gain and levels to the telemetry page and the legacy block, and the header-only
+// reader, which is included first to prove it needs nothing from the driver.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "leyline_reader.h"
+
+#include "HostTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace HostSim;
+
+static void InitPage(LeylineTelemetryPage* page)
+{
+    memset(page, 0, sizeof(*page));
+    page->Header.Magic        = LEYLINE_TELEMETRY_MAGIC;
+    page->Header.Version      = LEYLINE_TELEMETRY_VERSION;
+    page->Header.Size         = sizeof(LeylineTelemetryPage);
+    page->Header.CableId      = 1;
+    page->Header.QpcFrequency = QPC_FREQUENCY;
+}
+
+TEST(LayoutIsStable)
+{
+    // One cache line per producer, every 64-bit field aligned.
+    CHECK_EQ(offsetof(LeylineTelemetryPage, Gain), 64u);
+    CHECK_EQ(offsetof(LeylineTelemetryPage, Meter), 128u);
+    CHECK_EQ(offsetof(LeylineTelemetryHeader, QpcFrequency), 16u);
+    CHECK_EQ(offsetof(LeylineTelemetryMeter, LoudnessBits), 24u);
+    CHECK_EQ(offsetof(LeylineTelemetryPage, Timer), 192u);
+    CHECK_EQ(offsetof(LeylineTelemetryTimer, Wakeups), 16u);
+    CHECK_EQ(offsetof(LeylinePositionRecord, Position), 16u);
+    CHECK_EQ(offsetof(LeylinePositionPage, QpcFrequency), 16u);
+
+    // The legacy block keeps the layout existing clients were built against.
+    CHECK_EQ(offsetof(LeylineSharedParameters, QpcFrequency), 12u);
+    CHECK_EQ(offsetof(LeylineSharedParameters, WritePos), 44u);
+    CHECK_EQ(offsetof(LeylineSharedParameters, MeterSequence), 52u);
+    CHECK_EQ(offsetof(LeylineSharedParameters, LoudnessBits), 64u);
+
+    // The reader's codes are the driver's.
+    CHECK_EQ(LEYLINE_READER_IOCTL_MAP_PARAMS, (ULONG)IOCTL_LEYLINE_MAP_PARAMS);
+    CHECK_EQ(LEYLINE_READER_IOCTL_MAP_POSITIONS, (ULONG)IOCTL_LEYLINE_MAP_POSITIONS);
+    CHECK_EQ(LEYLINE_READER_IOCTL_MAP_TELEMETRY, (ULONG)IOCTL_LEYLINE_MAP_TELEMETRY);
+}
+
+TEST(ReaderRejectsForeignPages)
+{
+    LeylineTelemetryPage page;
+    InitPage(&page);
+    CHECK(LeylineTelemetryValid(&page, sizeof(page)));
+    CHECK(!LeylineTelemetryValid(&page, sizeof(page) - 1));
+    CHECK(!LeylineTelemetryValid(nullptr, sizeof(page)));
+
+    // A newer driver may append; a different major version may not be read.
+    page.Header.Size = sizeof(page) + 64;
+    CHECK(LeylineTelemetryValid(&page, sizeof(page)));
+    page.Header.Size = LEYLINE_TELEMETRY_SIZE_V1 - 64;
+    CHECK(!LeylineTelemetryValid(&page, sizeof(page)));
+
+    // An older one has no timer section, and the reader knows not to look.
+    page.Header.Size = LEYLINE_TELEMETRY_SIZE_V1;
+    CHECK(LeylineTelemetryValid(&page, LEYLINE_TELEMETRY_SIZE_V1));
+    LeylineTimerReading timer = {};
+    CHECK(!LeylineReadTimer(&page, &timer));
+    InitPage(&page);
+    page.Header.Version = LEYLINE_TELEMETRY_VERSION + 1;
+    CHECK(!LeylineTelemetryValid(&page, sizeof(page)));
+    InitPage(&page);
+    page.Header.Magic = 0;
+    CHECK(!LeylineTelemetryValid(&page, sizeof(page)));
+
+    // A section left mid-write is reported, not returned.
+    InitPage(&page);
+    page.Meter.Sequence = 1;
+    LeylineMeterReading meter = {};
+    CHECK(!LeylineReadMeter(&page, &meter));
+    page.Meter.Sequence = 2;
+    CHECK(LeylineReadMeter(&page, &meter));
+}
+
+TEST(EnginePublishesToBothPages)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylineTelemetryPage page;
+    InitPage(&page);
+    LeylineSharedParameters params = {};
+    LoopbackEngineSetTelemetry(&engine, &page);
+    LoopbackEngineSetSharedParameters(&engine, &params);
+
+    // Attaching publishes the current gain and the idle levels.
+    LeylineGainReading gain = {};
+    CHECK(LeylineReadGain(&page, &gain));
+    CHECK_EQ(page.Gain.Sequence, 2u);
+    CHECK(gain.Gain == 1.0f);
+    CHECK_EQ(gain.VolumeLevel, 0);
+    CHECK(!gain.Mute);
+    CHECK(page.Meter.Sequence > 0 && page.Meter.Sequence % 2 == 0);
+
+    LoopbackEngineSetMasterGain(&engine, -6 * 0x10000, FALSE);
+    CHECK(LeylineReadGain(&page, &gain));
+    CHECK(gain.Gain == LeylineGainFromVolume(-6 * 0x10000));
+    CHECK_EQ(gain.VolumeLevel, -6 * 0x10000);
+    LoopbackEngineSetMasterGain(&engine, -6 * 0x10000, TRUE);
+    CHECK(LeylineReadGain(&page, &gain));
+    CHECK(gain.Gain == 0.0f);
+    CHECK(gain.Mute);
+    LoopbackEngineSetMasterGain(&engine, 0, FALSE);
+    CHECK_EQ(page.Gain.Sequence, 8u);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    SHORT* src = reinterpret_cast<SHORT*>(render.Buffer.GetBaseAddress());
+    for (ULONG f = 0; f < render.Buffer.GetSize() / 4; f++)
+    {
+        src[f * 2]     = 16384;     // 0.5
+        src[f * 2 + 1] = -8192;     // -0.25
+    }
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    ULONG sequence = page.Meter.Sequence;
+    RunTicks(&engine, 100);
+
+    // Both pages carry the same settled levels.
+    LeylineMeterReading meter = {}, legacy = {};
+    CHECK(LeylineReadMeter(&page, &meter));
+    CHECK(LeylineReadLegacyMeter(&params, &legacy));
+    CHECK_EQ(page.Meter.Sequence, sequence + 2);
+    CHECK_EQ(meter.Channels, 2u);
+    CHECK(meter.Peak[0] == 0.5f && meter.Peak[1] == 0.25f);
+    CHECK(meter.Peak[0] == legacy.Peak[0] && meter.Peak[1] == legacy.Peak[1]);
+    CHECK(meter.Rms[0] == legacy.Rms[0] && meter.Rms[1] == legacy.Rms[1]);
+    CHECK(meter.Loudness == legacy.Loudness);
+
+    // Silence when the loopback stops; detaching leaves the page alone.
+    CloseStream(&engine, &capture);
+    CHECK(LeylineReadMeter(&page, &meter));
+    CHECK_EQ(meter.Channels, 0u);
+    CHECK(meter.Peak[0] == 0.0f);
+    LoopbackEngineSetTelemetry(&engine, nullptr);
+    LoopbackEngineSetMasterGain(&engine, -20 * 0x10000, FALSE);
+    CHECK_EQ(page.Gain.Sequence, 8u);
+
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(TimerSectionCountsWakeups)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetSafetyOffset(&engine, 2000, TRUE);
+    LeylineTelemetryPage page;
+    InitPage(&page);
+    LoopbackEngineSetTelemetry(&engine, &page);
+
+    LeylineTimerReading timer = {};
+    CHECK(LeylineReadTimer(&page, &timer));
+    CHECK(!timer.Running);
+    CHECK_EQ(timer.Arms, 0ull);
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK(LeylineReadTimer(&page, &timer));
+    CHECK(timer.Running);
+    CHECK_EQ(timer.Arms, 1ull);
+    CHECK_EQ(timer.ToleranceMs, 1u);            // A 2 ms floor leaves a period to spare
+    CHECK_EQ(timer.PeriodUs, 1000u);
+
+    // The tick republishes every 100 wakeups; stopping publishes the rest.
+    RunTicks(&engine, 250);
+    CHECK(LeylineReadTimer(&page, &timer));
+    CHECK_EQ(timer.Wakeups, 200ull);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_PAUSE);
+    CHECK(LeylineReadTimer(&page, &timer));
+    CHECK(!timer.Running);
+    CHECK_EQ(timer.Wakeups, 250ull);
+    CHECK_EQ(timer.IdleWakeups, 0ull);
+
+    // Idle, nothing moves.
+    RunTicks(&engine, 250);
+    CHECK(LeylineReadTimer(&page, &timer));
+    CHECK_EQ(timer.Wakeups, 250ull);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineSetTelemetry(&engine, nullptr);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(GainReadsAreNeverTorn)
+{
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylineTelemetryPage page;
+    InitPage(&page);
+    LoopbackEngineSetTelemetry(&engine, &page);
+
+    // Every published gain must match the volume and mute published with it.
+    std::atomic<bool>  stop(false);
+    std::atomic<ULONG> reads(0), torn(0);
+    std::thread reader([&]() {
+        while (!stop.load())
+        {
+            LeylineGainReading gain = {};
+            if (!LeylineReadGain(&page, &gain)) continue;
+            float expected = gain.Mute ? 0.0f : LeylineGainFromVolume(gain.VolumeLevel);
+            if (gain.Gain != expected) torn++;
+            reads++;
+        }
+    });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (ULONG i = 0; (i < 200000 || reads.load() < 10000) && std::chrono::steady_clock::now() < deadline; i++)
+    {
+        LONG level = -(LONG)(i % 96) * 0x10000;
+        LoopbackEngineSetMasterGain(&engine, level, (i % 7) == 0);
+    }
+    stop = true;
+    reader.join();
+
+    printf("  %u reads\n", reads.load());
+    CHECK(reads.load() > 0u);
+    CHECK_EQ(torn.load(), 0u);
+    LoopbackEngineCleanup(&engine);
+}
+
+TEST(PositionsThroughTheReader)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LeylinePositionPage page = {};
+    LoopbackEngineSetPositionPage(&engine, &page);
+    CHECK(LeylinePositionsValid(&page, sizeof(page)));
+    CHECK(!LeylinePositionsValid(&page, sizeof(page) - 1));
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+
+    LeylinePositionRecord record = {};
+    CHECK(LeylineReadPosition(&page, 0, &record));
+    CHECK_EQ(record.StreamId, 1u);
+    CHECK_EQ(record.Position, 480ull * 4);
+    CHECK_EQ(record.Qpc, HostClockNow());
+    CHECK(!LeylineReadPosition(&page, LEYLINE_MAX_POSITION_RECORDS, &record));
+
+    // Between ticks the position follows the byte rate; paused, it holds.
+    CHECK(LeylineReadPosition(&page, 0, &record));
+    CHECK_EQ(LeylinePositionAt(&record, page.QpcFrequency, record.Qpc + TICK_QPC / 2), 504ull * 4);
+    LoopbackStreamSetState(&engine, &render, KSSTATE_PAUSE);
+    CHECK(LeylineReadPosition(&page, 0, &record));
+    CHECK_EQ(LeylinePositionAt(&record, page.QpcFrequency, record.Qpc + TICK_QPC), record.Position);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineSetPositionPage(&engine, nullptr);
+    LoopbackEngineCleanup(&engine);
+}
+
+HOST_TEST_MAIN()
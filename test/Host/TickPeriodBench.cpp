@@ -0,0 +1,78 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TICK PERIOD BENCHMARK
+// Loopback CPU time per simulated second of audio against the tick period, for a cable
+// carrying one 48 kHz 16-bit stereo render stream into one capture, and for eight of
+// each. The period is pinned with the cable's tick range; the streams' 100 ms buffers
+// would allow any of them. Each sample is the wall time of all ticks in one simulated
+// second, so what falls with a longer period is the fixed cost of each wakeup; the
+// samples themselves cost the same at any period. Host timers fire without an
+// interrupt or a context switch, so the per-wakeup saving in the kernel is larger.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostBench.h"
+
+using namespace HostSim;
+
+static const ULONG c_Rate        = 48000;
+static const ULONG c_BufferBytes = c_Rate * 4 / 10;    // 100 ms of 16-bit stereo
+
+static void RunPeriod(ULONG periodUs, ULONG pairs, ULONG seconds)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetTickRange(&engine, periodUs, periodUs);
+
+    std::vector<LoopbackStream> streams(pairs * 2);
+    for (ULONG i = 0; i < streams.size(); i++)
+    {
+        OpenStream(&streams[i], i >= pairs, c_Rate, 16, 2, FALSE, c_BufferBytes);
+        LoopbackStreamSetState(&engine, &streams[i], KSSTATE_RUN);
+    }
+
+    LONGLONG step = QPC_FREQUENCY * periodUs / 1000000;
+    ULONG    ticks = 1000000 / periodUs;
+    ULONG    fired = 0;
+    HostBench::Samples perSecond;
+    perSecond.Reserve(seconds);
+    for (ULONG s = 0; s < seconds; s++)
+    {
+        long long t0 = HostBench::WallNs();
+        for (ULONG i = 0; i < ticks; i++)
+        {
+            HostClockAdvance(step);
+            fired += HostTimerFire(&engine.LoopbackTimer);
+            fired += HostExTimerFire(engine.FastTimer);
+        }
+        perSecond.Add(HostBench::WallNs() - t0);
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%ur+%uc %5.1f ms%s", pairs, pairs, periodUs / 1000.0,
+             engine.TickFast ? " (hr)" : "");
+    HostBench::PrintRow(label, perSecond);
+    printf("%-28s %7u wakeups/s  %7.1f ns/wakeup  %5.3f%% of a core\n", "", fired / seconds,
+           perSecond.Mean() * seconds / (double)max(fired, 1u), perSecond.Mean() / 1e7);
+
+    for (LoopbackStream& stream : streams) CloseStream(&engine, &stream);
+    LoopbackEngineCleanup(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    ULONG seconds = HostBench::IterationsFromArgs(argc, argv, 20);
+
+    static const ULONG periods[] = { 500, 1000, 2000, 5000, 10000 };
+    static const ULONG pairs[]   = { 1, 8 };
+
+    HostBench::PrintHeader("Loopback CPU per simulated second by tick period");
+    printf("%u simulated seconds per row\n", seconds);
+    for (ULONG n : pairs)
+        for (ULONG period : periods) RunPeriod(period, n, seconds);
+    return 0;
+}
@@ -0,0 +1,312 @@
+// Copyright (c) 2026 Randall Rosas (Slategray).
+// All rights reserved.
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// EVENT TRACING TESTS
+// The provider against the host's in-memory session: nothing is written while no
+// session wants it, the enable callback's level and keyword folding, and the stream,
+// cable and glitch events decoded field by field as the manifest lays them out.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include "HostTest.h"
+#include "leyline_trace.h"
+
+using namespace HostSim;
+
+static const GUID c_TestProvider = { 0x71549463, 0x5E1E, 0x4B7E, { 0x9F, 0x93, 0xA6, 0x56, 0x06, 0xE5, 0x0D, 0x64 } };
+
+static const ULONGLONG c_AllKeywords = LEYLINE_KEYWORD_STREAM | LEYLINE_KEYWORD_CABLE | LEYLINE_KEYWORD_GLITCH;
+
+// Reads an event's payload in field order; Done() once every byte has been read.
+struct PayloadReader
+{
+    EVENT_DESCRIPTOR Descriptor;
+    const UCHAR*     Payload;
+    ULONG            Size;
+    ULONG            Offset;
+
+    explicit PayloadReader(ULONG index) : Descriptor(), Payload(nullptr), Size(0), Offset(0)
+    {
+        HostEtwEvent(index, &Descriptor, &Payload, &Size);
+    }
+
+    template <typename T> T Read()
+    {
+        T value = {};
+        if (Offset + sizeof(T) <= Size) memcpy(&value, Payload + Offset, sizeof(T));
+        Offset += sizeof(T);
+        return value;
+    }
+
+    BOOLEAN Done() const { return Offset == Size; }
+};
+
+// Index of the first kept event with this id, or MAXULONG.
+static ULONG FindEvent(USHORT id, ULONG from = 0)
+{
+    for (ULONG i = from; i < HostEtwEventCount(); i++)
+    {
+        EVENT_DESCRIPTOR descriptor;
+        HostEtwEvent(i, &descriptor, nullptr, nullptr);
+        if (descriptor.Id == id) return i;
+    }
+    return MAXULONG;
+}
+
+static ULONG CountEvents(USHORT id)
+{
+    ULONG count = 0;
+    for (ULONG i = FindEvent(id); i != MAXULONG; i = FindEvent(id, i + 1)) count++;
+    return count;
+}
+
+static void StartSession(UCHAR level, ULONGLONG keywords)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+    HostEtwClear();
+    HostEtwEnable(level, keywords);
+    CHECK_EQ(LeylineTraceRegister(&c_TestProvider), STATUS_SUCCESS);
+}
+
+static void StopSession()
+{
+    LeylineTraceUnregister();
+    HostEtwDisable();
+    HostEtwClear();
+}
+
+TEST(NothingIsWrittenWithoutASession)
+{
+    HostClockReset(QPC_FREQUENCY);
+    HostClockSet(QPC_FREQUENCY);
+    CHECK_EQ(LeylineTraceRegister(&c_TestProvider), STATUS_SUCCESS);
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+
+    ULONG writes = HostEtwWrites();
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+    RunTicks(&engine, 1, 20 * TICK_QPC);
+    CHECK_EQ(engine.GlitchCount, 1u);
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+
+    CHECK_EQ(HostEtwWrites(), writes);
+    CHECK_EQ(HostEtwEventCount(), 0u);
+    LeylineTraceUnregister();
+}
+
+TEST(SessionsFoldIntoKeywordMask)
+{
+    // A session already running when the provider registers enables it at once.
+    StartSession(0, 0);
+    CHECK_EQ(g_LeylineTraceKeywords, c_AllKeywords);
+
+    HostEtwEnable(LEYLINE_LEVEL_WARNING, 0);
+    CHECK_EQ(g_LeylineTraceKeywords, LEYLINE_KEYWORD_GLITCH);
+    HostEtwEnable(LEYLINE_LEVEL_INFORMATION, LEYLINE_KEYWORD_STREAM | LEYLINE_KEYWORD_GLITCH);
+    CHECK_EQ(g_LeylineTraceKeywords, LEYLINE_KEYWORD_STREAM | LEYLINE_KEYWORD_GLITCH);
+    HostEtwEnable(LEYLINE_LEVEL_WARNING, LEYLINE_KEYWORD_STREAM);
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+    HostEtwEnable(2, 0);                                        // Error and worse only
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+    HostEtwEnable(5, 0x1000);                                   // Keywords this provider lacks
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+
+    HostEtwDisable();
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+    HostEtwEnable(0, 0);
+    CHECK_EQ(g_LeylineTraceKeywords, c_AllKeywords);
+
+    // Unregistering turns every call site off, whatever the session still asks for.
+    LeylineTraceUnregister();
+    CHECK_EQ(g_LeylineTraceKeywords, 0ull);
+    StopSession();
+}
+
+TEST(StreamEventsCarryFormatBufferAndState)
+{
+    StartSession(LEYLINE_LEVEL_INFORMATION, LEYLINE_KEYWORD_STREAM);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    engine.CableId = 3;
+
+    LoopbackStream render;
+    LONGLONG openQpc = HostClockNow();
+    CHECK(NT_SUCCESS(OpenStream(&render, FALSE, 48000, 24, 2, FALSE, 28800)));
+    LoopbackStreamSetState(&engine, &render, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+    LONGLONG stopQpc = HostClockNow();
+    LoopbackStreamSetState(&engine, &render, KSSTATE_STOP);
+    LoopbackStreamFreeBuffer(&render);
+
+    ULONG format = FindEvent(LEYLINE_EVENT_STREAM_FORMAT);
+    CHECK(format != MAXULONG);
+    {
+        PayloadReader r(format);
+        CHECK_EQ(r.Descriptor.Level, (UCHAR)LEYLINE_LEVEL_INFORMATION);
+        CHECK_EQ(r.Descriptor.Keyword, LEYLINE_KEYWORD_STREAM);
+        CHECK_EQ(r.Read<ULONGLONG>(), (ULONGLONG)(ULONG_PTR)&render);
+        CHECK_EQ(r.Read<UCHAR>(), 0);
+        CHECK_EQ(r.Read<ULONG>(), 48000u);
+        CHECK_EQ(r.Read<ULONG>(), 24u);
+        CHECK_EQ(r.Read<ULONG>(), 0u);
+        CHECK_EQ(r.Read<ULONG>(), 2u);
+        CHECK_EQ(r.Read<UCHAR>(), 0);
+        CHECK_EQ(r.Read<LONGLONG>(), openQpc);
+        CHECK(r.Done());
+    }
+
+    ULONG buffer = FindEvent(LEYLINE_EVENT_STREAM_BUFFER);
+    CHECK(buffer != MAXULONG && buffer > format);
+    {
+        PayloadReader r(buffer);
+        CHECK_EQ(r.Read<ULONGLONG>(), (ULONGLONG)(ULONG_PTR)&render);
+        CHECK_EQ(r.Read<ULONG>(), 28800u);
+        CHECK_EQ(r.Read<ULONG>(), 28800u);
+        CHECK_EQ(r.Read<UCHAR>(), 0);                           // No pool
+        CHECK_EQ(r.Read<UCHAR>(), 0);                           // Not asked to mirror
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)STATUS_SUCCESS);
+        CHECK_EQ(r.Read<LONGLONG>(), openQpc);
+        CHECK(r.Done());
+    }
+
+    // Stop -> run, then run -> stop 10 ms in: 480 frames of 6 bytes.
+    CHECK_EQ(CountEvents(LEYLINE_EVENT_STREAM_STATE), 2u);
+    ULONG run  = FindEvent(LEYLINE_EVENT_STREAM_STATE);
+    ULONG stop = FindEvent(LEYLINE_EVENT_STREAM_STATE, run + 1);
+    {
+        PayloadReader r(run);
+        CHECK_EQ(r.Read<ULONG>(), 3u);
+        CHECK_EQ(r.Read<ULONGLONG>(), (ULONGLONG)(ULONG_PTR)&render);
+        CHECK_EQ(r.Read<UCHAR>(), 0);
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)KSSTATE_STOP);
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)KSSTATE_RUN);
+        CHECK_EQ(r.Read<ULONGLONG>(), 0ull);
+        CHECK_EQ(r.Read<LONGLONG>(), QPC_FREQUENCY);
+        CHECK(r.Done());
+    }
+    {
+        PayloadReader r(stop);
+        CHECK_EQ(r.Read<ULONG>(), 3u);
+        CHECK_EQ(r.Read<ULONGLONG>(), (ULONGLONG)(ULONG_PTR)&render);
+        CHECK_EQ(r.Read<UCHAR>(), 0);
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)KSSTATE_RUN);
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)KSSTATE_STOP);
+        CHECK_EQ(r.Read<ULONGLONG>(), 480ull * 6);
+        CHECK_EQ(r.Read<LONGLONG>(), stopQpc);
+        CHECK(r.Done());
+    }
+
+    // A failed allocation is traced with its status.
+    LoopbackStream again;
+    OpenStream(&again, TRUE, 48000, 16, 2, FALSE, 1920);
+    HostEtwClear();
+    CHECK_EQ(LoopbackStreamAllocateBuffer(&again, 1920, 0, nullptr), STATUS_ALREADY_COMMITTED);
+    CHECK_EQ(HostEtwEventCount(), 1u);
+    {
+        PayloadReader r(0);
+        CHECK_EQ(r.Descriptor.Id, (USHORT)LEYLINE_EVENT_STREAM_BUFFER);
+        r.Read<ULONGLONG>();
+        CHECK_EQ(r.Read<ULONG>(), 1920u);
+        CHECK_EQ(r.Read<ULONG>(), 0u);
+        r.Read<UCHAR>();
+        r.Read<UCHAR>();
+        CHECK_EQ(r.Read<ULONG>(), (ULONG)STATUS_ALREADY_COMMITTED);
+        CHECK_EQ(r.Read<LONGLONG>(), HostClockNow());
+        CHECK(r.Done());
+    }
+    LoopbackStreamFreeBuffer(&again);
+
+    LoopbackEngineCleanup(&engine);
+    StopSession();
+}
+
+TEST(OverrunCarriesLostFramesAndBytes)
+{
+    // Warning level: the glitches, but none of the stream events.
+    StartSession(LEYLINE_LEVEL_WARNING, 0);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    engine.CableId = 2;
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 1920);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 1920);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    RunTicks(&engine, 10);
+    CHECK_EQ(HostEtwEventCount(), 0u);
+
+    // 20 ms in one tick overruns the 10 ms buffers: the older half is dropped.
+    RunTicks(&engine, 1, 20 * TICK_QPC);
+    CHECK_EQ(CountEvents(LEYLINE_EVENT_OVERRUN), 1u);
+    {
+        PayloadReader r(FindEvent(LEYLINE_EVENT_OVERRUN));
+        CHECK_EQ(r.Descriptor.Level, (UCHAR)LEYLINE_LEVEL_WARNING);
+        CHECK_EQ(r.Descriptor.Keyword, LEYLINE_KEYWORD_GLITCH);
+        CHECK_EQ(r.Read<ULONG>(), 2u);
+        CHECK_EQ(r.Read<ULONGLONG>(), 480ull);
+        CHECK_EQ(r.Read<ULONGLONG>(), 1920ull);
+        CHECK_EQ(r.Read<LONGLONG>(), HostClockNow());
+        CHECK(r.Done());
+    }
+    CHECK_EQ(CountEvents(LEYLINE_EVENT_STREAM_STATE), 0u);
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    StopSession();
+}
+
+TEST(LateTickPastReadBehindIsAnUnderrun)
+{
+    StartSession(0, LEYLINE_KEYWORD_GLITCH);
+
+    LoopbackEngine engine;
+    LoopbackEngineInit(&engine);
+    LoopbackEngineSetSafetyOffset(&engine, 2000, FALSE);
+    engine.CableId = 5;
+
+    LoopbackStream render, capture;
+    OpenStream(&render,  FALSE, 48000, 16, 2, FALSE, 19200);
+    OpenStream(&capture, TRUE,  48000, 16, 2, FALSE, 19200);
+    LoopbackStreamSetState(&engine, &render,  KSSTATE_RUN);
+    LoopbackStreamSetState(&engine, &capture, KSSTATE_RUN);
+    CHECK_EQ(capture.SafetyFrames, 96u);
+
+    // Ticks up to 2 ms apart never let the reader, 2 ms behind, pass the writes.
+    RunTicks(&engine, 10);
+    RunTicks(&engine, 1, 2 * TICK_QPC);
+    CHECK_EQ(HostEtwEventCount(), 0u);
+
+    // 4 ms apart: the reader got 2 ms past the last write.
+    RunTicks(&engine, 1, 4 * TICK_QPC);
+    CHECK_EQ(CountEvents(LEYLINE_EVENT_UNDERRUN), 1u);
+    CHECK_EQ(CountEvents(LEYLINE_EVENT_OVERRUN), 0u);
+    {
+        PayloadReader r(FindEvent(LEYLINE_EVENT_UNDERRUN));
+        CHECK_EQ(r.Read<ULONG>(), 5u);
+        CHECK_EQ(r.Read<ULONGLONG>(), (ULONGLONG)(ULONG_PTR)&capture);
+        CHECK_EQ(r.Read<ULONGLONG>(), capture.HwPositionRegister);
+        CHECK_EQ(r.Read<ULONGLONG>(), 96ull * 4);
+        CHECK_EQ(r.Read<LONGLONG>(), HostClockNow());
+        CHECK(r.Done());
+    }
+
+    CloseStream(&engine, &capture);
+    CloseStream(&engine, &render);
+    LoopbackEngineCleanup(&engine);
+    StopSession();
+}
+
+HOST_TEST_MAIN()